@@ -0,0 +1,98 @@
+/*
+ * AlignedAllocator.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_ALIGNED_ALLOCATOR_H
+#define GM_ALIGNED_ALLOCATOR_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <vector>
+
+
+namespace Gm
+{
+
+
+/**
+\brief Standard allocator with a minimal memory alignment.
+\tparam T Specifies the value type.
+\tparam Alignment Specifies the memory alignment (in bytes). This must be a power of two. By default 32, which is sufficient for AVX loads.
+\remarks This is used for the coordinate streams of structure-of-arrays meshes, so the SIMD loads of the kernels do not cross cache line boundaries.
+*/
+template <typename T, std::size_t Alignment = 32>
+class AlignedAllocator
+{
+
+        static_assert(Alignment > 0 && (Alignment & (Alignment - 1)) == 0, "AlignedAllocator alignment must be a power of two");
+
+    public:
+
+        using value_type = T;
+
+        template <typename U>
+        struct rebind
+        {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        AlignedAllocator() = default;
+
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&)
+        {
+        }
+
+        T* allocate(std::size_t n)
+        {
+            if (n > (std::numeric_limits<std::size_t>::max() - Alignment - sizeof(void*)) / sizeof(T))
+                throw std::bad_alloc();
+
+            /* Allocate with padding and store the original pointer in front of the aligned memory block */
+            auto base = ::operator new(n * sizeof(T) + Alignment + sizeof(void*));
+            auto addr = (reinterpret_cast<std::uintptr_t>(base) + sizeof(void*) + Alignment - 1) & ~static_cast<std::uintptr_t>(Alignment - 1);
+            reinterpret_cast<void**>(addr)[-1] = base;
+
+            return reinterpret_cast<T*>(addr);
+        }
+
+        void deallocate(T* ptr, std::size_t)
+        {
+            if (ptr)
+                ::operator delete(reinterpret_cast<void**>(ptr)[-1]);
+        }
+
+};
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator == (const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+{
+    return true;
+}
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator != (const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+{
+    return false;
+}
+
+
+//! Vector with 32 byte aligned memory.
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
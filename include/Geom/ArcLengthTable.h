@@ -0,0 +1,300 @@
+/*
+ * ArcLengthTable.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_ARC_LENGTH_TABLE_H
+#define GM_ARC_LENGTH_TABLE_H
+
+
+#include <Geom/Macros.h>
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace Gm
+{
+
+
+/**
+\brief Arc-length lookup table to reparameterize a curve by distance.
+\tparam T Specifies the base data type. This should be float or double.
+\remarks The table stores the curve parameter and the accumulated distance at each sample.
+The distances are integrated with a 5-point Gauss-Legendre quadrature between two samples.
+The same quadrature nodes are extrapolated to the speed at both ends of each sample interval,
+so the speed is never evaluated exactly on a curve segment border where the derivative may jump.
+A distance is mapped back to a curve parameter with a monotone cubic Hermite interpolation within the enclosing sample interval,
+so no curve evaluation is required for a lookup.
+\see UniformSpline::BuildArcLengthTable
+\see BezierCurve::BuildArcLengthTable
+\see Spline::BuildArcLengthTable
+*/
+template <typename T>
+class ArcLengthTable
+{
+
+    public:
+
+        GM_ASSERT_FLOAT_TYPE("ArcLengthTable");
+
+        //! Arc-length table sample.
+        struct Sample
+        {
+            T parameter;    //!< Curve parameter.
+            T distance;     //!< Arc length from the start of the curve up to this sample.
+            T startSpeed;   //!< Length of the curve derivative at the start of the interval to the next sample.
+            T endSpeed;     //!< Length of the curve derivative at the end of the interval to the next sample.
+        };
+
+        /**
+        \brief Builds the table for a curve given by its speed function.
+        \param[in] breakpoints Specifies the ascending curve parameters where the curve segments (e.g. the spline polynomials) begin and end.
+        Intervals of zero length are skipped.
+        \param[in] subdivisions Specifies the number of samples per curve segment. This is clamped to at least 1.
+        \param[in] speed Specifies the function that returns the length of the curve derivative at the specified curve parameter.
+        This must have the signature 'T speed(T t)'.
+        */
+        template <typename SpeedFunc>
+        void Build(const std::vector<T>& breakpoints, std::uint32_t subdivisions, SpeedFunc speed)
+        {
+            samples_.clear();
+
+            if (breakpoints.empty())
+                return;
+
+            subdivisions = std::max(subdivisions, 1u);
+            samples_.reserve((breakpoints.size() - 1) * subdivisions + 1);
+
+            /* Add first sample */
+            auto t0 = breakpoints.front();
+            auto s0 = T(0);
+
+            samples_.push_back({ t0, s0, T(0), T(0) });
+
+            for (std::size_t i = 1; i < breakpoints.size(); ++i)
+            {
+                const auto a = breakpoints[i - 1];
+                const auto b = breakpoints[i];
+
+                if (!(a < b))
+                    continue;
+
+                /* Integrate speed over each subdivision of the segment */
+                for (std::uint32_t j = 1; j <= subdivisions; ++j)
+                {
+                    auto t1 = (j == subdivisions ? b : a + (b - a) * static_cast<T>(j) / static_cast<T>(subdivisions));
+                    s0 += Integrate(t0, t1, speed, samples_.back());
+                    samples_.push_back({ t1, s0, T(0), T(0) });
+                    t0 = t1;
+                }
+            }
+        }
+
+        //! Clears the table.
+        void Clear()
+        {
+            samples_.clear();
+        }
+
+        //! Returns true if the table has no samples.
+        bool Empty() const
+        {
+            return samples_.empty();
+        }
+
+        //! Returns the total arc length of the curve.
+        T GetLength() const
+        {
+            return (samples_.empty() ? T(0) : samples_.back().distance);
+        }
+
+        /**
+        \brief Returns the curve parameter at the specified arc length with a binary search in O(log n).
+        \param[in] distance Specifies the arc length from the start of the curve. This is clamped to [0, GetLength()].
+        */
+        T GetParameter(const T& distance) const
+        {
+            std::size_t cursor = 0;
+            return GetParameter(distance, cursor, false);
+        }
+
+        /**
+        \brief Returns the curve parameter at the specified arc length, starting at the specified cursor.
+        \param[in] distance Specifies the arc length from the start of the curve. This is clamped to [0, GetLength()].
+        \param[in,out] cursor Specifies the sample interval of the previous lookup and receives the sample interval of this lookup.
+        Objects that move along the curve in small steps should keep one cursor each, so most lookups run in constant time.
+        Initialize it with 0.
+        */
+        T GetParameter(const T& distance, std::size_t& cursor) const
+        {
+            return GetParameter(distance, cursor, true);
+        }
+
+        /**
+        \brief Returns the curve parameters for many arc lengths at once.
+        \param[in] distances Pointer to the array of arc lengths.
+        \param[out] parameters Pointer to the array of output curve parameters. This must have at least 'count' elements.
+        \param[in] count Specifies the number of arc lengths.
+        \remarks The sample interval of the previous lookup is tried first, so ascending distances skip most of the binary searches.
+        */
+        void GetParameters(const T* distances, T* parameters, std::size_t count) const
+        {
+            std::size_t cursor = 0;
+            for (std::size_t i = 0; i < count; ++i)
+                parameters[i] = GetParameter(distances[i], cursor, true);
+        }
+
+        //! Returns the list of all samples.
+        const std::vector<Sample>& GetSamples() const
+        {
+            return samples_;
+        }
+
+    private:
+
+        // Integrates the speed function over [a, b] with the 5-point Gauss-Legendre quadrature and stores the extrapolated speeds at 'a' and 'b' in the specified sample.
+        template <typename SpeedFunc>
+        static T Integrate(const T& a, const T& b, SpeedFunc& speed, Sample& sample)
+        {
+            static const T nodes[5] =
+            {
+                T(-0.906179845938663992797626878299392965),
+                T(-0.538469310105683091036314420700208805),
+                T(0.0),
+                T(+0.538469310105683091036314420700208805),
+                T(+0.906179845938663992797626878299392965),
+            };
+
+            static const T weights[5] =
+            {
+                T(0.236926885056189087514264040719917363),
+                T(0.478628670499366468086461626275420332),
+                T(0.568888888888888888888888888888888889),
+                T(0.478628670499366468086461626275420332),
+                T(0.236926885056189087514264040719917363),
+            };
+
+            // Lagrange basis of the nodes at +1; the basis at -1 is the same in reverse order.
+            static const T extrapolation[5] =
+            {
+                T(0.076358661795812931),
+                T(-0.267941652223387589),
+                T(0.533333333333333333),
+                T(-0.893158392000072022),
+                T(1.551408049094312736),
+            };
+
+            const auto halfRange    = (b - a) * T(0.5);
+            const auto center       = (a + b) * T(0.5);
+
+            T sum = T(0), startSpeed = T(0), endSpeed = T(0);
+
+            for (int i = 0; i < 5; ++i)
+            {
+                const auto v = speed(center + halfRange * nodes[i]);
+                sum         += weights[i] * v;
+                startSpeed  += extrapolation[4 - i] * v;
+                endSpeed    += extrapolation[i] * v;
+            }
+
+            sample.startSpeed   = std::max(startSpeed, T(0));
+            sample.endSpeed     = std::max(endSpeed, T(0));
+
+            return sum * halfRange;
+        }
+
+        // Returns the index 'i' of the sample interval [i, i + 1] that contains the specified distance.
+        std::size_t FindInterval(const T& distance, std::size_t cursor, bool useCursor) const
+        {
+            const auto last = samples_.size() - 1;
+
+            /* Try the previous and next interval first */
+            if (useCursor && cursor < last && samples_[cursor].distance <= distance)
+            {
+                if (distance <= samples_[cursor + 1].distance)
+                    return cursor;
+                if (cursor + 2 <= last && distance <= samples_[cursor + 2].distance)
+                    return cursor + 1;
+            }
+
+            /* Binary search for the first sample with a greater distance */
+            auto it = std::upper_bound(
+                samples_.begin() + 1,
+                samples_.end(),
+                distance,
+                [](const T& lhs, const Sample& rhs)
+                {
+                    return lhs < rhs.distance;
+                }
+            );
+
+            return std::min(static_cast<std::size_t>(it - samples_.begin()) - 1, last - 1);
+        }
+
+        // Returns the tangent of the inverse mapping 'parameter(distance)', limitted to keep the interpolation monotone.
+        static T InverseSlope(const T& speed, const T& secant)
+        {
+            const auto maxSlope = secant * T(3);
+            return (speed * maxSlope > T(1) ? T(1) / speed : maxSlope);
+        }
+
+        T GetParameter(T distance, std::size_t& cursor, bool useCursor) const
+        {
+            if (samples_.empty())
+                return T(0);
+            if (samples_.size() == 1 || distance <= T(0))
+                return samples_.front().parameter;
+            if (distance >= samples_.back().distance)
+                return samples_.back().parameter;
+
+            cursor = FindInterval(distance, cursor, useCursor);
+
+            const auto& a = samples_[cursor];
+            const auto& b = samples_[cursor + 1];
+
+            const auto ds = b.distance - a.distance;
+            if (!(ds > T(0)))
+                return a.parameter;
+
+            /* Interpolate the inverse mapping with a cubic Hermite curve */
+            const auto dt       = b.parameter - a.parameter;
+            const auto secant   = dt / ds;
+            const auto m0       = InverseSlope(a.startSpeed, secant) * ds;
+            const auto m1       = InverseSlope(a.endSpeed, secant) * ds;
+
+            const auto u    = (distance - a.distance) / ds;
+            const auto u2   = u*u;
+            const auto u3   = u2*u;
+
+            const auto h00 = T(2)*u3 - T(3)*u2 + T(1);
+            const auto h10 = u3 - T(2)*u2 + u;
+            const auto h01 = T(-2)*u3 + T(3)*u2;
+            const auto h11 = u3 - u2;
+
+            return h00*a.parameter + h10*m0 + h01*b.parameter + h11*m1;
+        }
+
+        std::vector<Sample> samples_;
+
+};
+
+
+/* --- Type Alias --- */
+
+using ArcLengthTablef = ArcLengthTable<float>;
+using ArcLengthTabled = ArcLengthTable<double>;
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
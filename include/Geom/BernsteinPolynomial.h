@@ -9,8 +9,11 @@
 #define GM_BERNSTEIN_POLYNOMIAL_H
 
 
+#include <vector>
+#include <algorithm>
 #include <cstdlib>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 
 
@@ -26,11 +29,143 @@ constexpr std::uint64_t Factorial(std::uint64_t n)
     return (n <= 1 ? 1 : (n * Factorial(n - 1)));
 }
 
+/*
+Computes the binomial coefficient with the multiplicative formula 'C(n, i) = C(n, i - 1) * (n - i + 1) / i',
+where each division is exact. This does not overflow for n <= 62, unlike the factorials (n <= 20).
+*/
 constexpr std::uint64_t BinomialCoefficient(std::uint64_t i, std::uint64_t n)
 {
-    return Factorial(n) / (Factorial(i) * Factorial(n - i));
+    return (
+        i > n ? 0 :
+        i == 0 || i == n ? 1 :
+        i > n - i ? BinomialCoefficient(n - i, n) :
+        BinomialCoefficient(i - 1, n) * (n - i + 1) / i
+    );
+}
+
+// Returns 'x' to the power of 'e' by repeated squaring.
+template <typename T>
+T IntegralPow(T x, std::uint32_t e)
+{
+    T result = T(1);
+
+    while (e > 0)
+    {
+        if ((e & 1u) != 0)
+            result *= x;
+        x *= x;
+        e >>= 1;
+    }
+
+    return result;
+}
+
+// Computes the Bernstein basis of order 'n' for any order.
+template <typename T>
+void BernsteinBasisGeneric(const T& t, std::uint32_t n, T* basis)
+{
+    /* Multiply binomial coefficients and ascending powers of t */
+    T coeff = T(1), tPow = T(1);
+
+    for (std::uint32_t i = 0; i <= n; ++i)
+    {
+        basis[i] = coeff * tPow;
+        coeff = coeff * static_cast<T>(n - i) / static_cast<T>(i + 1);
+        tPow *= t;
+    }
+
+    /* Multiply descending powers of (1 - t) */
+    const T s = T(1) - t;
+    T sPow = T(1);
+
+    for (std::uint32_t i = n + 1; i-- > 0;)
+    {
+        basis[i] *= sPow;
+        sPow *= s;
+    }
 }
 
+// Bernstein basis for a fixed order. The loops of the generic version have a constant trip count here.
+template <std::uint32_t N, typename T>
+struct FixedBernsteinBasis
+{
+    static void Evaluate(const T& t, T* basis)
+    {
+        BernsteinBasisGeneric(t, N, basis);
+    }
+};
+
+template <typename T>
+struct FixedBernsteinBasis<3, T>
+{
+    static void Evaluate(const T& t, T* basis)
+    {
+        const T s = T(1) - t;
+        const T t2 = t*t, s2 = s*s;
+        basis[0] = s2*s;
+        basis[1] = T(BinomialCoefficient(1, 3))*t*s2;
+        basis[2] = T(BinomialCoefficient(2, 3))*t2*s;
+        basis[3] = t2*t;
+    }
+};
+
+template <typename T>
+struct FixedBernsteinBasis<4, T>
+{
+    static void Evaluate(const T& t, T* basis)
+    {
+        const T s = T(1) - t;
+        const T t2 = t*t, s2 = s*s;
+        basis[0] = s2*s2;
+        basis[1] = T(BinomialCoefficient(1, 4))*t*s2*s;
+        basis[2] = T(BinomialCoefficient(2, 4))*t2*s2;
+        basis[3] = T(BinomialCoefficient(3, 4))*t2*t*s;
+        basis[4] = t2*t2;
+    }
+};
+
+// Buffer for a Bernstein basis, which only allocates memory for large orders. This is not copyable, because 'data_' may point into 'local_'.
+template <typename T>
+class BernsteinBasisBuffer
+{
+
+    public:
+
+        explicit BernsteinBasisBuffer(std::size_t size)
+        {
+            if (size > maxLocalSize)
+            {
+                heap_.resize(size);
+                data_ = heap_.data();
+            }
+        }
+
+        BernsteinBasisBuffer(const BernsteinBasisBuffer&) = delete;
+        BernsteinBasisBuffer(BernsteinBasisBuffer&&) = delete;
+
+        BernsteinBasisBuffer& operator = (const BernsteinBasisBuffer&) = delete;
+        BernsteinBasisBuffer& operator = (BernsteinBasisBuffer&&) = delete;
+
+        T& operator [] (std::size_t idx)
+        {
+            return data_[idx];
+        }
+
+        T* Data()
+        {
+            return data_;
+        }
+
+    private:
+
+        static const std::size_t    maxLocalSize = 16;
+
+        T                           local_[maxLocalSize];
+        std::vector<T>              heap_;
+        T*                          data_ = local_;
+
+};
+
 } // /namespace Details
 
 
@@ -38,19 +173,109 @@ constexpr std::uint64_t BinomialCoefficient(std::uint64_t i, std::uint64_t n)
 \brief Computes the bernstein polynomial.
 \param[in] t Specifies the interpolation parameter which is typically in the range [0, 1], but not limitted to.
 \param[in] i Specifies the polynomial index which must be less than or equal to 'n'.
-\param[in] n Specifies the polynomial order which must be greater than zero.
+\param[in] n Specifies the polynomial order.
+\remarks To evaluate all polynomials of one order, use 'BernsteinBasis' which is O(n) instead of O(n^2).
+\see BernsteinBasis
 */
 template <typename T>
 T BernsteinPolynomial(const T& t, std::uint32_t i, std::uint32_t n)
 {
-    if (i <= n && n > 0)
+    if (i <= n)
     {
         auto coeff = static_cast<T>(Details::BinomialCoefficient(i, n));
-        return coeff * static_cast<T>(std::pow(t, static_cast<int>(i))) * static_cast<T>(std::pow(T(1) - t, static_cast<int>(n - i)));
+        return coeff * Details::IntegralPow(t, i) * Details::IntegralPow(T(1) - t, n - i);
     }
     return T(0);
 }
 
+/**
+\brief Computes all bernstein polynomials B(t, 0, n) to B(t, n, n) of the specified order at once in O(n).
+\param[in] t Specifies the interpolation parameter.
+\param[in] n Specifies the polynomial order.
+\param[out] basis Pointer to the output array. This must have at least 'n + 1' elements.
+\remarks Cubic and quartic polynomials use the fixed-order specializations.
+\see BernsteinPolynomial
+*/
+template <typename T>
+void BernsteinBasis(const T& t, std::uint32_t n, T* basis)
+{
+    switch (n)
+    {
+        case 3:
+            Details::FixedBernsteinBasis<3, T>::Evaluate(t, basis);
+            break;
+        case 4:
+            Details::FixedBernsteinBasis<4, T>::Evaluate(t, basis);
+            break;
+        default:
+            Details::BernsteinBasisGeneric(t, n, basis);
+            break;
+    }
+}
+
+/**
+\brief Computes all bernstein polynomials of the fixed order 'N' at once.
+\param[out] basis Pointer to the output array. This must have at least 'N + 1' elements.
+\see BernsteinBasis(const T&, std::uint32_t, T*)
+*/
+template <std::uint32_t N, typename T>
+void BernsteinBasis(const T& t, T* basis)
+{
+    Details::FixedBernsteinBasis<N, T>::Evaluate(t, basis);
+}
+
+/**
+\brief Computes all bernstein polynomials of the specified order for many interpolation parameters at once.
+\param[in] t Pointer to the array of interpolation parameters.
+\param[in] count Specifies the number of interpolation parameters.
+\param[in] n Specifies the polynomial order.
+\param[out] basis Pointer to the output array. This must have at least '(n + 1) * count' elements.
+The polynomial 'i' for the parameter 'k' is written to 'basis[i*count + k]', i.e. each polynomial forms one contiguous row,
+so the inner loops run over the parameters and can be vectorized by the compiler.
+*/
+template <typename T>
+void BernsteinBasis(const T* t, std::size_t count, std::uint32_t n, T* basis)
+{
+    static const std::size_t chunkSize = 64;
+
+    T sPow[chunkSize];
+
+    for (std::size_t first = 0; first < count; first += chunkSize)
+    {
+        const auto size = std::min(chunkSize, count - first);
+        const auto tc   = t + first;
+        const auto bc   = basis + first;
+
+        /* Ascending powers of t */
+        for (std::size_t k = 0; k < size; ++k)
+            bc[k] = T(1);
+
+        for (std::uint32_t i = 1; i <= n; ++i)
+        {
+            auto row = bc + i*count, prev = row - count;
+            for (std::size_t k = 0; k < size; ++k)
+                row[k] = prev[k] * tc[k];
+        }
+
+        /* Binomial coefficients and descending powers of (1 - t) */
+        for (std::size_t k = 0; k < size; ++k)
+            sPow[k] = T(1);
+
+        T coeff = T(1);
+
+        for (std::uint32_t i = n + 1; i-- > 0;)
+        {
+            auto row = bc + i*count;
+            for (std::size_t k = 0; k < size; ++k)
+            {
+                row[k] *= coeff * sPow[k];
+                sPow[k] *= T(1) - tc[k];
+            }
+            coeff = coeff * static_cast<T>(i) / static_cast<T>(n - i + 1);
+        }
+    }
+}
+
 
 } // /namespace Gm
 
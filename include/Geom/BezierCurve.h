@@ -10,11 +10,13 @@
 
 
 #include <Geom/BernsteinPolynomial.h>
+#include <Geom/ArcLengthTable.h>
 
 #include <Gauss/Real.h>
 #include <Gauss/Vector2.h>
 #include <Gauss/Vector3.h>
 #include <vector>
+#include <algorithm>
 
 
 namespace Gm
@@ -36,17 +38,119 @@ class BezierCurve
         {
             P point;
 
-            for (std::uint32_t i = 0, n = static_cast<std::uint32_t>(controlPoints.size()); i < n; ++i)
-                point += controlPoints[i] * BernsteinPolynomial(t, i, n - 1);
+            if (!controlPoints.empty())
+            {
+                auto n = static_cast<std::uint32_t>(controlPoints.size());
+
+                Details::BernsteinBasisBuffer<T> basis(n);
+                BernsteinBasis(t, n - 1, basis.Data());
+
+                for (std::uint32_t i = 0; i < n; ++i)
+                    point += controlPoints[i] * basis[i];
+            }
 
             return point;
         }
 
+        /**
+        \brief Evaluates the curve at many interpolation factors at once.
+        \param[in] t Pointer to the array of interpolation factors.
+        \param[out] points Pointer to the array of output points. This must have at least 'count' elements.
+        \param[in] count Specifies the number of interpolation factors.
+        \remarks The Bernstein basis is computed for blocks of interpolation factors at once.
+        \see BernsteinBasis(const T*, std::size_t, std::uint32_t, T*)
+        */
+        void Evaluate(const T* t, P* points, std::size_t count) const
+        {
+            static const std::size_t blockSize = 64;
+
+            if (controlPoints.empty())
+            {
+                std::fill(points, points + count, P());
+                return;
+            }
+
+            auto n = static_cast<std::uint32_t>(controlPoints.size());
+
+            std::vector<T> basis(n * blockSize);
+
+            for (std::size_t first = 0; first < count; first += blockSize)
+            {
+                const auto size = std::min(blockSize, count - first);
+
+                BernsteinBasis(t + first, size, n - 1, basis.data());
+
+                for (std::size_t k = 0; k < size; ++k)
+                {
+                    P point;
+                    for (std::uint32_t i = 0; i < n; ++i)
+                        point += controlPoints[i] * basis[i*size + k];
+                    points[first + k] = point;
+                }
+            }
+        }
+
+        //! Evaluates the first derivative of the curve with respect to the interpolation factor 't'.
+        P EvaluateDerivative(const T& t) const
+        {
+            P derivative;
+
+            if (controlPoints.size() >= 2)
+            {
+                auto n = static_cast<std::uint32_t>(controlPoints.size()) - 1;
+
+                Details::BernsteinBasisBuffer<T> basis(n);
+                BernsteinBasis(t, n - 1, basis.Data());
+
+                for (std::uint32_t i = 0; i < n; ++i)
+                    derivative += (controlPoints[i + 1] - controlPoints[i]) * basis[i];
+
+                derivative *= static_cast<T>(n);
+            }
+
+            return derivative;
+        }
+
         P operator () (const T& t) const
         {
             return Evaluate(t);
         }
 
+        /**
+        \brief Builds the arc-length table of this curve over the range [0, 1].
+        \param[out] table Specifies the output table. This must be rebuilt whenever the control points change.
+        \param[in] subdivisions Specifies the number of table samples. By default 32.
+        \see EvaluateAtDistance
+        */
+        void BuildArcLengthTable(ArcLengthTable<T>& table, std::uint32_t subdivisions = 32) const
+        {
+            table.Build(
+                { T(0), T(1) },
+                subdivisions,
+                [this](const T& t)
+                {
+                    return EvaluateDerivative(t).Length();
+                }
+            );
+        }
+
+        //! Evaluates the curve at the specified arc length, so equal distance steps move with constant speed along the curve.
+        P EvaluateAtDistance(const ArcLengthTable<T>& table, const T& distance) const
+        {
+            return Evaluate(table.GetParameter(distance));
+        }
+
+        /**
+        \brief Evaluates the curve at many arc lengths at once, e.g. for many objects on the same path.
+        \see UniformSpline::EvaluateAtDistance(const ArcLengthTable<T>&, const T*, P*, std::size_t) const
+        */
+        void EvaluateAtDistance(const ArcLengthTable<T>& table, const T* distances, P* points, std::size_t count) const
+        {
+            std::size_t cursor = 0;
+            for (std::size_t i = 0; i < count; ++i)
+                points[i] = Evaluate(table.GetParameter(distances[i], cursor));
+        }
+
         std::vector<P> controlPoints;
 
 };
@@ -50,15 +50,24 @@ class BezierPatch
         {
             P result;
 
-            for (std::uint32_t i = 0; i <= order_; ++i)
+            /* Compute bernstein basis in both directions once */
+            Details::BernsteinBasisBuffer<T> basisU(order_ + 1), basisV(order_ + 1);
+
+            BernsteinBasis(u, order_, basisU.Data());
+            BernsteinBasis(v, order_, basisV.Data());
+
+            for (std::uint32_t j = 0; j <= order_; ++j)
             {
-                for (std::uint32_t j = 0; j <= order_; ++j)
-                {
-                    /* Accumulate bernstein-bezier transformed control points */
-                    auto point = GetControlPoint(i, j);
-                    point *= (BernsteinPolynomial(u, i, order_) * BernsteinPolynomial(v, j, order_));
-                    result += point;
-                }
+                /* Accumulate bernstein-bezier transformed control points */
+                const auto row = controlPoints_.data() + GetIndex(0, j);
+
+                P point;
+
+                for (std::uint32_t i = 0; i <= order_; ++i)
+                    point += row[i] * basisU[i];
+
+                point *= basisV[j];
+                result += point;
             }
 
             return result;
@@ -9,6 +9,8 @@
 #define GM_BEZIER_TRIANGLE_H
 
 
+#include <Geom/BernsteinPolynomial.h>
+
 #include <Gauss/Vector2.h>
 #include <Gauss/Vector3.h>
 #include <vector>
@@ -22,7 +24,6 @@ namespace Gm
 /**
 \brief Curved triangle patch in BB-Form (Bernstein Bezier).
 \tparam P Specifies the type of the control points.
-\todo This is incomplete!!!
 */
 template <typename P, typename T>
 class BezierTriangle
@@ -35,16 +36,58 @@ class BezierTriangle
             SetOrder(0);
         }
 
-        P operator () (const T& u, const T& v) const
+        P operator () (const T& s, const T& t) const
         {
-            return Evaluate(u, v);
+            return Evaluate(s, t, T(1) - s - t);
         }
 
+        /**
+        \brief Evaluates the bezier triangle.
+        \param[in] s Specifies the barycentric coordinate for the first control point index 'i'.
+        \param[in] t Specifies the barycentric coordinate for the second control point index 'j'.
+        \param[in] u Specifies the barycentric coordinate for the remaining index 'GetOrder() - i - j'. This should be '1 - s - t'.
+        \remarks Each control point (i, j) is weighted with the bivariate Bernstein polynomial 'n!/(i! j! k!) * s^i * t^j * u^k' where 'k = n - i - j'.
+        */
         P Evaluate(const T& s, const T& t, const T& u) const
         {
             P result;
 
-            //todo...
+            const auto n = order_;
+
+            /* Compute ascending powers of each coordinate once */
+            Details::BernsteinBasisBuffer<T> sPow(n + 1), uPow(n + 1);
+
+            sPow[0] = T(1);
+            uPow[0] = T(1);
+
+            for (std::uint32_t i = 1; i <= n; ++i)
+            {
+                sPow[i] = sPow[i - 1] * s;
+                uPow[i] = uPow[i - 1] * u;
+            }
+
+            T rowCoeff = T(1);
+
+            for (std::uint32_t j = 0; j <= n; ++j)
+            {
+                /* Accumulate row with the univariate weights 'C(n - j, i) * s^i * u^(n - j - i)' */
+                const auto m = n - j;
+
+                P point;
+                T coeff = T(1);
+
+                for (std::uint32_t i = 0; i <= m; ++i)
+                {
+                    point += controlPoints_[GetIndex(i, j)] * (coeff * sPow[i] * uPow[m - i]);
+                    coeff = coeff * static_cast<T>(m - i) / static_cast<T>(i + 1);
+                }
+
+                /* Apply row weight 'C(n, j) * t^j' */
+                point *= rowCoeff;
+                result += point;
+
+                rowCoeff = rowCoeff * t * static_cast<T>(n - j) / static_cast<T>(j + 1);
+            }
 
             return result;
         }
@@ -103,7 +146,8 @@ class BezierTriangle
         */
         std::uint32_t GetIndex(std::uint32_t i, std::uint32_t j) const
         {
-            return (j > 0 ? j*(order_ + 1) - j + 1 + i : i);
+            /* Row 'j' has 'order + 1 - j' control points */
+            return (j*(order_ + 1) - j*(j - 1)/2 + i);
         }
 
         std::uint32_t   order_          = 0;
@@ -0,0 +1,74 @@
+/*
+ * BoundingBoxKernels.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_BOUNDING_BOX_KERNELS_H
+#define GM_BOUNDING_BOX_KERNELS_H
+
+
+#include <Geom/AABB.h>
+
+#include <Gauss/AffineMatrix4.h>
+#include <cstddef>
+
+
+namespace Gm
+{
+
+
+/**
+\brief Computes the bounding box of a strided array of points (AoS layout) with SIMD instructions.
+\param[in] points Pointer to the X coordinate of the first point. The Y and Z coordinates must follow directly.
+\param[in] count Specifies the number of points.
+\param[in] stride Specifies the byte offset from one point to the next, e.g. 'sizeof(TriangleMesh::Vertex)'.
+\return Bounding box of all points. This is equal to inserting each point into a default initialized AABB,
+i.e. the result is exact and NaN coordinates are ignored.
+\remarks Only the 3 coordinates of each point are read, i.e. no memory beyond the last point is accessed.
+*/
+AABB3f ComputeBoundingBox(const float* points, std::size_t count, std::size_t stride);
+
+//! \see ComputeBoundingBox(const float*, std::size_t, std::size_t)
+AABB3d ComputeBoundingBox(const double* points, std::size_t count, std::size_t stride);
+
+/**
+\brief Computes the bounding box of a strided array of points (AoS layout) which are transformed by the specified matrix.
+\remarks Each point is transformed like with 'Gs::TransformVector', i.e. with the same order of operations, so the result is exact.
+\see ComputeBoundingBox(const float*, std::size_t, std::size_t)
+*/
+AABB3f ComputeBoundingBox(const float* points, std::size_t count, std::size_t stride, const Gs::AffineMatrix4T<float>& matrix);
+
+//! \see ComputeBoundingBox(const float*, std::size_t, std::size_t, const Gs::AffineMatrix4T<float>&)
+AABB3d ComputeBoundingBox(const double* points, std::size_t count, std::size_t stride, const Gs::AffineMatrix4T<double>& matrix);
+
+/**
+\brief Computes the bounding box of separate coordinate arrays (SoA layout).
+\param[in] x Pointer to the array of X coordinates.
+\param[in] y Pointer to the array of Y coordinates.
+\param[in] z Pointer to the array of Z coordinates.
+\param[in] count Specifies the number of points.
+\remarks This is the fastest variant, because the coordinates are loaded directly into SIMD registers (with AVX if enabled).
+\see ComputeBoundingBox(const float*, std::size_t, std::size_t)
+*/
+AABB3f ComputeBoundingBoxSoA(const float* x, const float* y, const float* z, std::size_t count);
+
+//! \see ComputeBoundingBoxSoA(const float*, const float*, const float*, std::size_t)
+AABB3d ComputeBoundingBoxSoA(const double* x, const double* y, const double* z, std::size_t count);
+
+//! \see ComputeBoundingBox(const float*, std::size_t, std::size_t, const Gs::AffineMatrix4T<float>&)
+AABB3f ComputeBoundingBoxSoA(const float* x, const float* y, const float* z, std::size_t count, const Gs::AffineMatrix4T<float>& matrix);
+
+//! \see ComputeBoundingBox(const float*, std::size_t, std::size_t, const Gs::AffineMatrix4T<float>&)
+AABB3d ComputeBoundingBoxSoA(const double* x, const double* y, const double* z, std::size_t count, const Gs::AffineMatrix4T<double>& matrix);
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
@@ -9,10 +9,8 @@
 #define GM_CONFIG_H
 
 
-//! Enables multi-threading features.
-#ifndef __GNUC__
-//#   define GM_ENABLE_MULTI_THREADING
-#endif
+//! Enables multi-threading features (see ThreadPool).
+//#define GM_ENABLE_MULTI_THREADING
 
 //! Enables the alternative plane euqation as default (i.e. "n*x + d = 0" instead of "n*x = d").
 //#define GM_DEFAULT_PLANE_EQUATION_ALT
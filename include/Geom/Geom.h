@@ -20,12 +20,25 @@
 #include <Geom/Cone.h>
 #include <Geom/Spline.h>
 #include <Geom/UniformSpline.h>
+#include <Geom/ArcLengthTable.h>
 #include <Geom/Triangle.h>
 #include <Geom/TangentSpace.h>
 
 #include <Geom/TriangleMesh.h>
+#include <Geom/TriangleMeshT.h>
+#include <Geom/TriangleMeshSoA.h>
+#include <Geom/MeshView.h>
+#include <Geom/AlignedAllocator.h>
+#include <Geom/IndexBuffer.h>
+#include <Geom/MeshAdjacency.h>
+#include <Geom/MeshSilhouette.h>
+#include <Geom/Meshlet.h>
 #include <Geom/MeshGenerator.h>
 #include <Geom/MeshModifier.h>
+#include <Geom/MeshClipper.h>
+#include <Geom/VertexLayout.h>
+#include <Geom/ThreadPool.h>
+#include <Geom/BoundingBoxKernels.h>
 
 #include <Geom/Transform2.h>
 #include <Geom/Transform3.h>
@@ -38,6 +51,7 @@
 #include <Geom/AABBCollision.h>
 #include <Geom/ConeCollision.h>
 #include <Geom/SphereCollision.h>
+#include <Geom/MeshCollision.h>
 
 #include <Geom/BezierCurve.h>
 #include <Geom/BezierTriangle.h>
@@ -67,6 +81,7 @@ Features:
 - \b Projection (4x4 Projection Matrix Manager)
 - \b Sphere
 - \b Spline
+- \b ArcLengthTable (Constant-Speed Curve Reparameterization)
 - \b TriangleMesh
 - \b MeshGenerator
 - \b BezierCurve
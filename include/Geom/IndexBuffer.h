@@ -0,0 +1,197 @@
+/*
+ * IndexBuffer.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_INDEX_BUFFER_H
+#define GM_INDEX_BUFFER_H
+
+
+#include <Geom/TriangleMesh.h>
+
+#include <vector>
+#include <cstdint>
+
+
+namespace Gm
+{
+
+
+//! Index buffer formats.
+enum class IndexFormat
+{
+    UInt16, //!< 16-bit unsigned integer indices (up to 65,536 vertices).
+    UInt32, //!< 32-bit unsigned integer indices (up to 4,294,967,296 vertices).
+};
+
+//! Returns the size (in bytes) of a single index of the specified format.
+std::size_t GetIndexFormatSize(IndexFormat format);
+
+//! Returns the maximal vertex index that can be stored with the specified format.
+std::uint64_t GetIndexFormatMaxIndex(IndexFormat format);
+
+/**
+\brief Returns the smallest index format that can store the specified vertex index.
+\throws std::out_of_range If the vertex index does not fit into 32 bits.
+*/
+IndexFormat FindIndexFormat(TriangleMesh::VertexIndex maxIndex);
+
+
+/**
+\brief Compact triangle index storage with 16-bit or 32-bit indices.
+\remarks In contrast to 'TriangleMesh::triangles', which stores each triangle with indices of type 'std::size_t',
+this stores 3 indices per triangle in the smallest format that has been requested. When a new index exceeds the current format,
+the buffer is widened automatically (from 16 to 32 bits). Indices that do not fit into 32 bits are rejected with an exception.
+The data can be uploaded directly into a hardware index buffer.
+\see TriangleMesh
+*/
+class IndexBuffer
+{
+
+    public:
+
+        using VertexIndex   = TriangleMesh::VertexIndex;
+        using TriangleIndex = TriangleMesh::TriangleIndex;
+        using Triangle      = TriangleMesh::Triangle;
+
+        IndexBuffer() = default;
+
+        //! Initializes an empty index buffer with the specified format.
+        explicit IndexBuffer(IndexFormat format);
+
+        /**
+        \brief Initializes the index buffer with all triangles of the specified mesh in the smallest format.
+        \throws std::out_of_range If any vertex index of the mesh does not fit into 32 bits.
+        */
+        explicit IndexBuffer(const TriangleMesh& mesh);
+
+        //! Clears all indices. The format is kept.
+        void Clear();
+
+        //! Reserves memory for the specified number of triangles.
+        void Reserve(std::size_t numTriangles);
+
+        /**
+        \brief Adds a new triangle with the specified three indices and returns the index of the new triangle.
+        \throws std::out_of_range If any index does not fit into 32 bits. In this case, the buffer remains unchanged.
+        \remarks If any index does not fit into the current format, the buffer is widened first.
+        */
+        TriangleIndex AddTriangle(VertexIndex v0, VertexIndex v1, VertexIndex v2);
+
+        /**
+        \brief Appends all triangles of the specified list.
+        \param[in] triangles Specifies the list of triangles that are to be appended.
+        \param[in] vertexOffset Specifies the offset that is added to each index. By default 0.
+        \throws std::out_of_range If any resulting index does not fit into 32 bits. In this case, the buffer remains unchanged.
+        */
+        void Append(const std::vector<Triangle>& triangles, VertexIndex vertexOffset = 0);
+
+        //! \see Append(const std::vector<Triangle>&, VertexIndex)
+        void Append(const IndexBuffer& other, VertexIndex vertexOffset = 0);
+
+        /**
+        \brief Converts all indices into the specified format.
+        \throws std::out_of_range If any index does not fit into the new format. In this case, the buffer remains unchanged.
+        */
+        void SetFormat(IndexFormat format);
+
+        //! Converts all indices into the smallest format that can store the largest index.
+        void ShrinkToFit();
+
+        //! Returns the triangle with the specified index.
+        Triangle GetTriangle(TriangleIndex triangleIndex) const;
+
+        //! Returns the list of all triangles with indices of type 'std::size_t'.
+        std::vector<Triangle> ToTriangles() const;
+
+        /**
+        \brief Calls the specified function for each triangle.
+        \param[in] func Specifies the function with the signature 'void(TriangleIndex triangleIndex, VertexIndex v0, VertexIndex v1, VertexIndex v2)'.
+        \remarks The index format is only dispatched once, so the loop itself is free of branches on the format.
+        */
+        template <typename Func>
+        void ForEachTriangle(const Func& func) const;
+
+        //! Returns the current index format.
+        IndexFormat GetFormat() const
+        {
+            return format_;
+        }
+
+        //! Returns the largest index of this buffer, or 0 if the buffer is empty.
+        VertexIndex GetMaxIndex() const
+        {
+            return maxIndex_;
+        }
+
+        //! Returns the number of indices, i.e. three times the number of triangles.
+        std::size_t NumIndices() const
+        {
+            return (format_ == IndexFormat::UInt16 ? indices16_.size() : indices32_.size());
+        }
+
+        //! Returns the number of triangles.
+        std::size_t NumTriangles() const
+        {
+            return NumIndices() / 3;
+        }
+
+        //! Returns the raw index data in the current format.
+        const void* Data() const
+        {
+            return (format_ == IndexFormat::UInt16 ? static_cast<const void*>(indices16_.data()) : static_cast<const void*>(indices32_.data()));
+        }
+
+        //! Returns the size (in bytes) of the raw index data.
+        std::size_t SizeInBytes() const
+        {
+            return NumIndices() * GetIndexFormatSize(format_);
+        }
+
+    private:
+
+        template <typename Index, typename Func>
+        static void ForEachTriangleTyped(const std::vector<Index>& indices, const Func& func);
+
+        void Widen(VertexIndex maxIndex);
+
+        IndexFormat                 format_     = IndexFormat::UInt16;
+        VertexIndex                 maxIndex_   = 0;
+        std::vector<std::uint16_t>  indices16_;
+        std::vector<std::uint32_t>  indices32_;
+
+};
+
+
+/* ----- Template functions ----- */
+
+template <typename Func>
+void IndexBuffer::ForEachTriangle(const Func& func) const
+{
+    if (format_ == IndexFormat::UInt16)
+        ForEachTriangleTyped(indices16_, func);
+    else
+        ForEachTriangleTyped(indices32_, func);
+}
+
+template <typename Index, typename Func>
+void IndexBuffer::ForEachTriangleTyped(const std::vector<Index>& indices, const Func& func)
+{
+    const auto numTriangles = indices.size() / 3;
+    for (TriangleIndex i = 0; i < numTriangles; ++i)
+    {
+        const auto* tri = &indices[i*3];
+        func(i, static_cast<VertexIndex>(tri[0]), static_cast<VertexIndex>(tri[1]), static_cast<VertexIndex>(tri[2]));
+    }
+}
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
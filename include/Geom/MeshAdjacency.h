@@ -0,0 +1,173 @@
+/*
+ * MeshAdjacency.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_MESH_ADJACENCY_H
+#define GM_MESH_ADJACENCY_H
+
+
+#include <Geom/TriangleMesh.h>
+
+#include <vector>
+
+
+namespace Gm
+{
+
+
+/**
+\brief Vertex-to-triangle adjacency of a triangle mesh in compressed sparse row (CSR) form.
+\remarks All queries run in O(degree), i.e. only the triangles around the respective vertex are visited.
+The adjacency is a snapshot of the mesh it was built for and must be rebuilt whenever the triangles of that mesh change.
+\see TriangleMesh::BuildAdjacency
+*/
+class MeshAdjacency
+{
+
+    public:
+
+        using VertexIndex   = TriangleMesh::VertexIndex;
+        using TriangleIndex = TriangleMesh::TriangleIndex;
+        using Edge          = TriangleMesh::Edge;
+
+        //! Read-only range of triangle indices. The indices are sorted in ascending order.
+        class TriangleRange
+        {
+
+            public:
+
+                TriangleRange(const TriangleIndex* begin, const TriangleIndex* end) :
+                    begin_ { begin },
+                    end_   { end   }
+                {
+                }
+
+                const TriangleIndex* begin() const
+                {
+                    return begin_;
+                }
+
+                const TriangleIndex* end() const
+                {
+                    return end_;
+                }
+
+                std::size_t size() const
+                {
+                    return static_cast<std::size_t>(end_ - begin_);
+                }
+
+                bool empty() const
+                {
+                    return (begin_ == end_);
+                }
+
+                TriangleIndex operator [] (std::size_t idx) const
+                {
+                    GS_ASSERT(idx < size());
+                    return begin_[idx];
+                }
+
+            private:
+
+                const TriangleIndex* begin_;
+                const TriangleIndex* end_;
+
+        };
+
+        MeshAdjacency() = default;
+
+        //! Builds the adjacency for the specified mesh.
+        explicit MeshAdjacency(const TriangleMesh& mesh, bool weldByPosition = false);
+
+        /**
+        \brief Builds the adjacency for the specified mesh. This runs in parallel for large meshes.
+        \param[in] mesh Specifies the mesh whose adjacency is to be built.
+        \param[in] weldByPosition Specifies whether to also build the adjacency of all vertices with equal positions
+        (compared with 'Gs::Equals'). This is required for 'PositionTriangles' and 'WeldedVertex'. By default false.
+        */
+        void Build(const TriangleMesh& mesh, bool weldByPosition = false);
+
+        //! Releases all adjacency information.
+        void Clear();
+
+        //! Returns the list of all triangles that are connected to the specified vertex.
+        TriangleRange VertexTriangles(VertexIndex vertexIndex) const;
+
+        /**
+        \brief Returns the list of all triangles that are connected to any vertex with the same position as the specified vertex.
+        \remarks If the adjacency was not built with position welding, this is equivalent to 'VertexTriangles'.
+        */
+        TriangleRange PositionTriangles(VertexIndex vertexIndex) const;
+
+        /**
+        \brief Returns the representative of all vertices with the same position as the specified vertex.
+        \remarks The representative is the vertex with the smallest index of its group.
+        If the adjacency was not built with position welding, the input vertex index is returned.
+        */
+        VertexIndex WeldedVertex(VertexIndex vertexIndex) const;
+
+        /**
+        \brief Computes the list of all triangles that are connected to the specified edge.
+        \param[in] mesh Specifies the mesh this adjacency was built for.
+        \param[in] edge Specifies the edge whose triangles are to be found. The edge direction is ignored.
+        \param[out] triangleIndices Specifies the output list of triangle indices. This list is cleared first.
+        \remarks This only visits the triangles of the edge's vertex with the smaller degree.
+        */
+        void EdgeTriangles(const TriangleMesh& mesh, const Edge& edge, std::vector<TriangleIndex>& triangleIndices) const;
+
+        //! Returns true if this adjacency was built with position welding.
+        bool HasPositionWelding() const
+        {
+            return weldByPosition_;
+        }
+
+        //! Returns true if this adjacency matches the number of vertices and triangles of the specified mesh.
+        bool IsBuiltFor(const TriangleMesh& mesh) const
+        {
+            return (numVertices_ == mesh.vertices.size() && numTriangles_ == mesh.triangles.size());
+        }
+
+        //! Returns the number of vertices this adjacency was built for.
+        std::size_t NumVertices() const
+        {
+            return numVertices_;
+        }
+
+        //! Returns the number of triangles this adjacency was built for.
+        std::size_t NumTriangles() const
+        {
+            return numTriangles_;
+        }
+
+    private:
+
+        void BuildVertexTriangles(const TriangleMesh& mesh);
+        void BuildWeldIndices(const TriangleMesh& mesh);
+        void BuildPositionTriangles();
+
+        std::size_t                 numVertices_        = 0;
+        std::size_t                 numTriangles_       = 0;
+        bool                        weldByPosition_     = false;
+
+        std::vector<TriangleIndex>  vertexOffsets_;     //!< CSR offsets into 'vertexTriangles_' (one entry per vertex plus one).
+        std::vector<TriangleIndex>  vertexTriangles_;   //!< CSR triangle indices for each vertex.
+
+        std::vector<VertexIndex>    weldIndices_;       //!< Representative vertex for each vertex (only with position welding).
+        std::vector<TriangleIndex>  positionOffsets_;   //!< CSR offsets into 'positionTriangles_' (one entry per vertex plus one).
+        std::vector<TriangleIndex>  positionTriangles_; //!< CSR triangle indices for each representative vertex.
+
+};
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,399 @@
+/*
+ * MeshClipper.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_MESH_CLIPPER_H
+#define GM_MESH_CLIPPER_H
+
+
+#include <Geom/TriangleMesh.h>
+#include <Geom/TriangleMeshT.h>
+#include <Geom/MeshView.h>
+#include <Geom/Plane.h>
+#include <Geom/ConvexHull.h>
+#include <Geom/Frustum.h>
+
+#include <vector>
+#include <unordered_map>
+#include <type_traits>
+#include <limits>
+#include <cstdint>
+
+
+namespace Gm
+{
+
+
+class TriangleMeshSoA;
+
+/**
+\brief Index preserving triangle mesh clipping against one or more planes.
+\remarks In contrast to clipping each triangle on its own, the output meshes keep the vertex sharing of the input mesh:
+triangles that are not intersected by any plane refer to the remapped original vertices, and vertices that are created
+on an edge of the input mesh are shared between all triangles of that edge. The vertices on a shared edge are computed
+from the edge end points in a canonical order, so both adjacent triangles produce bit-identical vertices.
+\remarks The working memory is kept between calls, and the output meshes are resized instead of cleared, so clipping
+many meshes (e.g. per frame) does not reallocate memory once the buffers are large enough.
+With 'GM_ENABLE_MULTI_THREADING', the triangles are clipped in parallel chunks on the global thread pool.
+The output is identical for any number of threads.
+\remarks The clipping itself only operates on a 'MeshView', so meshes with other vertex layouts can be clipped as well:
+the view based functions store the output triangles and vertex references, from which each mesh type generates its output vertices.
+\see MeshModifier::ClipMesh
+*/
+class MeshClipper
+{
+
+    public:
+
+        using Vertex        = TriangleMesh::Vertex;
+        using VertexIndex   = TriangleMesh::VertexIndex;
+        using TriangleIndex = TriangleMesh::TriangleIndex;
+
+        //! Remap entry for input vertices that are not part of an output mesh.
+        static const VertexIndex invalidIndex = ~VertexIndex(0);
+
+        //! Source reference of an output vertex.
+        struct VertexRef
+        {
+            enum class Type : std::uint8_t
+            {
+                Original,   //!< Copy of the input vertex 'index'.
+                Edge,       //!< Intersection of the input edge ('index', 'index2') with a plane, interpolated with the factor 'barycentric.x'.
+                Interior,   //!< Vertex inside of the input triangle 'index', interpolated with the barycentric coordinates 'barycentric'.
+            };
+
+            Type            type;
+            std::uint32_t   plane;
+            VertexIndex     index;
+            VertexIndex     index2;
+            Gs::Vector3     barycentric;
+        };
+
+        /**
+        \brief Clips the specified mesh into a front- and back sided mesh by the specified clipping plane.
+        \param[in] mesh Specifies the input mesh. This must not be one of the output meshes.
+        \param[in] clipPlane Specifies the clipping plane.
+        \param[out] front Specifies the output mesh of all triangle parts in front of the plane.
+        \param[out] back Specifies the output mesh of all triangle parts behind the plane.
+        \remarks Triangles that lie on the plane are only added to the front sided mesh.
+        \see GetVertexRemap
+        \see GetBackVertexRemap
+        */
+        void Clip(const TriangleMesh& mesh, const Plane& clipPlane, TriangleMesh& front, TriangleMesh& back);
+
+        /**
+        \brief Clips the specified mesh against a convex volume, which is described by the specified planes.
+        \param[in] mesh Specifies the input mesh. This must not be the output mesh.
+        \param[in] planes Pointer to the array of planes. The plane normals must point out of the volume (like in 'ConvexHull' and 'Frustum').
+        \param[in] numPlanes Specifies the number of planes.
+        \param[out] inside Specifies the output mesh of all triangle parts inside the volume, i.e. behind all planes.
+        \remarks All planes are clipped in a single pass over the triangles.
+        \see GetVertexRemap
+        */
+        void ClipConvex(const TriangleMesh& mesh, const Plane* planes, std::size_t numPlanes, TriangleMesh& inside);
+
+        //! \see ClipConvex(const TriangleMesh&, const Plane*, std::size_t, TriangleMesh&)
+        void ClipConvex(const TriangleMesh& mesh, const ConvexHull& convexHull, TriangleMesh& inside);
+
+        //! \see ClipConvex(const TriangleMesh&, const Plane*, std::size_t, TriangleMesh&)
+        void ClipConvex(const TriangleMesh& mesh, const Frustum& frustum, TriangleMesh& inside);
+
+        /**
+        \brief Clips the specified SoA mesh into a front- and back sided mesh by the specified clipping plane.
+        \see Clip(const TriangleMesh&, const Plane&, TriangleMesh&, TriangleMesh&)
+        */
+        void Clip(const TriangleMeshSoA& mesh, const Plane& clipPlane, TriangleMeshSoA& front, TriangleMeshSoA& back);
+
+        /**
+        \brief Clips the specified templated mesh into a front- and back sided mesh by the specified clipping plane.
+        \throws std::out_of_range If the number of output vertices exceeds the range of the index type.
+        \remarks The vertices on clipped edges and inside of clipped triangles are interpolated with 'VertexTraits<VertexT>::Interpolate'.
+        \see Clip(const TriangleMesh&, const Plane&, TriangleMesh&, TriangleMesh&)
+        */
+        template <typename VertexT, typename IndexT>
+        void Clip(
+            const TriangleMeshT<VertexT, IndexT>&   mesh,
+            const Plane&                            clipPlane,
+            TriangleMeshT<VertexT, IndexT>&         front,
+            TriangleMeshT<VertexT, IndexT>&         back
+        );
+
+        /**
+        \brief Clips the specified mesh view into a front- and back sided part, without generating any output vertices.
+        \remarks The output triangles and vertex references are returned by 'GetTriangles', 'GetVertexRefs', 'GetBackTriangles', and 'GetBackVertexRefs'.
+        This is used to clip meshes with other vertex layouts, which generate the output vertices from the vertex references.
+        \see Clip(const TriangleMesh&, const Plane&, TriangleMesh&, TriangleMesh&)
+        */
+        void Clip(const MeshView& mesh, const Plane& clipPlane);
+
+        /**
+        \brief Clips the specified mesh view against a convex volume, without generating any output vertices.
+        \see Clip(const MeshView&, const Plane&)
+        \see ClipConvex(const TriangleMesh&, const Plane*, std::size_t, TriangleMesh&)
+        */
+        void ClipConvex(const MeshView& mesh, const Plane* planes, std::size_t numPlanes);
+
+        //! Releases all working memory and remap tables.
+        void Clear();
+
+        /**
+        \brief Returns the vertex remap table of the front sided mesh of 'Clip', or of the inside mesh of 'ClipConvex'.
+        \remarks Entry i is the index of the input vertex i within the output mesh, or 'invalidIndex' if the vertex is not part of it.
+        */
+        const std::vector<VertexIndex>& GetVertexRemap() const
+        {
+            return sides_[0].remap;
+        }
+
+        //! Returns the vertex remap table of the back sided mesh of the last call to 'Clip'.
+        const std::vector<VertexIndex>& GetBackVertexRemap() const
+        {
+            return sides_[1].remap;
+        }
+
+        /**
+        \brief Returns the source references of all vertices of the front sided mesh of 'Clip', or of the inside mesh of 'ClipConvex'.
+        \remarks Entry i describes how the output vertex i is generated from the input mesh.
+        */
+        const std::vector<VertexRef>& GetVertexRefs() const
+        {
+            return sides_[0].refs;
+        }
+
+        //! Returns the source references of all vertices of the back sided mesh of the last call to 'Clip'.
+        const std::vector<VertexRef>& GetBackVertexRefs() const
+        {
+            return sides_[1].refs;
+        }
+
+        //! Returns the triangles of the front sided part of the last view based call to 'Clip', or of the inside part of 'ClipConvex'.
+        const std::vector<TriangleMesh::Triangle>& GetTriangles() const
+        {
+            return sides_[0].triangles;
+        }
+
+        //! Returns the triangles of the back sided part of the last view based call to 'Clip'.
+        const std::vector<TriangleMesh::Triangle>& GetBackTriangles() const
+        {
+            return sides_[1].triangles;
+        }
+
+    private:
+
+        // Vertex of a clipped polygon in the working space of a single triangle.
+        struct PolygonVertex
+        {
+            Gs::Vector3     position;
+            Gs::Vector3     barycentric;
+            std::uint8_t    edgeMask;   // Bit mask of the triangle edges (ab, bc, ca) this vertex is located on
+            VertexIndex     entry;      // Chunk entry (original index or new vertex reference)
+        };
+
+        /*
+        Output of a chunk of triangles: triangles as triplets of vertex entries and the references of all new vertices.
+        Each entry is either an original vertex index, or an index into 'refs' with the highest bit set.
+        The polygon buffers are the working memory to clip a single triangle, which is kept between the triangles and calls.
+        */
+        struct ChunkOutput
+        {
+            std::vector<VertexRef>      refs;
+            std::vector<VertexIndex>    triangles;
+            std::vector<PolygonVertex>  polygon;
+            std::vector<PolygonVertex>  clippedPolygon;
+            std::vector<Gs::Real>       polygonDistances;
+        };
+
+        // Output state of one side: the triangles are only used by the view based functions.
+        struct Side
+        {
+            std::vector<VertexIndex>            remap;
+            std::vector<ChunkOutput>            chunks;
+            std::vector<VertexRef>              refs;
+            std::vector<TriangleMesh::Triangle> triangles;
+        };
+
+        struct EdgeKey
+        {
+            VertexIndex     a;
+            VertexIndex     b;
+            std::uint32_t   plane;
+
+            bool operator == (const EdgeKey& rhs) const
+            {
+                return (a == rhs.a && b == rhs.b && plane == rhs.plane);
+            }
+        };
+
+        struct EdgeKeyHash
+        {
+            std::size_t operator () (const EdgeKey& key) const;
+        };
+
+        void ComputeDistances(const MeshView& mesh, const Plane* planes, std::size_t numPlanes);
+
+        void ClipSide(
+            const MeshView&                         mesh,
+            const Plane*                            planes,
+            std::size_t                             numPlanes,
+            Gs::Real                                sideSign,
+            bool                                    keepCoplanar,
+            Side&                                   side,
+            std::vector<TriangleMesh::Triangle>&    triangles
+        );
+
+        void ClipTriangleRange(
+            const MeshView&     mesh,
+            const Plane*        planes,
+            std::size_t         numPlanes,
+            Gs::Real            sideSign,
+            bool                keepCoplanar,
+            std::size_t         begin,
+            std::size_t         end,
+            ChunkOutput&        chunk
+        ) const;
+
+        void ResolveOutput(std::size_t numVertices, Side& side, std::vector<TriangleMesh::Triangle>& triangles);
+
+        void GenerateVertices(const TriangleMesh& mesh, const Side& side, TriangleMesh& output);
+        void GenerateVertices(const TriangleMeshSoA& mesh, const Side& side, TriangleMeshSoA& output) const;
+
+        template <typename VertexT, typename IndexT>
+        MeshView MakeClipView(const TriangleMeshT<VertexT, IndexT>& mesh, std::true_type);
+
+        template <typename VertexT, typename IndexT>
+        MeshView MakeClipView(const TriangleMeshT<VertexT, IndexT>& mesh, std::false_type);
+
+        template <typename VertexT, typename IndexT>
+        void GenerateMesh(const TriangleMeshT<VertexT, IndexT>& mesh, const Side& side, TriangleMeshT<VertexT, IndexT>& output) const;
+
+        // Signed distances of all vertices to all planes (numVertices x numPlanes).
+        std::vector<Gs::Real>                                   distances_;
+
+        Side                                                    sides_[2];
+
+        std::unordered_map<EdgeKey, VertexIndex, EdgeKeyHash>   edgeVertices_;
+
+        // Interior vertices of the current output mesh, which are interpolated in one batch.
+        std::vector<VertexIndex>                                interiorIndices_;
+        std::vector<TriangleIndex>                              interiorTriangles_;
+        std::vector<Gs::Vector3>                                interiorCoords_;
+        std::vector<Vertex>                                     interiorVertices_;
+
+        // Converted positions and triangles of templated meshes, whose layout does not match 'MeshView'.
+        std::vector<Gs::Vector3>                                viewPositions_;
+        std::vector<TriangleMesh::Triangle>                     viewTriangles_;
+
+};
+
+
+/* ----- Template functions ----- */
+
+template <typename VertexT, typename IndexT>
+void MeshClipper::Clip(
+    const TriangleMeshT<VertexT, IndexT>&   mesh,
+    const Plane&                            clipPlane,
+    TriangleMeshT<VertexT, IndexT>&         front,
+    TriangleMeshT<VertexT, IndexT>&         back)
+{
+    /* Clip the positions directly if their layout matches the view, otherwise clip converted copies */
+    using IsViewLayout = std::integral_constant<
+        bool,
+        ( std::is_same<typename VertexTraits<VertexT>::ScalarType, Gs::Real>::value &&
+          std::is_same<IndexT, VertexIndex>::value )
+    >;
+
+    Clip(MakeClipView(mesh, IsViewLayout()), clipPlane);
+
+    GenerateMesh(mesh, sides_[0], front);
+    GenerateMesh(mesh, sides_[1], back);
+}
+
+template <typename VertexT, typename IndexT>
+MeshView MeshClipper::MakeClipView(const TriangleMeshT<VertexT, IndexT>& mesh, std::true_type)
+{
+    return MakeMeshView(mesh);
+}
+
+template <typename VertexT, typename IndexT>
+MeshView MeshClipper::MakeClipView(const TriangleMeshT<VertexT, IndexT>& mesh, std::false_type)
+{
+    using Traits = VertexTraits<VertexT>;
+
+    viewPositions_.resize(mesh.vertices.size());
+    for (std::size_t i = 0; i < mesh.vertices.size(); ++i)
+        viewPositions_[i] = Traits::Position(mesh.vertices[i]).template Cast<Gs::Real>();
+
+    viewTriangles_.resize(mesh.triangles.size());
+    for (std::size_t i = 0; i < mesh.triangles.size(); ++i)
+    {
+        const auto& tri = mesh.triangles[i];
+        viewTriangles_[i] = { static_cast<VertexIndex>(tri.a), static_cast<VertexIndex>(tri.b), static_cast<VertexIndex>(tri.c) };
+    }
+
+    return MeshView(
+        PositionView(
+            (viewPositions_.empty() ? nullptr : &(viewPositions_.front().x)),
+            viewPositions_.size(),
+            sizeof(Gs::Vector3)
+        ),
+        viewTriangles_.data(),
+        viewTriangles_.size()
+    );
+}
+
+template <typename VertexT, typename IndexT>
+void MeshClipper::GenerateMesh(const TriangleMeshT<VertexT, IndexT>& mesh, const Side& side, TriangleMeshT<VertexT, IndexT>& output) const
+{
+    using Traits    = VertexTraits<VertexT>;
+    using T         = typename Traits::ScalarType;
+
+    Details::CheckVertexIndexRange(side.refs.size(), static_cast<std::uint64_t>(std::numeric_limits<IndexT>::max()));
+
+    /* Generate output vertices from their source references */
+    output.vertices.resize(side.refs.size());
+
+    for (std::size_t i = 0; i < side.refs.size(); ++i)
+    {
+        const auto& ref = side.refs[i];
+        switch (ref.type)
+        {
+            case VertexRef::Type::Original:
+                output.vertices[i] = mesh.vertices[ref.index];
+                break;
+
+            case VertexRef::Type::Edge:
+            {
+                const auto  t   = static_cast<T>(ref.barycentric.x);
+                const auto& vb  = mesh.vertices[ref.index2];
+                output.vertices[i] = Traits::Interpolate(mesh.vertices[ref.index], vb, vb, Gs::Vector3T<T>(T(1) - t, t, T(0)));
+            }
+            break;
+
+            case VertexRef::Type::Interior:
+                output.vertices[i] = mesh.Barycentric(ref.index, ref.barycentric.template Cast<T>());
+                break;
+        }
+    }
+
+    /* Convert output triangles to the index type */
+    output.triangles.resize(side.triangles.size());
+
+    for (std::size_t i = 0; i < side.triangles.size(); ++i)
+    {
+        const auto& tri = side.triangles[i];
+        output.triangles[i] = { static_cast<IndexT>(tri.a), static_cast<IndexT>(tri.b), static_cast<IndexT>(tri.c) };
+    }
+}
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,134 @@
+/*
+ * MeshCollision.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_MESH_COLLISION_H
+#define GM_MESH_COLLISION_H
+
+
+#include <Geom/MeshView.h>
+#include <Geom/TriangleCollision.h>
+#include <Geom/PlaneCollision.h>
+#include <Geom/Ray.h>
+
+#include <Gauss/Algebra.h>
+#include <limits>
+#include <vector>
+
+
+namespace Gm
+{
+
+
+/**
+\brief Computes the closest intersection between the specified ray and the triangles of the specified mesh view.
+\param[in] mesh Specifies the view of the mesh, e.g. created with 'MakeMeshView'.
+\param[in] ray Specifies the ray. Only front facing triangles are hit (see 'IntersectionWithTriangleBarycentric').
+\param[out] triangleIndex Specifies the index of the triangle that has been hit.
+\param[out] barycentric Specifies the barycentric coordinates of the intersection within the hit triangle.
+\return True if an intersection occurs, otherwise false.
+\remarks Only the position streams of the mesh are accessed, so this works equally on interleaved and SoA meshes.
+*/
+template <typename T, typename IndexT>
+bool IntersectionWithMesh(const MeshViewT<T, IndexT>& mesh, const Ray3T<T>& ray, std::size_t& triangleIndex, Gs::Vector3T<T>& barycentric)
+{
+    auto minDist = std::numeric_limits<T>::max();
+    Gs::Vector3T<T> coords;
+
+    for (std::size_t i = 0, n = mesh.NumTriangles(); i < n; ++i)
+    {
+        const auto tri = mesh.GetTriangle(i);
+        if (IntersectionWithTriangleBarycentric(tri, ray, coords))
+        {
+            /* Keep intersection with the smallest distance along the ray */
+            const auto dist = Gs::Dot(tri.BarycentricToCartesian(coords) - ray.origin, ray.direction);
+            if (dist < minDist)
+            {
+                minDist         = dist;
+                triangleIndex   = i;
+                barycentric     = coords;
+            }
+        }
+    }
+
+    return (minDist < std::numeric_limits<T>::max());
+}
+
+/**
+\brief Computes the point on the triangles of the specified mesh view which is the closest one to the specified point.
+\param[out] triangleIndex Specifies the index of the triangle the closest point belongs to.
+\return The closest point, or the input point if the mesh has no triangles.
+\see ClosestPointOnTriangle
+*/
+template <typename T, typename IndexT>
+Gs::Vector3T<T> ClosestPointOnMesh(const MeshViewT<T, IndexT>& mesh, const Gs::Vector3T<T>& point, std::size_t& triangleIndex)
+{
+    auto closestPoint   = point;
+    auto minDistSq      = std::numeric_limits<T>::max();
+
+    for (std::size_t i = 0, n = mesh.NumTriangles(); i < n; ++i)
+    {
+        const auto p        = ClosestPointOnTriangle(mesh.GetTriangle(i), point);
+        const auto distSq   = Gs::DistanceSq(p, point);
+        if (distSq < minDistSq)
+        {
+            minDistSq       = distSq;
+            closestPoint    = p;
+            triangleIndex   = i;
+        }
+    }
+
+    return closestPoint;
+}
+
+/**
+\brief Classifies all triangles of the specified mesh view against the specified plane.
+\param[out] relations Specifies the output list of relations. It will have the same size as the number of triangles.
+Each entry is either PlaneRelation::InFrontOf, PlaneRelation::Behind, or PlaneRelation::Clipped,
+i.e. the same relation 'ClipTriangle' returns for the respective triangle.
+\remarks This is the position-only pass of mesh clipping. Only triangles with the relation PlaneRelation::Clipped need to be clipped.
+\see ClipTriangle
+*/
+template <typename T, typename IndexT, typename PlaneEq>
+void ClassifyTriangles(
+    const MeshViewT<T, IndexT>&     mesh,
+    const PlaneT<T, PlaneEq>&       plane,
+    std::vector<PlaneRelation>&     relations,
+    const T&                        epsilon = Gs::Epsilon<T>())
+{
+    const auto& positions = mesh.Positions();
+
+    relations.resize(mesh.NumTriangles());
+
+    for (std::size_t i = 0; i < relations.size(); ++i)
+    {
+        const auto& tri = mesh.Indices(i);
+
+        /* Count vertices that are not behind the plane (like 'ClipTriangle') */
+        const auto numFront = (
+            (RelationToPlane(plane, positions[tri.a], epsilon) != PlaneRelation::Behind ? 1 : 0) +
+            (RelationToPlane(plane, positions[tri.b], epsilon) != PlaneRelation::Behind ? 1 : 0) +
+            (RelationToPlane(plane, positions[tri.c], epsilon) != PlaneRelation::Behind ? 1 : 0)
+        );
+
+        if (numFront == 3)
+            relations[i] = PlaneRelation::InFrontOf;
+        else if (numFront == 0)
+            relations[i] = PlaneRelation::Behind;
+        else
+            relations[i] = PlaneRelation::Clipped;
+    }
+}
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
@@ -10,9 +10,11 @@
 
 
 #include <Geom/TriangleMesh.h>
+#include <Geom/IndexBuffer.h>
 #include <Geom/BezierPatch.h>
 
 #include <functional>
+#include <cstddef>
 #include <cstdint>
 
 
@@ -30,6 +32,7 @@ namespace MeshGenerator
 \param[in] v Specifies the interpolation factor V. This is in the range [0, 1].
 \return Interpolation factor which should be in the range [0, 1].
 \remarks This can be used for a couple of mesh generators, to adjust the final vertex position.
+Large meshes are generated in parallel, so this function may be called concurrently from multiple threads.
 \see TorusKnotDescriptor
 */
 using VertexModifier = std::function<Gs::Real(Gs::Real u, Gs::Real v)>;
@@ -42,6 +45,15 @@ using VertexModifier = std::function<Gs::Real(Gs::Real u, Gs::Real v)>;
 */
 using CurveFunction = std::function<Gs::Vector3(Gs::Real t)>;
 
+/**
+\brief Batched function interface for an arbitrary R -> R^3 transformation.
+\param[in] t Pointer to the array of curve progressions. Each one is in the range [0, 1].
+\param[out] points Pointer to the array of 3D points which lie on the curve at the respective positions in 't'.
+\param[in] count Specifies the number of elements in both arrays.
+\see CurveDescriptor
+*/
+using CurveBatchFunction = std::function<void(const Gs::Real* t, Gs::Vector3* points, std::size_t count)>;
+
 
 /* --- Descriptors --- */
 
@@ -210,37 +222,43 @@ struct TorusDescriptor
 struct TorusKnotDescriptor
 {
     //! Radius of the torus ring in X, and Y direction. By default (0.25, 0.25, 0.25).
-    Gs::Vector3     ringRadius      = Gs::Vector3(Gs::Real(0.25));
+    Gs::Vector3     ringRadius         = Gs::Vector3(Gs::Real(0.25));
 
     //! Radius of the inner tube. By default 0.125.
-    Gs::Real        tubeRadius      = Gs::Real(0.125);
+    Gs::Real        tubeRadius         = Gs::Real(0.125);
 
     //! Inner radius within the torus knot curve. By default 2.
-    Gs::Real        innerRadius     = Gs::Real(2);
+    Gs::Real        innerRadius        = Gs::Real(2);
 
     /**
     \breif Number of loops within the torus knot. By default 2.
     \remarks This must be coprime to 'turns', otherwise the mesh will not be a valid torus knot.
     */
-    std::uint32_t   loops           = 2;
+    std::uint32_t   loops              = 2;
 
     /**
     \breif Number of turns within the torus knot. By default 3.
     \remarks This must be coprime to 'loops', otherwise the mesh will not be a valid torus knot.
     */
-    std::uint32_t   turns           = 3;
+    std::uint32_t   turns              = 3;
 
     /**
     \brief Segmentation in U (x component), and V (y component) direction.
     \remarks Each component will be clamped to [3, +inf). By default (256, 20).
     */
-    Gs::Vector2ui   segments        = Gs::Vector2ui(256, 20);
+    Gs::Vector2ui   segments           = Gs::Vector2ui(256, 20);
 
     //! Specifies whether the face grids are to be alternating or uniform. By default false.
-    bool            alternateGrid   = false;
+    bool            alternateGrid      = false;
 
     //! Vertex modifier to adjust the tube radius during mesh generation.
-    VertexModifier  vertexModifier  = nullptr;
+    VertexModifier  vertexModifier     = nullptr;
+
+    //! Chord error tolerance for adaptive ring placement. If 0, the rings are placed uniformly. By default 0.
+    Gs::Real        tolerance          = Gs::Real(0);
+
+    //! Specifies whether the ring frames are parallel transported along the curve. By default false.
+    bool            parallelTransport  = false;
 };
 
 //! Descriptor structure for a spiral mesh.
@@ -278,22 +296,43 @@ struct SpiralDescriptor
 struct CurveDescriptor
 {
     //! Curve progression function.
-    CurveFunction   curveFunction   = nullptr;
+    CurveFunction       curveFunction       = nullptr;
+
+    //! Batched curve progression function. If this is set, it is used instead of 'curveFunction' to evaluate all samples with a single call.
+    CurveBatchFunction  curveBatchFunction  = nullptr;
 
     //! Radius of the tube which forms the curve. By default 0.25.
-    Gs::Real        radius          = Gs::Real(0.25);
+    Gs::Real            radius              = Gs::Real(0.25);
 
     /**
     \brief Segmentation in U (x component), and V (y component) direction.
     \remarks Each component will be clamped to [3, +inf). By default (20, 20).
     */
-    Gs::Vector2ui   segments        = Gs::Vector2ui(20, 20);
+    Gs::Vector2ui       segments            = Gs::Vector2ui(20, 20);
 
     //! Specifies whether the face grids are to be alternating or uniform. By default false.
-    bool            alternateGrid   = false;
+    bool                alternateGrid       = false;
 
     //! Vertex modifier to adjust the radius during mesh generation.
-    VertexModifier  vertexModifier  = nullptr;
+    VertexModifier      vertexModifier      = nullptr;
+
+    /**
+    \brief Chord error tolerance for adaptive ring placement. By default 0.
+    \remarks If this is greater than zero, the curve is sampled with 'segments.x' samples as maximal resolution,
+    and only those rings are generated which are required to keep all samples within this distance to the centerline of the tube.
+    Straight parts of the curve then get fewer rings, while strongly bent parts keep the full resolution.
+    If 0, all 'segments.x' rings are placed uniformly.
+    */
+    Gs::Real            tolerance           = Gs::Real(0);
+
+    /**
+    \brief Specifies whether the ring frames are parallel transported along the curve (rotation-minimizing frames). By default false.
+    \remarks If false, each ring is oriented with the Y axis as up vector, which twists the tube where the curve tangent gets close to the Y axis.
+    For closed curves, the remaining twist between the last and the first ring is distributed over all rings.
+    \remarks The ring normals are rotated around the tangent with precomputed sine and cosine tables.
+    With the default options, the vertices are therefore equal to a per-vertex rotation with 'Gs::RotateVectorAroundAxis' within rounding, but not bit-identical.
+    */
+    bool                parallelTransport   = false;
 };
 
 //! Descriptor structure for a Bezier patch mesh.
@@ -316,6 +355,64 @@ struct BezierPatchDescriptor
 };
 
 
+/* --- Output --- */
+
+//! Exact number of vertices and triangles that a mesh generator produces.
+struct MeshCounts
+{
+    std::size_t numVertices     = 0;    //!< Number of vertices.
+    std::size_t numTriangles    = 0;    //!< Number of triangles, i.e. three indices each.
+};
+
+/**
+\brief Function interface to write a generated vertex into a custom vertex layout.
+\param[in] vertices Specifies the pointer to the output vertices, i.e. 'MeshSpan::customVertices'.
+\param[in] index Specifies the index of the vertex within the output vertices.
+\remarks Large meshes are generated in parallel, so this function may be called concurrently for different vertices.
+\see MeshSpan::writeVertex
+*/
+using VertexWriteFunction = void (*)(void* vertices, std::size_t index, const Gs::Vector3& position, const Gs::Vector3& normal, const Gs::Vector2& texCoord);
+
+/**
+\brief Function interface to write a generated triangle with a custom index type.
+\param[in] indices Specifies the pointer to the output indices, i.e. 'MeshSpan::indices'.
+\param[in] index Specifies the index of the triangle within the output indices.
+\remarks Large meshes are generated in parallel, so this function may be called concurrently for different triangles.
+\see MeshSpan::writeTriangle
+*/
+using TriangleWriteFunction = void (*)(void* indices, std::size_t index, TriangleMesh::VertexIndex v0, TriangleMesh::VertexIndex v1, TriangleMesh::VertexIndex v2);
+
+/**
+\brief Caller-provided output memory for the mesh generators, e.g. a mapped vertex and index buffer.
+\remarks The vertex indices are written relative to the first vertex in 'vertices', plus 'baseVertex'.
+Use the 'Count*' functions (e.g. 'CountCuboid') to determine the required capacities up front.
+The span overloads of the mesh generators throw 'std::out_of_range' if the capacities are insufficient,
+or if the vertices cannot be addressed with the specified index format.
+Other vertex layouts and index types are written with 'writeVertex' and 'writeTriangle' (see 'TriangleMeshT::AppendSpan').
+*/
+struct MeshSpan
+{
+    TriangleMesh::Vertex*   vertices        = nullptr;              //!< Pointer to the output vertices.
+    std::size_t             maxVertices     = 0;                    //!< Capacity of the output vertices.
+    void*                   indices         = nullptr;              //!< Pointer to the output indices, three per triangle.
+    std::size_t             maxTriangles    = 0;                    //!< Capacity of the output triangles.
+    IndexFormat             indexFormat     = IndexFormat::UInt32;  //!< Format of the output indices.
+    std::size_t             baseVertex      = 0;                    //!< Offset that is added to all output indices, e.g. to append to a shared vertex buffer.
+
+    //! Optional function to write the vertices into 'customVertices'. If this is non-null, 'vertices' is ignored.
+    VertexWriteFunction     writeVertex     = nullptr;
+
+    //! Pointer to the output vertices in a custom layout. This is only used if 'writeVertex' is non-null.
+    void*                   customVertices  = nullptr;
+
+    //! Optional function to write the triangles into 'indices'. If this is non-null, 'indexFormat' is ignored.
+    TriangleWriteFunction   writeTriangle   = nullptr;
+
+    //! Maximal index that 'writeTriangle' can store. This is only used if 'writeTriangle' is non-null.
+    std::uint64_t           maxIndex        = 0;
+};
+
+
 /* --- Global Functions --- */
 
 //! Generates a cuboid (also cube) mesh with the specified descriptor and appends the result to the specified output mesh.
@@ -324,6 +421,12 @@ void GenerateCuboid(const CuboidDescriptor& desc, TriangleMesh& mesh);
 //! Generates and returns a new cuboid (also cube) mesh with the specified descriptor.
 TriangleMesh GenerateCuboid(const CuboidDescriptor& desc);
 
+//! Generates a cuboid (also cube) mesh with the specified descriptor into the specified output span and returns the number of written vertices and triangles.
+MeshCounts GenerateCuboid(const CuboidDescriptor& desc, const MeshSpan& span);
+
+//! Returns the exact number of vertices and triangles that are generated for a cuboid (also cube) mesh with the specified descriptor.
+MeshCounts CountCuboid(const CuboidDescriptor& desc);
+
 
 
 //! Generates an ellipsoid (also sphere) mesh with the specified descriptor and appends the result to the specified output mesh.
@@ -332,6 +435,12 @@ void GenerateEllipsoid(const EllipsoidDescriptor& desc, TriangleMesh& mesh);
 //! Generates and returns a new ellipsoid (also sphere) mesh with the specified descriptor.
 TriangleMesh GenerateEllipsoid(const EllipsoidDescriptor& desc);
 
+//! Generates a ellipsoid (also sphere) mesh with the specified descriptor into the specified output span and returns the number of written vertices and triangles.
+MeshCounts GenerateEllipsoid(const EllipsoidDescriptor& desc, const MeshSpan& span);
+
+//! Returns the exact number of vertices and triangles that are generated for a ellipsoid (also sphere) mesh with the specified descriptor.
+MeshCounts CountEllipsoid(const EllipsoidDescriptor& desc);
+
 
 
 //! Generates a cone mesh with the specified descriptor and appends the result to the specified output mesh.
@@ -340,6 +449,12 @@ void GenerateCone(const ConeDescriptor& desc, TriangleMesh& mesh);
 //! Generates and returns a new cone mesh with the specified descriptor.
 TriangleMesh GenerateCone(const ConeDescriptor& desc);
 
+//! Generates a cone mesh with the specified descriptor into the specified output span and returns the number of written vertices and triangles.
+MeshCounts GenerateCone(const ConeDescriptor& desc, const MeshSpan& span);
+
+//! Returns the exact number of vertices and triangles that are generated for a cone mesh with the specified descriptor.
+MeshCounts CountCone(const ConeDescriptor& desc);
+
 
 
 //! Generates a cylinder mesh with the specified descriptor and appends the result to the specified output mesh.
@@ -348,6 +463,12 @@ void GenerateCylinder(const CylinderDescriptor& desc, TriangleMesh& mesh);
 //! Generates and returns a new cylinder mesh with the specified descriptor.
 TriangleMesh GenerateCylinder(const CylinderDescriptor& desc);
 
+//! Generates a cylinder mesh with the specified descriptor into the specified output span and returns the number of written vertices and triangles.
+MeshCounts GenerateCylinder(const CylinderDescriptor& desc, const MeshSpan& span);
+
+//! Returns the exact number of vertices and triangles that are generated for a cylinder mesh with the specified descriptor.
+MeshCounts CountCylinder(const CylinderDescriptor& desc);
+
 
 
 //! Generates a pie (also pie-diagram) mesh with the specified descriptor and appends the result to the specified output mesh.
@@ -356,6 +477,12 @@ void GeneratePie(const PieDescriptor& desc, TriangleMesh& mesh);
 //! Generates and returns a new (also pie-diagram) mesh with the specified descriptor.
 TriangleMesh GeneratePie(const PieDescriptor& desc);
 
+//! Generates a pie (also pie-diagram) mesh with the specified descriptor into the specified output span and returns the number of written vertices and triangles.
+MeshCounts GeneratePie(const PieDescriptor& desc, const MeshSpan& span);
+
+//! Returns the exact number of vertices and triangles that are generated for a pie (also pie-diagram) mesh with the specified descriptor.
+MeshCounts CountPie(const PieDescriptor& desc);
+
 
 
 //! Generates a pipe mesh (i.e. cylinder with a hole) with the specified descriptor and appends the result to the specified output mesh.
@@ -364,6 +491,12 @@ void GeneratePipe(const PipeDescriptor& desc, TriangleMesh& mesh);
 //! Generates and returns a new pipe (i.e. cylinder with a hole) mesh with the specified descriptor.
 TriangleMesh GeneratePipe(const PipeDescriptor& desc);
 
+//! Generates a pipe (i.e. cylinder with a hole) mesh with the specified descriptor into the specified output span and returns the number of written vertices and triangles.
+MeshCounts GeneratePipe(const PipeDescriptor& desc, const MeshSpan& span);
+
+//! Returns the exact number of vertices and triangles that are generated for a pipe (i.e. cylinder with a hole) mesh with the specified descriptor.
+MeshCounts CountPipe(const PipeDescriptor& desc);
+
 
 
 //! Generates a capsule mesh (i.e. cylinder with a half-sphere at top and bottom) with the specified descriptor and appends the result to the specified output mesh.
@@ -372,6 +505,12 @@ void GenerateCapsule(const CapsuleDescriptor& desc, TriangleMesh& mesh);
 //! Generates and returns a new capsule mesh (i.e. cylinder with a half-sphere at top and bottom) with the specified descriptor.
 TriangleMesh GenerateCapsule(const CapsuleDescriptor& desc);
 
+//! Generates a capsule (i.e. cylinder with a half-sphere at top and bottom) mesh with the specified descriptor into the specified output span and returns the number of written vertices and triangles.
+MeshCounts GenerateCapsule(const CapsuleDescriptor& desc, const MeshSpan& span);
+
+//! Returns the exact number of vertices and triangles that are generated for a capsule (i.e. cylinder with a half-sphere at top and bottom) mesh with the specified descriptor.
+MeshCounts CountCapsule(const CapsuleDescriptor& desc);
+
 
 
 //! Generates a torus mesh with the specified descriptor and appends the result to the specified output mesh.
@@ -380,6 +519,12 @@ void GenerateTorus(const TorusDescriptor& desc, TriangleMesh& mesh);
 //! Generates and returns a new torus mesh with the specified descriptor.
 TriangleMesh GenerateTorus(const TorusDescriptor& desc);
 
+//! Generates a torus mesh with the specified descriptor into the specified output span and returns the number of written vertices and triangles.
+MeshCounts GenerateTorus(const TorusDescriptor& desc, const MeshSpan& span);
+
+//! Returns the exact number of vertices and triangles that are generated for a torus mesh with the specified descriptor.
+MeshCounts CountTorus(const TorusDescriptor& desc);
+
 
 
 //! Generates a torus-knot mesh with the specified descriptor and appends the result to the specified output mesh.
@@ -388,6 +533,15 @@ void GenerateTorusKnot(const TorusKnotDescriptor& desc, TriangleMesh& mesh);
 //! Generates and returns a new torus-knot mesh with the specified descriptor.
 TriangleMesh GenerateTorusKnot(const TorusKnotDescriptor& desc);
 
+//! Generates a torus-knot mesh with the specified descriptor into the specified output span and returns the number of written vertices and triangles.
+MeshCounts GenerateTorusKnot(const TorusKnotDescriptor& desc, const MeshSpan& span);
+
+/**
+\brief Returns the exact number of vertices and triangles that are generated for a torus-knot mesh with the specified descriptor.
+\remarks If 'desc.tolerance' is greater than zero, the torus-knot curve is evaluated to determine the number of rings.
+*/
+MeshCounts CountTorusKnot(const TorusKnotDescriptor& desc);
+
 
 
 //! Generates a spiral mesh with the specified descriptor and appends the result to the specified output mesh.
@@ -396,6 +550,12 @@ void GenerateSpiral(const SpiralDescriptor& desc, TriangleMesh& mesh);
 //! Generates and returns a new spiral mesh with the specified descriptor.
 TriangleMesh GenerateSpiral(const SpiralDescriptor& desc);
 
+//! Generates a spiral mesh with the specified descriptor into the specified output span and returns the number of written vertices and triangles.
+MeshCounts GenerateSpiral(const SpiralDescriptor& desc, const MeshSpan& span);
+
+//! Returns the exact number of vertices and triangles that are generated for a spiral mesh with the specified descriptor.
+MeshCounts CountSpiral(const SpiralDescriptor& desc);
+
 
 
 //! Generates a curve mesh (as a rope along a given curve function) with the specified descriptor and appends the result to the specified output mesh.
@@ -404,6 +564,15 @@ void GenerateCurve(const CurveDescriptor& desc, TriangleMesh& mesh);
 //! Generates and returns a new curve mesh (as a rope along a given curve function) with the specified descriptor.
 TriangleMesh GenerateCurve(const CurveDescriptor& desc);
 
+//! Generates a curve (as a rope along a given curve function) mesh with the specified descriptor into the specified output span and returns the number of written vertices and triangles.
+MeshCounts GenerateCurve(const CurveDescriptor& desc, const MeshSpan& span);
+
+/**
+\brief Returns the exact number of vertices and triangles that are generated for a curve (as a rope along a given curve function) mesh with the specified descriptor.
+\remarks If 'desc.tolerance' is greater than zero, the curve function is evaluated to determine the number of rings.
+*/
+MeshCounts CountCurve(const CurveDescriptor& desc);
+
 
 
 //! Generates a Bezier patch mesh with the specified descriptor and appends the result to the specified output mesh.
@@ -412,6 +581,12 @@ void GenerateBezierPatch(const BezierPatchDescriptor& desc, TriangleMesh& mesh);
 //! Generates and returns a new Bezier patch mesh with the specified descriptor.
 TriangleMesh GenerateBezierPatch(const BezierPatchDescriptor& desc);
 
+//! Generates a Bezier patch mesh with the specified descriptor into the specified output span and returns the number of written vertices and triangles.
+MeshCounts GenerateBezierPatch(const BezierPatchDescriptor& desc, const MeshSpan& span);
+
+//! Returns the exact number of vertices and triangles that are generated for a Bezier patch mesh with the specified descriptor.
+MeshCounts CountBezierPatch(const BezierPatchDescriptor& desc);
+
 
 } // /namespace MeshGenerator
 
@@ -10,37 +10,71 @@
 
 
 #include <Geom/TriangleMesh.h>
+#include <Geom/TriangleMeshT.h>
+#include <Geom/TriangleCollision.h>
+#include <Geom/MeshClipper.h>
 #include <Geom/Plane.h>
 
 #include <cstdint>
+#include <limits>
 
 
 namespace Gm
 {
 
+
+class TriangleMeshSoA;
+
 //! Namespace with all mesh modifier functions.
 namespace MeshModifier
 {
 
 
+//! Component formats of vertex attributes.
+enum class VertexFormat
+{
+    Real,               //!< Components of type "Gs::Real".
+    Float,              //!< 32-bit floating-point components.
+    Half,               //!< 16-bit floating-point components (IEEE 754 half precision).
+    SNorm8,             //!< 8-bit signed normalized components, i.e. [-1, 1] is mapped to [-127, 127].
+    SNorm16,            //!< 16-bit signed normalized components, i.e. [-1, 1] is mapped to [-32767, 32767].
+    UNorm8,             //!< 8-bit unsigned normalized components, i.e. [0, 1] is mapped to [0, 255].
+    UNorm16,            //!< 16-bit unsigned normalized components, i.e. [0, 1] is mapped to [0, 65535].
+    OctahedralSNorm8,   //!< Unit vector with 3 components, octahedral encoded into 2 components of type SNorm8.
+    OctahedralSNorm16,  //!< Unit vector with 3 components, octahedral encoded into 2 components of type SNorm16.
+};
+
+//! Vertex attributes of the 'TriangleMesh::Vertex' structure.
+enum class VertexSemantic
+{
+    Position,   //!< Vertex position with 3 components.
+    Normal,     //!< Normal vector with 3 components.
+    TexCoord,   //!< Texture coordinate with 2 components.
+};
+
 /**
 \brief Vertex attribute descriptor structure.
-\note This mesh modifier can only handle vertex attributes with components of type "Gs::Real".
+\note The interpolation functions of this mesh modifier can only handle vertex attributes with the format VertexFormat::Real.
+All formats are supported by 'PackVertices'.
 */
 struct VertexAttributeDescriptor
 {
     VertexAttributeDescriptor() = default;
-    VertexAttributeDescriptor(std::size_t offset, std::uint32_t components) :
+    VertexAttributeDescriptor(std::size_t offset, std::uint32_t components, VertexFormat format = VertexFormat::Real) :
         offset     { offset     },
-        components { components }
+        components { components },
+        format     { format     }
     {
     }
 
     //! Byte offset within each vertex.
     std::size_t     offset      = 0;
 
-    //! Number of components of this vertex attribute. By default 1.
+    //! Number of components of this vertex attribute. By default 1. For octahedral formats, this is the number of source components, i.e. 3.
     std::uint32_t   components  = 1;
+
+    //! Component format of this vertex attribute. By default VertexFormat::Real.
+    VertexFormat    format      = VertexFormat::Real;
 };
 
 //! Vertex descriptor structure.
@@ -63,6 +97,163 @@ struct VertexDescriptor
     std::size_t                             stride      = 0;
 };
 
+//! Attribute of a packed vertex buffer.
+struct PackedVertexAttribute
+{
+    PackedVertexAttribute() = default;
+    PackedVertexAttribute(VertexSemantic semantic, const VertexAttributeDescriptor& attribute, std::uint32_t buffer = 0) :
+        semantic  { semantic  },
+        attribute { attribute },
+        buffer    { buffer    }
+    {
+    }
+
+    //! Source attribute of the 'TriangleMesh::Vertex' structure. By default VertexSemantic::Position.
+    VertexSemantic              semantic    = VertexSemantic::Position;
+
+    //! Offset, number of components, and format within the output vertex.
+    VertexAttributeDescriptor   attribute;
+
+    //! Index of the output buffer. Attributes with the same buffer index are interleaved. By default 0.
+    std::uint32_t               buffer      = 0;
+};
+
+/**
+\brief Vertex packing descriptor structure.
+\remarks A single buffer with all attributes describes an interleaved layout,
+and one buffer per attribute describes a de-interleaved layout.
+\see PackVertices
+*/
+struct VertexPackingDescriptor
+{
+    //! Attributes of all output buffers.
+    std::vector<PackedVertexAttribute>  attributes;
+
+    /**
+    \brief Byte offset to the next vertex for each output buffer.
+    \remarks If a buffer has no entry in this list or the entry is zero, the end of its last attribute is used.
+    */
+    std::vector<std::size_t>            strides;
+};
+
+//! Post-transform vertex cache statistics structure.
+struct VertexCacheStatistics
+{
+    //! Number of simulated vertex shader invocations (i.e. cache misses).
+    std::size_t numTransforms   = 0;
+
+    //! Average cache miss ratio, i.e. vertex shader invocations per triangle. The optimum is 0.5, the worst case is 3.
+    Gs::Real    acmr            = Gs::Real(0);
+
+    //! Average transformed vertex ratio, i.e. vertex shader invocations per referenced vertex. The optimum is 1.
+    Gs::Real    atvr            = Gs::Real(0);
+};
+
+//! Vertex cache optimization descriptor structure.
+struct VertexCacheDescriptor
+{
+    //! Number of entries of the simulated post-transform vertex cache. By default 16.
+    std::size_t cacheSize           = 16;
+
+    //! Specifies whether the triangle clusters are to be sorted to reduce overdraw. By default false.
+    bool        optimizeOverdraw    = false;
+
+    /**
+    \brief Maximal ratio of the ACMR after overdraw optimization to the ACMR before. By default 1.05.
+    \remarks Smaller values result in fewer but larger clusters. This is only used if 'optimizeOverdraw' is true.
+    */
+    Gs::Real    overdrawThreshold   = Gs::Real(1.05);
+
+    //! Specifies whether the vertices are to be reordered by their first use afterwards. By default true.
+    bool        optimizeVertexFetch = true;
+};
+
+//! Vertex cache optimization result structure.
+struct VertexCacheResult
+{
+    VertexCacheStatistics                   before;     //!< Statistics before the optimization.
+    VertexCacheStatistics                   after;      //!< Statistics after the optimization.
+    std::vector<TriangleMesh::VertexIndex>  vertexRemap;//!< Remap table from old to new vertex indices (only if the vertices have been reordered).
+};
+
+//! Mesh simplification descriptor structure.
+struct SimplifyDescriptor
+{
+    //! Ratio of triangles to keep. This must be in the range [0, 1]. By default 0.5.
+    Gs::Real    targetRatio             = Gs::Real(0.5);
+
+    /**
+    \brief Maximal error of the simplification. By default std::numeric_limits<Gs::Real>::max().
+    \remarks The error of each vertex is the square root of the sum of its squared distances to the planes
+    of all original triangles that have been collapsed into it. The simplification stops as soon as the next
+    edge collapse would exceed this error, even if the target ratio has not been reached yet.
+    */
+    Gs::Real    maxError                = std::numeric_limits<Gs::Real>::max();
+
+    //! Specifies whether vertices on open borders are locked. Otherwise, they are only collapsed along the border. By default false.
+    bool        lockBorders             = false;
+
+    //! Specifies whether vertices that are no longer referenced are removed from the mesh. By default true.
+    bool        removeUnusedVertices    = true;
+};
+
+//! Vertex welding descriptor structure.
+struct WeldDescriptor
+{
+    //! Maximal distance (per component) between two positions to be welded. By default Gs::Epsilon<Gs::Real>().
+    Gs::Real    positionEpsilon     = Gs::Epsilon<Gs::Real>();
+
+    //! Specifies whether the normals of two vertices must also be equal to be welded. By default false.
+    bool        compareNormals      = false;
+
+    //! Maximal distance (per component) between two normals to be welded. By default Gs::Epsilon<Gs::Real>().
+    Gs::Real    normalEpsilon       = Gs::Epsilon<Gs::Real>();
+
+    //! Specifies whether the texture coordinates of two vertices must also be equal to be welded. By default false.
+    bool        compareTexCoords    = false;
+
+    //! Maximal distance (per component) between two texture coordinates to be welded. By default Gs::Epsilon<Gs::Real>().
+    Gs::Real    texCoordEpsilon     = Gs::Epsilon<Gs::Real>();
+};
+
+//! Weighting of the face normals for smooth vertex normals.
+enum class NormalWeighting
+{
+    Uniform,    //!< Each face contributes equally.
+    Area,       //!< Each face contributes with its area.
+    Angle,      //!< Each face contributes with its interior angle at the vertex.
+};
+
+//! Normal recomputation descriptor structure.
+struct NormalsDescriptor
+{
+    //! Weighting of the face normals. By default NormalWeighting::Area.
+    NormalWeighting weighting       = NormalWeighting::Area;
+
+    /**
+    \brief Crease angle (in radians). By default Gs::pi, i.e. no creases.
+    \remarks Faces whose normals differ by more than this angle are not smoothed together.
+    Vertices on such creases are split, so new vertices may be appended to the mesh.
+    */
+    Gs::Real        creaseAngle     = Gs::Real(Gs::pi);
+
+    /**
+    \brief Specifies whether vertices with equal positions are smoothed together. By default false.
+    \remarks This smoothes the normals across texture seams and is required for creases between vertices that are already split.
+    */
+    bool            smoothSeams     = false;
+};
+
+//! Tangent generation descriptor structure.
+struct TangentsDescriptor
+{
+    /**
+    \brief Specifies whether vertices whose triangles have mirrored texture coordinates are split. By default true.
+    \remarks If this is false, the tangents of both handednesses are averaged at such vertices, which results in distorted tangents.
+    */
+    bool splitMirroredUVs = true;
+};
+
 
 /**
 \brief Returns the vertex descriptor for the default vertex format.
@@ -79,6 +270,8 @@ const VertexDescriptor& GetDefaultVertexDesc();
 \param[in] v1 Specifies the second vertex index for the triangle to interpolate the barycentric coordinates.
 \param[in] v2 Specifies the thrid vertex index for the triangle to interpolate the barycentric coordinates.
 \param[in] barycentricCoords Specifies the barycentric coordinates. The sum of all components must be 1.
+\remarks This is the fallback for vertex layouts that are only known at runtime. Descriptors with the same content as the default vertex descriptor are forwarded to the specialized interpolator.
+\see Gm::InterpolateBarycentric
 */
 void InterpolateBarycentric(
     const VertexDescriptor& vertexDesc,
@@ -90,12 +283,246 @@ void InterpolateBarycentric(
     const Gs::Vector3&      barycentricCoords
 );
 
+/**
+\brief Interpolates many vertices at once, each from a triangle with the respective barycentric coordinates.
+\param[in] vertexDesc Specifies the vertex descriptor for both output and input vertex buffers.
+\param[out] outputVertexBuffer Specifies the output vertex buffer. It must have enough space for 'count' vertices.
+\param[in] inputVertexBuffer Specifies the input vertex buffer.
+\param[in] triangles Specifies the triangles of the input vertex buffer.
+\param[in] triangleIndices Specifies the triangle index for each output vertex.
+\param[in] barycentricCoords Specifies the barycentric coordinates for each output vertex.
+\param[in] count Specifies the number of output vertices.
+\remarks Descriptors with the same content as the default vertex descriptor are forwarded to the specialized interpolator.
+\see Gm::InterpolateBarycentricBatch
+*/
+void InterpolateBarycentricBatch(
+    const VertexDescriptor&         vertexDesc,
+    void*                           outputVertexBuffer,
+    const void*                     inputVertexBuffer,
+    const TriangleMesh::Triangle*   triangles,
+    const std::size_t*              triangleIndices,
+    const Gs::Vector3*              barycentricCoords,
+    std::size_t                     count
+);
+
 /**
 Clips this triangle mesh into a front- and back sided mesh by the specified clipping plane.
+\remarks The output meshes preserve the vertex sharing of the input mesh, and vertices on split edges are shared by the adjacent triangles.
+Use 'MeshClipper' directly to reuse the working memory between calls, to query the vertex remap tables, or to clip against multiple planes.
+\see MeshClipper
 \see ClipTriangle
 */
 void ClipMesh(const TriangleMesh& mesh, const Plane& clipPlane, TriangleMesh& front, TriangleMesh& back);
 
+/**
+Clips the specified SoA triangle mesh into a front- and back sided mesh by the specified clipping plane.
+\remarks Like the interleaved version, the output meshes preserve the vertex sharing of the input mesh.
+The vertex distances to the plane are computed with the position streams only.
+\see ClipMesh(const TriangleMesh&, const Plane&, TriangleMesh&, TriangleMesh&)
+\see MeshClipper
+*/
+void ClipMesh(const TriangleMeshSoA& mesh, const Plane& clipPlane, TriangleMeshSoA& front, TriangleMeshSoA& back);
+
+/**
+Clips the specified templated triangle mesh into a front- and back sided mesh by the specified clipping plane.
+\throws std::out_of_range If the number of output vertices exceeds the range of the index type.
+\remarks Like the base mesh version, the output meshes preserve the vertex sharing of the input mesh.
+The clipped vertices are interpolated with 'VertexTraits<VertexT>::Interpolate'.
+\see ClipMesh(const TriangleMesh&, const Plane&, TriangleMesh&, TriangleMesh&)
+\see TriangleMeshT
+*/
+template <typename VertexT, typename IndexT>
+void ClipMesh(
+    const TriangleMeshT<VertexT, IndexT>&                                   mesh,
+    const PlaneT<typename TriangleMeshT<VertexT, IndexT>::ScalarType>&      clipPlane,
+    TriangleMeshT<VertexT, IndexT>&                                         front,
+    TriangleMeshT<VertexT, IndexT>&                                         back
+);
+
+//! Returns the size (in bytes) of a vertex attribute with the specified format and number of components.
+std::size_t GetVertexFormatSize(VertexFormat format, std::uint32_t components);
+
+/**
+\brief Returns the stride (in bytes) of the specified output buffer of the vertex packing descriptor.
+\see VertexPackingDescriptor::strides
+*/
+std::size_t GetPackedVertexStride(const VertexPackingDescriptor& packingDesc, std::uint32_t buffer);
+
+//! Returns the number of output buffers of the vertex packing descriptor, i.e. the greatest buffer index plus one.
+std::uint32_t GetNumPackedVertexBuffers(const VertexPackingDescriptor& packingDesc);
+
+/**
+\brief Packs the vertices of the specified mesh into GPU-ready vertex buffers.
+\param[in] mesh Specifies the mesh whose vertices are to be packed.
+\param[in] packingDesc Specifies the output layout and the component formats.
+\param[out] buffers Pointer to the array of output buffers. Each buffer must have enough space for the number of vertices times its stride.
+\remarks All attributes are converted in a single pass over the vertices. The components are converted in blocks of vertices with SIMD instructions,
+and large meshes are packed in parallel. Normalized formats are clamped and rounded to the nearest integer.
+Bytes of the output buffers that are not covered by any attribute are not written.
+\throws std::invalid_argument If an attribute has an invalid number of components for its semantic or format, or exceeds the stride of its buffer.
+\see GetPackedVertexStride
+*/
+void PackVertices(const TriangleMesh& mesh, const VertexPackingDescriptor& packingDesc, void* const* buffers);
+
+/**
+\brief Packs the vertices of the specified mesh into the specified list of byte buffers.
+\remarks The list is resized to the number of output buffers, and each buffer is resized to the number of vertices times its stride.
+\see PackVertices(const TriangleMesh&, const VertexPackingDescriptor&, void* const*)
+*/
+void PackVertices(const TriangleMesh& mesh, const VertexPackingDescriptor& packingDesc, std::vector<std::vector<std::uint8_t>>& buffers);
+
+/**
+\brief Encodes the specified unit vector with the octahedral mapping.
+\return 2D coordinates in the range [-1, 1].
+\see DecodeOctahedral
+*/
+Gs::Vector2 EncodeOctahedral(const Gs::Vector3& normal);
+
+//! Decodes the specified octahedral coordinates into a unit vector.
+Gs::Vector3 DecodeOctahedral(const Gs::Vector2& coords);
+
+/**
+\brief Simulates a FIFO post-transform vertex cache for the triangles of the specified mesh.
+\param[in] mesh Specifies the mesh whose triangles are to be analyzed in their current order.
+\param[in] cacheSize Specifies the number of cache entries. By default 16.
+*/
+VertexCacheStatistics AnalyzeVertexCache(const TriangleMesh& mesh, std::size_t cacheSize = 16);
+
+/**
+\brief Reorders the triangles of the specified mesh for the post-transform vertex cache and optionally for overdraw and vertex fetch.
+\param[in,out] mesh Specifies the mesh whose triangles (and vertices) are to be reordered.
+\param[in] cacheDesc Specifies the optimization descriptor.
+\return Vertex cache statistics before and after the optimization and the vertex remap table.
+\remarks This uses the "Tipsify" algorithm (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007),
+which runs in linear time. Overdraw optimization sorts the triangle clusters by their orientation towards the outside of the mesh.
+\see AnalyzeVertexCache
+\see OptimizeVertexFetch
+*/
+VertexCacheResult OptimizeVertexCache(TriangleMesh& mesh, const VertexCacheDescriptor& cacheDesc = {});
+
+/**
+\brief Reorders the vertices of the specified mesh by their first use in the triangle list.
+\return Remap table from the old vertex indices to the new vertex indices.
+\remarks Vertices that are not referenced by any triangle are moved to the end, while keeping their order.
+*/
+std::vector<TriangleMesh::VertexIndex> OptimizeVertexFetch(TriangleMesh& mesh);
+
+/**
+\brief Reduces the number of triangles of the specified mesh by collapsing edges in the order of their quadric error.
+\param[in,out] mesh Specifies the mesh that is to be simplified.
+\param[in] simplifyDesc Specifies the simplification descriptor.
+\return Final error of the simplification (see SimplifyDescriptor::maxError).
+\remarks This uses quadric error metrics (Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics", 1997)
+with half-edge collapses, i.e. no new vertices are created. Vertices with the same position but different normals or
+texture coordinates (attribute seams) are only collapsed along the seam, and all of their copies are collapsed together.
+Collapses that would flip a triangle are rejected.
+\see SimplifyLODChain
+*/
+Gs::Real Simplify(TriangleMesh& mesh, const SimplifyDescriptor& simplifyDesc = {});
+
+/**
+\brief Generates a chain of simplified triangle lists in a single simplification pass.
+\param[in] mesh Specifies the input mesh.
+\param[in] ratios Specifies the ratio of triangles to keep for each level of detail. This must be in descending order.
+\param[in] simplifyDesc Specifies the simplification descriptor. The members 'targetRatio' and 'removeUnusedVertices' are ignored.
+\return List of triangle lists (one for each ratio). All levels refer to the vertices of the input mesh, so they can share the same vertex buffer.
+\remarks The quadrics and the priority queue are reused between the levels,
+so generating the entire chain costs about as much as generating the coarsest level.
+If the error limit is reached, the remaining levels are equal to the last level.
+\see Simplify
+*/
+std::vector<std::vector<TriangleMesh::Triangle>> SimplifyLODChain(
+    const TriangleMesh&             mesh,
+    const std::vector<Gs::Real>&    ratios,
+    const SimplifyDescriptor&       simplifyDesc = {}
+);
+
+/**
+\brief Welds all vertices of the specified mesh which are equal within the specified tolerances.
+\param[in,out] mesh Specifies the mesh whose vertices are to be welded. The vertices are compacted and the triangles are remapped in place.
+\param[in] weldDesc Specifies the welding descriptor.
+\return Remap table from the old vertex indices to the new vertex indices.
+\remarks The vertices are found with a spatial hash in parallel. Welding is transitive, i.e. each vertex is welded
+with the vertex of smallest index it is equal to, and the first vertex of each group is kept.
+The order of the remaining vertices is preserved. Degenerated triangles are not removed.
+*/
+std::vector<TriangleMesh::VertexIndex> WeldVertices(TriangleMesh& mesh, const WeldDescriptor& weldDesc = {});
+
+/**
+\brief Generates an indexed triangle mesh from the specified triangle list (also called "triangle soup").
+\param[in] triangleList Specifies the list of triangles, where each triangle has its own three vertices.
+\param[out] mesh Specifies the output mesh. Previous vertices and triangles are cleared.
+\param[in] weldDesc Specifies the welding descriptor for equal vertices.
+\see TriangleMesh::TriangleList
+\see WeldVertices
+*/
+void IndexTriangleList(
+    const std::vector<Gm::Triangle<TriangleMesh::Vertex>>&  triangleList,
+    TriangleMesh&                                           mesh,
+    const WeldDescriptor&                                   weldDesc = {}
+);
+
+//! \see IndexTriangleList(const std::vector<Gm::Triangle<TriangleMesh::Vertex>>&, TriangleMesh&, const WeldDescriptor&)
+TriangleMesh IndexTriangleList(
+    const std::vector<Gm::Triangle<TriangleMesh::Vertex>>&  triangleList,
+    const WeldDescriptor&                                   weldDesc = {}
+);
+
+/**
+\brief Computes the normals of all triangles of the specified mesh in parallel.
+\param[in] mesh Specifies the mesh whose triangle normals are to be computed.
+\param[out] normals Specifies the output list of normalized triangle normals (one per triangle).
+\remarks This is equivalent to calling 'TriangleMesh::TriangleNormal' for each triangle, but much faster for large meshes.
+\see TriangleMesh::TriangleNormal
+*/
+void ComputeTriangleNormals(const TriangleMesh& mesh, std::vector<Gs::Vector3>& normals);
+
+/**
+\brief Recomputes the vertex normals of the specified mesh from its triangles.
+\param[in,out] mesh Specifies the mesh whose vertex normals are to be recomputed.
+\param[in] normalsDesc Specifies the normal recomputation descriptor.
+\return Number of vertices that have been appended to the mesh by splitting them along creases.
+\remarks Each vertex gathers the weighted normals of its adjacent triangles, so this runs in parallel without write conflicts.
+The vertex-to-triangle adjacency cached in the mesh is used if it is up to date (with position welding if 'smoothSeams' is true),
+so build it once with 'TriangleMesh::BuildAdjacency' when the normals of a deformed mesh are recomputed every frame.
+Vertices without any non-degenerated triangle keep their normals.
+\see TriangleMesh::BuildAdjacency
+*/
+std::size_t RecomputeNormals(TriangleMesh& mesh, const NormalsDescriptor& normalsDesc = {});
+
+/**
+\brief Generates the per-vertex tangents of the specified mesh from its positions, normals and texture coordinates.
+\param[in,out] mesh Specifies the mesh whose tangents are to be generated. Vertices may be appended (see TangentsDescriptor::splitMirroredUVs).
+\param[out] tangents Specifies the output tangent stream (one per vertex). The XYZ components contain the normalized tangent vector,
+which is orthogonalized against the vertex normal (Gram-Schmidt), and the W component contains the bitangent sign (+1 or -1),
+i.e. the bitangent is 'Cross(normal, tangent) * w'.
+\param[in] tangentsDesc Specifies the tangent generation descriptor.
+\return Number of vertices that have been appended to the mesh by splitting them at mirrored texture coordinates.
+\remarks The tangents of all triangles are computed in parallel over triangle chunks and each vertex gathers the area weighted tangents
+of its adjacent triangles, so no write conflicts occur. Vertices on UV seams are already separate vertices, so their tangents are not smoothed together.
+Vertices whose triangles have degenerated texture coordinates get an arbitrary tangent that is orthogonal to the normal.
+\see ComputeTangentSpace
+*/
+std::size_t GenerateTangents(
+    TriangleMesh&               mesh,
+    std::vector<Gs::Vector4>&   tangents,
+    const TangentsDescriptor&   tangentsDesc = {}
+);
+
+
+/* ----- Template functions ----- */
+
+template <typename VertexT, typename IndexT>
+void ClipMesh(
+    const TriangleMeshT<VertexT, IndexT>&                                   mesh,
+    const PlaneT<typename TriangleMeshT<VertexT, IndexT>::ScalarType>&      clipPlane,
+    TriangleMeshT<VertexT, IndexT>&                                         front,
+    TriangleMeshT<VertexT, IndexT>&                                         back)
+{
+    MeshClipper clipper;
+    clipper.Clip(mesh, Plane(clipPlane.normal.template Cast<Gs::Real>(), static_cast<Gs::Real>(clipPlane.distance)), front, back);
+}
+
 
 } // /namespace MeshModifier
 
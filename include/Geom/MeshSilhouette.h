@@ -0,0 +1,149 @@
+/*
+ * MeshSilhouette.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_MESH_SILHOUETTE_H
+#define GM_MESH_SILHOUETTE_H
+
+
+#include <Geom/TriangleMesh.h>
+#include <Gauss/Vector4.h>
+
+#include <vector>
+#include <cstdint>
+
+
+namespace Gm
+{
+
+
+/**
+\brief View dependent silhouette extraction of a triangle mesh, e.g. for shadow volumes.
+\remarks The edge-to-face pairs and face planes are precomputed once with 'Build'.
+Afterwards, the silhouette can be extracted for any point or directional light in O(T + E) without memory allocations.
+The light is specified in homogeneous coordinates in the object space of the mesh:
+a point light at position P is specified as (P.x, P.y, P.z, 1) and a directional light
+with the direction D (pointing from the light to the scene) is specified as (-D.x, -D.y, -D.z, 0).
+\see TriangleMesh::SilhouetteEdges
+*/
+class MeshSilhouette
+{
+
+    public:
+
+        using VertexIndex   = TriangleMesh::VertexIndex;
+        using TriangleIndex = TriangleMesh::TriangleIndex;
+        using Edge          = TriangleMesh::Edge;
+
+        //! Invalid triangle index for boundary edges.
+        static const TriangleIndex invalidTriangle = ~TriangleIndex(0);
+
+        //! Edge with its two adjacent faces. The edge (a, b) is in the winding order of the first face.
+        struct EdgeFaces
+        {
+            VertexIndex     a;
+            VertexIndex     b;
+            TriangleIndex   face0;
+            TriangleIndex   face1;  //!< Second face, or 'invalidTriangle' for boundary edges.
+        };
+
+        MeshSilhouette() = default;
+
+        //! Builds the silhouette information for the specified mesh.
+        explicit MeshSilhouette(const TriangleMesh& mesh);
+
+        /**
+        \brief Precomputes the edge-to-face pairs and face planes of the specified mesh.
+        \remarks This must be called again whenever the positions or triangles of the mesh change.
+        Edges that are shared by more than two faces (non-manifold edges) are split into one boundary edge per surplus face.
+        */
+        void Build(const TriangleMesh& mesh);
+
+        //! Releases all silhouette information.
+        void Clear();
+
+        /**
+        \brief Extracts the silhouette edges for the specified light.
+        \param[in] light Specifies the light position or direction in homogeneous coordinates (see class description).
+        \param[out] edges Specifies the output buffer of silhouette edges.
+        Each edge is in the winding order of its face that is facing the light.
+        \param[in] maxEdges Specifies the capacity of the output buffer. 'MaxSilhouetteEdges' is always sufficient.
+        \return Number of edges written to the output buffer. No more than 'maxEdges' are written.
+        \remarks Boundary edges are part of the silhouette if their face is facing the light.
+        */
+        std::size_t ExtractEdges(const Gs::Vector4& light, Edge* edges, std::size_t maxEdges);
+
+        /**
+        \brief Extracts the silhouette edges and the respective quads of an infinite shadow volume.
+        \param[in] mesh Specifies the mesh this silhouette was built for.
+        \param[in] light Specifies the light position or direction in homogeneous coordinates (see class description).
+        \param[out] edges Specifies the output buffer of silhouette edges. This may also be null.
+        \param[out] quadVertices Specifies the output buffer of shadow volume quads. It must have a capacity of 4*maxEdges elements.
+        For each silhouette edge (A, B), the quad consists of the two edge vertices (with w = 1) followed by both vertices extruded
+        to infinity (with w = 0), i.e. (B, A, A', B'). The quads have the same orientation as the mesh faces
+        and can be rendered as two triangles (0, 1, 2) and (0, 2, 3).
+        \param[in] maxEdges Specifies the capacity of the output buffers.
+        \return Number of edges (and quads) written to the output buffers.
+        */
+        std::size_t ExtractShadowVolume(
+            const TriangleMesh& mesh,
+            const Gs::Vector4&  light,
+            Edge*               edges,
+            Gs::Vector4*        quadVertices,
+            std::size_t         maxEdges
+        );
+
+        //! Returns the maximal number of silhouette edges, i.e. the number of edge-to-face pairs.
+        std::size_t MaxSilhouetteEdges() const
+        {
+            return edgeFaces_.size();
+        }
+
+        //! Returns the list of all edge-to-face pairs.
+        const std::vector<EdgeFaces>& GetEdgeFaces() const
+        {
+            return edgeFaces_;
+        }
+
+        //! Returns the facing flags of the last extraction (one per face, non-zero if the face is facing the light).
+        const std::vector<std::uint8_t>& GetFacing() const
+        {
+            return facing_;
+        }
+
+    private:
+
+        void ClassifyFaces(const Gs::Vector4& light);
+
+        std::size_t ExtractSilhouette(
+            const TriangleMesh* mesh,
+            const Gs::Vector4&  light,
+            Edge*               edges,
+            Gs::Vector4*        quadVertices,
+            std::size_t         maxEdges
+        ) const;
+
+        std::vector<EdgeFaces>      edgeFaces_;
+
+        // Face planes in SoA layout (n.x, n.y, n.z, d) with the plane equation 'n*x = d'. The normals are not normalized.
+        std::vector<Gs::Real>       planeNX_;
+        std::vector<Gs::Real>       planeNY_;
+        std::vector<Gs::Real>       planeNZ_;
+        std::vector<Gs::Real>       planeD_;
+
+        std::vector<std::uint8_t>   facing_;
+
+};
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
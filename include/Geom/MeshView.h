@@ -0,0 +1,276 @@
+/*
+ * MeshView.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_MESH_VIEW_H
+#define GM_MESH_VIEW_H
+
+
+#include <Geom/TriangleMesh.h>
+#include <Geom/TriangleMeshT.h>
+#include <Geom/BoundingBoxKernels.h>
+#include <Geom/Triangle.h>
+
+#include <Gauss/Vector3.h>
+#include <Gauss/AffineMatrix4.h>
+#include <Gauss/TransformVector.h>
+#include <cstddef>
+
+
+namespace Gm
+{
+
+
+/**
+\brief Non-owning view of vertex positions, either in an interleaved (AoS) or in a structure-of-arrays (SoA) layout.
+\remarks Both layouts are accessed as three strided coordinate streams, so algorithms can operate on either layout without copying.
+The viewed memory must outlive this view.
+\see MeshViewT
+*/
+template <typename T>
+class PositionViewT
+{
+
+    public:
+
+        PositionViewT() = default;
+
+        /**
+        \brief Initializes the view with strided points (AoS layout).
+        \param[in] points Pointer to the X coordinate of the first point. The Y and Z coordinates must follow directly.
+        \param[in] count Specifies the number of points.
+        \param[in] stride Specifies the byte offset from one point to the next.
+        */
+        PositionViewT(const T* points, std::size_t count, std::size_t stride) :
+            x_      { points     },
+            y_      { points + 1 },
+            z_      { points + 2 },
+            count_  { count      },
+            stride_ { stride     },
+            soa_    { false      }
+        {
+        }
+
+        //! Initializes the view with separate coordinate arrays (SoA layout).
+        PositionViewT(const T* x, const T* y, const T* z, std::size_t count) :
+            x_      { x         },
+            y_      { y         },
+            z_      { z         },
+            count_  { count     },
+            stride_ { sizeof(T) },
+            soa_    { true      }
+        {
+        }
+
+        //! Returns the X coordinate of the specified point.
+        T X(std::size_t i) const
+        {
+            return Stream(x_, i);
+        }
+
+        //! Returns the Y coordinate of the specified point.
+        T Y(std::size_t i) const
+        {
+            return Stream(y_, i);
+        }
+
+        //! Returns the Z coordinate of the specified point.
+        T Z(std::size_t i) const
+        {
+            return Stream(z_, i);
+        }
+
+        //! Returns the specified point.
+        Gs::Vector3T<T> operator [] (std::size_t i) const
+        {
+            return Gs::Vector3T<T>(X(i), Y(i), Z(i));
+        }
+
+        //! Returns the number of points.
+        std::size_t Size() const
+        {
+            return count_;
+        }
+
+        //! Returns true if this view refers to separate coordinate arrays.
+        bool IsSoA() const
+        {
+            return soa_;
+        }
+
+        //! Computes the axis-aligned bounding-box of all points with the SIMD kernel for the respective layout.
+        AABB3T<T> BoundingBox() const
+        {
+            if (count_ == 0)
+                return AABB3T<T>();
+            if (soa_)
+                return ComputeBoundingBoxSoA(x_, y_, z_, count_);
+            return ComputeBoundingBox(x_, count_, stride_);
+        }
+
+        //! Computes the axis-aligned bounding-box of all points with the specified transformation matrix.
+        AABB3T<T> BoundingBox(const Gs::AffineMatrix4T<T>& matrix) const
+        {
+            #ifndef GS_ROW_VECTORS
+
+            if (count_ == 0)
+                return AABB3T<T>();
+            if (soa_)
+                return ComputeBoundingBoxSoA(x_, y_, z_, count_, matrix);
+            return ComputeBoundingBox(x_, count_, stride_, matrix);
+
+            #else
+
+            AABB3T<T> box;
+
+            for (std::size_t i = 0; i < count_; ++i)
+                box.Insert(Gs::TransformVector(matrix, (*this)[i]));
+
+            return box;
+
+            #endif
+        }
+
+    private:
+
+        T Stream(const T* stream, std::size_t i) const
+        {
+            return *reinterpret_cast<const T*>(reinterpret_cast<const char*>(stream) + i * stride_);
+        }
+
+        const T*    x_      = nullptr;
+        const T*    y_      = nullptr;
+        const T*    z_      = nullptr;
+        std::size_t count_  = 0;
+        std::size_t stride_ = 0;
+        bool        soa_    = false;
+
+};
+
+
+/**
+\brief Non-owning view of the vertex positions and triangles of a mesh.
+\remarks This is used for position-only algorithms (i.e. bounding boxes, clipping classification, and collision queries),
+so they can operate on 'TriangleMesh', 'TriangleMeshT', and 'TriangleMeshSoA' without copying.
+\see MakeMeshView
+\see PositionViewT
+*/
+template <typename T, typename IndexT>
+class MeshViewT
+{
+
+    public:
+
+        using VertexIndex   = IndexT;
+        using Triangle      = Gm::Triangle<VertexIndex>;
+        using TriangleIndex = std::size_t;
+
+        MeshViewT() = default;
+
+        MeshViewT(const PositionViewT<T>& positions, const Triangle* triangles, std::size_t numTriangles) :
+            positions_    { positions    },
+            triangles_    { triangles    },
+            numTriangles_ { numTriangles }
+        {
+        }
+
+        //! Returns the view of all vertex positions.
+        const PositionViewT<T>& Positions() const
+        {
+            return positions_;
+        }
+
+        //! Returns the number of vertices.
+        std::size_t NumVertices() const
+        {
+            return positions_.Size();
+        }
+
+        //! Returns the number of triangles.
+        std::size_t NumTriangles() const
+        {
+            return numTriangles_;
+        }
+
+        //! Returns the vertex indices of the specified triangle.
+        const Triangle& Indices(TriangleIndex triangleIndex) const
+        {
+            return triangles_[triangleIndex];
+        }
+
+        //! Returns the vertex positions of the specified triangle.
+        Triangle3T<T> GetTriangle(TriangleIndex triangleIndex) const
+        {
+            const auto& tri = triangles_[triangleIndex];
+            return Triangle3T<T>(positions_[tri.a], positions_[tri.b], positions_[tri.c]);
+        }
+
+        //! Computes the axis-aligned bounding-box of all vertices.
+        AABB3T<T> BoundingBox() const
+        {
+            return positions_.BoundingBox();
+        }
+
+        //! Computes the axis-aligned bounding-box of all vertices with the specified transformation matrix.
+        AABB3T<T> BoundingBox(const Gs::AffineMatrix4T<T>& matrix) const
+        {
+            return positions_.BoundingBox(matrix);
+        }
+
+    private:
+
+        PositionViewT<T>    positions_;
+        const Triangle*     triangles_      = nullptr;
+        std::size_t         numTriangles_   = 0;
+
+};
+
+
+using PositionView  = PositionViewT<Gs::Real>;
+using MeshView      = MeshViewT<Gs::Real, TriangleMesh::VertexIndex>;
+
+
+//! Returns a view of the positions and triangles of the specified mesh.
+inline MeshView MakeMeshView(const TriangleMesh& mesh)
+{
+    return MeshView(
+        PositionView(
+            (mesh.vertices.empty() ? nullptr : &(mesh.vertices.front().position.x)),
+            mesh.vertices.size(),
+            sizeof(TriangleMesh::Vertex)
+        ),
+        mesh.triangles.data(),
+        mesh.triangles.size()
+    );
+}
+
+//! Returns a view of the positions and triangles of the specified templated mesh.
+template <typename VertexT, typename IndexT>
+MeshViewT<typename TriangleMeshT<VertexT, IndexT>::ScalarType, IndexT> MakeMeshView(const TriangleMeshT<VertexT, IndexT>& mesh)
+{
+    using Traits    = typename TriangleMeshT<VertexT, IndexT>::Traits;
+    using T         = typename TriangleMeshT<VertexT, IndexT>::ScalarType;
+
+    return MeshViewT<T, IndexT>(
+        PositionViewT<T>(
+            (mesh.vertices.empty() ? nullptr : &(Traits::Position(mesh.vertices.front()).x)),
+            mesh.vertices.size(),
+            sizeof(VertexT)
+        ),
+        mesh.triangles.data(),
+        mesh.triangles.size()
+    );
+}
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
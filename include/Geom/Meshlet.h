@@ -0,0 +1,118 @@
+/*
+ * Meshlet.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_MESHLET_H
+#define GM_MESHLET_H
+
+
+#include <Geom/TriangleMesh.h>
+#include <Geom/AABB.h>
+#include <Geom/Sphere.h>
+#include <Geom/Frustum.h>
+
+#include <vector>
+#include <cstdint>
+
+
+namespace Gm
+{
+
+
+//! Meshlet build descriptor structure.
+struct MeshletDescriptor
+{
+    //! Maximal number of vertices per meshlet. This must be in the range [3, 256]. By default 64.
+    std::size_t maxVertices     = 64;
+
+    //! Maximal number of triangles per meshlet. This must be greater than zero. By default 124.
+    std::size_t maxTriangles    = 124;
+};
+
+/**
+\brief Normal cone of a meshlet for backface culling.
+\remarks The entire meshlet is back facing for a view position V if: Dot(Normalize(apex - V), axis) >= cutoff.
+\see IsMeshletBackFacing
+*/
+struct MeshletCone
+{
+    Gs::Vector3 apex;                   //!< Apex of the cone.
+    Gs::Vector3 axis;                   //!< Normalized axis of the cone.
+    Gs::Real    cutoff  = Gs::Real(2);  //!< Sine of the cone angle. A value greater than 1 means the meshlet can not be culled.
+};
+
+//! Meshlet (i.e. small cluster of triangles) with its bounding volumes.
+struct Meshlet
+{
+    std::uint32_t   vertexOffset    = 0;    //!< Offset into the list of global vertex indices (see MeshletList::vertexIndices).
+    std::uint32_t   vertexCount     = 0;    //!< Number of vertices of this meshlet.
+    std::uint32_t   triangleOffset  = 0;    //!< Offset (in triangles) into the list of local indices (see MeshletList::localIndices).
+    std::uint32_t   triangleCount   = 0;    //!< Number of triangles of this meshlet.
+
+    AABB3           boundingBox;            //!< Bounding box of all meshlet vertices.
+    Sphere          boundingSphere;         //!< Bounding sphere of all meshlet vertices.
+    MeshletCone     cone;                   //!< Normal cone of all meshlet triangles.
+};
+
+//! List of meshlets with their shared vertex and index buffers.
+struct MeshletList
+{
+    std::vector<Meshlet>                    meshlets;       //!< List of all meshlets.
+    std::vector<TriangleMesh::VertexIndex>  vertexIndices;  //!< Global vertex indices of all meshlets.
+    std::vector<std::uint8_t>               localIndices;   //!< Local vertex indices (3 per triangle) of all meshlets.
+};
+
+
+/**
+\brief Partitions the triangles of the specified mesh into meshlets.
+\param[in] mesh Specifies the input mesh.
+\param[out] meshletList Specifies the output meshlet list. Previous content is cleared.
+\param[in] meshletDesc Specifies the meshlet descriptor.
+\throws std::invalid_argument If the limits of the meshlet descriptor are out of range.
+\remarks The triangles are sorted along a Morton curve and split into chunks, which are processed in parallel.
+Within each chunk, the meshlets are grown greedily by adjacent triangles that add the fewest new vertices
+and are closest to the meshlet center, so that the meshlets are spatially compact.
+*/
+void BuildMeshlets(const TriangleMesh& mesh, MeshletList& meshletList, const MeshletDescriptor& meshletDesc = {});
+
+//! Returns true if the specified meshlet is back facing for the specified view position.
+bool IsMeshletBackFacing(const Meshlet& meshlet, const Gs::Vector3& viewPosition);
+
+/**
+\brief Culls all meshlets against the specified frustum.
+\param[in] meshletList Specifies the meshlets that are to be culled.
+\param[in] frustum Specifies the view frustum (in the same coordinate space as the meshlets).
+\param[out] visibleMeshlets Specifies the output list of indices of all visible meshlets. Previous content is cleared.
+\return Number of visible meshlets.
+\remarks The bounding spheres of the meshlets are tested against the frustum planes.
+*/
+std::size_t CullMeshlets(
+    const MeshletList&          meshletList,
+    const Frustum&              frustum,
+    std::vector<std::uint32_t>& visibleMeshlets
+);
+
+/**
+\brief Culls all meshlets against the specified frustum and rejects all meshlets that are back facing.
+\see CullMeshlets(const MeshletList&, const Frustum&, std::vector<std::uint32_t>&)
+\see IsMeshletBackFacing
+*/
+std::size_t CullMeshlets(
+    const MeshletList&          meshletList,
+    const Frustum&              frustum,
+    const Gs::Vector3&          viewPosition,
+    std::vector<std::uint32_t>& visibleMeshlets
+);
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
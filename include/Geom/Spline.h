@@ -10,11 +10,15 @@
 
 
 #include <Geom/Macros.h>
+#include <Geom/ArcLengthTable.h>
 
 #include <Gauss/Real.h>
 #include <Gauss/Vector2.h>
 #include <Gauss/Vector3.h>
 
+#include <vector>
+#include <cstddef>
+
 
 namespace Gm
 {
@@ -22,10 +26,12 @@ namespace Gm
 
 
 /**
-\brief Spline base class.
+\brief B-spline class.
 \tparam P Specifies the type of the spline control points.
 \tparam T Specifies the base data type. This should be float or double.
-\todo !!!OPTIMIZE THIS!!!
+\remarks The spline has the degree 'GetOrder()'. Its knot vector is formed by the control point intervals,
+where the first interval is repeated 'GetOrder() + 1' times and the last interval twice.
+The spline is evaluated with de Boor's algorithm in O(order^2) after a binary search for the knot span.
 */
 template <typename P, typename T>
 class Spline
@@ -58,18 +64,86 @@ class Spline
             return points_[idx];
         }
 
+        //! Evaluates the spline at the specified position. Outside of the knot vector, the result is zero.
         P Evaluate(const T& t) const
         {
-            P result = P(0);
+            int span = -1;
+            return EvaluateInSpan(t, span);
+        }
 
-            if (!points_.empty())
-            {
-                int j = -order_;
-                for (std::size_t i = 0; i < points_.size(); ++i, ++j)
-                    result += points_[i].point * BernsteinPolynomial(order_, j, t);
-            }
+        /**
+        \brief Evaluates the spline at many positions at once.
+        \param[in] t Pointer to the array of positions.
+        \param[out] points Pointer to the array of output points. This must have at least 'count' elements.
+        \param[in] count Specifies the number of positions.
+        \remarks The knot span of the previous position is tried first, so ascending positions (e.g. path sampling) skip most of the span searches.
+        */
+        void Evaluate(const T* t, P* points, std::size_t count) const
+        {
+            int span = -1;
+            for (std::size_t i = 0; i < count; ++i)
+                points[i] = EvaluateInSpan(t[i], span);
+        }
+
+        //! Evaluates the first derivative of the spline at the specified position.
+        P EvaluateDerivative(const T& t) const
+        {
+            int span = -1;
+            return EvaluateDerivativeInSpan(t, span);
+        }
 
-            return result;
+        /**
+        \brief Evaluates the first derivative of the spline at many positions at once.
+        \see Evaluate(const T*, P*, std::size_t) const
+        */
+        void EvaluateDerivative(const T* t, P* derivatives, std::size_t count) const
+        {
+            int span = -1;
+            for (std::size_t i = 0; i < count; ++i)
+                derivatives[i] = EvaluateDerivativeInSpan(t[i], span);
+        }
+
+        /**
+        \brief Builds the arc-length table of this spline over the range of the control point intervals.
+        \param[out] table Specifies the output table. This must be rebuilt whenever the spline changes.
+        \param[in] subdivisions Specifies the number of table samples between two control point intervals. By default 16.
+        \see EvaluateAtDistance
+        */
+        void BuildArcLengthTable(ArcLengthTable<T>& table, std::uint32_t subdivisions = 16) const
+        {
+            std::vector<T> breakpoints;
+            breakpoints.reserve(points_.size());
+
+            for (const auto& cp : points_)
+                breakpoints.push_back(cp.interval);
+
+            table.Build(
+                breakpoints,
+                subdivisions,
+                [this](const T& t)
+                {
+                    return EvaluateDerivative(t).Length();
+                }
+            );
+        }
+
+        //! Evaluates the spline at the specified arc length, so equal distance steps move with constant speed along the spline.
+        P EvaluateAtDistance(const ArcLengthTable<T>& table, const T& distance) const
+        {
+            return Evaluate(table.GetParameter(distance));
+        }
+
+        /**
+        \brief Evaluates the spline at many arc lengths at once, e.g. for many objects on the same path.
+        \remarks The sample interval of the table and the knot span of the previous arc length are tried first.
+        \see ArcLengthTable::GetParameters
+        */
+        void EvaluateAtDistance(const ArcLengthTable<T>& table, const T* distances, P* points, std::size_t count) const
+        {
+            std::size_t cursor = 0;
+            int span = -1;
+            for (std::size_t i = 0; i < count; ++i)
+                points[i] = EvaluateInSpan(table.GetParameter(distances[i], cursor), span);
         }
 
         int GetOrder() const
@@ -90,6 +164,7 @@ class Spline
         \brief Adds a new control point.
         \param[in] point Specifies the point position.
         \param[in] t Specifies the interpolation factor (or interval value).
+        This must not be less than the interval of the previous control point.
         */
         void AddPoint(const P& point, const T& t)
         {
@@ -116,9 +191,12 @@ class Spline
             return static_cast<std::size_t>(i);
         }
 
-        P Point(int i) const
+        // Returns the control point with the specified index, or zero if the index is out of range.
+        P PointOrZero(int i) const
         {
-            return points_[Idx(i)].point;
+            if (i < 0 || static_cast<std::size_t>(i) >= points_.size())
+                return P(0);
+            return points_[static_cast<std::size_t>(i)].point;
         }
 
         T Interval(int i) const
@@ -126,30 +204,151 @@ class Spline
             return points_[Idx(i)].interval;
         }
 
-        T BernsteinPolynomial(int q, int i, const T& t) const
+        // Returns the knot with the specified index.
+        T Knot(int i) const
+        {
+            return Interval(i - order_);
+        }
+
+        // Returns the number of knots minus one, i.e. the index of the last knot.
+        int LastKnot() const
+        {
+            return static_cast<int>(points_.size()) + order_;
+        }
+
+        // Returns the index 'k' of the knot span [Knot(k), Knot(k + 1)) that contains 't', or -1 if there is none. Tries the specified span first.
+        int FindSpan(const T& t, int span) const
+        {
+            const auto last = LastKnot();
+
+            if (points_.empty() || t < Knot(0) || !(t < Knot(last)))
+                return -1;
+
+            /* Try the previous and next span first */
+            if (span >= 0 && span < last)
+            {
+                if (Knot(span) <= t)
+                {
+                    if (t < Knot(span + 1))
+                        return span;
+                    if (span + 1 < last && t < Knot(span + 2))
+                        return span + 1;
+                }
+            }
+
+            /* Binary search for the last knot less than or equal to 't' */
+            int lo = 0, hi = last;
+
+            while (hi - lo > 1)
+            {
+                auto mid = (lo + hi) / 2;
+                if (t < Knot(mid))
+                    hi = mid;
+                else
+                    lo = mid;
+            }
+
+            return lo;
+        }
+
+        // Evaluates the local points 'd[0..degree]' (belonging to the indices 'span - degree' to 'span') with de Boor's algorithm.
+        P DeBoor(int span, const T& t, int degree, P* d) const
         {
-            auto xi = Interval(i);
-            auto xi1 = Interval(i + 1);
+            for (int r = 1; r <= degree; ++r)
+            {
+                for (int j = degree; j >= r; --j)
+                {
+                    auto i = j + span - degree;
+                    auto ki = Knot(i);
+                    auto dx = Knot(i + degree + 1 - r) - ki;
+                    auto alpha = (dx > T(0) ? (t - ki) / dx : T(0));
+                    d[j] = d[j - 1] * (T(1) - alpha) + d[j] * alpha;
+                }
+            }
+            return d[degree];
+        }
 
-            if (q == 0)
-                return (xi <= t && t < xi1) ? T(1) : T(0);
+        P EvaluateInSpan(const T& t, int& span) const
+        {
+            span = FindSpan(t, span);
+            if (span < 0)
+                return P(0);
 
-            auto xiq = Interval(i + q);
-            auto xiq1 = Interval(i + q + 1);
+            LocalPoints d(order_ + 1);
 
-            auto dx1 = xiq - xi;
-            auto dx2 = xiq1 - xi1;
+            for (int j = 0; j <= order_; ++j)
+                d[j] = PointOrZero(j + span - order_);
+
+            return DeBoor(span, t, order_, d.Data());
+        }
+
+        P EvaluateDerivativeInSpan(const T& t, int& span) const
+        {
+            span = FindSpan(t, span);
 
-            T r1 = T(0), r2 = T(0);
+            /* Order 0 (only after 'SetOrder' on an empty spline) is piecewise constant */
+            if (span < 0 || order_ < 1)
+                return P(0);
 
-            if (dx1 > T(0))
-                r1 = (t - xi)/dx1 * BernsteinPolynomial(q - 1, i, t);
-            if (dx2 > T(0))
-                r2 = (xiq1 - t)/dx2 * BernsteinPolynomial(q - 1, i + 1, t);
+            /* Derivative is a spline of one degree less, with the differences of the control points */
+            const auto degree = order_ - 1;
 
-            return r1 + r2;
+            LocalPoints d(order_);
+
+            for (int j = 0; j <= degree; ++j)
+            {
+                auto i = j + span - order_;
+                auto dx = Knot(i + order_ + 1) - Knot(i + 1);
+                if (dx > T(0))
+                    d[j] = (PointOrZero(i + 1) - PointOrZero(i)) * (static_cast<T>(order_) / dx);
+                else
+                    d[j] = P(0);
+            }
+
+            return DeBoor(span, t, degree, d.Data());
         }
 
+        // Local point buffer for de Boor's algorithm, which only allocates memory for large orders. This is not copyable, because 'data_' may point into 'local_'.
+        class LocalPoints
+        {
+
+            public:
+
+                LocalPoints(int size)
+                {
+                    if (size > maxLocalPoints)
+                    {
+                        heap_.resize(static_cast<std::size_t>(size));
+                        data_ = heap_.data();
+                    }
+                }
+
+                LocalPoints(const LocalPoints&) = delete;
+                LocalPoints(LocalPoints&&) = delete;
+
+                LocalPoints& operator = (const LocalPoints&) = delete;
+                LocalPoints& operator = (LocalPoints&&) = delete;
+
+                P& operator [] (int idx)
+                {
+                    return data_[idx];
+                }
+
+                P* Data()
+                {
+                    return data_;
+                }
+
+            private:
+
+                static const int    maxLocalPoints = 8;
+
+                P                   local_[maxLocalPoints];
+                std::vector<P>      heap_;
+                P*                  data_ = local_;
+
+        };
+
         //! B-Spline control points
         std::vector<ControlPoint> points_;
 
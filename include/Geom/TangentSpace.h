@@ -32,6 +32,7 @@ t = tangent, b = bitangent, n = normal
 M := | t b n |
      \ t b n /
 \endcode
+\see MeshModifier::GenerateTangents
 */
 template <typename T>
 void ComputeTangentSpace(
@@ -0,0 +1,257 @@
+/*
+ * ThreadPool.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_THREAD_POOL_H
+#define GM_THREAD_POOL_H
+
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace Gm
+{
+
+
+class TaskGroup;
+
+/**
+\brief Persistent pool of worker threads with work stealing.
+\remarks Each worker has its own task queue. Workers take their own tasks in LIFO order and steal tasks
+from other queues in FIFO order when they run out of work. Threads that wait for a task group help executing
+pending tasks, so parallel algorithms can be nested. The calling thread always participates in the parallel algorithms,
+so a pool with N workers runs up to N + 1 tasks concurrently.
+\see TaskGroup
+\see SetGlobalThreadPool
+*/
+class ThreadPool
+{
+
+    public:
+
+        //! Creates a thread pool with one worker less than the number of hardware threads.
+        ThreadPool();
+
+        /**
+        \brief Creates a thread pool with the specified number of worker threads.
+        \param[in] numWorkers Specifies the number of worker threads. If this is zero, all tasks run on the calling threads.
+        */
+        explicit ThreadPool(std::size_t numWorkers);
+
+        //! Waits until all workers have finished their pending tasks and joins them.
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator = (const ThreadPool&) = delete;
+
+        //! Returns the number of worker threads.
+        std::size_t NumWorkers() const
+        {
+            return workers_.size();
+        }
+
+        //! Returns the maximal number of tasks that run concurrently, i.e. the number of workers plus the calling thread.
+        std::size_t Concurrency() const
+        {
+            return (workers_.size() + 1);
+        }
+
+        /**
+        \brief Calls the specified function for chunks of the range [0, count) in parallel.
+        \param[in] count Specifies the number of elements.
+        \param[in] grainSize Specifies the minimal number of elements per chunk.
+        \param[in] func Specifies the chunk function with the signature 'void(std::size_t begin, std::size_t end)'.
+        \remarks The range is split into more chunks than threads, so idle threads can steal the remaining chunks.
+        This function returns after all chunks have been processed. Exceptions thrown by the function are rethrown to the caller.
+        */
+        template <typename Func>
+        void ParallelFor(std::size_t count, std::size_t grainSize, const Func& func);
+
+        /**
+        \brief Reduces chunks of the range [0, count) in parallel.
+        \param[in] count Specifies the number of elements.
+        \param[in] grainSize Specifies the minimal number of elements per chunk.
+        \param[in] identity Specifies the identity value of the reduction, which is returned for an empty range.
+        \param[in] func Specifies the chunk function with the signature 'T(std::size_t begin, std::size_t end)'.
+        \param[in] reduce Specifies the reduction function with the signature 'T(const T& lhs, const T& rhs)'.
+        \remarks The chunk results are reduced in the order of their ranges, so the result is deterministic for a given concurrency.
+        */
+        template <typename T, typename Func, typename Reduce>
+        T ParallelReduce(std::size_t count, std::size_t grainSize, const T& identity, const Func& func, const Reduce& reduce);
+
+        /**
+        \brief Returns the number of chunks 'ParallelFor' and 'ParallelReduce' split the range [0, count) into.
+        \see ParallelFor
+        */
+        std::size_t GetChunkCount(std::size_t count, std::size_t grainSize) const;
+
+    private:
+
+        friend class TaskGroup;
+
+        using Task = std::function<void()>;
+
+        struct WorkQueue
+        {
+            std::mutex          mutex;
+            std::deque<Task>    tasks;
+        };
+
+        void StartWorkers(std::size_t numWorkers);
+        void WorkerThread(std::size_t workerIndex);
+
+        // Pushes the specified task into the queue of the current worker, or into any queue from other threads.
+        void Submit(Task task);
+
+        // Runs one pending task and returns true, or returns false if there are no pending tasks.
+        bool RunPendingTask();
+
+        std::vector<std::unique_ptr<WorkQueue>> queues_;
+        std::vector<std::thread>                workers_;
+
+        std::mutex                              sleepMutex_;
+        std::condition_variable                 wakeCondition_;
+        std::atomic<std::size_t>                numPendingTasks_;
+        std::atomic<std::size_t>                nextQueue_;
+        bool                                    stop_               = false;
+
+};
+
+/**
+\brief Group of tasks that run on a thread pool and can be waited for.
+\remarks The destructor waits for all tasks of this group, but does not rethrow their exceptions.
+*/
+class TaskGroup
+{
+
+    public:
+
+        explicit TaskGroup(ThreadPool& pool);
+        ~TaskGroup();
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator = (const TaskGroup&) = delete;
+
+        //! Schedules the specified task on the thread pool.
+        void Run(std::function<void()> task);
+
+        /**
+        \brief Waits until all tasks of this group have finished. The calling thread helps executing pending tasks meanwhile.
+        \throws Rethrows the first exception that has been thrown by any task of this group.
+        */
+        void Wait();
+
+    private:
+
+        void WaitForTasks();
+
+        ThreadPool&                 pool_;
+        std::atomic<std::size_t>    numTasks_;
+
+        std::mutex                  mutex_;
+        std::condition_variable     doneCondition_;
+        std::exception_ptr          exception_;
+
+};
+
+
+/**
+\brief Sets the thread pool that is used by all parallel algorithms of this library.
+\param[in] pool Specifies the new global thread pool. If this is null, a default thread pool is created on demand.
+\remarks Use this to control the lifetime and the number of worker threads of the library.
+A pool with zero workers makes all algorithms run on the calling thread.
+\note Only the algorithms that are compiled with 'GM_ENABLE_MULTI_THREADING' run in parallel.
+*/
+void SetGlobalThreadPool(const std::shared_ptr<ThreadPool>& pool);
+
+/**
+\brief Returns the thread pool that is used by all parallel algorithms of this library.
+\remarks If no thread pool has been set, a default thread pool is created with the default constructor.
+\see SetGlobalThreadPool
+*/
+std::shared_ptr<ThreadPool> GetGlobalThreadPool();
+
+
+/* ----- Template functions ----- */
+
+template <typename Func>
+void ThreadPool::ParallelFor(std::size_t count, std::size_t grainSize, const Func& func)
+{
+    const auto numChunks = GetChunkCount(count, grainSize);
+
+    if (numChunks <= 1)
+    {
+        if (count > 0)
+            func(std::size_t(0), count);
+        return;
+    }
+
+    const auto chunkSize = count / numChunks;
+
+    /* Schedule all chunks but the first one and run the first chunk on the calling thread */
+    TaskGroup group(*this);
+
+    for (std::size_t i = numChunks - 1; i > 0; --i)
+    {
+        const auto begin    = i*chunkSize;
+        const auto end      = (i + 1 == numChunks ? count : begin + chunkSize);
+        group.Run([&func, begin, end]() { func(begin, end); });
+    }
+
+    func(std::size_t(0), chunkSize);
+
+    group.Wait();
+}
+
+template <typename T, typename Func, typename Reduce>
+T ThreadPool::ParallelReduce(std::size_t count, std::size_t grainSize, const T& identity, const Func& func, const Reduce& reduce)
+{
+    const auto numChunks = GetChunkCount(count, grainSize);
+
+    if (numChunks <= 1)
+        return (count > 0 ? reduce(identity, func(std::size_t(0), count)) : identity);
+
+    const auto chunkSize = count / numChunks;
+
+    /* Compute partial results of all chunks */
+    std::vector<T> partialResults(numChunks, identity);
+
+    ParallelFor(
+        numChunks, 1,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+                partialResults[i] = func(i*chunkSize, (i + 1 == numChunks ? count : (i + 1)*chunkSize));
+        }
+    );
+
+    /* Reduce partial results in order */
+    auto result = identity;
+
+    for (const auto& partial : partialResults)
+        result = reduce(result, partial);
+
+    return result;
+}
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
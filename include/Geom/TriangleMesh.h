@@ -19,6 +19,7 @@
 #include <Gauss/AffineMatrix4.h>
 #include <Gauss/Epsilon.h>
 #include <algorithm>
+#include <memory>
 #include <set>
 #include <cstdint>
 
@@ -27,6 +28,8 @@ namespace Gm
 {
 
 
+class MeshAdjacency;
+
 /**
 \brief Triangle mesh base class.
 \remarks This class is used for generation and modification of all triangle meshes.
@@ -79,13 +82,40 @@ class TriangleMesh
         //! Returns the vertex, interpolated from the triangle with the specified barycentric coordinates.
         Vertex Barycentric(TriangleIndex triangleIndex, const Gs::Vector3& barycentricCoords) const;
 
-        //! Computes the set of all triangle edges.
+        /**
+        \brief Interpolates many vertices at once, each from a triangle with the respective barycentric coordinates.
+        \param[in] triangleIndices Pointer to the array of triangle indices.
+        \param[in] barycentricCoords Pointer to the array of barycentric coordinates.
+        \param[in] count Specifies the number of vertices to interpolate.
+        \param[out] outputVertices Pointer to the array of output vertices. This must have at least 'count' elements.
+        \remarks Large batches are interpolated in parallel.
+        */
+        void Barycentric(const TriangleIndex* triangleIndices, const Gs::Vector3* barycentricCoords, std::size_t count, Vertex* outputVertices) const;
+
+        /**
+        \brief Computes the set of all triangle edges.
+        \return List of unique edges, sorted by their smaller vertex index first and their larger vertex index second.
+        The first vertex index of each edge is always less than or equal to the second vertex index.
+        \remarks The edges are sorted with a parallel radix sort.
+        */
         std::vector<Edge> Edges() const;
 
+        /**
+        \brief Computes the set of all triangle edges and the number of triangles that are connected to each edge.
+        \param[out] edgeTriangleCounts Specifies the output list of triangle counts. It will have the same size as the returned edge list.
+        A count of 1 denotes a boundary edge, a count of 2 denotes a manifold edge, and a count greater than 2 denotes a non-manifold edge.
+        \see Edges()
+        */
+        std::vector<Edge> Edges(std::vector<std::uint32_t>& edgeTriangleCounts) const;
+
         /**
         \brief Computes the set of all triangle edges which are part of the silhouette.
         \param[in] toleranceAngle Specifies the tolerance angle (in radians) to reject edges. Must be in the range [0, pi].
+        \remarks This uses the cached adjacency if available, otherwise a temporary adjacency is built.
+        This is a view independent crease edge search. For light or viewer dependent silhouettes use 'MeshSilhouette'.
         \see Edges
+        \see BuildAdjacency
+        \see MeshSilhouette
         */
         std::vector<Edge> SilhouetteEdges(Gs::Real toleranceAngle = Gs::Real(0)) const;
 
@@ -98,6 +128,8 @@ class TriangleMesh
         \param[in] searchViaPosition Specifies whether to search triangles via the position of
         their vertices (true), or only search via the index of their vertices (false). By default false.
         \return Set of triangle indices of the neighbor search result including the input triangle indices.
+        \remarks This uses the cached adjacency if available, otherwise a temporary adjacency is built.
+        \see BuildAdjacency
         */
         std::set<TriangleIndex> TriangleNeighbors(
             std::set<TriangleIndex> triangleIndices,
@@ -106,16 +138,45 @@ class TriangleMesh
             bool                    searchViaPosition = false
         ) const;
 
-        //! Computes the list of all triangles that are connected to the specified vertex.
+        /**
+        \brief Computes the list of all triangles that are connected to the specified vertex.
+        \remarks This runs in O(degree) if the adjacency has been cached, otherwise all triangles are scanned.
+        \see BuildAdjacency
+        */
         std::vector<TriangleIndex> FindTriangles(VertexIndex vertexIndex) const;
 
-        //! Computes the list of all triangles that are connected to the specified edge.
+        /**
+        \brief Computes the list of all triangles that are connected to the specified edge.
+        \remarks This runs in O(degree) if the adjacency has been cached, otherwise all triangles are scanned.
+        \see BuildAdjacency
+        */
         std::vector<TriangleIndex> FindTriangles(const Edge& edge) const;
 
+        /**
+        \brief Builds the vertex/triangle adjacency of this mesh and caches it.
+        \param[in] weldByPosition Specifies whether to also build the adjacency of vertices with equal positions. By default false.
+        \remarks The cache is released by all modifying member functions (i.e. Clear, AddVertex, AddTriangle, and Append).
+        If the 'vertices' or 'triangles' containers are modified directly, 'ClearAdjacency' must be called afterwards.
+        \see MeshAdjacency
+        */
+        const MeshAdjacency& BuildAdjacency(bool weldByPosition = false);
+
+        //! Releases the cached vertex/triangle adjacency.
+        void ClearAdjacency();
+
+        //! Returns the cached vertex/triangle adjacency or null if there is none.
+        const MeshAdjacency* GetAdjacency() const
+        {
+            return adjacency_.get();
+        }
+
         //! Computes the list of all triangles with their own vertices, but without indices.
         std::vector<Gm::Triangle<Vertex>> TriangleList() const;
 
-        //! Returns the normal vector of the specified triangle (in unit length of 1.0).
+        /**
+        \brief Returns the normal vector of the specified triangle (in unit length of 1.0).
+        \see MeshModifier::ComputeTriangleNormals
+        */
         Gs::Vector3 TriangleNormal(TriangleIndex triangleIndex) const;
 
         //! Computes the axis-aligned bounding-box of this mesh.
@@ -128,8 +189,12 @@ class TriangleMesh
 
         /**
         \brief Computes the axis-aligned bounding-box of this mesh with the specified number of threads.
-        \param[in] threadCount Specifies the number of threads. This will be clamped to the range [1, vertices.size()].
+        \param[in] threadCount Specifies the number of threads. This is the maximal number of chunks the vertices are split into.
         \remarks This may only increase performance with very large triangle meshes, i.e. over 1 Mio. vertices and more.
+        The chunks are processed on the global thread pool, so no threads are created per call.
+        If the vertices cannot be split into 'threadCount' chunks of at least 64 vertices each, the bounding-box is computed on the calling thread.
+        The number of chunks is also limited by the concurrency of the global thread pool (see 'ThreadPool::GetChunkCount').
+        \see GetGlobalThreadPool
         */
         AABB3 BoundingBoxMultiThreaded(std::size_t threadCount) const;
 
@@ -141,6 +206,16 @@ class TriangleMesh
         std::vector<Vertex>     vertices;   //!< Vertex array list.
         std::vector<Triangle>   triangles;  //!< Triangle array list. Make sure that all triangle indices are less than the number of vertices of this mesh!
 
+    private:
+
+        // Returns the cached adjacency if it is valid for this mesh, otherwise the temporary adjacency is built and returned.
+        const MeshAdjacency& CachedOrTemporaryAdjacency(MeshAdjacency& temporary, bool weldByPosition) const;
+
+        // Returns the cached adjacency if it is valid for this mesh, otherwise null.
+        const MeshAdjacency* ValidAdjacency() const;
+
+        std::shared_ptr<const MeshAdjacency> adjacency_;
+
 };
 
 
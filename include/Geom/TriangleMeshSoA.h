@@ -0,0 +1,136 @@
+/*
+ * TriangleMeshSoA.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_TRIANGLE_MESH_SOA_H
+#define GM_TRIANGLE_MESH_SOA_H
+
+
+#include <Geom/TriangleMesh.h>
+#include <Geom/MeshView.h>
+#include <Geom/AlignedAllocator.h>
+
+#include <Gauss/Vector2.h>
+#include <Gauss/Vector3.h>
+#include <Gauss/AffineMatrix4.h>
+#include <vector>
+
+
+namespace Gm
+{
+
+
+/**
+\brief Triangle mesh with a structure-of-arrays (SoA) vertex layout.
+\remarks The X, Y, and Z coordinates of all positions are stored in separate aligned streams, and the normals and texture coordinates
+are stored in their own streams. Position-only passes (bounding boxes, culling, ray casts, and clipping classification) therefore
+only touch the position streams. Use 'MakeMeshView' to run the position-only algorithms on either layout.
+\see TriangleMesh
+\see MeshView
+*/
+class TriangleMeshSoA
+{
+
+    public:
+
+        using Vertex        = TriangleMesh::Vertex;
+        using VertexIndex   = TriangleMesh::VertexIndex;
+        using Triangle      = TriangleMesh::Triangle;
+        using TriangleIndex = TriangleMesh::TriangleIndex;
+
+        TriangleMeshSoA() = default;
+
+        //! Initializes this mesh with the vertices and triangles of the specified interleaved mesh.
+        explicit TriangleMeshSoA(const TriangleMesh& mesh);
+
+        //! Clears all vertices and triangles.
+        void Clear();
+
+        //! Reserves memory for the specified number of vertices and triangles.
+        void Reserve(std::size_t numVertices, std::size_t numTriangles);
+
+        //! Resizes all vertex streams to the specified number of vertices.
+        void ResizeVertices(std::size_t numVertices);
+
+        /**
+        \brief Replaces the vertices and triangles of this mesh by those of the specified interleaved mesh.
+        \remarks Large meshes are converted in parallel.
+        */
+        void Assign(const TriangleMesh& mesh);
+
+        //! Writes the vertices and triangles of this mesh into the specified interleaved mesh. Previous content of the output mesh is replaced.
+        void ToTriangleMesh(TriangleMesh& mesh) const;
+
+        //! Returns a new interleaved mesh with the vertices and triangles of this mesh.
+        TriangleMesh ToTriangleMesh() const;
+
+        //! Adds a new vertex with the specified attributes and returns the index of the new vertex.
+        VertexIndex AddVertex(const Gs::Vector3& position, const Gs::Vector3& normal, const Gs::Vector2& texCoord);
+
+        //! Adds the specified vertex and returns the index of the new vertex.
+        VertexIndex AddVertex(const Vertex& vertex);
+
+        //! Adds a new triangle with the specified three indices and returns the index of the new triangle.
+        TriangleIndex AddTriangle(VertexIndex v0, VertexIndex v1, VertexIndex v2);
+
+        //! Returns the position of the specified vertex.
+        Gs::Vector3 Position(VertexIndex vertexIndex) const;
+
+        //! Sets the position of the specified vertex.
+        void SetPosition(VertexIndex vertexIndex, const Gs::Vector3& position);
+
+        //! Returns all attributes of the specified vertex.
+        Vertex GetVertex(VertexIndex vertexIndex) const;
+
+        //! Returns the vertex, interpolated from the triangle with the specified barycentric coordinates.
+        Vertex Barycentric(TriangleIndex triangleIndex, const Gs::Vector3& barycentricCoords) const;
+
+        //! Computes the axis-aligned bounding-box of this mesh.
+        AABB3 BoundingBox() const;
+
+        //! Computes the axis-aligned bounding-box of this mesh with the specified transformation matrix.
+        AABB3 BoundingBox(const Gs::AffineMatrix4& matrix) const;
+
+        //! Appends the specified triangle mesh to this mesh. The specified mesh may also be this mesh.
+        void Append(const TriangleMeshSoA& other);
+
+        //! Returns the number of vertices.
+        std::size_t NumVertices() const
+        {
+            return positionsX.size();
+        }
+
+        //! Returns a view of the position streams.
+        PositionView Positions() const
+        {
+            return PositionView(positionsX.data(), positionsY.data(), positionsZ.data(), positionsX.size());
+        }
+
+        AlignedVector<Gs::Real>     positionsX; //!< X coordinates of all vertex positions.
+        AlignedVector<Gs::Real>     positionsY; //!< Y coordinates of all vertex positions.
+        AlignedVector<Gs::Real>     positionsZ; //!< Z coordinates of all vertex positions.
+        std::vector<Gs::Vector3>    normals;    //!< Normal vectors of all vertices.
+        std::vector<Gs::Vector2>    texCoords;  //!< Texture coordinates of all vertices.
+        std::vector<Triangle>       triangles;  //!< Triangle array list. Make sure that all triangle indices are less than the number of vertices of this mesh!
+
+};
+
+
+//! Returns a view of the positions and triangles of the specified SoA mesh.
+inline MeshView MakeMeshView(const TriangleMeshSoA& mesh)
+{
+    return MeshView(mesh.Positions(), mesh.triangles.data(), mesh.triangles.size());
+}
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,346 @@
+/*
+ * TriangleMeshT.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_TRIANGLE_MESH_T_H
+#define GM_TRIANGLE_MESH_T_H
+
+
+#include <Geom/TriangleMesh.h>
+#include <Geom/MeshGenerator.h>
+#include <Geom/BoundingBoxKernels.h>
+
+#include <Gauss/Vector2.h>
+#include <Gauss/Vector3.h>
+#include <Gauss/AffineMatrix4.h>
+#include <Gauss/TransformVector.h>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+
+namespace Gm
+{
+
+
+//! Compact vertex structure with single precision attributes (32 bytes per vertex, independent of 'Gs::Real').
+struct CompactVertex
+{
+    Gs::Vector3f position;
+    Gs::Vector3f normal;
+    Gs::Vector2f texCoord;
+};
+
+/**
+\brief Vertex traits for the 'TriangleMeshT' class template.
+\remarks The default traits can be used for all vertex types with the members 'position', 'normal', and 'texCoord',
+like 'TriangleMesh::Vertex' and 'CompactVertex'. Specialize this template for other vertex types (e.g. with colors, tangents, or skin indices).
+A specialization must provide the following members:
+\code
+// Scalar type of the position, must be float or double.
+using ScalarType = ...;
+
+// Returns a reference to the position within the specified vertex (the position must be stored as 3 consecutive scalars).
+static const Gs::Vector3T<ScalarType>& Position(const VertexT& vertex);
+
+// Returns the vertex that is interpolated from the three vertices with the specified barycentric coordinates.
+static VertexT Interpolate(const VertexT& v0, const VertexT& v1, const VertexT& v2, const Gs::Vector3T<ScalarType>& barycentricCoords);
+
+// Converts the specified base vertex into the vertex type, e.g. to convert the output of the mesh generators.
+static void Convert(VertexT& dst, const TriangleMesh::Vertex& src);
+\endcode
+\see TriangleMeshT
+*/
+template <typename VertexT>
+struct VertexTraits
+{
+    using ScalarType = typename std::decay<decltype(std::declval<VertexT>().position.x)>::type;
+
+    static const Gs::Vector3T<ScalarType>& Position(const VertexT& vertex)
+    {
+        return vertex.position;
+    }
+
+    static VertexT Interpolate(const VertexT& v0, const VertexT& v1, const VertexT& v2, const Gs::Vector3T<ScalarType>& barycentricCoords)
+    {
+        VertexT v = v0;
+
+        v.position  = v0.position * barycentricCoords.x + v1.position * barycentricCoords.y + v2.position * barycentricCoords.z;
+        v.normal    = v0.normal   * barycentricCoords.x + v1.normal   * barycentricCoords.y + v2.normal   * barycentricCoords.z;
+        v.texCoord  = v0.texCoord * barycentricCoords.x + v1.texCoord * barycentricCoords.y + v2.texCoord * barycentricCoords.z;
+
+        return v;
+    }
+
+    static void Convert(VertexT& dst, const TriangleMesh::Vertex& src)
+    {
+        dst.position    = src.position.Cast<typename std::decay<decltype(dst.position.x)>::type>();
+        dst.normal      = src.normal.Cast<typename std::decay<decltype(dst.normal.x)>::type>();
+        dst.texCoord    = src.texCoord.Cast<typename std::decay<decltype(dst.texCoord.x)>::type>();
+    }
+};
+
+
+/**
+\brief Extracts all unique edges of the specified triangles.
+\param[in] triangles Specifies the triangles whose edges are to be extracted.
+\param[in] numVertices Specifies the number of vertices the triangles refer to. This is used to pack the edges into sort keys.
+\param[out] edgeTriangleCounts Optional pointer to the output list of triangle counts per edge. By default null.
+\return List of unique edges, sorted by their smaller vertex index first and their larger vertex index second.
+\remarks This is used by 'TriangleMesh::Edges' and 'TriangleMeshT::Edges'. The index type must be an unsigned integral type.
+\see TriangleMesh::Edges(std::vector<std::uint32_t>&)
+*/
+template <typename IndexT>
+std::vector<Line<IndexT>> ExtractEdges(
+    const std::vector<Triangle<IndexT>>&    triangles,
+    std::size_t                             numVertices,
+    std::vector<std::uint32_t>*             edgeTriangleCounts = nullptr
+);
+
+namespace Details
+{
+
+// Throws std::out_of_range if the last of the specified number of vertices cannot be addressed with the specified maximal index.
+void CheckVertexIndexRange(std::size_t numVertices, std::uint64_t maxIndex);
+
+} // /namespace Details
+
+
+/**
+\brief Triangle mesh class template with user defined vertex and index types.
+\tparam VertexT Specifies the vertex type. The vertex attributes are accessed with 'VertexTraits<VertexT>'.
+\tparam IndexT Specifies the index type. This must be an unsigned integral type, e.g. std::uint16_t or std::uint32_t.
+\remarks In contrast to 'TriangleMesh', this class has no adjacency cache and its vertex layout is defined by the client programmer,
+so meshes can be stored in the same compact layout that is uploaded to the GPU. The mesh generators can write into this layout
+directly with 'AppendSpan', and existing meshes can be converted with the respective constructor or 'Assign'.
+\see TriangleMesh
+\see VertexTraits
+*/
+template <typename VertexT, typename IndexT = std::uint32_t>
+class TriangleMeshT
+{
+
+        static_assert(std::is_integral<IndexT>::value && std::is_unsigned<IndexT>::value, "TriangleMeshT index type must be an unsigned integral type");
+
+    public:
+
+        using Traits        = VertexTraits<VertexT>;
+        using Vertex        = VertexT;
+        using ScalarType    = typename Traits::ScalarType;
+
+        using VertexIndex   = IndexT;
+
+        using Edge          = Gm::Line<VertexIndex>;
+        using Triangle      = Gm::Triangle<VertexIndex>;
+
+        using TriangleIndex = typename std::vector<Triangle>::size_type;
+
+        TriangleMeshT() = default;
+
+        /**
+        \brief Initializes this mesh with the converted vertices and triangles of the specified base mesh.
+        \throws std::out_of_range If the number of vertices exceeds the range of the index type.
+        \see Assign
+        */
+        explicit TriangleMeshT(const TriangleMesh& mesh)
+        {
+            Assign(mesh);
+        }
+
+        //! Clears all vertices and triangles.
+        void Clear()
+        {
+            vertices.clear();
+            triangles.clear();
+        }
+
+        /**
+        \brief Replaces the vertices and triangles of this mesh by the converted vertices and triangles of the specified base mesh.
+        \throws std::out_of_range If the number of vertices exceeds the range of the index type. In this case, this mesh remains unchanged.
+        \remarks Each vertex is converted with 'VertexTraits<VertexT>::Convert'.
+        */
+        void Assign(const TriangleMesh& mesh)
+        {
+            CheckVertexCount(mesh.vertices.size());
+
+            vertices.resize(mesh.vertices.size());
+            for (std::size_t i = 0; i < vertices.size(); ++i)
+                Traits::Convert(vertices[i], mesh.vertices[i]);
+
+            triangles.resize(mesh.triangles.size());
+            for (std::size_t i = 0; i < triangles.size(); ++i)
+            {
+                const auto& tri = mesh.triangles[i];
+                triangles[i] = { static_cast<VertexIndex>(tri.a), static_cast<VertexIndex>(tri.b), static_cast<VertexIndex>(tri.c) };
+            }
+        }
+
+        /**
+        \brief Adds the specified vertex and returns the index of the new vertex.
+        \throws std::out_of_range If the index of the new vertex exceeds the range of the index type.
+        */
+        VertexIndex AddVertex(const VertexT& vertex)
+        {
+            CheckVertexCount(vertices.size() + 1);
+            const auto idx = static_cast<VertexIndex>(vertices.size());
+            vertices.push_back(vertex);
+            return idx;
+        }
+
+        //! Adds a new triangle with the specified three indices and returns the index of the new triangle.
+        TriangleIndex AddTriangle(VertexIndex v0, VertexIndex v1, VertexIndex v2)
+        {
+            GS_ASSERT(v0 < vertices.size() && v1 < vertices.size() && v2 < vertices.size());
+            const auto idx = triangles.size();
+            triangles.push_back({ v0, v1, v2 });
+            return idx;
+        }
+
+        /**
+        \brief Appends the specified triangle mesh to this mesh.
+        \throws std::out_of_range If the number of vertices exceeds the range of the index type. In this case, this mesh remains unchanged.
+        */
+        void Append(const TriangleMeshT& other)
+        {
+            CheckVertexCount(vertices.size() + other.vertices.size());
+
+            const auto offset = static_cast<VertexIndex>(vertices.size());
+
+            vertices.insert(vertices.end(), other.vertices.begin(), other.vertices.end());
+
+            triangles.reserve(triangles.size() + other.triangles.size());
+            for (const auto& tri : other.triangles)
+            {
+                triangles.push_back(
+                    {
+                        static_cast<VertexIndex>(tri.a + offset),
+                        static_cast<VertexIndex>(tri.b + offset),
+                        static_cast<VertexIndex>(tri.c + offset)
+                    }
+                );
+            }
+        }
+
+        /**
+        \brief Appends the specified number of vertices and triangles and returns an output span to generate them in place.
+        \param[in] counts Specifies the exact number of vertices and triangles to append, e.g. from 'MeshGenerator::CountCuboid'.
+        \throws std::out_of_range If the number of vertices exceeds the range of the index type. In this case, this mesh remains unchanged.
+        \remarks The mesh generators write each vertex with 'VertexTraits<VertexT>::Convert' and each triangle with the index type of this mesh,
+        so no intermediate 'TriangleMesh' is generated. The span is invalidated by any further modification of this mesh. Example:
+        \code
+        Gm::CompactTriangleMesh mesh;
+        Gm::MeshGenerator::GenerateCuboid(desc, mesh.AppendSpan(Gm::MeshGenerator::CountCuboid(desc)));
+        \endcode
+        */
+        MeshGenerator::MeshSpan AppendSpan(const MeshGenerator::MeshCounts& counts)
+        {
+            CheckVertexCount(vertices.size() + counts.numVertices);
+
+            const auto firstVertex      = vertices.size();
+            const auto firstTriangle    = triangles.size();
+
+            vertices.resize(firstVertex + counts.numVertices);
+            triangles.resize(firstTriangle + counts.numTriangles);
+
+            MeshGenerator::MeshSpan span;
+
+            span.maxVertices    = counts.numVertices;
+            span.indices        = triangles.data() + firstTriangle;
+            span.maxTriangles   = counts.numTriangles;
+            span.baseVertex     = firstVertex;
+            span.writeVertex    = WriteVertex;
+            span.customVertices = vertices.data() + firstVertex;
+            span.writeTriangle  = WriteTriangle;
+            span.maxIndex       = static_cast<std::uint64_t>(std::numeric_limits<IndexT>::max());
+
+            return span;
+        }
+
+        //! Returns the vertex, interpolated from the triangle with the specified barycentric coordinates.
+        VertexT Barycentric(TriangleIndex triangleIndex, const Gs::Vector3T<ScalarType>& barycentricCoords) const
+        {
+            GS_ASSERT(triangleIndex < triangles.size());
+            const auto& tri = triangles[triangleIndex];
+            return Traits::Interpolate(vertices[tri.a], vertices[tri.b], vertices[tri.c], barycentricCoords);
+        }
+
+        //! \see TriangleMesh::Edges()
+        std::vector<Edge> Edges() const
+        {
+            return ExtractEdges(triangles, vertices.size());
+        }
+
+        //! \see TriangleMesh::Edges(std::vector<std::uint32_t>&)
+        std::vector<Edge> Edges(std::vector<std::uint32_t>& edgeTriangleCounts) const
+        {
+            return ExtractEdges(triangles, vertices.size(), &edgeTriangleCounts);
+        }
+
+        //! Computes the axis-aligned bounding-box of this mesh.
+        AABB3T<ScalarType> BoundingBox() const
+        {
+            if (vertices.empty())
+                return AABB3T<ScalarType>();
+            return ComputeBoundingBox(&(Traits::Position(vertices.front()).x), vertices.size(), sizeof(VertexT));
+        }
+
+        //! Computes the axis-aligned bounding-box of this mesh with the specified transformation matrix.
+        AABB3T<ScalarType> BoundingBox(const Gs::AffineMatrix4T<ScalarType>& matrix) const
+        {
+            #ifndef GS_ROW_VECTORS
+
+            if (vertices.empty())
+                return AABB3T<ScalarType>();
+            return ComputeBoundingBox(&(Traits::Position(vertices.front()).x), vertices.size(), sizeof(VertexT), matrix);
+
+            #else
+
+            AABB3T<ScalarType> box;
+
+            for (const auto& vert : vertices)
+                box.Insert(Gs::TransformVector(matrix, Traits::Position(vert)));
+
+            return box;
+
+            #endif
+        }
+
+        std::vector<VertexT>    vertices;   //!< Vertex array list.
+        std::vector<Triangle>   triangles;  //!< Triangle array list. Make sure that all triangle indices are less than the number of vertices of this mesh!
+
+    private:
+
+        static void CheckVertexCount(std::size_t numVertices)
+        {
+            Details::CheckVertexIndexRange(numVertices, static_cast<std::uint64_t>(std::numeric_limits<IndexT>::max()));
+        }
+
+        static void WriteVertex(void* dst, std::size_t index, const Gs::Vector3& position, const Gs::Vector3& normal, const Gs::Vector2& texCoord)
+        {
+            Traits::Convert(static_cast<VertexT*>(dst)[index], TriangleMesh::Vertex(position, normal, texCoord));
+        }
+
+        static void WriteTriangle(void* dst, std::size_t index, TriangleMesh::VertexIndex v0, TriangleMesh::VertexIndex v1, TriangleMesh::VertexIndex v2)
+        {
+            static_cast<Triangle*>(dst)[index] = { static_cast<VertexIndex>(v0), static_cast<VertexIndex>(v1), static_cast<VertexIndex>(v2) };
+        }
+
+};
+
+
+//! Triangle mesh with compact single precision vertices and 32-bit indices.
+using CompactTriangleMesh = TriangleMeshT<CompactVertex, std::uint32_t>;
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
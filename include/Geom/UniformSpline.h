@@ -10,12 +10,14 @@
 
 
 #include <Geom/Macros.h>
+#include <Geom/ArcLengthTable.h>
 
 #include <Gauss/Real.h>
 #include <Gauss/Vector2.h>
 #include <Gauss/Vector3.h>
 #include <vector>
 #include <array>
+#include <algorithm>
 #include <cmath>
 
 
@@ -56,6 +58,11 @@ class UniformSpline
                 return coeff[0] + coeff[1]*t + coeff[2]*t*t + coeff[3]*t*t*t;
             }
 
+            P EvaluateDerivative(const T& t) const
+            {
+                return coeff[1] + coeff[2]*(T(2)*t) + coeff[3]*(T(3)*t*t);
+            }
+
             std::array<P, 4> coeff;
         };
 
@@ -66,25 +73,121 @@ class UniformSpline
 
         /**
         \brief Builds the spline polynomials.
-        \param[in] points Specifies the control points.
+        \param[in] points Specifies the control points. If there are less than two points, the spline remains unchanged.
         \param[in] expansion Specifies the expansion of the polynomials.
         If the expansion is 0.0, this spline will be a linear spline. By default 1.0.
+        \remarks The tridiagonal system for the polynomial slopes is solved for all dimensions at once.
+        The spline keeps the control points and the intermediate results of the solver, so rebuilding a spline with the same number of points allocates no memory,
+        and single control points can be modified with 'SetPoint', 'InsertPoint', and 'RemovePoint' afterwards.
         */
         void Build(const std::vector<P>& points, const T& expansion = T(1))
         {
             if (points.size() >= 2)
             {
-                polynomials_.resize(points.size() - 1);
+                points_     = points;
+                expansion_  = expansion;
+
+                const auto numPoints = points_.size();
+
+                polynomials_.resize(numPoints - 1);
+                forward_.resize(numPoints);
+                slopes_.resize(numPoints);
+
+                /* Forward elimination */
+                forward_[0] = Forward(0, P(0));
+
+                for (std::size_t i = 1; i < numPoints; ++i)
+                    forward_[i] = Forward(i, forward_[i - 1]);
 
-                for (std::size_t i = 0; i < UniformSpline::dimension; ++i)
-                    BuildDimension(points, i, expansion);
+                /* Back substitution */
+                slopes_[numPoints - 1] = forward_[numPoints - 1];
+
+                for (std::size_t i = numPoints - 1; i > 0; --i)
+                {
+                    slopes_[i - 1] = forward_[i - 1] - slopes_[i]*Pivot(i - 1);
+                    UpdatePolynomial(i - 1);
+                }
             }
         }
 
-        //! Clears the spline polynoms.
+        /**
+        \brief Moves the specified control point and updates the affected polynomials.
+        \param[in] idx Specifies the control point index. This must be less than the number of points of the last 'Build' call.
+        \param[in] point Specifies the new point position.
+        \remarks If less than two points remain (e.g. after 'RemovePoint'), only the point is stored, just like 'Build' leaves the polynomials untouched.
+        The influence of a control point on the slopes decays exponentially with the distance to that point.
+        Only the band of slopes that actually changes is solved again, which is typically a few dozen polynomials around the control point,
+        and the result is the same as a complete rebuild.
+        */
+        void SetPoint(std::size_t idx, const P& point)
+        {
+            GS_ASSERT(idx < points_.size());
+            points_[idx] = point;
+            if (points_.size() >= 2)
+                Update(idx > 0 ? idx - 1 : 0, std::min(idx + 1, points_.size() - 1));
+        }
+
+        /**
+        \brief Inserts a new control point and updates the affected polynomials.
+        \param[in] idx Specifies the position where the point is to be inserted. This must be less than or equal to the number of points.
+        \param[in] point Specifies the point position.
+        \see SetPoint
+        */
+        void InsertPoint(std::size_t idx, const P& point)
+        {
+            GS_ASSERT(idx <= points_.size());
+
+            points_.insert(points_.begin() + idx, point);
+
+            if (points_.size() == 2)
+            {
+                /* Build the first polynomial from scratch */
+                auto points = std::move(points_);
+                Build(points, expansion_);
+            }
+            else if (points_.size() > 2)
+            {
+                polynomials_.insert(polynomials_.begin() + std::min(idx, polynomials_.size()), Polynomial());
+                forward_.insert(forward_.begin() + idx, P(0));
+                slopes_.insert(slopes_.begin() + idx, P(0));
+                Update(idx > 0 ? idx - 1 : 0, std::min(idx + 1, points_.size() - 1));
+            }
+        }
+
+        /**
+        \brief Removes the specified control point and updates the affected polynomials.
+        \param[in] idx Specifies the control point index. This must be less than the number of points.
+        \remarks If less than two points remain, the spline polynomials are cleared.
+        \see SetPoint
+        */
+        void RemovePoint(std::size_t idx)
+        {
+            GS_ASSERT(idx < points_.size());
+
+            points_.erase(points_.begin() + idx);
+
+            if (points_.size() < 2)
+            {
+                polynomials_.clear();
+                forward_.clear();
+                slopes_.clear();
+            }
+            else
+            {
+                polynomials_.erase(polynomials_.begin() + std::min(idx, polynomials_.size() - 1));
+                forward_.erase(forward_.begin() + idx);
+                slopes_.erase(slopes_.begin() + idx);
+                Update(idx > 0 ? idx - 1 : 0, std::min(idx, points_.size() - 1));
+            }
+        }
+
+        //! Clears the spline polynoms and control points.
         void Clear()
         {
+            points_.clear();
             polynomials_.clear();
+            forward_.clear();
+            slopes_.clear();
         }
 
         const Polynomial& operator [] (std::size_t idx) const
@@ -103,24 +206,70 @@ class UniformSpline
         {
             if (!polynomials_.empty())
             {
-                /* Clamp to edges */
-                if (t <= T(0))
-                    return polynomials_.front().Evaluate(T(0));
-                else if (t >= T(1))
-                    return polynomials_.back().Evaluate(T(1));
-
-                /* Get polynomial index and transform interpolator */
-                t *= static_cast<T>(polynomials_.size());
+                auto idx = PolynomialIndex(t);
+                return polynomials_[idx].Evaluate(t);
+            }
+            return P(0);
+        }
 
-                auto trimedT = std::floor(t);
-                t -= trimedT;
+        //! Evaluates the first derivative of the spline with respect to the interpolation factor 't' in the range [0, 1].
+        P EvaluateDerivative(T t) const
+        {
+            if (!polynomials_.empty())
+            {
+                auto idx = PolynomialIndex(t);
+                return polynomials_[idx].EvaluateDerivative(t) * static_cast<T>(polynomials_.size());
+            }
+            return P(0);
+        }
 
-                auto idx = static_cast<std::size_t>(trimedT);
+        /**
+        \brief Builds the arc-length table of this spline.
+        \param[out] table Specifies the output table. This must be rebuilt whenever the spline changes.
+        \param[in] subdivisions Specifies the number of table samples per polynomial. By default 16.
+        \see EvaluateAtDistance
+        */
+        void BuildArcLengthTable(ArcLengthTable<T>& table, std::uint32_t subdivisions = 16) const
+        {
+            std::vector<T> breakpoints;
 
-                /* Return polynomial interpolation */
-                return polynomials_[idx].Evaluate(t);
+            if (!polynomials_.empty())
+            {
+                const auto n = polynomials_.size();
+                breakpoints.resize(n + 1);
+                for (std::size_t i = 0; i <= n; ++i)
+                    breakpoints[i] = static_cast<T>(i) / static_cast<T>(n);
             }
-            return P(0);
+
+            table.Build(
+                breakpoints,
+                subdivisions,
+                [this](const T& t)
+                {
+                    return EvaluateDerivative(t).Length();
+                }
+            );
+        }
+
+        //! Evaluates the spline at the specified arc length, so equal distance steps move with constant speed along the spline.
+        P EvaluateAtDistance(const ArcLengthTable<T>& table, const T& distance) const
+        {
+            return Evaluate(table.GetParameter(distance));
+        }
+
+        /**
+        \brief Evaluates the spline at many arc lengths at once, e.g. for many objects on the same path.
+        \param[in] table Specifies the arc-length table of this spline.
+        \param[in] distances Pointer to the array of arc lengths.
+        \param[out] points Pointer to the array of output points. This must have at least 'count' elements.
+        \param[in] count Specifies the number of arc lengths.
+        \see ArcLengthTable::GetParameters
+        */
+        void EvaluateAtDistance(const ArcLengthTable<T>& table, const T* distances, P* points, std::size_t count) const
+        {
+            std::size_t cursor = 0;
+            for (std::size_t i = 0; i < count; ++i)
+                points[i] = Evaluate(table.GetParameter(distances[i], cursor));
         }
 
         const std::vector<Polynomial>& GetPolynomials() const
@@ -128,50 +277,163 @@ class UniformSpline
             return polynomials_;
         }
 
+        //! Returns the control points of the last 'Build' call, including all modifications with 'SetPoint', 'InsertPoint', and 'RemovePoint'.
+        const std::vector<P>& GetPoints() const
+        {
+            return points_;
+        }
+
     private:
 
-        //! Builds the polynomials for the specified dimension.
-        void BuildDimension(const std::vector<P>& points, std::size_t dim, const T& expansion)
+        // Returns the polynomial index for the interpolation factor 't' and transforms 't' into the local polynomial range [0, 1].
+        std::size_t PolynomialIndex(T& t) const
         {
-            auto numPoints = points.size();
+            /* Clamp to edges */
+            if (t <= T(0))
+            {
+                t = T(0);
+                return 0;
+            }
+            else if (t >= T(1))
+            {
+                t = T(1);
+                return polynomials_.size() - 1;
+            }
+
+            /* Get polynomial index and transform interpolator */
+            t *= static_cast<T>(polynomials_.size());
 
-            std::vector<T> s(numPoints), y(numPoints), v(numPoints), q(numPoints);
+            auto trimedT = std::floor(t);
+            t -= trimedT;
 
-            y[0] = 3 * ((points[1])[dim] - (points[0])[dim]);
+            return static_cast<std::size_t>(trimedT);
+        }
+
+        // Returns the pivot 'v[i]' of the forward elimination. This only depends on the index and converges after a few dozen rows.
+        static T Pivot(std::size_t i)
+        {
+            static const std::size_t numPivots = 64;
 
-            for (std::size_t i = 1; i < numPoints - 1; ++i)
-                y[i] = 3 * ((points[i+1])[dim] - (points[i-1])[dim]);
+            struct PivotTable
+            {
+                PivotTable()
+                {
+                    v[0] = T(0.5);
+                    for (std::size_t i = 1; i < numPivots; ++i)
+                        v[i] = T(1) / (T(4) - v[i - 1]);
+                }
+                T v[numPivots];
+            };
+
+            static const PivotTable table;
+
+            return table.v[std::min(i, numPivots - 1)];
+        }
 
-            y[numPoints - 1] = 3 * ((points[numPoints - 1])[dim] - (points[numPoints - 2])[dim]);
+        // Returns the right-hand side 'y[i]' of the tridiagonal system.
+        P RightHandSide(std::size_t i) const
+        {
+            if (i == 0)
+                return (points_[1] - points_[0])*T(3);
+            else if (i + 1 < points_.size())
+                return (points_[i + 1] - points_[i - 1])*T(3);
+            else
+                return (points_[i] - points_[i - 1])*T(3);
+        }
 
-            v[0] = T(0.5);
-            q[0] = T(0.5) * y[0];
+        // Returns the forward eliminated right-hand side 'q[i]' for the previous value 'q[i - 1]'.
+        P Forward(std::size_t i, const P& prevForward) const
+        {
+            if (i == 0)
+                return RightHandSide(0)*T(0.5);
+            else if (i + 1 < points_.size())
+                return (RightHandSide(i) - prevForward)*(expansion_ * Pivot(i));
+            else
+                return (RightHandSide(i) - prevForward)*(expansion_ * (T(1) / (T(2) - Pivot(i - 1))));
+        }
 
-            for (std::size_t i = 1; i + 1 < numPoints; ++i)
+        static bool Equals(const P& lhs, const P& rhs)
+        {
+            for (std::size_t i = 0; i < UniformSpline::dimension; ++i)
             {
-                v[i] = T(1) / (4 - v[i - 1]);
-                q[i] = expansion * v[i] * (y[i] - q[i - 1]);
+                if (lhs[i] != rhs[i])
+                    return false;
             }
+            return true;
+        }
+
+        // Updates the polynomial coefficients between the control points 'i' and 'i + 1'.
+        void UpdatePolynomial(std::size_t i)
+        {
+            const auto& p0 = points_[i];
+            const auto& p1 = points_[i + 1];
+            const auto& s0 = slopes_[i];
+            const auto& s1 = slopes_[i + 1];
+
+            auto& polynomial = polynomials_[i];
+
+            polynomial[0] = p0;
+            polynomial[1] = s0;
+            polynomial[2] = p1*T(3) - p0*T(3) - s0*T(2) - s1;
+            polynomial[3] = p0*T(2) - p1*T(2) + s0 + s1;
+        }
+
+        /*
+        Solves the tridiagonal system again after the right-hand sides 'y[first]' to 'y[last]' have changed.
+        The forward elimination continues until it reaches the previous results again (with converged pivots, since inserted or removed rows shift the pivots),
+        and the back substitution stops as soon as the slopes before the first modified row remain unchanged.
+        */
+        void Update(std::size_t first, std::size_t last)
+        {
+            const auto numPoints = points_.size();
+
+            if (numPoints < 2 || forward_.size() != numPoints || slopes_.size() != numPoints)
+                return;
 
-            q[numPoints - 1] = expansion * (T(1) / (2 - v[numPoints - 2])) * (y[numPoints - 1] - q[numPoints - 2]);
+            /* Forward elimination */
+            auto end = first;
 
-            s[numPoints - 1] = q[numPoints - 1];
+            for (; end < numPoints; ++end)
+            {
+                auto q = Forward(end, end > 0 ? forward_[end - 1] : P(0));
+                if (end > last && Pivot(end) == Pivot(end - 1) && Equals(q, forward_[end]))
+                    break;
+                forward_[end] = q;
+            }
 
-            for (std::size_t i = numPoints - 1; i > 0; --i)
-                s[i - 1] = q[i - 1] - v[i - 1]*s[i];
+            /* Back substitution */
+            auto i = end;
 
-            for (std::size_t i = 0; i + 1 < numPoints; ++i)
+            if (i == numPoints)
             {
-                auto& polynomial = polynomials_[i];
+                --i;
+                slopes_[i] = forward_[i];
+            }
+
+            auto begin = i;
 
-                (polynomial[0])[dim] = (points[i])[dim];
-                (polynomial[1])[dim] = s[i];
-                (polynomial[2])[dim] = 3*(points[i+1])[dim] - 3*(points[i  ])[dim] - 2*s[i] - s[i+1];
-                (polynomial[3])[dim] = 2*(points[i  ])[dim] - 2*(points[i+1])[dim] +   s[i] + s[i+1];
+            while (i > 0)
+            {
+                auto s = forward_[i - 1] - slopes_[i]*Pivot(i - 1);
+                if (i - 1 < first && Equals(s, slopes_[i - 1]))
+                    break;
+                slopes_[--i] = s;
+                begin = i;
             }
+
+            /* Update polynomials of all modified points and slopes */
+            begin   = (begin > 0 ? begin - 1 : 0);
+            end     = std::min(std::max(end, last + 1), numPoints - 1);
+
+            for (i = begin; i < end; ++i)
+                UpdatePolynomial(i);
         }
 
+        std::vector<P>          points_;
+        T                       expansion_      = T(1);
         std::vector<Polynomial> polynomials_;
+        std::vector<P>          forward_;
+        std::vector<P>          slopes_;
 
 };
 
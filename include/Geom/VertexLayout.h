@@ -0,0 +1,185 @@
+/*
+ * VertexLayout.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_VERTEX_LAYOUT_H
+#define GM_VERTEX_LAYOUT_H
+
+
+#include <Geom/TriangleMesh.h>
+#include <Geom/MeshModifier.h>
+
+#include <Gauss/Vector3.h>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace Gm
+{
+
+
+/**
+\brief Compile-time vertex attribute.
+\tparam Offset Specifies the byte offset within each vertex.
+\tparam Components Specifies the number of scalar components of this attribute.
+\see VertexLayoutT
+*/
+template <std::size_t Offset, std::uint32_t Components>
+struct VertexAttributeT
+{
+    static const std::size_t    offset      = Offset;
+    static const std::uint32_t  components  = Components;
+};
+
+/**
+\brief Compile-time vertex layout, i.e. the compile-time counterpart of 'MeshModifier::VertexDescriptor'.
+\tparam T Specifies the scalar type of all attribute components.
+\tparam Stride Specifies the byte offset to the next vertex.
+\tparam Attributes Specifies the list of 'VertexAttributeT' types.
+\remarks The interpolation functions for a layout have no loops over the attributes and a constant number of components per attribute,
+so the weighted sums are fully unrolled and can be vectorized by the compiler.
+\see InterpolateBarycentric
+\see DefaultVertexLayout
+*/
+template <typename T, std::size_t Stride, typename... Attributes>
+struct VertexLayoutT
+{
+    using ScalarType = T;
+
+    static const std::size_t stride         = Stride;
+    static const std::size_t numAttributes  = sizeof...(Attributes);
+
+    //! Returns the runtime vertex descriptor of this layout.
+    static MeshModifier::VertexDescriptor ToDescriptor()
+    {
+        return MeshModifier::VertexDescriptor(
+            { MeshModifier::VertexAttributeDescriptor(Attributes::offset, Attributes::components)... },
+            Stride
+        );
+    }
+};
+
+//! Compile-time vertex layout of 'TriangleMesh::Vertex'. This matches 'MeshModifier::GetDefaultVertexDesc'.
+using DefaultVertexLayout = VertexLayoutT<
+    Gs::Real,
+    sizeof(TriangleMesh::Vertex),
+    VertexAttributeT<0, 3>,
+    VertexAttributeT<3 * sizeof(Gs::Real), 3>,
+    VertexAttributeT<6 * sizeof(Gs::Real), 2>
+>;
+
+
+namespace Details
+{
+
+template <typename T, typename... Attributes>
+struct AttributeInterpolator;
+
+template <typename T>
+struct AttributeInterpolator<T>
+{
+    static void Interpolate(char*, const char*, const char*, const char*, T, T, T)
+    {
+    }
+};
+
+template <typename T, typename Attribute, typename... Next>
+struct AttributeInterpolator<T, Attribute, Next...>
+{
+    static void Interpolate(char* out, const char* in0, const char* in1, const char* in2, T w0, T w1, T w2)
+    {
+        auto        dst = reinterpret_cast<T*>(out + Attribute::offset);
+        const auto  a   = reinterpret_cast<const T*>(in0 + Attribute::offset);
+        const auto  b   = reinterpret_cast<const T*>(in1 + Attribute::offset);
+        const auto  c   = reinterpret_cast<const T*>(in2 + Attribute::offset);
+
+        for (std::uint32_t i = 0; i < Attribute::components; ++i)
+            dst[i] = a[i] * w0 + b[i] * w1 + c[i] * w2;
+
+        AttributeInterpolator<T, Next...>::Interpolate(out, in0, in1, in2, w0, w1, w2);
+    }
+};
+
+template <typename Layout>
+struct LayoutInterpolator;
+
+template <typename T, std::size_t Stride, typename... Attributes>
+struct LayoutInterpolator<VertexLayoutT<T, Stride, Attributes...>>
+{
+    static void Interpolate(void* output, const void* input, std::size_t v0, std::size_t v1, std::size_t v2, const Gs::Vector3T<T>& barycentricCoords)
+    {
+        const auto base = reinterpret_cast<const char*>(input);
+        AttributeInterpolator<T, Attributes...>::Interpolate(
+            reinterpret_cast<char*>(output),
+            base + v0 * Stride,
+            base + v1 * Stride,
+            base + v2 * Stride,
+            barycentricCoords.x,
+            barycentricCoords.y,
+            barycentricCoords.z
+        );
+    }
+};
+
+} // /namespace Details
+
+
+/**
+\brief Makes a barycentric interpolation between the three specified vertices with a compile-time vertex layout.
+\tparam Layout Specifies the vertex layout, e.g. 'DefaultVertexLayout'.
+\param[out] outputVertex Pointer to the output vertex. Only the attributes of the layout are written.
+\param[in] inputVertexBuffer Specifies the input vertex buffer from where the three vertices are to be read.
+\remarks This is the specialized counterpart of 'MeshModifier::InterpolateBarycentric', which remains the fallback for layouts that are only known at runtime.
+\see MeshModifier::InterpolateBarycentric
+*/
+template <typename Layout>
+void InterpolateBarycentric(
+    void*                                                   outputVertex,
+    const void*                                             inputVertexBuffer,
+    std::size_t                                             v0,
+    std::size_t                                             v1,
+    std::size_t                                             v2,
+    const Gs::Vector3T<typename Layout::ScalarType>&        barycentricCoords)
+{
+    Details::LayoutInterpolator<Layout>::Interpolate(outputVertex, inputVertexBuffer, v0, v1, v2, barycentricCoords);
+}
+
+/**
+\brief Interpolates many vertices at once with a compile-time vertex layout.
+\param[out] outputVertexBuffer Specifies the output vertex buffer. It must have enough space for 'count' vertices with the stride of the layout.
+\param[in] inputVertexBuffer Specifies the input vertex buffer.
+\param[in] triangles Specifies the triangles of the input vertex buffer.
+\param[in] triangleIndices Specifies the triangle index for each output vertex.
+\param[in] barycentricCoords Specifies the barycentric coordinates for each output vertex.
+\param[in] count Specifies the number of output vertices.
+*/
+template <typename Layout, typename IndexT>
+void InterpolateBarycentricBatch(
+    void*                                                   outputVertexBuffer,
+    const void*                                             inputVertexBuffer,
+    const Triangle<IndexT>*                                 triangles,
+    const std::size_t*                                      triangleIndices,
+    const Gs::Vector3T<typename Layout::ScalarType>*        barycentricCoords,
+    std::size_t                                             count)
+{
+    auto output = reinterpret_cast<char*>(outputVertexBuffer);
+
+    for (std::size_t i = 0; i < count; ++i, output += Layout::stride)
+    {
+        const auto& tri = triangles[triangleIndices[i]];
+        Details::LayoutInterpolator<Layout>::Interpolate(output, inputVertexBuffer, tri.a, tri.b, tri.c, barycentricCoords[i]);
+    }
+}
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
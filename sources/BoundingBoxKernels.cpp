@@ -0,0 +1,609 @@
+/*
+ * BoundingBoxKernels.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/BoundingBoxKernels.h>
+#include "SIMDDetails.h"
+#include <limits>
+
+
+namespace Gm
+{
+
+
+/* ----- Internal functions ----- */
+
+// Bounds of three coordinates with the same comparison semantics as 'AABB::Insert' (NaN values are ignored).
+template <typename T>
+struct ScalarBounds
+{
+    ScalarBounds()
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            min[i] = std::numeric_limits<T>::max();
+            max[i] = std::numeric_limits<T>::lowest();
+        }
+    }
+
+    void Insert(int axis, T value)
+    {
+        Merge(axis, value, value);
+    }
+
+    void Insert(T x, T y, T z)
+    {
+        Insert(0, x);
+        Insert(1, y);
+        Insert(2, z);
+    }
+
+    // Merges the specified partial bounds of one axis (like 'AABB::Insert(const AABB&)').
+    void Merge(int axis, T minValue, T maxValue)
+    {
+        if (min[axis] > minValue)
+            min[axis] = minValue;
+        if (max[axis] < maxValue)
+            max[axis] = maxValue;
+    }
+
+    AABB3T<T> ToAABB() const
+    {
+        return AABB3T<T>(Gs::Vector3T<T>(min[0], min[1], min[2]), Gs::Vector3T<T>(max[0], max[1], max[2]));
+    }
+
+    T min[3];
+    T max[3];
+};
+
+// Row-major coefficients of an affine 4x4 matrix (only the first 3 rows).
+template <typename T>
+struct AffineCoeffs
+{
+    explicit AffineCoeffs(const Gs::AffineMatrix4T<T>& matrix)
+    {
+        for (std::size_t r = 0; r < 3; ++r)
+        {
+            for (std::size_t c = 0; c < 4; ++c)
+                m[r][c] = matrix(r, c);
+        }
+    }
+
+    // Transforms the specified coordinate of a point in the same order of operations as 'Gs::TransformVector'.
+    T Transform(std::size_t row, T x, T y, T z) const
+    {
+        return m[row][0]*x + m[row][1]*y + m[row][2]*z + m[row][3];
+    }
+
+    T m[3][4];
+};
+
+template <typename T>
+const T* PointAt(const T* points, std::size_t stride, std::size_t index)
+{
+    return reinterpret_cast<const T*>(reinterpret_cast<const char*>(points) + stride*index);
+}
+
+#ifdef GM_SIMD_SSE2
+
+// Loads X, Y, Z of the specified point into the first 3 components without reading beyond the point.
+static __m128 LoadPoint(const float* p)
+{
+    return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(p)), _mm_load_ss(p + 2));
+}
+
+static void StoreBounds(__m128 minVec, __m128 maxVec, ScalarBounds<float>& bounds)
+{
+    float minArray[4], maxArray[4];
+    _mm_storeu_ps(minArray, minVec);
+    _mm_storeu_ps(maxArray, maxVec);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        bounds.Merge(i, minArray[i], maxArray[i]);
+    }
+}
+
+#endif
+
+/* --- SoA SIMD traits --- */
+
+#if defined(GM_SIMD_AVX)
+
+struct SIMDFloat
+{
+    using Scalar    = float;
+    using Register  = __m256;
+
+    static const std::size_t width = 8;
+
+    static Register Load(const float* p)                { return _mm256_loadu_ps(p); }
+    static Register Set1(float s)                       { return _mm256_set1_ps(s); }
+    static Register Min(Register a, Register b)         { return _mm256_min_ps(a, b); }
+    static Register Max(Register a, Register b)         { return _mm256_max_ps(a, b); }
+    static Register Add(Register a, Register b)         { return _mm256_add_ps(a, b); }
+    static Register Mul(Register a, Register b)         { return _mm256_mul_ps(a, b); }
+    static void     Store(float* p, Register a)         { _mm256_storeu_ps(p, a); }
+};
+
+struct SIMDDouble
+{
+    using Scalar    = double;
+    using Register  = __m256d;
+
+    static const std::size_t width = 4;
+
+    static Register Load(const double* p)               { return _mm256_loadu_pd(p); }
+    static Register Set1(double s)                      { return _mm256_set1_pd(s); }
+    static Register Min(Register a, Register b)         { return _mm256_min_pd(a, b); }
+    static Register Max(Register a, Register b)         { return _mm256_max_pd(a, b); }
+    static Register Add(Register a, Register b)         { return _mm256_add_pd(a, b); }
+    static Register Mul(Register a, Register b)         { return _mm256_mul_pd(a, b); }
+    static void     Store(double* p, Register a)        { _mm256_storeu_pd(p, a); }
+};
+
+#elif defined(GM_SIMD_SSE2)
+
+struct SIMDFloat
+{
+    using Scalar    = float;
+    using Register  = __m128;
+
+    static const std::size_t width = 4;
+
+    static Register Load(const float* p)                { return _mm_loadu_ps(p); }
+    static Register Set1(float s)                       { return _mm_set1_ps(s); }
+    static Register Min(Register a, Register b)         { return _mm_min_ps(a, b); }
+    static Register Max(Register a, Register b)         { return _mm_max_ps(a, b); }
+    static Register Add(Register a, Register b)         { return _mm_add_ps(a, b); }
+    static Register Mul(Register a, Register b)         { return _mm_mul_ps(a, b); }
+    static void     Store(float* p, Register a)         { _mm_storeu_ps(p, a); }
+};
+
+struct SIMDDouble
+{
+    using Scalar    = double;
+    using Register  = __m128d;
+
+    static const std::size_t width = 2;
+
+    static Register Load(const double* p)               { return _mm_loadu_pd(p); }
+    static Register Set1(double s)                      { return _mm_set1_pd(s); }
+    static Register Min(Register a, Register b)         { return _mm_min_pd(a, b); }
+    static Register Max(Register a, Register b)         { return _mm_max_pd(a, b); }
+    static Register Add(Register a, Register b)         { return _mm_add_pd(a, b); }
+    static Register Mul(Register a, Register b)         { return _mm_mul_pd(a, b); }
+    static void     Store(double* p, Register a)        { _mm_storeu_pd(p, a); }
+};
+
+#endif
+
+#if defined(GM_SIMD_AVX) || defined(GM_SIMD_SSE2)
+
+#define GM_SIMD_SOA_BOUNDS
+
+/*
+Accumulates the bounds of the SoA coordinates with SIMD registers and returns the index of the first point that is not yet inserted.
+The new value is always the first argument of Min/Max, so NaN values are ignored like in 'AABB::Insert'.
+*/
+template <typename SIMD>
+std::size_t InsertSoASIMD(
+    const typename SIMD::Scalar* x, const typename SIMD::Scalar* y, const typename SIMD::Scalar* z,
+    std::size_t count, ScalarBounds<typename SIMD::Scalar>& bounds)
+{
+    using T = typename SIMD::Scalar;
+
+    if (count < SIMD::width)
+        return 0;
+
+    auto minX = SIMD::Set1(std::numeric_limits<T>::max()), maxX = SIMD::Set1(std::numeric_limits<T>::lowest());
+    auto minY = minX, maxY = maxX;
+    auto minZ = minX, maxZ = maxX;
+
+    std::size_t i = 0;
+
+    for (; i + SIMD::width <= count; i += SIMD::width)
+    {
+        const auto vx = SIMD::Load(x + i);
+        const auto vy = SIMD::Load(y + i);
+        const auto vz = SIMD::Load(z + i);
+
+        minX = SIMD::Min(vx, minX);
+        maxX = SIMD::Max(vx, maxX);
+        minY = SIMD::Min(vy, minY);
+        maxY = SIMD::Max(vy, maxY);
+        minZ = SIMD::Min(vz, minZ);
+        maxZ = SIMD::Max(vz, maxZ);
+    }
+
+    /* Reduce lanes */
+    T lanes[6][SIMD::width];
+
+    SIMD::Store(lanes[0], minX);
+    SIMD::Store(lanes[1], maxX);
+    SIMD::Store(lanes[2], minY);
+    SIMD::Store(lanes[3], maxY);
+    SIMD::Store(lanes[4], minZ);
+    SIMD::Store(lanes[5], maxZ);
+
+    for (std::size_t j = 0; j < SIMD::width; ++j)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            bounds.Merge(axis, lanes[axis*2][j], lanes[axis*2 + 1][j]);
+        }
+    }
+
+    return i;
+}
+
+// Transformed variant of 'InsertSoASIMD'.
+template <typename SIMD>
+std::size_t InsertSoASIMD(
+    const typename SIMD::Scalar* x, const typename SIMD::Scalar* y, const typename SIMD::Scalar* z,
+    std::size_t count, const AffineCoeffs<typename SIMD::Scalar>& coeffs, ScalarBounds<typename SIMD::Scalar>& bounds)
+{
+    using T = typename SIMD::Scalar;
+    using Register = typename SIMD::Register;
+
+    if (count < SIMD::width)
+        return 0;
+
+    Register m[3][4];
+    for (int r = 0; r < 3; ++r)
+    {
+        for (int c = 0; c < 4; ++c)
+            m[r][c] = SIMD::Set1(coeffs.m[r][c]);
+    }
+
+    Register minVec[3], maxVec[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        minVec[axis] = SIMD::Set1(std::numeric_limits<T>::max());
+        maxVec[axis] = SIMD::Set1(std::numeric_limits<T>::lowest());
+    }
+
+    std::size_t i = 0;
+
+    for (; i + SIMD::width <= count; i += SIMD::width)
+    {
+        const auto vx = SIMD::Load(x + i);
+        const auto vy = SIMD::Load(y + i);
+        const auto vz = SIMD::Load(z + i);
+
+        for (int r = 0; r < 3; ++r)
+        {
+            const auto v = SIMD::Add(SIMD::Add(SIMD::Add(SIMD::Mul(m[r][0], vx), SIMD::Mul(m[r][1], vy)), SIMD::Mul(m[r][2], vz)), m[r][3]);
+            minVec[r] = SIMD::Min(v, minVec[r]);
+            maxVec[r] = SIMD::Max(v, maxVec[r]);
+        }
+    }
+
+    /* Reduce lanes */
+    T minLanes[SIMD::width], maxLanes[SIMD::width];
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        SIMD::Store(minLanes, minVec[axis]);
+        SIMD::Store(maxLanes, maxVec[axis]);
+
+        for (std::size_t j = 0; j < SIMD::width; ++j)
+        {
+            bounds.Merge(axis, minLanes[j], maxLanes[j]);
+        }
+    }
+
+    return i;
+}
+
+#endif
+
+/* --- AoS SIMD kernels --- */
+
+static std::size_t InsertAoSSIMD(const float* points, std::size_t count, std::size_t stride, ScalarBounds<float>& bounds)
+{
+    #ifdef GM_SIMD_SSE2
+
+    if (count < 2)
+        return 0;
+
+    /* Use two pairs of accumulators to hide the latency of min/max */
+    auto minVec0 = _mm_set1_ps(std::numeric_limits<float>::max());
+    auto maxVec0 = _mm_set1_ps(std::numeric_limits<float>::lowest());
+    auto minVec1 = minVec0;
+    auto maxVec1 = maxVec0;
+
+    std::size_t i = 0;
+
+    for (; i + 2 <= count; i += 2)
+    {
+        const auto p0 = LoadPoint(PointAt(points, stride, i));
+        const auto p1 = LoadPoint(PointAt(points, stride, i + 1));
+
+        minVec0 = _mm_min_ps(p0, minVec0);
+        maxVec0 = _mm_max_ps(p0, maxVec0);
+        minVec1 = _mm_min_ps(p1, minVec1);
+        maxVec1 = _mm_max_ps(p1, maxVec1);
+    }
+
+    StoreBounds(minVec0, maxVec0, bounds);
+    StoreBounds(minVec1, maxVec1, bounds);
+
+    return i;
+
+    #else
+
+    return 0;
+
+    #endif
+}
+
+static std::size_t InsertAoSSIMD(const double* points, std::size_t count, std::size_t stride, ScalarBounds<double>& bounds)
+{
+    #ifdef GM_SIMD_SSE2
+
+    /* X and Y are stored in one register, Z is stored in the lower half of another register */
+    auto minXY = _mm_set1_pd(std::numeric_limits<double>::max());
+    auto maxXY = _mm_set1_pd(std::numeric_limits<double>::lowest());
+    auto minZ  = minXY;
+    auto maxZ  = maxXY;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto p    = PointAt(points, stride, i);
+        const auto xy   = _mm_loadu_pd(p);
+        const auto z    = _mm_load_sd(p + 2);
+
+        minXY   = _mm_min_pd(xy, minXY);
+        maxXY   = _mm_max_pd(xy, maxXY);
+        minZ    = _mm_min_sd(z, minZ);
+        maxZ    = _mm_max_sd(z, maxZ);
+    }
+
+    double minArray[2], maxArray[2];
+
+    _mm_storeu_pd(minArray, minXY);
+    _mm_storeu_pd(maxArray, maxXY);
+    bounds.Merge(0, minArray[0], maxArray[0]);
+    bounds.Merge(1, minArray[1], maxArray[1]);
+
+    _mm_storeu_pd(minArray, minZ);
+    _mm_storeu_pd(maxArray, maxZ);
+    bounds.Merge(2, minArray[0], maxArray[0]);
+
+    return count;
+
+    #else
+
+    return 0;
+
+    #endif
+}
+
+static std::size_t InsertAoSSIMD(
+    const float* points, std::size_t count, std::size_t stride, const AffineCoeffs<float>& coeffs, ScalarBounds<float>& bounds)
+{
+    #ifdef GM_SIMD_SSE2
+
+    /* Store matrix columns, so each point is transformed with 3 broadcasts */
+    __m128 columns[4];
+    for (int c = 0; c < 4; ++c)
+        columns[c] = _mm_set_ps(0.0f, coeffs.m[2][c], coeffs.m[1][c], coeffs.m[0][c]);
+
+    auto minVec = _mm_set1_ps(std::numeric_limits<float>::max());
+    auto maxVec = _mm_set1_ps(std::numeric_limits<float>::lowest());
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto p = LoadPoint(PointAt(points, stride, i));
+
+        const auto x = _mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0));
+        const auto y = _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1));
+        const auto z = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2));
+
+        const auto v = _mm_add_ps(
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(columns[0], x), _mm_mul_ps(columns[1], y)), _mm_mul_ps(columns[2], z)),
+            columns[3]
+        );
+
+        minVec = _mm_min_ps(v, minVec);
+        maxVec = _mm_max_ps(v, maxVec);
+    }
+
+    StoreBounds(minVec, maxVec, bounds);
+
+    return count;
+
+    #else
+
+    return 0;
+
+    #endif
+}
+
+static std::size_t InsertAoSSIMD(
+    const double* points, std::size_t count, std::size_t stride, const AffineCoeffs<double>& coeffs, ScalarBounds<double>& bounds)
+{
+    #ifdef GM_SIMD_SSE2
+
+    /* Rows 0 and 1 are computed in one register, row 2 is computed in another register */
+    __m128d columnsXY[4], columnsZ[4];
+    for (int c = 0; c < 4; ++c)
+    {
+        columnsXY[c]    = _mm_set_pd(coeffs.m[1][c], coeffs.m[0][c]);
+        columnsZ[c]     = _mm_set1_pd(coeffs.m[2][c]);
+    }
+
+    auto minXY = _mm_set1_pd(std::numeric_limits<double>::max());
+    auto maxXY = _mm_set1_pd(std::numeric_limits<double>::lowest());
+    auto minZ  = minXY;
+    auto maxZ  = maxXY;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto p = PointAt(points, stride, i);
+        const auto x = _mm_set1_pd(p[0]);
+        const auto y = _mm_set1_pd(p[1]);
+        const auto z = _mm_set1_pd(p[2]);
+
+        const auto xy = _mm_add_pd(
+            _mm_add_pd(_mm_add_pd(_mm_mul_pd(columnsXY[0], x), _mm_mul_pd(columnsXY[1], y)), _mm_mul_pd(columnsXY[2], z)),
+            columnsXY[3]
+        );
+        const auto tz = _mm_add_pd(
+            _mm_add_pd(_mm_add_pd(_mm_mul_pd(columnsZ[0], x), _mm_mul_pd(columnsZ[1], y)), _mm_mul_pd(columnsZ[2], z)),
+            columnsZ[3]
+        );
+
+        minXY   = _mm_min_pd(xy, minXY);
+        maxXY   = _mm_max_pd(xy, maxXY);
+        minZ    = _mm_min_pd(tz, minZ);
+        maxZ    = _mm_max_pd(tz, maxZ);
+    }
+
+    double minArray[2], maxArray[2];
+
+    _mm_storeu_pd(minArray, minXY);
+    _mm_storeu_pd(maxArray, maxXY);
+    bounds.Merge(0, minArray[0], maxArray[0]);
+    bounds.Merge(1, minArray[1], maxArray[1]);
+
+    _mm_storeu_pd(minArray, minZ);
+    _mm_storeu_pd(maxArray, maxZ);
+    bounds.Merge(2, minArray[0], maxArray[0]);
+
+    return count;
+
+    #else
+
+    return 0;
+
+    #endif
+}
+
+/* --- Generic entry points with scalar remainder --- */
+
+template <typename T>
+AABB3T<T> BoundingBoxAoS(const T* points, std::size_t count, std::size_t stride)
+{
+    ScalarBounds<T> bounds;
+
+    for (auto i = InsertAoSSIMD(points, count, stride, bounds); i < count; ++i)
+    {
+        const auto p = PointAt(points, stride, i);
+        bounds.Insert(p[0], p[1], p[2]);
+    }
+
+    return bounds.ToAABB();
+}
+
+template <typename T>
+AABB3T<T> BoundingBoxAoS(const T* points, std::size_t count, std::size_t stride, const Gs::AffineMatrix4T<T>& matrix)
+{
+    const AffineCoeffs<T> coeffs(matrix);
+    ScalarBounds<T> bounds;
+
+    for (auto i = InsertAoSSIMD(points, count, stride, coeffs, bounds); i < count; ++i)
+    {
+        const auto p = PointAt(points, stride, i);
+        bounds.Insert(coeffs.Transform(0, p[0], p[1], p[2]), coeffs.Transform(1, p[0], p[1], p[2]), coeffs.Transform(2, p[0], p[1], p[2]));
+    }
+
+    return bounds.ToAABB();
+}
+
+template <typename SIMD, typename T>
+AABB3T<T> BoundingBoxSoA(const T* x, const T* y, const T* z, std::size_t count)
+{
+    ScalarBounds<T> bounds;
+
+    #ifdef GM_SIMD_SOA_BOUNDS
+    auto i = InsertSoASIMD<SIMD>(x, y, z, count, bounds);
+    #else
+    std::size_t i = 0;
+    #endif
+
+    for (; i < count; ++i)
+        bounds.Insert(x[i], y[i], z[i]);
+
+    return bounds.ToAABB();
+}
+
+template <typename SIMD, typename T>
+AABB3T<T> BoundingBoxSoA(const T* x, const T* y, const T* z, std::size_t count, const Gs::AffineMatrix4T<T>& matrix)
+{
+    const AffineCoeffs<T> coeffs(matrix);
+    ScalarBounds<T> bounds;
+
+    #ifdef GM_SIMD_SOA_BOUNDS
+    auto i = InsertSoASIMD<SIMD>(x, y, z, count, coeffs, bounds);
+    #else
+    std::size_t i = 0;
+    #endif
+
+    for (; i < count; ++i)
+        bounds.Insert(coeffs.Transform(0, x[i], y[i], z[i]), coeffs.Transform(1, x[i], y[i], z[i]), coeffs.Transform(2, x[i], y[i], z[i]));
+
+    return bounds.ToAABB();
+}
+
+#ifndef GM_SIMD_SOA_BOUNDS
+
+// Placeholders for the SIMD traits when no SIMD instructions are available.
+struct SIMDFloat {};
+struct SIMDDouble {};
+
+#endif
+
+
+/* ----- Global functions ----- */
+
+AABB3f ComputeBoundingBox(const float* points, std::size_t count, std::size_t stride)
+{
+    return BoundingBoxAoS(points, count, stride);
+}
+
+AABB3d ComputeBoundingBox(const double* points, std::size_t count, std::size_t stride)
+{
+    return BoundingBoxAoS(points, count, stride);
+}
+
+AABB3f ComputeBoundingBox(const float* points, std::size_t count, std::size_t stride, const Gs::AffineMatrix4T<float>& matrix)
+{
+    return BoundingBoxAoS(points, count, stride, matrix);
+}
+
+AABB3d ComputeBoundingBox(const double* points, std::size_t count, std::size_t stride, const Gs::AffineMatrix4T<double>& matrix)
+{
+    return BoundingBoxAoS(points, count, stride, matrix);
+}
+
+AABB3f ComputeBoundingBoxSoA(const float* x, const float* y, const float* z, std::size_t count)
+{
+    return BoundingBoxSoA<SIMDFloat>(x, y, z, count);
+}
+
+AABB3d ComputeBoundingBoxSoA(const double* x, const double* y, const double* z, std::size_t count)
+{
+    return BoundingBoxSoA<SIMDDouble>(x, y, z, count);
+}
+
+AABB3f ComputeBoundingBoxSoA(const float* x, const float* y, const float* z, std::size_t count, const Gs::AffineMatrix4T<float>& matrix)
+{
+    return BoundingBoxSoA<SIMDFloat>(x, y, z, count, matrix);
+}
+
+AABB3d ComputeBoundingBoxSoA(const double* x, const double* y, const double* z, std::size_t count, const Gs::AffineMatrix4T<double>& matrix)
+{
+    return BoundingBoxSoA<SIMDDouble>(x, y, z, count, matrix);
+}
+
+
+} // /namespace Gm
+
+
+
+// ================================================================================
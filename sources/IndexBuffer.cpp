@@ -0,0 +1,325 @@
+/*
+ * IndexBuffer.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/IndexBuffer.h>
+#include "ParallelDetails.h"
+#include "Except.h"
+#include <algorithm>
+#include <limits>
+
+
+namespace Gm
+{
+
+
+/* ----- Internal functions ----- */
+
+// Minimal number of triangles per thread for the conversion of large meshes.
+static const std::size_t g_parallelGrainSize = 16384;
+
+static void ThrowIndexOutOfRange()
+{
+    throw std::out_of_range(GM_EXCEPT_INFO("vertex index does not fit into 32-bit index format"));
+}
+
+// Returns the largest index of the specified triangles, or throws if an index plus offset does not fit into 32 bits.
+static IndexBuffer::VertexIndex FindMaxIndex(const std::vector<IndexBuffer::Triangle>& triangles, IndexBuffer::VertexIndex vertexOffset)
+{
+    using VertexIndex = IndexBuffer::VertexIndex;
+
+    const VertexIndex maxIndex32 = static_cast<VertexIndex>(std::numeric_limits<std::uint32_t>::max());
+
+    auto FindMaxIndexRange = [&triangles](std::size_t begin, std::size_t end) -> VertexIndex
+    {
+        VertexIndex maxIndex = 0;
+        for (auto i = begin; i < end; ++i)
+        {
+            const auto& tri = triangles[i];
+            maxIndex = std::max(maxIndex, std::max(tri.a, std::max(tri.b, tri.c)));
+        }
+        return maxIndex;
+    };
+
+    #ifdef GM_ENABLE_MULTI_THREADING
+    const auto maxIndex = GetGlobalThreadPool()->ParallelReduce(
+        triangles.size(),
+        g_parallelGrainSize,
+        VertexIndex(0),
+        FindMaxIndexRange,
+        [](VertexIndex lhs, VertexIndex rhs) { return std::max(lhs, rhs); }
+    );
+    #else
+    const auto maxIndex = FindMaxIndexRange(0, triangles.size());
+    #endif
+
+    if (!triangles.empty() && (vertexOffset > maxIndex32 || maxIndex > maxIndex32 - vertexOffset))
+        ThrowIndexOutOfRange();
+
+    return (triangles.empty() ? 0 : maxIndex + vertexOffset);
+}
+
+// Copies the specified triangles (plus offset) into the destination indices, which must already have the required size.
+template <typename Index>
+static void CopyTriangles(Index* dst, const std::vector<IndexBuffer::Triangle>& triangles, IndexBuffer::VertexIndex vertexOffset)
+{
+    Details::ParallelFor(
+        triangles.size(),
+        g_parallelGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto& tri = triangles[i];
+                dst[i*3    ] = static_cast<Index>(tri.a + vertexOffset);
+                dst[i*3 + 1] = static_cast<Index>(tri.b + vertexOffset);
+                dst[i*3 + 2] = static_cast<Index>(tri.c + vertexOffset);
+            }
+        }
+    );
+}
+
+// Copies the specified indices (plus offset) into another index format.
+template <typename DstIndex, typename SrcIndex>
+static void CopyIndices(DstIndex* dst, const SrcIndex* src, std::size_t count, IndexBuffer::VertexIndex vertexOffset)
+{
+    Details::ParallelFor(
+        count,
+        g_parallelGrainSize * 3,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+                dst[i] = static_cast<DstIndex>(static_cast<IndexBuffer::VertexIndex>(src[i]) + vertexOffset);
+        }
+    );
+}
+
+
+/* ----- Global functions ----- */
+
+std::size_t GetIndexFormatSize(IndexFormat format)
+{
+    return (format == IndexFormat::UInt16 ? sizeof(std::uint16_t) : sizeof(std::uint32_t));
+}
+
+std::uint64_t GetIndexFormatMaxIndex(IndexFormat format)
+{
+    return (format == IndexFormat::UInt16 ? std::numeric_limits<std::uint16_t>::max() : std::numeric_limits<std::uint32_t>::max());
+}
+
+IndexFormat FindIndexFormat(TriangleMesh::VertexIndex maxIndex)
+{
+    const auto index = static_cast<std::uint64_t>(maxIndex);
+
+    if (index <= GetIndexFormatMaxIndex(IndexFormat::UInt16))
+        return IndexFormat::UInt16;
+    if (index <= GetIndexFormatMaxIndex(IndexFormat::UInt32))
+        return IndexFormat::UInt32;
+
+    ThrowIndexOutOfRange();
+    return IndexFormat::UInt32;
+}
+
+
+/* ----- IndexBuffer class ----- */
+
+IndexBuffer::IndexBuffer(IndexFormat format) :
+    format_ { format }
+{
+}
+
+IndexBuffer::IndexBuffer(const TriangleMesh& mesh)
+{
+    Append(mesh.triangles);
+}
+
+void IndexBuffer::Clear()
+{
+    indices16_.clear();
+    indices32_.clear();
+    maxIndex_ = 0;
+}
+
+void IndexBuffer::Reserve(std::size_t numTriangles)
+{
+    if (format_ == IndexFormat::UInt16)
+        indices16_.reserve(numTriangles * 3);
+    else
+        indices32_.reserve(numTriangles * 3);
+}
+
+IndexBuffer::TriangleIndex IndexBuffer::AddTriangle(VertexIndex v0, VertexIndex v1, VertexIndex v2)
+{
+    const auto maxIndex = std::max(v0, std::max(v1, v2));
+
+    if (static_cast<std::uint64_t>(maxIndex) > GetIndexFormatMaxIndex(format_))
+        Widen(maxIndex);
+
+    const auto triangleIndex = NumTriangles();
+
+    if (format_ == IndexFormat::UInt16)
+    {
+        indices16_.push_back(static_cast<std::uint16_t>(v0));
+        indices16_.push_back(static_cast<std::uint16_t>(v1));
+        indices16_.push_back(static_cast<std::uint16_t>(v2));
+    }
+    else
+    {
+        indices32_.push_back(static_cast<std::uint32_t>(v0));
+        indices32_.push_back(static_cast<std::uint32_t>(v1));
+        indices32_.push_back(static_cast<std::uint32_t>(v2));
+    }
+
+    maxIndex_ = std::max(maxIndex_, maxIndex);
+
+    return triangleIndex;
+}
+
+void IndexBuffer::Append(const std::vector<Triangle>& triangles, VertexIndex vertexOffset)
+{
+    if (triangles.empty())
+        return;
+
+    /* Validate all indices before the buffer is modified */
+    const auto maxIndex = FindMaxIndex(triangles, vertexOffset);
+
+    if (static_cast<std::uint64_t>(maxIndex) > GetIndexFormatMaxIndex(format_))
+        Widen(maxIndex);
+
+    /* Copy triangles into the current format */
+    const auto first = NumIndices();
+
+    if (format_ == IndexFormat::UInt16)
+    {
+        indices16_.resize(first + triangles.size() * 3);
+        CopyTriangles(indices16_.data() + first, triangles, vertexOffset);
+    }
+    else
+    {
+        indices32_.resize(first + triangles.size() * 3);
+        CopyTriangles(indices32_.data() + first, triangles, vertexOffset);
+    }
+
+    maxIndex_ = std::max(maxIndex_, maxIndex);
+}
+
+void IndexBuffer::Append(const IndexBuffer& other, VertexIndex vertexOffset)
+{
+    const auto count = other.NumIndices();
+    if (count == 0)
+        return;
+
+    /* Validate all indices before the buffer is modified */
+    const auto maxIndex32 = static_cast<VertexIndex>(std::numeric_limits<std::uint32_t>::max());
+
+    if (vertexOffset > maxIndex32 || other.maxIndex_ > maxIndex32 - vertexOffset)
+        ThrowIndexOutOfRange();
+
+    const auto maxIndex = other.maxIndex_ + vertexOffset;
+
+    if (static_cast<std::uint64_t>(maxIndex) > GetIndexFormatMaxIndex(format_))
+        Widen(maxIndex);
+
+    /* Copy indices into the current format (the other buffer may be this buffer) */
+    const auto first = NumIndices();
+
+    if (format_ == IndexFormat::UInt16)
+    {
+        indices16_.resize(first + count);
+        if (other.format_ == IndexFormat::UInt16)
+            CopyIndices(indices16_.data() + first, other.indices16_.data(), count, vertexOffset);
+        else
+            CopyIndices(indices16_.data() + first, other.indices32_.data(), count, vertexOffset);
+    }
+    else
+    {
+        indices32_.resize(first + count);
+        if (other.format_ == IndexFormat::UInt16)
+            CopyIndices(indices32_.data() + first, other.indices16_.data(), count, vertexOffset);
+        else
+            CopyIndices(indices32_.data() + first, other.indices32_.data(), count, vertexOffset);
+    }
+
+    maxIndex_ = std::max(maxIndex_, maxIndex);
+}
+
+void IndexBuffer::SetFormat(IndexFormat format)
+{
+    if (format_ == format)
+        return;
+
+    if (format == IndexFormat::UInt32)
+    {
+        /* Widen 16-bit indices into 32-bit indices */
+        indices32_.resize(indices16_.size());
+        CopyIndices(indices32_.data(), indices16_.data(), indices16_.size(), 0);
+        indices16_.clear();
+        indices16_.shrink_to_fit();
+    }
+    else
+    {
+        /* Narrow 32-bit indices into 16-bit indices if all indices fit */
+        if (static_cast<std::uint64_t>(maxIndex_) > GetIndexFormatMaxIndex(format))
+            throw std::out_of_range(GM_EXCEPT_INFO("vertex index does not fit into 16-bit index format"));
+
+        indices16_.resize(indices32_.size());
+        CopyIndices(indices16_.data(), indices32_.data(), indices32_.size(), 0);
+        indices32_.clear();
+        indices32_.shrink_to_fit();
+    }
+
+    format_ = format;
+}
+
+void IndexBuffer::ShrinkToFit()
+{
+    SetFormat(FindIndexFormat(maxIndex_));
+
+    if (format_ == IndexFormat::UInt16)
+        indices16_.shrink_to_fit();
+    else
+        indices32_.shrink_to_fit();
+}
+
+IndexBuffer::Triangle IndexBuffer::GetTriangle(TriangleIndex triangleIndex) const
+{
+    const auto i = triangleIndex * 3;
+    if (format_ == IndexFormat::UInt16)
+        return { indices16_[i], indices16_[i + 1], indices16_[i + 2] };
+    else
+        return { indices32_[i], indices32_[i + 1], indices32_[i + 2] };
+}
+
+std::vector<IndexBuffer::Triangle> IndexBuffer::ToTriangles() const
+{
+    std::vector<Triangle> triangles(NumTriangles());
+
+    ForEachTriangle(
+        [&triangles](TriangleIndex i, VertexIndex v0, VertexIndex v1, VertexIndex v2)
+        {
+            triangles[i] = { v0, v1, v2 };
+        }
+    );
+
+    return triangles;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void IndexBuffer::Widen(VertexIndex maxIndex)
+{
+    SetFormat(FindIndexFormat(maxIndex));
+}
+
+
+} // /namespace Gm
+
+
+
+// ================================================================================
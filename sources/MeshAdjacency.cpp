@@ -0,0 +1,265 @@
+/*
+ * MeshAdjacency.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshAdjacency.h>
+#include "ParallelDetails.h"
+#include "WeldDetails.h"
+#include <algorithm>
+#include <atomic>
+
+
+namespace Gm
+{
+
+
+/* ----- Internal functions ----- */
+
+static const std::size_t g_adjacencyGrainSize = 8192;
+
+// Calls the specified function for each unique vertex of the triangle (degenerated triangles reference a vertex more than once).
+template <typename Func>
+static void ForEachUniqueVertex(const TriangleMesh::Triangle& tri, const Func& func)
+{
+    func(tri.a);
+    if (tri.b != tri.a)
+        func(tri.b);
+    if (tri.c != tri.a && tri.c != tri.b)
+        func(tri.c);
+}
+
+
+/* ----- MeshAdjacency class ----- */
+
+MeshAdjacency::MeshAdjacency(const TriangleMesh& mesh, bool weldByPosition)
+{
+    Build(mesh, weldByPosition);
+}
+
+void MeshAdjacency::Build(const TriangleMesh& mesh, bool weldByPosition)
+{
+    Clear();
+
+    numVertices_    = mesh.vertices.size();
+    numTriangles_   = mesh.triangles.size();
+    weldByPosition_ = weldByPosition;
+
+    BuildVertexTriangles(mesh);
+
+    if (weldByPosition)
+    {
+        BuildWeldIndices(mesh);
+        BuildPositionTriangles();
+    }
+}
+
+void MeshAdjacency::Clear()
+{
+    numVertices_    = 0;
+    numTriangles_   = 0;
+    weldByPosition_ = false;
+
+    vertexOffsets_.clear();
+    vertexTriangles_.clear();
+    weldIndices_.clear();
+    positionOffsets_.clear();
+    positionTriangles_.clear();
+}
+
+MeshAdjacency::TriangleRange MeshAdjacency::VertexTriangles(VertexIndex vertexIndex) const
+{
+    GS_ASSERT(vertexIndex < numVertices_);
+    const auto data = vertexTriangles_.data();
+    return TriangleRange(data + vertexOffsets_[vertexIndex], data + vertexOffsets_[vertexIndex + 1]);
+}
+
+MeshAdjacency::TriangleRange MeshAdjacency::PositionTriangles(VertexIndex vertexIndex) const
+{
+    if (weldByPosition_)
+    {
+        GS_ASSERT(vertexIndex < numVertices_);
+        const auto data = positionTriangles_.data();
+        const auto rep  = weldIndices_[vertexIndex];
+        return TriangleRange(data + positionOffsets_[rep], data + positionOffsets_[rep + 1]);
+    }
+    return VertexTriangles(vertexIndex);
+}
+
+MeshAdjacency::VertexIndex MeshAdjacency::WeldedVertex(VertexIndex vertexIndex) const
+{
+    GS_ASSERT(vertexIndex < numVertices_);
+    return (weldByPosition_ ? weldIndices_[vertexIndex] : vertexIndex);
+}
+
+void MeshAdjacency::EdgeTriangles(const TriangleMesh& mesh, const Edge& edge, std::vector<TriangleIndex>& triangleIndices) const
+{
+    GS_ASSERT(IsBuiltFor(mesh));
+
+    triangleIndices.clear();
+
+    auto HasEdge = [](const TriangleMesh::Triangle& tri, VertexIndex v0, VertexIndex v1)
+    {
+        return
+            ( tri.a == v0 && tri.b == v1 ) ||
+            ( tri.b == v0 && tri.c == v1 ) ||
+            ( tri.c == v0 && tri.a == v1 );
+    };
+
+    /* Only visit the triangles around the vertex with the smaller degree */
+    auto rangeA = VertexTriangles(edge.a);
+    auto rangeB = VertexTriangles(edge.b);
+
+    for (auto i : (rangeA.size() <= rangeB.size() ? rangeA : rangeB))
+    {
+        const auto& tri = mesh.triangles[i];
+        if (HasEdge(tri, edge.a, edge.b) || HasEdge(tri, edge.b, edge.a))
+            triangleIndices.push_back(i);
+    }
+}
+
+void MeshAdjacency::BuildVertexTriangles(const TriangleMesh& mesh)
+{
+    const auto& triangles = mesh.triangles;
+
+    /* Count number of triangles per vertex */
+    std::vector<std::atomic<TriangleIndex>> counters(numVertices_);
+
+    Details::ParallelFor(
+        numTriangles_, g_adjacencyGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                ForEachUniqueVertex(
+                    triangles[i],
+                    [&counters](VertexIndex v)
+                    {
+                        counters[v].fetch_add(1, std::memory_order_relaxed);
+                    }
+                );
+            }
+        }
+    );
+
+    /* Build CSR offsets with an exclusive prefix sum and reuse the counters as write cursors */
+    vertexOffsets_.resize(numVertices_ + 1);
+    vertexOffsets_[0] = 0;
+
+    for (std::size_t v = 0; v < numVertices_; ++v)
+    {
+        const auto count = counters[v].load(std::memory_order_relaxed);
+        counters[v].store(vertexOffsets_[v], std::memory_order_relaxed);
+        vertexOffsets_[v + 1] = vertexOffsets_[v] + count;
+    }
+
+    /* Scatter triangle indices into their vertex ranges */
+    vertexTriangles_.resize(vertexOffsets_[numVertices_]);
+
+    Details::ParallelFor(
+        numTriangles_, g_adjacencyGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                ForEachUniqueVertex(
+                    triangles[i],
+                    [&](VertexIndex v)
+                    {
+                        vertexTriangles_[counters[v].fetch_add(1, std::memory_order_relaxed)] = i;
+                    }
+                );
+            }
+        }
+    );
+
+    /* Sort each range to keep the result deterministic (the scatter order depends on the thread scheduling) */
+    Details::ParallelFor(
+        numVertices_, g_adjacencyGrainSize,
+        [this](std::size_t begin, std::size_t end)
+        {
+            for (auto v = begin; v < end; ++v)
+                std::sort(vertexTriangles_.begin() + vertexOffsets_[v], vertexTriangles_.begin() + vertexOffsets_[v + 1]);
+        }
+    );
+}
+
+void MeshAdjacency::BuildWeldIndices(const TriangleMesh& mesh)
+{
+    weldIndices_.resize(numVertices_);
+
+    if (numVertices_ == 0)
+        return;
+
+    /* Find equal positions with the spatial hash of the vertex welding (the default tolerance is the same as for 'Gs::Equals') */
+    const auto candidates = MeshModifier::FindWeldCandidates(mesh.vertices, MeshModifier::WeldDescriptor());
+
+    /* Each candidate has a smaller index, so its representative is already final */
+    for (VertexIndex v = 0; v < numVertices_; ++v)
+        weldIndices_[v] = (candidates[v] == v ? v : weldIndices_[candidates[v]]);
+}
+
+void MeshAdjacency::BuildPositionTriangles()
+{
+    /* Count upper bound of triangles per representative */
+    positionOffsets_.assign(numVertices_ + 1, 0);
+
+    for (VertexIndex v = 0; v < numVertices_; ++v)
+        positionOffsets_[weldIndices_[v] + 1] += (vertexOffsets_[v + 1] - vertexOffsets_[v]);
+
+    for (std::size_t v = 0; v < numVertices_; ++v)
+        positionOffsets_[v + 1] += positionOffsets_[v];
+
+    /* Gather triangles of all vertices into the range of their representative */
+    positionTriangles_.resize(positionOffsets_[numVertices_]);
+
+    std::vector<TriangleIndex> cursors(positionOffsets_.begin(), positionOffsets_.end() - 1);
+
+    for (VertexIndex v = 0; v < numVertices_; ++v)
+    {
+        auto& cursor = cursors[weldIndices_[v]];
+        for (auto i : VertexTriangles(v))
+            positionTriangles_[cursor++] = i;
+    }
+
+    /* Sort each range and remove triangles that are connected to more than one vertex of the same group */
+    Details::ParallelFor(
+        numVertices_, g_adjacencyGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto v = begin; v < end; ++v)
+            {
+                auto first  = positionTriangles_.begin() + positionOffsets_[v];
+                auto last   = positionTriangles_.begin() + positionOffsets_[v + 1];
+                std::sort(first, last);
+                cursors[v]  = static_cast<TriangleIndex>(std::unique(first, last) - positionTriangles_.begin());
+            }
+        }
+    );
+
+    /* Compact ranges (cursors now hold the end of each unique range) */
+    TriangleIndex writeOffset = 0;
+
+    for (std::size_t v = 0; v < numVertices_; ++v)
+    {
+        const auto first    = positionOffsets_[v];
+        const auto last     = cursors[v];
+
+        positionOffsets_[v] = writeOffset;
+
+        for (auto i = first; i < last; ++i)
+            positionTriangles_[writeOffset++] = positionTriangles_[i];
+    }
+
+    positionOffsets_[numVertices_] = writeOffset;
+    positionTriangles_.resize(writeOffset);
+}
+
+
+} // /namespace Gm
+
+
+
+// ================================================================================
@@ -0,0 +1,542 @@
+/*
+ * MeshClipper.cpp
+ *
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshClipper.h>
+#include <Geom/TriangleMeshSoA.h>
+#include <Geom/PlaneCollision.h>
+#include "ParallelDetails.h"
+#include <algorithm>
+
+
+namespace Gm
+{
+
+
+/* ----- Internal functions ----- */
+
+using VertexIndex = TriangleMesh::VertexIndex;
+
+// Minimal number of triangles per thread.
+static const std::size_t g_clipGrainSize = 4096;
+
+// Minimal number of vertices per thread for the plane distances and output vertices.
+static const std::size_t g_vertexGrainSize = 16384;
+
+// Bit of the chunk triangle entries that refer to new vertices.
+static const VertexIndex g_newVertexBit = (VertexIndex(1) << (sizeof(VertexIndex)*8 - 1));
+
+static TriangleMesh::Vertex LerpVertex(const TriangleMesh::Vertex& a, const TriangleMesh::Vertex& b, Gs::Real t)
+{
+    return TriangleMesh::Vertex(
+        a.position + (b.position - a.position) * t,
+        a.normal   + (b.normal   - a.normal  ) * t,
+        a.texCoord + (b.texCoord - a.texCoord) * t
+    );
+}
+
+
+/* ----- MeshClipper class ----- */
+
+const MeshClipper::VertexIndex MeshClipper::invalidIndex;
+
+void MeshClipper::Clip(const TriangleMesh& mesh, const Plane& clipPlane, TriangleMesh& front, TriangleMesh& back)
+{
+    const auto view = MakeMeshView(mesh);
+
+    ComputeDistances(view, &clipPlane, 1);
+
+    /* Keep the front side (negated distances) and the back side (without coplanar triangles) */
+    ClipSide(view, &clipPlane, 1, Gs::Real(-1), true, sides_[0], front.triangles);
+    GenerateVertices(mesh, sides_[0], front);
+
+    ClipSide(view, &clipPlane, 1, Gs::Real(1), false, sides_[1], back.triangles);
+    GenerateVertices(mesh, sides_[1], back);
+}
+
+void MeshClipper::Clip(const TriangleMeshSoA& mesh, const Plane& clipPlane, TriangleMeshSoA& front, TriangleMeshSoA& back)
+{
+    const auto view = MakeMeshView(mesh);
+
+    ComputeDistances(view, &clipPlane, 1);
+
+    ClipSide(view, &clipPlane, 1, Gs::Real(-1), true, sides_[0], front.triangles);
+    GenerateVertices(mesh, sides_[0], front);
+
+    ClipSide(view, &clipPlane, 1, Gs::Real(1), false, sides_[1], back.triangles);
+    GenerateVertices(mesh, sides_[1], back);
+}
+
+void MeshClipper::ClipConvex(const TriangleMesh& mesh, const Plane* planes, std::size_t numPlanes, TriangleMesh& inside)
+{
+    const auto view = MakeMeshView(mesh);
+
+    ComputeDistances(view, planes, numPlanes);
+    ClipSide(view, planes, numPlanes, Gs::Real(1), true, sides_[0], inside.triangles);
+    GenerateVertices(mesh, sides_[0], inside);
+
+    sides_[1].remap.clear();
+    sides_[1].refs.clear();
+}
+
+void MeshClipper::ClipConvex(const TriangleMesh& mesh, const ConvexHull& convexHull, TriangleMesh& inside)
+{
+    ClipConvex(mesh, convexHull.planes.data(), convexHull.planes.size(), inside);
+}
+
+void MeshClipper::ClipConvex(const TriangleMesh& mesh, const Frustum& frustum, TriangleMesh& inside)
+{
+    const Plane planes[] =
+    {
+        frustum.GetPlane(FrustumPlane::Near),
+        frustum.GetPlane(FrustumPlane::Left),
+        frustum.GetPlane(FrustumPlane::Right),
+        frustum.GetPlane(FrustumPlane::Top),
+        frustum.GetPlane(FrustumPlane::Bottom),
+        frustum.GetPlane(FrustumPlane::Far),
+    };
+    ClipConvex(mesh, planes, 6, inside);
+}
+
+void MeshClipper::Clip(const MeshView& mesh, const Plane& clipPlane)
+{
+    ComputeDistances(mesh, &clipPlane, 1);
+    ClipSide(mesh, &clipPlane, 1, Gs::Real(-1), true, sides_[0], sides_[0].triangles);
+    ClipSide(mesh, &clipPlane, 1, Gs::Real(1), false, sides_[1], sides_[1].triangles);
+}
+
+void MeshClipper::ClipConvex(const MeshView& mesh, const Plane* planes, std::size_t numPlanes)
+{
+    ComputeDistances(mesh, planes, numPlanes);
+    ClipSide(mesh, planes, numPlanes, Gs::Real(1), true, sides_[0], sides_[0].triangles);
+
+    sides_[1].remap.clear();
+    sides_[1].refs.clear();
+    sides_[1].triangles.clear();
+}
+
+void MeshClipper::Clear()
+{
+    distances_.clear();
+    distances_.shrink_to_fit();
+
+    for (auto& side : sides_)
+    {
+        side.remap.clear();
+        side.remap.shrink_to_fit();
+        side.chunks.clear();
+        side.chunks.shrink_to_fit();
+        side.refs.clear();
+        side.refs.shrink_to_fit();
+        side.triangles.clear();
+        side.triangles.shrink_to_fit();
+    }
+
+    edgeVertices_.clear();
+
+    interiorIndices_.clear();
+    interiorIndices_.shrink_to_fit();
+    interiorTriangles_.clear();
+    interiorTriangles_.shrink_to_fit();
+    interiorCoords_.clear();
+    interiorCoords_.shrink_to_fit();
+    interiorVertices_.clear();
+    interiorVertices_.shrink_to_fit();
+
+    viewPositions_.clear();
+    viewPositions_.shrink_to_fit();
+    viewTriangles_.clear();
+    viewTriangles_.shrink_to_fit();
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+std::size_t MeshClipper::EdgeKeyHash::operator () (const EdgeKey& key) const
+{
+    auto h = static_cast<std::size_t>(key.a) * std::size_t(0x9E3779B1u);
+    h ^= static_cast<std::size_t>(key.b) + std::size_t(0x7F4A7C15u) + (h << 6) + (h >> 2);
+    h ^= static_cast<std::size_t>(key.plane) + std::size_t(0x7F4A7C15u) + (h << 6) + (h >> 2);
+    return h;
+}
+
+void MeshClipper::ComputeDistances(const MeshView& mesh, const Plane* planes, std::size_t numPlanes)
+{
+    const auto& positions = mesh.Positions();
+
+    distances_.resize(positions.Size() * numPlanes);
+
+    Details::ParallelFor(
+        positions.Size(),
+        g_vertexGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto p = positions[i];
+                for (std::size_t j = 0; j < numPlanes; ++j)
+                    distances_[i*numPlanes + j] = SgnDistanceToPlane(planes[j], p);
+            }
+        }
+    );
+}
+
+void MeshClipper::ClipSide(
+    const MeshView&                         mesh,
+    const Plane*                            planes,
+    std::size_t                             numPlanes,
+    Gs::Real                                sideSign,
+    bool                                    keepCoplanar,
+    Side&                                   side,
+    std::vector<TriangleMesh::Triangle>&    triangles)
+{
+    const auto numTriangles = mesh.NumTriangles();
+
+    /* Clip triangle chunks in parallel (the chunk outputs keep their memory between calls) */
+    side.chunks.resize(Details::GetParallelChunkCount(numTriangles, g_clipGrainSize));
+
+    Details::ParallelForChunks(
+        numTriangles,
+        g_clipGrainSize,
+        [&](std::size_t chunk, std::size_t begin, std::size_t end)
+        {
+            ClipTriangleRange(mesh, planes, numPlanes, sideSign, keepCoplanar, begin, end, side.chunks[chunk]);
+        }
+    );
+
+    ResolveOutput(mesh.NumVertices(), side, triangles);
+}
+
+void MeshClipper::ClipTriangleRange(
+    const MeshView&     mesh,
+    const Plane*        planes,
+    std::size_t         numPlanes,
+    Gs::Real            sideSign,
+    bool                keepCoplanar,
+    std::size_t         begin,
+    std::size_t         end,
+    ChunkOutput&        chunk) const
+{
+    const auto& positions   = mesh.Positions();
+    const auto  epsilon     = Gs::Epsilon<Gs::Real>();
+
+    chunk.refs.clear();
+    chunk.triangles.clear();
+
+    auto& polygon           = chunk.polygon;
+    auto& clipped           = chunk.clippedPolygon;
+    auto& polygonDistances  = chunk.polygonDistances;
+
+    auto Distance = [&](VertexIndex v, std::size_t plane)
+    {
+        return distances_[v*numPlanes + plane] * sideSign;
+    };
+
+    for (auto triIdx = begin; triIdx < end; ++triIdx)
+    {
+        const auto& tri = mesh.Indices(triIdx);
+
+        /* Classify triangle against all planes with the precomputed vertex distances */
+        bool discard = false, needsClip = false, coplanar = true;
+
+        for (std::size_t j = 0; j < numPlanes && !discard; ++j)
+        {
+            const auto da = Distance(tri.a, j), db = Distance(tri.b, j), dc = Distance(tri.c, j);
+
+            if (da > epsilon && db > epsilon && dc > epsilon)
+                discard = true;
+            else if (da > epsilon || db > epsilon || dc > epsilon)
+                needsClip = true;
+
+            if (std::abs(da) > epsilon || std::abs(db) > epsilon || std::abs(dc) > epsilon)
+                coplanar = false;
+        }
+
+        if (discard || (coplanar && !keepCoplanar))
+            continue;
+
+        if (!needsClip)
+        {
+            /* Keep triangle with its original vertices */
+            chunk.triangles.push_back(tri.a);
+            chunk.triangles.push_back(tri.b);
+            chunk.triangles.push_back(tri.c);
+            continue;
+        }
+
+        /* Setup polygon with the triangle corners */
+        const VertexIndex corners[3] = { tri.a, tri.b, tri.c };
+
+        polygon.clear();
+        polygon.push_back({ positions[tri.a], Gs::Vector3(1, 0, 0), 0x5, tri.a });
+        polygon.push_back({ positions[tri.b], Gs::Vector3(0, 1, 0), 0x3, tri.b });
+        polygon.push_back({ positions[tri.c], Gs::Vector3(0, 0, 1), 0x6, tri.c });
+
+        /* Clip polygon against each plane (Sutherland-Hodgman) */
+        for (std::size_t j = 0; j < numPlanes && polygon.size() >= 3; ++j)
+        {
+            const auto& plane = planes[j];
+
+            polygonDistances.resize(polygon.size());
+            bool allInside = true;
+
+            for (std::size_t i = 0; i < polygon.size(); ++i)
+            {
+                const auto& p = polygon[i];
+                polygonDistances[i] = ((p.entry & g_newVertexBit) == 0 ? Distance(p.entry, j) : SgnDistanceToPlane(plane, p.position) * sideSign);
+                if (polygonDistances[i] > epsilon)
+                    allInside = false;
+            }
+
+            if (allInside)
+                continue;
+
+            clipped.clear();
+
+            for (std::size_t i = 0, n = polygon.size(); i < n; ++i)
+            {
+                const auto  k   = (i + 1) % n;
+                const auto& p   = polygon[i];
+                const auto& q   = polygon[k];
+                const auto  dp  = polygonDistances[i];
+                const auto  dq  = polygonDistances[k];
+
+                if (dp <= epsilon)
+                    clipped.push_back(p);
+
+                if ((dp < -epsilon && dq > epsilon) || (dp > epsilon && dq < -epsilon))
+                {
+                    PolygonVertex v;
+                    VertexRef ref;
+
+                    ref.plane = static_cast<std::uint32_t>(j);
+
+                    if (const auto edgeMask = static_cast<std::uint8_t>(p.edgeMask & q.edgeMask))
+                    {
+                        /* Intersect original edge in canonical order, so adjacent triangles compute the same vertex */
+                        const auto edge = (edgeMask == 0x1 ? 0 : edgeMask == 0x2 ? 1 : 2);
+                        auto lo = edge, hi = (edge + 1) % 3;
+
+                        if (corners[hi] < corners[lo])
+                            std::swap(lo, hi);
+
+                        const auto dlo  = distances_[corners[lo]*numPlanes + j];
+                        const auto dhi  = distances_[corners[hi]*numPlanes + j];
+                        const auto t    = dlo / (dlo - dhi);
+
+                        const auto plo  = positions[corners[lo]];
+                        const auto phi  = positions[corners[hi]];
+
+                        v.position      = plo + (phi - plo) * t;
+                        v.barycentric   = Gs::Vector3(0, 0, 0);
+                        v.barycentric[lo] = Gs::Real(1) - t;
+                        v.barycentric[hi] = t;
+                        v.edgeMask      = edgeMask;
+
+                        ref.type        = VertexRef::Type::Edge;
+                        ref.index       = corners[lo];
+                        ref.index2      = corners[hi];
+                        ref.barycentric = Gs::Vector3(t, 0, 0);
+                    }
+                    else
+                    {
+                        /* Intersect interior segment of the polygon */
+                        const auto t = dp / (dp - dq);
+
+                        v.position      = p.position + (q.position - p.position) * t;
+                        v.barycentric   = p.barycentric + (q.barycentric - p.barycentric) * t;
+                        v.edgeMask      = 0;
+
+                        ref.type        = VertexRef::Type::Interior;
+                        ref.index       = triIdx;
+                        ref.index2      = 0;
+                        ref.barycentric = v.barycentric;
+                    }
+
+                    v.entry = (static_cast<VertexIndex>(chunk.refs.size()) | g_newVertexBit);
+                    chunk.refs.push_back(ref);
+                    clipped.push_back(v);
+                }
+            }
+
+            std::swap(polygon, clipped);
+        }
+
+        /* Triangulate clipped polygon as triangle fan */
+        for (std::size_t i = 2; i < polygon.size(); ++i)
+        {
+            chunk.triangles.push_back(polygon[0].entry);
+            chunk.triangles.push_back(polygon[i - 1].entry);
+            chunk.triangles.push_back(polygon[i].entry);
+        }
+    }
+}
+
+void MeshClipper::ResolveOutput(std::size_t numVertices, Side& side, std::vector<TriangleMesh::Triangle>& triangles)
+{
+    auto& refs = side.refs;
+
+    side.remap.assign(numVertices, invalidIndex);
+    edgeVertices_.clear();
+    refs.clear();
+
+    std::size_t numTriangleEntries = 0;
+    for (const auto& chunk : side.chunks)
+        numTriangleEntries += chunk.triangles.size();
+
+    triangles.resize(numTriangleEntries / 3);
+
+    /* Assign output vertex indices in the order of their first use, so the output is independent of the chunk sizes */
+    auto ResolveEntry = [&](const ChunkOutput& chunk, VertexIndex entry) -> VertexIndex
+    {
+        if ((entry & g_newVertexBit) == 0)
+        {
+            auto& index = side.remap[entry];
+            if (index == invalidIndex)
+            {
+                index = refs.size();
+                VertexRef ref;
+                ref.type    = VertexRef::Type::Original;
+                ref.index   = entry;
+                refs.push_back(ref);
+            }
+            return index;
+        }
+
+        const auto& ref = chunk.refs[entry & ~g_newVertexBit];
+
+        if (ref.type == VertexRef::Type::Edge)
+        {
+            /* Share vertices on the same edge and plane */
+            auto result = edgeVertices_.insert({ EdgeKey{ ref.index, ref.index2, ref.plane }, refs.size() });
+            if (!result.second)
+                return result.first->second;
+        }
+
+        refs.push_back(ref);
+        return refs.size() - 1;
+    };
+
+    std::size_t triIdx = 0;
+
+    for (const auto& chunk : side.chunks)
+    {
+        for (std::size_t i = 0; i < chunk.triangles.size(); i += 3, ++triIdx)
+        {
+            auto& tri = triangles[triIdx];
+            tri.a = ResolveEntry(chunk, chunk.triangles[i    ]);
+            tri.b = ResolveEntry(chunk, chunk.triangles[i + 1]);
+            tri.c = ResolveEntry(chunk, chunk.triangles[i + 2]);
+        }
+    }
+}
+
+void MeshClipper::GenerateVertices(const TriangleMesh& mesh, const Side& side, TriangleMesh& output)
+{
+    const auto& vertices    = mesh.vertices;
+    const auto& refs        = side.refs;
+
+    output.ClearAdjacency();
+
+    /* Interpolate all interior vertices in one batch with the specialized vertex layout */
+    interiorIndices_.clear();
+    interiorTriangles_.clear();
+    interiorCoords_.clear();
+
+    for (std::size_t i = 0; i < refs.size(); ++i)
+    {
+        const auto& ref = refs[i];
+        if (ref.type == VertexRef::Type::Interior)
+        {
+            interiorIndices_.push_back(i);
+            interiorTriangles_.push_back(ref.index);
+            interiorCoords_.push_back(ref.barycentric);
+        }
+    }
+
+    interiorVertices_.resize(interiorIndices_.size());
+    mesh.Barycentric(interiorTriangles_.data(), interiorCoords_.data(), interiorIndices_.size(), interiorVertices_.data());
+
+    /* Generate the remaining output vertices in parallel */
+    output.vertices.resize(refs.size());
+
+    Details::ParallelFor(
+        refs.size(),
+        g_vertexGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto& ref = refs[i];
+                switch (ref.type)
+                {
+                    case VertexRef::Type::Original:
+                        output.vertices[i] = vertices[ref.index];
+                        break;
+
+                    case VertexRef::Type::Edge:
+                        output.vertices[i] = LerpVertex(vertices[ref.index], vertices[ref.index2], ref.barycentric.x);
+                        break;
+
+                    case VertexRef::Type::Interior:
+                        break;
+                }
+            }
+        }
+    );
+
+    for (std::size_t i = 0; i < interiorIndices_.size(); ++i)
+        output.vertices[interiorIndices_[i]] = interiorVertices_[i];
+}
+
+void MeshClipper::GenerateVertices(const TriangleMeshSoA& mesh, const Side& side, TriangleMeshSoA& output) const
+{
+    const auto& refs = side.refs;
+
+    /* Generate output vertices in parallel, with the same interpolation as for the interleaved layout */
+    output.ResizeVertices(refs.size());
+
+    Details::ParallelFor(
+        refs.size(),
+        g_vertexGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto& ref = refs[i];
+
+                TriangleMesh::Vertex v;
+                switch (ref.type)
+                {
+                    case VertexRef::Type::Original:
+                        v = mesh.GetVertex(ref.index);
+                        break;
+
+                    case VertexRef::Type::Edge:
+                        v = LerpVertex(mesh.GetVertex(ref.index), mesh.GetVertex(ref.index2), ref.barycentric.x);
+                        break;
+
+                    case VertexRef::Type::Interior:
+                        v = mesh.Barycentric(ref.index, ref.barycentric);
+                        break;
+                }
+
+                output.SetPosition(i, v.position);
+                output.normals[i]   = v.normal;
+                output.texCoords[i] = v.texCoord;
+            }
+        }
+    );
+}
+
+
+} // /namespace Gm
+
+
+
+// ================================================================================
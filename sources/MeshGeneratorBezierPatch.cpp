@@ -15,72 +15,99 @@ namespace MeshGenerator
 {
 
 
-void GenerateBezierPatch(const BezierPatchDescriptor& desc, TriangleMesh& mesh)
+static void GenerateBezierPatchPrimary(const BezierPatchDescriptor& desc, MeshWriter& mesh)
 {
-    const auto idxOffset    = mesh.vertices.size();
-
     const auto segsHorz     = std::max(1u, desc.segments.x);
     const auto segsVert     = std::max(1u, desc.segments.y);
 
     const auto invHorz      = Gs::Real(1) / static_cast<Gs::Real>(segsHorz);
     const auto invVert      = Gs::Real(1) / static_cast<Gs::Real>(segsVert);
 
-    auto AddQuad = [&](std::uint32_t u, std::uint32_t v, VertexIndex i0, VertexIndex i1, VertexIndex i2, VertexIndex i3)
-    {
-        if (desc.backFacing)
-            AddTriangulatedQuad(mesh, desc.alternateGrid, u, v, i1, i0, i3, i2, idxOffset);
-        else
-            AddTriangulatedQuad(mesh, desc.alternateGrid, u, v, i0, i1, i2, i3, idxOffset);
-    };
+    const auto strideHorz   = segsHorz + 1;
 
-    /* Generate vertices */
+    /* Generate vertices in parallel blocks of rows */
     static const Gs::Real delta = Gs::Real(0.01);
 
-    Gs::Vector3 coord, normal;
-    Gs::Vector2 texCoord;
+    const auto idxOffset    = mesh.AddVertices(strideHorz*(segsVert + 1));
 
-    for (std::uint32_t i = 0; i <= segsVert; ++i)
-    {
-        for (std::uint32_t j = 0; j <= segsHorz; ++j)
+    ParallelForRows(
+        segsVert + 1, strideHorz,
+        [&](std::uint32_t begin, std::uint32_t end)
         {
-            /* Compute coordinate and texture-coordinate */
-            texCoord.x = static_cast<Gs::Real>(j) * invHorz;
-            texCoord.y = static_cast<Gs::Real>(i) * invVert;
-
-            coord = desc.bezierPatch(texCoord.x, texCoord.y);
+            Gs::Vector3 coord, normal;
+            Gs::Vector2 texCoord;
 
-            /* Sample bezier patch to approximate normal */
-            auto uOffset = (desc.bezierPatch(texCoord.x + delta, texCoord.y) - coord);
-            auto vOffset = (desc.bezierPatch(texCoord.x, texCoord.y + delta) - coord);
-            normal = Gs::Cross(uOffset, vOffset).Normalized();
-
-            /* Add vertex */
-            if (!desc.backFacing)
+            for (std::uint32_t i = begin; i < end; ++i)
             {
-                texCoord.y = Gs::Real(1) - texCoord.y;
-                normal = -normal;
+                for (std::uint32_t j = 0; j <= segsHorz; ++j)
+                {
+                    /* Compute coordinate and texture-coordinate */
+                    texCoord.x = static_cast<Gs::Real>(j) * invHorz;
+                    texCoord.y = static_cast<Gs::Real>(i) * invVert;
+
+                    coord = desc.bezierPatch(texCoord.x, texCoord.y);
+
+                    /* Sample bezier patch to approximate normal */
+                    auto uOffset = (desc.bezierPatch(texCoord.x + delta, texCoord.y) - coord);
+                    auto vOffset = (desc.bezierPatch(texCoord.x, texCoord.y + delta) - coord);
+                    normal = Gs::Cross(uOffset, vOffset).Normalized();
+
+                    /* Set vertex */
+                    if (!desc.backFacing)
+                    {
+                        texCoord.y = Gs::Real(1) - texCoord.y;
+                        normal = -normal;
+                    }
+
+                    mesh.SetVertex(idxOffset + i*strideHorz + j, coord, normal, texCoord);
+                }
             }
-
-            mesh.AddVertex(coord, normal, texCoord);
         }
-    }
+    );
 
-    /* Generate indices */
-    const auto strideHorz = segsHorz + 1;
+    /* Generate indices in parallel blocks of rows */
+    const auto triOffset    = mesh.AddTriangles(2*segsHorz*segsVert);
 
-    for (std::uint32_t v = 0; v < segsVert; ++v)
-    {
-        for (std::uint32_t u = 0; u < segsHorz; ++u)
+    ParallelForRows(
+        segsVert, segsHorz,
+        [&](std::uint32_t begin, std::uint32_t end)
         {
-            AddQuad(
-                u, v,
-                (  v   *strideHorz + u   ),
-                ( (v+1)*strideHorz + u   ),
-                ( (v+1)*strideHorz + u+1 ),
-                (  v   *strideHorz + u+1 )
-            );
+            for (std::uint32_t v = begin; v < end; ++v)
+            {
+                for (std::uint32_t u = 0; u < segsHorz; ++u)
+                {
+                    auto i0 = (  v   *strideHorz + u   );
+                    auto i1 = ( (v+1)*strideHorz + u   );
+                    auto i2 = ( (v+1)*strideHorz + u+1 );
+                    auto i3 = (  v   *strideHorz + u+1 );
+
+                    auto triIndex = triOffset + 2*(v*segsHorz + u);
+
+                    if (desc.backFacing)
+                        SetTriangulatedQuad(mesh, triIndex, desc.alternateGrid, u, v, i1, i0, i3, i2, idxOffset);
+                    else
+                        SetTriangulatedQuad(mesh, triIndex, desc.alternateGrid, u, v, i0, i1, i2, i3, idxOffset);
+                }
+            }
         }
-    }
+    );
+}
+
+MeshCounts CountBezierPatch(const BezierPatchDescriptor& desc)
+{
+    const std::size_t segsHorz  = std::max(1u, desc.segments.x);
+    const std::size_t segsVert  = std::max(1u, desc.segments.y);
+
+    MeshCounts counts;
+    counts.numVertices  = (segsHorz + 1)*(segsVert + 1);
+    counts.numTriangles = 2*segsHorz*segsVert;
+    return counts;
+}
+
+void GenerateBezierPatch(const BezierPatchDescriptor& desc, TriangleMesh& mesh)
+{
+    MeshWriter writer(mesh, CountBezierPatch(desc));
+    GenerateBezierPatchPrimary(desc, writer);
 }
 
 TriangleMesh GenerateBezierPatch(const BezierPatchDescriptor& desc)
@@ -90,6 +117,13 @@ TriangleMesh GenerateBezierPatch(const BezierPatchDescriptor& desc)
     return mesh;
 }
 
+MeshCounts GenerateBezierPatch(const BezierPatchDescriptor& desc, const MeshSpan& span)
+{
+    MeshWriter writer(span, CountBezierPatch(desc));
+    GenerateBezierPatchPrimary(desc, writer);
+    return writer.GetSpanCounts();
+}
+
 
 } // /namespace MeshGenerator
 
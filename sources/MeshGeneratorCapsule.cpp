@@ -6,7 +6,6 @@
  */
 
 #include "MeshGeneratorDetails.h"
-#include <Gauss/Spherical.h>
 
 
 namespace Gm
@@ -16,9 +15,9 @@ namespace MeshGenerator
 {
 
 
-void GenerateCapsule(const CapsuleDescriptor& desc, TriangleMesh& mesh)
+static void GenerateCapsulePrimary(const CapsuleDescriptor& desc, MeshWriter& mesh)
 {
-    const auto idxBaseOffset    = mesh.vertices.size();
+    const auto idxBaseOffset    = mesh.NumVertices();
 
     const auto segsHorz         = std::max(3u, desc.mantleSegments.x);
     const auto segsVert         = std::max(1u, desc.mantleSegments.y);
@@ -28,22 +27,20 @@ void GenerateCapsule(const CapsuleDescriptor& desc, TriangleMesh& mesh)
     const auto invVert          = Gs::Real(1) / static_cast<Gs::Real>(segsVert);
     const auto invSegsV         = Gs::Real(1) / static_cast<Gs::Real>(segsV);
 
-    const auto angleSteps       = invHorz * pi_2;
+    const auto ring             = GetRingBasis(segsHorz);
+    const auto ringTheta        = GetRingBasis(segsV, pi_0_5);
 
     const auto halfHeight       = desc.height*Gs::Real(0.5);
 
     /* Generate mantle vertices */
-    Gs::Spherical point(1, 0, 0);
     Gs::Vector3 coord, normal;
     Gs::Vector2 texCoord;
 
-    auto angle = Gs::Real(0);
-
     for (std::uint32_t u = 0; u <= segsHorz; ++u)
     {
         /* Compute X- and Z coordinates */
-        texCoord.x = std::sin(angle);
-        texCoord.y = std::cos(angle);
+        texCoord.x = ring->sin[u];
+        texCoord.y = ring->cos[u];
 
         coord.x = texCoord.x * desc.radius.x;
         coord.z = texCoord.y * desc.radius.z;
@@ -63,9 +60,6 @@ void GenerateCapsule(const CapsuleDescriptor& desc, TriangleMesh& mesh)
             coord.y = Gs::Lerp(halfHeight, -halfHeight, texCoord.y);
             mesh.AddVertex(coord, normal, texCoord);
         }
-
-        /* Increase angle for the next iteration */
-        angle += angleSteps;
     }
 
     /* Generate bottom and top cover vertices */
@@ -74,24 +68,27 @@ void GenerateCapsule(const CapsuleDescriptor& desc, TriangleMesh& mesh)
 
     for (std::size_t i = 0; i < 2; ++i)
     {
-        idxBaseOffsetEllipsoid[i] = mesh.vertices.size();
+        idxBaseOffsetEllipsoid[i] = mesh.NumVertices();
 
         for (std::uint32_t v = 0; v <= segsV; ++v)
         {
-            /* Compute theta of spherical coordinate */
+            /* Get theta of spherical coordinate from ring basis */
             texCoord.y = static_cast<Gs::Real>(v) * invSegsV;
-            point.theta = texCoord.y * pi_0_5;
+
+            const auto sinTheta = ringTheta->sin[v];
+            const auto cosTheta = ringTheta->cos[v];
 
             for (std::uint32_t u = 0; u <= segsHorz; ++u)
             {
-                /* Compute phi of spherical coordinate */
                 texCoord.x = static_cast<Gs::Real>(u) * invHorz;
-                point.phi = texCoord.x * pi_2 * coverSide[i] + pi_0_5;
 
-                /* Convert spherical coordinate into cartesian coordinate and set normal by coordinate */
-                coord = Gs::Vector3(point);
-                std::swap(coord.y, coord.z);
-                coord.y *= coverSide[i];
+                /*
+                Convert spherical coordinate into cartesian coordinate (with Y and Z swapped) and set normal by coordinate,
+                where phi = angle*side + pi/2, i.e. cos(phi) = -side*sin(angle) and sin(phi) = cos(angle)
+                */
+                coord.x = -sinTheta * ring->sin[u] * coverSide[i];
+                coord.y = cosTheta * coverSide[i];
+                coord.z = sinTheta * ring->cos[u];
 
                 /* Get normal and move half-sphere */
                 normal = coord.Normalized();
@@ -146,6 +143,25 @@ void GenerateCapsule(const CapsuleDescriptor& desc, TriangleMesh& mesh)
     }
 }
 
+MeshCounts CountCapsule(const CapsuleDescriptor& desc)
+{
+    const std::size_t segsHorz      = std::max(3u, desc.mantleSegments.x);
+    const std::size_t segsVert      = std::max(1u, desc.mantleSegments.y);
+    const std::size_t segsEllipsoid = std::max(2u, desc.ellipsoidSegments);
+
+    /* Mantle and top and bottom half-ellipsoids */
+    MeshCounts counts;
+    counts.numVertices  = (segsHorz + 1)*(segsVert + 1) + 2*(segsEllipsoid + 1)*(segsHorz + 1);
+    counts.numTriangles = 2*segsHorz*segsVert + 4*segsEllipsoid*segsHorz;
+    return counts;
+}
+
+void GenerateCapsule(const CapsuleDescriptor& desc, TriangleMesh& mesh)
+{
+    MeshWriter writer(mesh, CountCapsule(desc));
+    GenerateCapsulePrimary(desc, writer);
+}
+
 TriangleMesh GenerateCapsule(const CapsuleDescriptor& desc)
 {
     TriangleMesh mesh;
@@ -153,6 +169,13 @@ TriangleMesh GenerateCapsule(const CapsuleDescriptor& desc)
     return mesh;
 }
 
+MeshCounts GenerateCapsule(const CapsuleDescriptor& desc, const MeshSpan& span)
+{
+    MeshWriter writer(span, CountCapsule(desc));
+    GenerateCapsulePrimary(desc, writer);
+    return writer.GetSpanCounts();
+}
+
 
 } // /namespace MeshGenerator
 
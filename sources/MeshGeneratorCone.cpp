@@ -15,9 +15,9 @@ namespace MeshGenerator
 {
 
 
-void GenerateCone(const ConeDescriptor& desc, TriangleMesh& mesh)
+static void GenerateConePrimary(const ConeDescriptor& desc, MeshWriter& mesh)
 {
-    const auto idxBaseOffset    = mesh.vertices.size();
+    const auto idxBaseOffset    = mesh.NumVertices();
 
     const auto segsHorz         = std::max(3u, desc.mantleSegments.x);
     const auto segsVert         = std::max(1u, desc.mantleSegments.y);
@@ -26,7 +26,7 @@ void GenerateCone(const ConeDescriptor& desc, TriangleMesh& mesh)
     const auto invHorz          = Gs::Real(1) / static_cast<Gs::Real>(segsHorz);
     const auto invVert          = Gs::Real(1) / static_cast<Gs::Real>(segsVert);
 
-    const auto angleSteps       = invHorz * pi_2;
+    const auto ring             = GetRingBasis(segsHorz);
 
     const auto halfHeight       = desc.height*Gs::Real(0.5);
 
@@ -37,13 +37,11 @@ void GenerateCone(const ConeDescriptor& desc, TriangleMesh& mesh)
     const Gs::Vector3 tip(0, halfHeight, 0);
     coord.y = -halfHeight;
 
-    auto angle = Gs::Real(0);
-
     for (std::uint32_t u = 0; u <= segsHorz; ++u)
     {
         /* Compute X- and Z coordinates */
-        texCoord.x = std::sin(angle);
-        texCoord.y = std::cos(angle);
+        texCoord.x = ring->sin[u];
+        texCoord.y = ring->cos[u];
 
         coord.x = texCoord.x * desc.radius.x;
         coord.z = texCoord.y * desc.radius.y;
@@ -74,13 +72,9 @@ void GenerateCone(const ConeDescriptor& desc, TriangleMesh& mesh)
             texCoord.y = 0.0f;
             mesh.AddVertex(tip, { 0, 1, 0 }, texCoord);
         }
-
-        /* Increase angle for the next iteration */
-        angle += angleSteps;
     }
 
     /* Generate cover vertices */
-    angle = Gs::Real(0);
     VertexIndex coverIndexOffset = 0;
 
     if (segsCov > 0)
@@ -93,8 +87,8 @@ void GenerateCone(const ConeDescriptor& desc, TriangleMesh& mesh)
         for (std::uint32_t u = 0; u <= segsHorz; ++u)
         {
             /* Compute X- and Z coordinates */
-            texCoord.x = std::sin(angle);
-            texCoord.y = std::cos(angle);
+            texCoord.x = ring->sin[u];
+            texCoord.y = ring->cos[u];
 
             coord.x = texCoord.x * desc.radius.x;
             coord.z = texCoord.y * desc.radius.y;
@@ -111,9 +105,6 @@ void GenerateCone(const ConeDescriptor& desc, TriangleMesh& mesh)
                     texCoordFinal
                 );
             }
-
-            /* Increase angle for the next iteration */
-            angle += angleSteps;
         }
     }
 
@@ -161,6 +152,33 @@ void GenerateCone(const ConeDescriptor& desc, TriangleMesh& mesh)
     }
 }
 
+MeshCounts CountCone(const ConeDescriptor& desc)
+{
+    const std::size_t segsHorz  = std::max(3u, desc.mantleSegments.x);
+    const std::size_t segsVert  = std::max(1u, desc.mantleSegments.y);
+    const std::size_t segsCov   = desc.coverSegments;
+
+    /* Mantle with a separate tip vertex for each segment */
+    MeshCounts counts;
+    counts.numVertices  = (segsHorz + 1)*segsVert + segsHorz;
+    counts.numTriangles = segsHorz*(2*segsVert - 1);
+
+    /* Bottom cover with center vertex */
+    if (segsCov > 0)
+    {
+        counts.numVertices  += 1 + (segsHorz + 1)*segsCov;
+        counts.numTriangles += segsHorz*(2*segsCov - 1);
+    }
+
+    return counts;
+}
+
+void GenerateCone(const ConeDescriptor& desc, TriangleMesh& mesh)
+{
+    MeshWriter writer(mesh, CountCone(desc));
+    GenerateConePrimary(desc, writer);
+}
+
 TriangleMesh GenerateCone(const ConeDescriptor& desc)
 {
     TriangleMesh mesh;
@@ -168,6 +186,13 @@ TriangleMesh GenerateCone(const ConeDescriptor& desc)
     return mesh;
 }
 
+MeshCounts GenerateCone(const ConeDescriptor& desc, const MeshSpan& span)
+{
+    MeshWriter writer(span, CountCone(desc));
+    GenerateConePrimary(desc, writer);
+    return writer.GetSpanCounts();
+}
+
 
 } // /namespace MeshGenerator
 
@@ -17,7 +17,7 @@ namespace MeshGenerator
 
 
 static void BuildFace(
-    TriangleMesh&           mesh,
+    MeshWriter&             mesh,
     const Gs::Quaternion&   rotation,
     Gs::Real                sizeHorz,
     Gs::Real                sizeVert,
@@ -28,7 +28,7 @@ static void BuildFace(
 {
     sizeOffsetZ /= 2;
 
-    const auto idxOffset    = mesh.vertices.size();
+    const auto idxOffset    = mesh.NumVertices();
 
     const auto invHorz      = Gs::Real(1) / static_cast<Gs::Real>(segsHorz);
     const auto invVert      = Gs::Real(1) / static_cast<Gs::Real>(segsVert);
@@ -75,7 +75,7 @@ static void BuildFace(
     }
 };
 
-void GenerateCuboid(const CuboidDescriptor& desc, TriangleMesh& mesh)
+static void GenerateCuboidPrimary(const CuboidDescriptor& desc, MeshWriter& mesh)
 {
     auto segsX = std::max(1u, desc.segments.x);
     auto segsY = std::max(1u, desc.segments.y);
@@ -119,6 +119,25 @@ void GenerateCuboid(const CuboidDescriptor& desc, TriangleMesh& mesh)
     );
 }
 
+MeshCounts CountCuboid(const CuboidDescriptor& desc)
+{
+    const std::size_t segsX = std::max(1u, desc.segments.x);
+    const std::size_t segsY = std::max(1u, desc.segments.y);
+    const std::size_t segsZ = std::max(1u, desc.segments.z);
+
+    /* Two faces for each pair of dimensions */
+    MeshCounts counts;
+    counts.numVertices  = 2*((segsX + 1)*(segsY + 1) + (segsZ + 1)*(segsY + 1) + (segsX + 1)*(segsZ + 1));
+    counts.numTriangles = 4*(segsX*segsY + segsZ*segsY + segsX*segsZ);
+    return counts;
+}
+
+void GenerateCuboid(const CuboidDescriptor& desc, TriangleMesh& mesh)
+{
+    MeshWriter writer(mesh, CountCuboid(desc));
+    GenerateCuboidPrimary(desc, writer);
+}
+
 TriangleMesh GenerateCuboid(const CuboidDescriptor& desc)
 {
     TriangleMesh mesh;
@@ -126,6 +145,13 @@ TriangleMesh GenerateCuboid(const CuboidDescriptor& desc)
     return mesh;
 }
 
+MeshCounts GenerateCuboid(const CuboidDescriptor& desc, const MeshSpan& span)
+{
+    MeshWriter writer(span, CountCuboid(desc));
+    GenerateCuboidPrimary(desc, writer);
+    return writer.GetSpanCounts();
+}
+
 
 } // /namespace MeshGenerator
 
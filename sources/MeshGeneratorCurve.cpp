@@ -7,8 +7,11 @@
 
 #include "MeshGeneratorDetails.h"
 
+#include <Geom/Line.h>
+#include <Geom/LineCollision.h>
 #include <Gauss/Equals.h>
-#include <Gauss/RotateVector.h>
+#include <cmath>
+#include <utility>
 
 
 namespace Gm
@@ -18,97 +21,356 @@ namespace MeshGenerator
 {
 
 
-void GenerateCurve(const CurveDescriptor& desc, TriangleMesh& mesh)
+/* ----- Internal structures ----- */
+
+// Samples of the curve progression function which form the centers of the tube rings.
+struct CurveSamples
 {
-    const auto idxBaseOffset    = mesh.vertices.size();
+    std::vector<Gs::Real>       t;
+    std::vector<Gs::Vector3>    points;
+};
 
-    const auto segsU            = std::max(3u, desc.segments.x);
-    const auto segsV            = std::max(3u, desc.segments.y);
+// Frame of a tube ring, decomposed for the rotation of the ring normal around the tangent (Rodrigues' formula).
+struct CurveRingFrame
+{
+    Gs::Vector3 normal;
+    Gs::Vector3 binormal;
+    Gs::Vector3 axial;
+};
 
-    /* Sample curve progression function */
-    std::vector<Gs::Vector3> curveSamples(segsU, Gs::Vector3());
 
-    for (std::uint32_t i = 0; i < segsU; ++i)
+/* ----- Internal functions ----- */
+
+// Evaluates the curve at the specified progressions, with a single call to the batched curve function if available.
+static void EvaluateCurve(const CurveDescriptor& desc, const Gs::Real* t, Gs::Vector3* points, std::size_t count)
+{
+    if (desc.curveBatchFunction)
+        desc.curveBatchFunction(t, points, count);
+    else
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            points[i] = desc.curveFunction(t[i]);
+    }
+}
+
+/*
+Marks the samples which must be kept so that all other samples are within the tolerance of the polyline (Douglas-Peucker).
+The first and last samples are always kept.
+*/
+static void SimplifyCurveSamples(const std::vector<Gs::Vector3>& points, Gs::Real tolerance, std::vector<bool>& keep)
+{
+    const auto toleranceSq = tolerance*tolerance;
+
+    keep.assign(points.size(), false);
+    keep.front() = true;
+    keep.back() = true;
+
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+    ranges.push_back({ 0, points.size() - 1 });
+
+    while (!ranges.empty())
     {
-        auto t = static_cast<Gs::Real>(i) / (segsU - 1);
-        curveSamples[i] = desc.curveFunction(t);
+        auto range = ranges.back();
+        ranges.pop_back();
+
+        if (range.second - range.first < 2)
+            continue;
+
+        /* Find the sample with the largest distance to the chord of this range */
+        const Line3 chord(points[range.first], points[range.second]);
+        const bool degenerated = (Gs::DistanceSq(chord.a, chord.b) == Gs::Real(0));
+
+        auto maxDistSq  = Gs::Real(0);
+        auto maxIdx     = range.first;
+
+        for (auto i = range.first + 1; i < range.second; ++i)
+        {
+            auto distSq = (degenerated ? Gs::DistanceSq(chord.a, points[i]) : DistanceSqToLine(chord, points[i]));
+            if (distSq > maxDistSq)
+            {
+                maxDistSq   = distSq;
+                maxIdx      = i;
+            }
+        }
+
+        /* Keep that sample and subdivide the range if the chord error exceeds the tolerance */
+        if (maxDistSq > toleranceSq)
+        {
+            keep[maxIdx] = true;
+            ranges.push_back({ range.first, maxIdx });
+            ranges.push_back({ maxIdx, range.second });
+        }
     }
+}
 
-    /* Generate vertices */
-    Gs::Vector3 coord, normal, tangent, bitangent;
-    Gs::Vector2 texCoord;
+static void SampleCurve(const CurveDescriptor& desc, CurveSamples& samples)
+{
+    const auto segsU = std::max(3u, desc.segments.x);
+
+    /* Sample curve progression function uniformly with the maximal resolution */
+    samples.t.resize(segsU);
+    samples.points.resize(segsU);
+
+    for (std::uint32_t i = 0; i < segsU; ++i)
+        samples.t[i] = static_cast<Gs::Real>(i) / (segsU - 1);
 
-    for (std::uint32_t u = 0; u < segsU; ++u)
+    EvaluateCurve(desc, samples.t.data(), samples.points.data(), segsU);
+
+    if (desc.tolerance > Gs::Real(0))
     {
-        /* Compute texture X coordinate */
-        texCoord.x = static_cast<Gs::Real>(u) / (segsU - 1);
+        /* Only keep the samples which are required to stay within the chord error tolerance */
+        std::vector<bool> keep;
+        SimplifyCurveSamples(samples.points, desc.tolerance, keep);
+
+        /* At least three rings are required for a closed tube */
+        std::size_t numKept = std::count(keep.begin(), keep.end(), true);
+        if (numKept < 3)
+            keep[segsU / 2] = true;
 
-        for (std::uint32_t v = 0; v < segsV; ++v)
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < segsU; ++i)
         {
-            /* Compute tangent vector from center of this ring to the next center */
-            tangent = curveSamples[(u + 1) % (segsU - 1)] - curveSamples[u];
-            tangent.Normalize();
+            if (keep[i])
+            {
+                samples.t[n]        = samples.t[i];
+                samples.points[n]   = samples.points[i];
+                ++n;
+            }
+        }
+
+        samples.t.resize(n);
+        samples.points.resize(n);
+    }
+}
+
+static CurveRingFrame MakeCurveRingFrame(const Gs::Vector3& tangent, const Gs::Vector3& normal)
+{
+    CurveRingFrame frame;
+    frame.normal    = normal;
+    frame.binormal  = Gs::Cross(tangent, normal);
+    frame.axial     = tangent * Gs::Dot(tangent, normal);
+    return frame;
+}
+
+// Computes the frames of all rings once, either aligned to the Y axis or parallel transported along the curve.
+static void ComputeCurveRingFrames(const CurveDescriptor& desc, const std::vector<Gs::Vector3>& points, std::vector<CurveRingFrame>& frames)
+{
+    const auto numRings = points.size();
+
+    /* Compute tangent vectors from center of each ring to the next center */
+    std::vector<Gs::Vector3> tangents(numRings);
+
+    for (std::size_t u = 0; u < numRings; ++u)
+    {
+        tangents[u] = points[(u + 1) % (numRings - 1)] - points[u];
+        tangents[u].Normalize();
+    }
 
+    frames.resize(numRings);
+
+    if (!desc.parallelTransport)
+    {
+        Gs::Vector3 bitangent, normal;
+
+        for (std::size_t u = 0; u < numRings; ++u)
+        {
             /* Compute vector which is perpendicular to the tangent */
             //if (!Gs::Equals(Gs::Dot(Gs::Vector3(0, 1, 0), tangent), Gs::Real(1)))
                 bitangent = Gs::Vector3(0, 1, 0);
             /*else
                 bitangent = Gs::Vector3(1, 0, 0);*/
 
-            bitangent = Gs::Cross(bitangent, tangent);
-            normal = Gs::Cross(tangent, bitangent);
+            bitangent = Gs::Cross(bitangent, tangents[u]);
+            normal = Gs::Cross(tangents[u], bitangent);
             normal.Normalize();
 
-            /* Compute coordinate and normal */
-            texCoord.y = static_cast<Gs::Real>(v) / (segsV - 1);
+            frames[u] = MakeCurveRingFrame(tangents[u], normal);
+        }
+    }
+    else
+    {
+        /* Start with a normal which is perpendicular to the first tangent */
+        std::vector<Gs::Vector3> normals(numRings);
+
+        const auto up = (std::abs(tangents[0].y) < Gs::Real(0.99) ? Gs::Vector3(0, 1, 0) : Gs::Vector3(1, 0, 0));
+        normals[0] = Gs::Cross(tangents[0], Gs::Cross(up, tangents[0]));
+        normals[0].Normalize();
+
+        /* Transport the normal from ring to ring with the double reflection method (rotation-minimizing frames) */
+        auto curveLength = Gs::Real(0);
+
+        for (std::size_t u = 1; u < numRings; ++u)
+        {
+            const auto v1 = points[u] - points[u - 1];
+            const auto c1 = Gs::Dot(v1, v1);
 
-            normal = Gs::RotateVectorAroundAxis(normal, tangent, texCoord.y*pi_2);
+            curveLength += std::sqrt(c1);
+
+            if (c1 > Gs::Real(0))
+            {
+                const auto rL = normals[u - 1] - v1 * (Gs::Real(2)/c1 * Gs::Dot(v1, normals[u - 1]));
+                const auto tL = tangents[u - 1] - v1 * (Gs::Real(2)/c1 * Gs::Dot(v1, tangents[u - 1]));
+                const auto v2 = tangents[u] - tL;
+                const auto c2 = Gs::Dot(v2, v2);
+                normals[u] = (c2 > Gs::Real(0) ? rL - v2 * (Gs::Real(2)/c2 * Gs::Dot(v2, rL)) : rL);
+            }
+            else
+                normals[u] = normals[u - 1];
 
-            auto displacement = desc.radius;
-            if (desc.vertexModifier)
-                displacement *= desc.vertexModifier(texCoord.x, texCoord.y);
+            /* Keep the normal perpendicular to the tangent */
+            normals[u] -= tangents[u] * Gs::Dot(tangents[u], normals[u]);
+            normals[u].Normalize();
+        }
 
-            coord = curveSamples[u] + normal * displacement;
+        /* Distribute the remaining twist between the last and the first ring over all rings, if the curve is closed */
+        if (Gs::Distance(points.front(), points.back()) <= curveLength * Gs::Real(1.0e-4))
+        {
+            const auto& r0      = normals.front();
+            const auto& rN      = normals.back();
+            const auto  twist   = std::atan2(Gs::Dot(Gs::Cross(rN, r0), tangents.back()), Gs::Dot(rN, r0));
 
-            mesh.AddVertex(coord, normal, texCoord);
+            for (std::size_t u = 1; u < numRings; ++u)
+            {
+                const auto angle = twist * static_cast<Gs::Real>(u) / static_cast<Gs::Real>(numRings - 1);
+                normals[u] = normals[u] * std::cos(angle) + Gs::Cross(tangents[u], normals[u]) * std::sin(angle);
+            }
         }
+
+        for (std::size_t u = 0; u < numRings; ++u)
+            frames[u] = MakeCurveRingFrame(tangents[u], normals[u]);
     }
+}
 
-    /* Generate indices */
-    VertexIndex i0, i1, i2, i3;
+static MeshCounts CountCurveRings(const CurveDescriptor& desc, std::size_t numRings)
+{
+    const std::size_t segsV = std::max(3u, desc.segments.y);
 
-    for (std::uint32_t u = 0; u < segsU; ++u)
-    {
-        for (std::uint32_t v = 0; v < segsV; ++v)
-        {
-            i0 = u*segsV + v;
+    /* Closed rings without seam vertices */
+    MeshCounts counts;
+    counts.numVertices  = numRings*segsV;
+    counts.numTriangles = 2*numRings*segsV;
+    return counts;
+}
 
-            if (v + 1 < segsV)
-                i1 = u*segsV + v + 1;
-            else
-                i1 = u*segsV;
+static void GenerateCurvePrimary(const CurveDescriptor& desc, const CurveSamples& samples, MeshWriter& mesh)
+{
+    const auto numRings         = static_cast<std::uint32_t>(samples.points.size());
+    const auto segsV            = std::max(3u, desc.segments.y);
 
-            if (u + 1 < segsU)
+    /* Compute the frame of each ring once */
+    std::vector<CurveRingFrame> frames;
+    ComputeCurveRingFrames(desc, samples.points, frames);
+
+    /* Angles around each ring, where the last vertex of a ring reaches the full circle */
+    const auto ring             = GetRingBasis(segsV - 1);
+
+    /* Generate vertices in parallel blocks of rings */
+    const auto idxBaseOffset    = mesh.AddVertices(numRings*segsV);
+
+    ParallelForRows(
+        numRings, segsV,
+        [&](std::uint32_t begin, std::uint32_t end)
+        {
+            Gs::Vector3 coord, normal;
+            Gs::Vector2 texCoord;
+
+            for (std::uint32_t u = begin; u < end; ++u)
             {
-                i2 = (u + 1)*segsV + v;
-                if (v + 1 < segsV)
-                    i3 = (u + 1)*segsV + v + 1;
-                else
-                    i3 = (u + 1)*segsV;
+                /* Texture X coordinate is the curve progression of this ring */
+                texCoord.x = samples.t[u];
+
+                const auto& frame = frames[u];
+
+                for (std::uint32_t v = 0; v < segsV; ++v)
+                {
+                    /* Compute coordinate and normal (the rotation around the tangent equals 'Gs::RotateVectorAroundAxis' within rounding) */
+                    texCoord.y = static_cast<Gs::Real>(v) / (segsV - 1);
+
+                    const auto c = ring->cos[v];
+                    const auto s = ring->sin[v];
+
+                    normal = frame.normal * c + frame.binormal * s + frame.axial * (Gs::Real(1) - c);
+
+                    auto displacement = desc.radius;
+                    if (desc.vertexModifier)
+                        displacement *= desc.vertexModifier(texCoord.x, texCoord.y);
+
+                    coord = samples.points[u] + normal * displacement;
+
+                    mesh.SetVertex(idxBaseOffset + u*segsV + v, coord, normal, texCoord);
+                }
             }
-            else
+        }
+    );
+
+    /* Generate indices in parallel blocks of rings */
+    const auto triBaseOffset    = mesh.AddTriangles(2*numRings*segsV);
+
+    ParallelForRows(
+        numRings, segsV,
+        [&](std::uint32_t begin, std::uint32_t end)
+        {
+            VertexIndex i0, i1, i2, i3;
+
+            for (std::uint32_t u = begin; u < end; ++u)
             {
-                i2 = v;
-                if (v + 1 < segsV)
-                    i3 = v + 1;
-                else
-                    i3 = 0;
+                for (std::uint32_t v = 0; v < segsV; ++v)
+                {
+                    i0 = u*segsV + v;
+
+                    if (v + 1 < segsV)
+                        i1 = u*segsV + v + 1;
+                    else
+                        i1 = u*segsV;
+
+                    if (u + 1 < numRings)
+                    {
+                        i2 = (u + 1)*segsV + v;
+                        if (v + 1 < segsV)
+                            i3 = (u + 1)*segsV + v + 1;
+                        else
+                            i3 = (u + 1)*segsV;
+                    }
+                    else
+                    {
+                        i2 = v;
+                        if (v + 1 < segsV)
+                            i3 = v + 1;
+                        else
+                            i3 = 0;
+                    }
+
+                    /* Set the computed quad */
+                    SetTriangulatedQuad(mesh, triBaseOffset + 2*(u*segsV + v), desc.alternateGrid, u, v, i0, i1, i3, i2, idxBaseOffset);
+                }
             }
-
-            /* Add the computed quad */
-            AddTriangulatedQuad(mesh, desc.alternateGrid, u, v, i0, i1, i3, i2, idxBaseOffset);
         }
+    );
+}
+
+
+
+/* ----- Global functions ----- */
+
+MeshCounts CountCurve(const CurveDescriptor& desc)
+{
+    /* Adaptive ring placement depends on the curve itself */
+    if (desc.tolerance > Gs::Real(0))
+    {
+        CurveSamples samples;
+        SampleCurve(desc, samples);
+        return CountCurveRings(desc, samples.points.size());
     }
+    return CountCurveRings(desc, std::max(3u, desc.segments.x));
+}
+
+void GenerateCurve(const CurveDescriptor& desc, TriangleMesh& mesh)
+{
+    CurveSamples samples;
+    SampleCurve(desc, samples);
+
+    MeshWriter writer(mesh, CountCurveRings(desc, samples.points.size()));
+    GenerateCurvePrimary(desc, samples, writer);
 }
 
 TriangleMesh GenerateCurve(const CurveDescriptor& desc)
@@ -118,6 +380,16 @@ TriangleMesh GenerateCurve(const CurveDescriptor& desc)
     return mesh;
 }
 
+MeshCounts GenerateCurve(const CurveDescriptor& desc, const MeshSpan& span)
+{
+    CurveSamples samples;
+    SampleCurve(desc, samples);
+
+    MeshWriter writer(span, CountCurveRings(desc, samples.points.size()));
+    GenerateCurvePrimary(desc, samples, writer);
+    return writer.GetSpanCounts();
+}
+
 
 } // /namespace MeshGenerator
 
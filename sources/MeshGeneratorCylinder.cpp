@@ -15,9 +15,9 @@ namespace MeshGenerator
 {
 
 
-void GenerateCylinder(const CylinderDescriptor& desc, TriangleMesh& mesh)
+static void GenerateCylinderPrimary(const CylinderDescriptor& desc, MeshWriter& mesh)
 {
-    const auto idxBaseOffset    = mesh.vertices.size();
+    const auto idxBaseOffset    = mesh.NumVertices();
 
     const auto segsHorz         = std::max(3u, desc.mantleSegments.x);
     const auto segsVert         = std::max(1u, desc.mantleSegments.y);
@@ -25,7 +25,7 @@ void GenerateCylinder(const CylinderDescriptor& desc, TriangleMesh& mesh)
     const auto invHorz          = Gs::Real(1) / static_cast<Gs::Real>(segsHorz);
     const auto invVert          = Gs::Real(1) / static_cast<Gs::Real>(segsVert);
 
-    const auto angleSteps       = invHorz * pi_2;
+    const auto ring             = GetRingBasis(segsHorz);
 
     const auto halfHeight       = desc.height*Gs::Real(0.5);
 
@@ -33,13 +33,11 @@ void GenerateCylinder(const CylinderDescriptor& desc, TriangleMesh& mesh)
     Gs::Vector3 coord, normal;
     Gs::Vector2 texCoord;
 
-    auto angle = Gs::Real(0);
-
     for (std::uint32_t u = 0; u <= segsHorz; ++u)
     {
         /* Compute X- and Z coordinates */
-        texCoord.x = std::sin(angle);
-        texCoord.y = std::cos(angle);
+        texCoord.x = ring->sin[u];
+        texCoord.y = ring->cos[u];
 
         coord.x = texCoord.x * desc.radius.x;
         coord.z = texCoord.y * desc.radius.y;
@@ -59,9 +57,6 @@ void GenerateCylinder(const CylinderDescriptor& desc, TriangleMesh& mesh)
             coord.y = Gs::Lerp(halfHeight, -halfHeight, texCoord.y);
             mesh.AddVertex(coord, normal, texCoord);
         }
-
-        /* Increase angle for the next iteration */
-        angle += angleSteps;
     }
 
     /* Generate bottom and top cover vertices */
@@ -75,7 +70,6 @@ void GenerateCylinder(const CylinderDescriptor& desc, TriangleMesh& mesh)
         if (segsCov[i] == 0)
             continue;
 
-        angle = Gs::Real(0);
         const auto invCov = Gs::Real(1) / static_cast<Gs::Real>(segsCov[i]);
 
         /* Add centered vertex */
@@ -90,8 +84,8 @@ void GenerateCylinder(const CylinderDescriptor& desc, TriangleMesh& mesh)
         for (std::uint32_t u = 0; u <= segsHorz; ++u)
         {
             /* Compute X- and Z coordinates */
-            texCoord.x = std::sin(angle);
-            texCoord.y = std::cos(angle);
+            texCoord.x = ring->sin[u];
+            texCoord.y = ring->cos[u];
 
             coord.x = texCoord.x * desc.radius.x;
             coord.z = texCoord.y * desc.radius.y;
@@ -111,9 +105,6 @@ void GenerateCylinder(const CylinderDescriptor& desc, TriangleMesh& mesh)
                     texCoordFinal
                 );
             }
-
-            /* Increase angle for the next iteration */
-            angle += angleSteps;
         }
     }
 
@@ -168,6 +159,35 @@ void GenerateCylinder(const CylinderDescriptor& desc, TriangleMesh& mesh)
     }
 }
 
+MeshCounts CountCylinder(const CylinderDescriptor& desc)
+{
+    const std::size_t segsHorz      = std::max(3u, desc.mantleSegments.x);
+    const std::size_t segsVert      = std::max(1u, desc.mantleSegments.y);
+    const std::size_t segsCov[2]    = { desc.topCoverSegments, desc.bottomCoverSegments };
+
+    MeshCounts counts;
+    counts.numVertices  = (segsHorz + 1)*(segsVert + 1);
+    counts.numTriangles = 2*segsHorz*segsVert;
+
+    /* Top and bottom covers with center vertex */
+    for (int i = 0; i < 2; ++i)
+    {
+        if (segsCov[i] > 0)
+        {
+            counts.numVertices  += 1 + (segsHorz + 1)*segsCov[i];
+            counts.numTriangles += segsHorz*(2*segsCov[i] - 1);
+        }
+    }
+
+    return counts;
+}
+
+void GenerateCylinder(const CylinderDescriptor& desc, TriangleMesh& mesh)
+{
+    MeshWriter writer(mesh, CountCylinder(desc));
+    GenerateCylinderPrimary(desc, writer);
+}
+
 TriangleMesh GenerateCylinder(const CylinderDescriptor& desc)
 {
     TriangleMesh mesh;
@@ -175,6 +195,13 @@ TriangleMesh GenerateCylinder(const CylinderDescriptor& desc)
     return mesh;
 }
 
+MeshCounts GenerateCylinder(const CylinderDescriptor& desc, const MeshSpan& span)
+{
+    MeshWriter writer(span, CountCylinder(desc));
+    GenerateCylinderPrimary(desc, writer);
+    return writer.GetSpanCounts();
+}
+
 
 } // /namespace MeshGenerator
 
@@ -6,6 +6,15 @@
  */
 
 #include "MeshGeneratorDetails.h"
+#include "Except.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+#include <mutex>
+#include <map>
+#include <utility>
+#include <cmath>
 
 
 namespace Gm
@@ -15,8 +24,159 @@ namespace MeshGenerator
 {
 
 
+/* ----- Internal functions ----- */
+
+// Reserves capacity for the specified number of additional elements, but keeps the geometric growth when many meshes are appended.
+template <typename T>
+static void ReserveAdditional(std::vector<T>& container, std::size_t count)
+{
+    const auto needed = container.size() + count;
+    if (container.capacity() < needed)
+        container.reserve(std::max(needed, container.capacity() * 2));
+}
+
+
+/* ----- MeshWriter class ----- */
+
+MeshWriter::MeshWriter(TriangleMesh& mesh, const MeshCounts& counts) :
+    mesh_ { &mesh }
+{
+    /* Reserve capacity up front to avoid repeated reallocations while generating */
+    ReserveAdditional(mesh.vertices, counts.numVertices);
+    ReserveAdditional(mesh.triangles, counts.numTriangles);
+
+    /* Containers are modified directly, so release the cached adjacency once here */
+    mesh.ClearAdjacency();
+}
+
+MeshWriter::MeshWriter(const MeshSpan& span, const MeshCounts& counts) :
+    span_ { span }
+{
+    if (counts.numVertices > span.maxVertices)
+        throw std::out_of_range(GM_EXCEPT_INFO("output span has insufficient capacity for the mesh generator vertices"));
+    if (counts.numTriangles > span.maxTriangles)
+        throw std::out_of_range(GM_EXCEPT_INFO("output span has insufficient capacity for the mesh generator triangles"));
+
+    const auto maxIndex = (span.writeTriangle != nullptr ? span.maxIndex : GetIndexFormatMaxIndex(span.indexFormat));
+    if (counts.numVertices > 0 && static_cast<std::uint64_t>(span.baseVertex + counts.numVertices - 1) > maxIndex)
+        throw std::out_of_range(GM_EXCEPT_INFO("index format of output span cannot address all mesh generator vertices"));
+
+    const auto vertices = (span.writeVertex != nullptr ? span.customVertices : span.vertices);
+    if ((counts.numVertices > 0 && vertices == nullptr) || (counts.numTriangles > 0 && span.indices == nullptr))
+        throw std::out_of_range(GM_EXCEPT_INFO("output span has no memory for the mesh generator"));
+}
+
+VertexIndex MeshWriter::AddVertices(std::size_t count)
+{
+    if (mesh_ != nullptr)
+    {
+        auto idx = mesh_->vertices.size();
+        mesh_->vertices.resize(idx + count);
+        return idx;
+    }
+    else
+    {
+        GS_ASSERT(numVertices_ + count <= span_.maxVertices);
+        auto idx = numVertices_;
+        numVertices_ += count;
+        return idx;
+    }
+}
+
+std::size_t MeshWriter::AddTriangles(std::size_t count)
+{
+    if (mesh_ != nullptr)
+    {
+        auto idx = mesh_->triangles.size();
+        mesh_->triangles.resize(idx + count);
+        return idx;
+    }
+    else
+    {
+        GS_ASSERT(numTriangles_ + count <= span_.maxTriangles);
+        auto idx = numTriangles_;
+        numTriangles_ += count;
+        return idx;
+    }
+}
+
+MeshCounts MeshWriter::GetSpanCounts() const
+{
+    MeshCounts counts;
+    counts.numVertices  = numVertices_;
+    counts.numTriangles = numTriangles_;
+    return counts;
+}
+
+
+/* ----- Global functions ----- */
+
+using RingBasisKey = std::pair<std::uint32_t, Gs::Real>;
+
+// Maximal number of cached ring bases; the cache is flushed when it grows beyond this limit.
+static const std::size_t                                        g_maxCachedRingBases = 64;
+
+static std::mutex                                               g_ringBasisCacheMutex;
+static std::map<RingBasisKey, std::shared_ptr<const RingBasis>> g_ringBasisCache;
+
+void ComputeRingBasis(RingBasis& basis, std::uint32_t segments, Gs::Real angleRange, Gs::Real angleOffset)
+{
+    const auto invSegs = Gs::Real(1) / static_cast<Gs::Real>(segments);
+
+    basis.sin.resize(segments + 1);
+    basis.cos.resize(segments + 1);
+
+    for (std::uint32_t i = 0; i <= segments; ++i)
+    {
+        auto angle = angleOffset + static_cast<Gs::Real>(i) * invSegs * angleRange;
+        basis.sin[i] = std::sin(angle);
+        basis.cos[i] = std::cos(angle);
+    }
+}
+
+std::shared_ptr<const RingBasis> GetRingBasis(std::uint32_t segments, Gs::Real angleRange)
+{
+    const auto key = RingBasisKey(segments, angleRange);
+
+    {
+        std::lock_guard<std::mutex> guard(g_ringBasisCacheMutex);
+        auto it = g_ringBasisCache.find(key);
+        if (it != g_ringBasisCache.end())
+            return it->second;
+    }
+
+    /* Compute new ring basis outside of the lock */
+    auto basis = std::make_shared<RingBasis>();
+    ComputeRingBasis(*basis, segments, angleRange);
+
+    {
+        std::lock_guard<std::mutex> guard(g_ringBasisCacheMutex);
+        if (g_ringBasisCache.size() >= g_maxCachedRingBases)
+            g_ringBasisCache.clear();
+        g_ringBasisCache[key] = basis;
+    }
+
+    return basis;
+}
+
+
 void AddTriangulatedQuad(
-    TriangleMesh&   mesh,
+    MeshWriter&     mesh,
+    bool            alternateGrid,
+    std::uint32_t   u,
+    std::uint32_t   v,
+    VertexIndex     i0,
+    VertexIndex     i1,
+    VertexIndex     i2,
+    VertexIndex     i3,
+    VertexIndex     indexOffset)
+{
+    SetTriangulatedQuad(mesh, mesh.AddTriangles(2), alternateGrid, u, v, i0, i1, i2, i3, indexOffset);
+}
+
+void SetTriangulatedQuad(
+    MeshWriter&     mesh,
+    std::size_t     triangleIndex,
     bool            alternateGrid,
     std::uint32_t   u,
     std::uint32_t   v,
@@ -26,9 +186,9 @@ void AddTriangulatedQuad(
     VertexIndex     i3,
     VertexIndex     indexOffset)
 {
-    auto Triangulate = [&mesh, indexOffset](VertexIndex a, VertexIndex b, VertexIndex c)
+    auto Triangulate = [&mesh, &triangleIndex, indexOffset](VertexIndex a, VertexIndex b, VertexIndex c)
     {
-        mesh.AddTriangle(indexOffset + a, indexOffset + b, indexOffset + c);
+        mesh.SetTriangle(triangleIndex++, indexOffset + a, indexOffset + b, indexOffset + c);
     };
 
     if (!alternateGrid || u % 2 == v % 2)
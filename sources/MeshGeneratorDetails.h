@@ -10,7 +10,11 @@
 
 
 #include <Geom/MeshGenerator.h>
+#include "ParallelDetails.h"
+
 #include <algorithm>
+#include <vector>
+#include <memory>
 
 
 namespace Gm
@@ -28,8 +32,155 @@ static const auto pi_0_5    = pi*Gs::Real(0.5);
 using VertexIndex = TriangleMesh::VertexIndex;
 
 
+// Minimal number of grid vertices (or quads) per parallel block of rows.
+static const std::size_t g_gridGrainSize = 8192;
+
+
+/*
+Output of the mesh generators. This either appends to a triangle mesh, whose containers are reserved up front with the exact counts,
+or writes directly into a caller-provided span.
+*/
+class MeshWriter
+{
+
+    public:
+
+        // Appends to the specified mesh and reserves the containers for the specified number of additional vertices and triangles.
+        MeshWriter(TriangleMesh& mesh, const MeshCounts& counts);
+
+        // Writes into the specified span. Throws std::out_of_range if the span cannot hold the specified counts.
+        MeshWriter(const MeshSpan& span, const MeshCounts& counts);
+
+        // Returns the number of vertices in the output, i.e. the index of the next vertex.
+        inline VertexIndex NumVertices() const
+        {
+            return (mesh_ != nullptr ? mesh_->vertices.size() : numVertices_);
+        }
+
+        inline VertexIndex AddVertex(const Gs::Vector3& position, const Gs::Vector3& normal, const Gs::Vector2& texCoord)
+        {
+            if (mesh_ != nullptr)
+            {
+                auto idx = mesh_->vertices.size();
+                mesh_->vertices.emplace_back(position, normal, texCoord);
+                return idx;
+            }
+            else
+            {
+                GS_ASSERT(numVertices_ < span_.maxVertices);
+                WriteSpanVertex(numVertices_, position, normal, texCoord);
+                return numVertices_++;
+            }
+        }
+
+        inline void AddTriangle(VertexIndex v0, VertexIndex v1, VertexIndex v2)
+        {
+            if (mesh_ != nullptr)
+                mesh_->triangles.push_back({ v0, v1, v2 });
+            else
+            {
+                GS_ASSERT(numTriangles_ < span_.maxTriangles);
+                SetTriangle(numTriangles_++, v0, v1, v2);
+            }
+        }
+
+        // Appends the specified number of vertices and returns the index of the first one. They must be written with 'SetVertex'.
+        VertexIndex AddVertices(std::size_t count);
+
+        // Appends the specified number of triangles and returns the index of the first one. They must be written with 'SetTriangle'.
+        std::size_t AddTriangles(std::size_t count);
+
+        // Writes a vertex that has been appended with 'AddVertices'. This can be called concurrently for different vertices.
+        inline void SetVertex(VertexIndex idx, const Gs::Vector3& position, const Gs::Vector3& normal, const Gs::Vector2& texCoord)
+        {
+            if (mesh_ != nullptr)
+                mesh_->vertices[idx] = TriangleMesh::Vertex(position, normal, texCoord);
+            else
+                WriteSpanVertex(idx, position, normal, texCoord);
+        }
+
+        // Writes a triangle that has been appended with 'AddTriangles'. This can be called concurrently for different triangles.
+        inline void SetTriangle(std::size_t idx, VertexIndex v0, VertexIndex v1, VertexIndex v2)
+        {
+            if (mesh_ != nullptr)
+                mesh_->triangles[idx] = { v0, v1, v2 };
+            else
+            {
+                const auto base = span_.baseVertex;
+                if (span_.writeTriangle != nullptr)
+                    span_.writeTriangle(span_.indices, idx, v0 + base, v1 + base, v2 + base);
+                else if (span_.indexFormat == IndexFormat::UInt16)
+                    WriteIndices(reinterpret_cast<std::uint16_t*>(span_.indices) + idx*3, v0 + base, v1 + base, v2 + base);
+                else
+                    WriteIndices(reinterpret_cast<std::uint32_t*>(span_.indices) + idx*3, v0 + base, v1 + base, v2 + base);
+            }
+        }
+
+        // Returns the number of vertices and triangles that have been written into the span.
+        MeshCounts GetSpanCounts() const;
+
+    private:
+
+        inline void WriteSpanVertex(VertexIndex idx, const Gs::Vector3& position, const Gs::Vector3& normal, const Gs::Vector2& texCoord)
+        {
+            if (span_.writeVertex != nullptr)
+                span_.writeVertex(span_.customVertices, idx, position, normal, texCoord);
+            else
+                span_.vertices[idx] = TriangleMesh::Vertex(position, normal, texCoord);
+        }
+
+        template <typename T>
+        static inline void WriteIndices(T* dst, VertexIndex v0, VertexIndex v1, VertexIndex v2)
+        {
+            dst[0] = static_cast<T>(v0);
+            dst[1] = static_cast<T>(v1);
+            dst[2] = static_cast<T>(v2);
+        }
+
+        TriangleMesh*   mesh_           = nullptr;
+        MeshSpan        span_;
+        std::size_t     numVertices_    = 0;
+        std::size_t     numTriangles_   = 0;
+
+};
+
+
+/*
+Sine and cosine tables of the angles 'angleOffset + angleRange * k / segments' for each k in [0, segments].
+Each angle is evaluated directly (not accumulated), so the last entry ends exactly at the end of the range.
+*/
+struct RingBasis
+{
+    std::vector<Gs::Real> sin;
+    std::vector<Gs::Real> cos;
+};
+
+// Computes the specified ring basis, e.g. for arbitrary angle ranges and offsets which are not worth sharing.
+void ComputeRingBasis(RingBasis& basis, std::uint32_t segments, Gs::Real angleRange = pi_2, Gs::Real angleOffset = Gs::Real(0));
+
+/*
+Returns the shared ring basis for the specified number of segments and angle range (without offset).
+The tables are computed once and reused across rings and calls. This function is thread-safe.
+*/
+std::shared_ptr<const RingBasis> GetRingBasis(std::uint32_t segments, Gs::Real angleRange = pi_2);
+
+
 void AddTriangulatedQuad(
-    TriangleMesh&   mesh,
+    MeshWriter&     mesh,
+    bool            alternateGrid,
+    std::uint32_t   u,
+    std::uint32_t   v,
+    VertexIndex     i0,
+    VertexIndex     i1,
+    VertexIndex     i2,
+    VertexIndex     i3,
+    VertexIndex     indexOffset = 0
+);
+
+// Writes the two triangles of a quad at the specified triangle index, which have been appended with 'MeshWriter::AddTriangles'.
+void SetTriangulatedQuad(
+    MeshWriter&     mesh,
+    std::size_t     triangleIndex,
     bool            alternateGrid,
     std::uint32_t   u,
     std::uint32_t   v,
@@ -40,6 +191,23 @@ void AddTriangulatedQuad(
     VertexIndex     indexOffset = 0
 );
 
+/*
+Calls the specified function for blocks of grid rows in parallel, with the signature 'void(std::uint32_t begin, std::uint32_t end)'.
+Each row has 'rowSize' elements. Small grids are processed on the calling thread.
+*/
+template <typename Func>
+void ParallelForRows(std::size_t numRows, std::size_t rowSize, const Func& func)
+{
+    const auto grainSize = std::max(std::size_t(1), g_gridGrainSize / std::max(std::size_t(1), rowSize));
+    Details::ParallelFor(
+        numRows, grainSize,
+        [&func](std::size_t begin, std::size_t end)
+        {
+            func(static_cast<std::uint32_t>(begin), static_cast<std::uint32_t>(end));
+        }
+    );
+}
+
 
 } // /namespace MeshGenerator
 
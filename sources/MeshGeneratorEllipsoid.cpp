@@ -6,7 +6,6 @@
  */
 
 #include "MeshGeneratorDetails.h"
-#include <Gauss/Spherical.h>
 
 
 namespace Gm
@@ -16,57 +15,92 @@ namespace MeshGenerator
 {
 
 
-void GenerateEllipsoid(const EllipsoidDescriptor& desc, TriangleMesh& mesh)
+static void GenerateEllipsoidPrimary(const EllipsoidDescriptor& desc, MeshWriter& mesh)
 {
-    const auto idxBaseOffset    = mesh.vertices.size();
-
     const auto segsU            = std::max(3u, desc.segments.x);
     const auto segsV            = std::max(2u, desc.segments.y);
 
     const auto invSegsU         = Gs::Real(1) / static_cast<Gs::Real>(segsU);
     const auto invSegsV         = Gs::Real(1) / static_cast<Gs::Real>(segsV);
 
-    /* Generate vertices */
-    Gs::Spherical point(1, 0, 0);
-    Gs::Vector2 texCoord;
+    const auto ringU            = GetRingBasis(segsU);
+    const auto ringV            = GetRingBasis(segsV, pi);
 
-    for (std::uint32_t v = 0; v <= segsV; ++v)
-    {
-        /* Compute theta of spherical coordinate */
-        texCoord.y = static_cast<Gs::Real>(v) * invSegsV;
-        point.theta = texCoord.y * pi;
+    /* Generate vertices in parallel blocks of rows */
+    const auto numRowVerts      = segsU + 1;
+    const auto idxBaseOffset    = mesh.AddVertices(numRowVerts*(segsV + 1));
 
-        for (std::uint32_t u = 0; u <= segsU; ++u)
+    ParallelForRows(
+        segsV + 1, numRowVerts,
+        [&](std::uint32_t begin, std::uint32_t end)
         {
-            /* Compute phi of spherical coordinate */
-            texCoord.x = static_cast<Gs::Real>(u) * invSegsU;
-            point.phi = texCoord.x * pi_2;
+            Gs::Vector3 coord;
+            Gs::Vector2 texCoord;
+
+            for (std::uint32_t v = begin; v < end; ++v)
+            {
+                /* Get theta of spherical coordinate from ring basis */
+                texCoord.y = static_cast<Gs::Real>(v) * invSegsV;
+
+                const auto sinTheta = ringV->sin[v];
+                coord.y = ringV->cos[v];
+
+                for (std::uint32_t u = 0; u <= segsU; ++u)
+                {
+                    texCoord.x = static_cast<Gs::Real>(u) * invSegsU;
 
-            /* Convert spherical coordinate into cartesian coordinate and set normal by coordinate */
-            auto coord = Gs::Vector3(point);
-            std::swap(coord.y, coord.z);
+                    /* Convert spherical coordinate into cartesian coordinate (with Y and Z swapped) and set normal by coordinate */
+                    coord.x = sinTheta * ringU->cos[u];
+                    coord.z = sinTheta * ringU->sin[u];
 
-            /* Add new vertex */
-            mesh.AddVertex(coord * desc.radius, coord.Normalized(), texCoord);
+                    /* Set vertex */
+                    mesh.SetVertex(idxBaseOffset + v*numRowVerts + u, coord * desc.radius, coord.Normalized(), texCoord);
+                }
+            }
         }
-    }
+    );
 
-    /* Generate indices */
-    for (std::uint32_t v = 0; v < segsV; ++v)
-    {
-        for (std::uint32_t u = 0; u < segsU; ++u)
+    /* Generate indices in parallel blocks of rows */
+    const auto triBaseOffset    = mesh.AddTriangles(2*segsU*segsV);
+
+    ParallelForRows(
+        segsV, segsU,
+        [&](std::uint32_t begin, std::uint32_t end)
         {
-            /* Compute indices for current face */
-            auto i0 = v*(segsU + 1) + u;
-            auto i1 = v*(segsU + 1) + (u + 1);
+            for (std::uint32_t v = begin; v < end; ++v)
+            {
+                for (std::uint32_t u = 0; u < segsU; ++u)
+                {
+                    /* Compute indices for current face */
+                    auto i0 = v*(segsU + 1) + u;
+                    auto i1 = v*(segsU + 1) + (u + 1);
+
+                    auto i2 = (v + 1)*(segsU + 1) + (u + 1);
+                    auto i3 = (v + 1)*(segsU + 1) + u;
+
+                    /* Set indices */
+                    SetTriangulatedQuad(mesh, triBaseOffset + 2*(v*segsU + u), desc.alternateGrid, u, v, i0, i1, i2, i3, idxBaseOffset);
+                }
+            }
+        }
+    );
+}
 
-            auto i2 = (v + 1)*(segsU + 1) + (u + 1);
-            auto i3 = (v + 1)*(segsU + 1) + u;
+MeshCounts CountEllipsoid(const EllipsoidDescriptor& desc)
+{
+    const std::size_t segsU = std::max(3u, desc.segments.x);
+    const std::size_t segsV = std::max(2u, desc.segments.y);
 
-            /* Add new indices */
-            AddTriangulatedQuad(mesh, desc.alternateGrid, u, v, i0, i1, i2, i3, idxBaseOffset);
-        }
-    }
+    MeshCounts counts;
+    counts.numVertices  = (segsU + 1)*(segsV + 1);
+    counts.numTriangles = 2*segsU*segsV;
+    return counts;
+}
+
+void GenerateEllipsoid(const EllipsoidDescriptor& desc, TriangleMesh& mesh)
+{
+    MeshWriter writer(mesh, CountEllipsoid(desc));
+    GenerateEllipsoidPrimary(desc, writer);
 }
 
 TriangleMesh GenerateEllipsoid(const EllipsoidDescriptor& desc)
@@ -76,6 +110,13 @@ TriangleMesh GenerateEllipsoid(const EllipsoidDescriptor& desc)
     return mesh;
 }
 
+MeshCounts GenerateEllipsoid(const EllipsoidDescriptor& desc, const MeshSpan& span)
+{
+    MeshWriter writer(span, CountEllipsoid(desc));
+    GenerateEllipsoidPrimary(desc, writer);
+    return writer.GetSpanCounts();
+}
+
 
 } // /namespace MeshGenerator
 
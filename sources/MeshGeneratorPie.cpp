@@ -15,9 +15,9 @@ namespace MeshGenerator
 {
 
 
-void GeneratePie(const PieDescriptor& desc, TriangleMesh& mesh)
+static void GeneratePiePrimary(const PieDescriptor& desc, MeshWriter& mesh)
 {
-    const auto idxBaseOffset    = mesh.vertices.size();
+    const auto idxBaseOffset    = mesh.NumVertices();
 
     const auto segsHorz         = std::max(3u, desc.mantleSegments.x);
     const auto segsVert         = std::max(1u, desc.mantleSegments.y);
@@ -31,7 +31,9 @@ void GeneratePie(const PieDescriptor& desc, TriangleMesh& mesh)
     const auto pieAngle         = Gs::Clamp(desc.angle, Gs::Real(0), pi_2);
     const auto pieAngleOffset   = desc.angleOffset + pieAngle;
 
-    const auto angleSteps       = invHorz * (pi_2 - pieAngle);
+    /* Pie rings have an arbitrary angle range and offset, so the ring basis is only shared by the mantle and covers */
+    RingBasis ring;
+    ComputeRingBasis(ring, segsHorz, pi_2 - pieAngle, pieAngleOffset);
 
     const auto halfHeight       = desc.height*Gs::Real(0.5);
 
@@ -39,13 +41,11 @@ void GeneratePie(const PieDescriptor& desc, TriangleMesh& mesh)
     Gs::Vector3 coord, normal;
     Gs::Vector2 texCoord;
 
-    auto angle = pieAngleOffset;
-
     for (std::uint32_t u = 0; u <= segsHorz; ++u)
     {
         /* Compute X- and Z coordinates */
-        texCoord.x = std::sin(angle);
-        texCoord.y = std::cos(angle);
+        texCoord.x = ring.sin[u];
+        texCoord.y = ring.cos[u];
 
         coord.x = texCoord.x * desc.radius.x;
         coord.z = texCoord.y * desc.radius.y;
@@ -65,9 +65,6 @@ void GeneratePie(const PieDescriptor& desc, TriangleMesh& mesh)
             coord.y = Gs::Lerp(halfHeight, -halfHeight, texCoord.y);
             mesh.AddVertex(coord, normal, texCoord);
         }
-
-        /* Increase angle for the next iteration */
-        angle += angleSteps;
     }
 
     /* Generate inner mantle vertices */
@@ -79,7 +76,7 @@ void GeneratePie(const PieDescriptor& desc, TriangleMesh& mesh)
 
     for (std::size_t i = 0; i < 2; ++i)
     {
-        mantleIndexOffset[i] = mesh.vertices.size();
+        mantleIndexOffset[i] = mesh.NumVertices();
 
         /* Compute normal vector */
         const auto angleNormal = mantleSideAngles[i] + mantleSideNormalOffset[i];
@@ -88,6 +85,9 @@ void GeneratePie(const PieDescriptor& desc, TriangleMesh& mesh)
         normal.y = Gs::Real(0);
         normal.z = std::cos(angleNormal);
 
+        const auto sideSin = std::sin(mantleSideAngles[i]);
+        const auto sideCos = std::cos(mantleSideAngles[i]);
+
         for (std::uint32_t u = 0; u <= segsCovMantle; ++u)
         {
             /* Compute X- and Z coordinates */
@@ -95,8 +95,8 @@ void GeneratePie(const PieDescriptor& desc, TriangleMesh& mesh)
 
             texCoord.x = mantleSideTC[i] + r * mantleSideTC[i + 2];
 
-            coord.x = std::sin(mantleSideAngles[i]) * desc.radius.x * r;
-            coord.z = std::cos(mantleSideAngles[i]) * desc.radius.y * r;
+            coord.x = sideSin * desc.radius.x * r;
+            coord.z = sideCos * desc.radius.y * r;
 
             for (std::uint32_t v = 0; v <= segsVert; ++v)
             {
@@ -121,8 +121,6 @@ void GeneratePie(const PieDescriptor& desc, TriangleMesh& mesh)
 
         for (std::size_t i = 0; i < 2; ++i)
         {
-            angle = pieAngleOffset;
-
             /* Add centered vertex */
             coord.y = halfHeight * coverSide[i];
 
@@ -135,8 +133,8 @@ void GeneratePie(const PieDescriptor& desc, TriangleMesh& mesh)
             for (std::uint32_t u = 0; u <= segsHorz; ++u)
             {
                 /* Compute X- and Z coordinates */
-                texCoord.x = std::sin(angle);
-                texCoord.y = std::cos(angle);
+                texCoord.x = ring.sin[u];
+                texCoord.y = ring.cos[u];
 
                 coord.x = texCoord.x * desc.radius.x;
                 coord.z = texCoord.y * desc.radius.y;
@@ -156,9 +154,6 @@ void GeneratePie(const PieDescriptor& desc, TriangleMesh& mesh)
                         texCoordFinal
                     );
                 }
-
-                /* Increase angle for the next iteration */
-                angle += angleSteps;
             }
         }
     }
@@ -238,6 +233,34 @@ void GeneratePie(const PieDescriptor& desc, TriangleMesh& mesh)
     }
 }
 
+MeshCounts CountPie(const PieDescriptor& desc)
+{
+    const std::size_t segsHorz      = std::max(3u, desc.mantleSegments.x);
+    const std::size_t segsVert      = std::max(1u, desc.mantleSegments.y);
+    const std::size_t segsCov       = desc.coverSegments;
+    const std::size_t segsCovMantle = std::max(1u, desc.coverSegments);
+
+    /* Outer mantle and the two inner mantles of the missing piece */
+    MeshCounts counts;
+    counts.numVertices  = (segsHorz + 1)*(segsVert + 1) + 2*(segsCovMantle + 1)*(segsVert + 1);
+    counts.numTriangles = 2*segsHorz*segsVert + 4*segsCovMantle*segsVert;
+
+    /* Top and bottom covers with center vertex */
+    if (segsCov > 0)
+    {
+        counts.numVertices  += 2*(1 + (segsHorz + 1)*segsCov);
+        counts.numTriangles += 2*segsHorz*(2*segsCov - 1);
+    }
+
+    return counts;
+}
+
+void GeneratePie(const PieDescriptor& desc, TriangleMesh& mesh)
+{
+    MeshWriter writer(mesh, CountPie(desc));
+    GeneratePiePrimary(desc, writer);
+}
+
 TriangleMesh GeneratePie(const PieDescriptor& desc)
 {
     TriangleMesh mesh;
@@ -245,6 +268,13 @@ TriangleMesh GeneratePie(const PieDescriptor& desc)
     return mesh;
 }
 
+MeshCounts GeneratePie(const PieDescriptor& desc, const MeshSpan& span)
+{
+    MeshWriter writer(span, CountPie(desc));
+    GeneratePiePrimary(desc, writer);
+    return writer.GetSpanCounts();
+}
+
 
 } // /namespace MeshGenerator
 
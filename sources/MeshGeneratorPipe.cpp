@@ -15,9 +15,9 @@ namespace MeshGenerator
 {
 
 
-void GeneratePipe(const PipeDescriptor& desc, TriangleMesh& mesh)
+static void GeneratePipePrimary(const PipeDescriptor& desc, MeshWriter& mesh)
 {
-    const auto idxBaseOffset    = mesh.vertices.size();
+    const auto idxBaseOffset    = mesh.NumVertices();
 
     const auto segsHorz         = std::max(3u, desc.mantleSegments.x);
     const auto segsVert         = std::max(1u, desc.mantleSegments.y);
@@ -25,7 +25,7 @@ void GeneratePipe(const PipeDescriptor& desc, TriangleMesh& mesh)
     const auto invHorz          = Gs::Real(1) / static_cast<Gs::Real>(segsHorz);
     const auto invVert          = Gs::Real(1) / static_cast<Gs::Real>(segsVert);
 
-    const auto angleSteps       = invHorz * pi_2;
+    const auto ring             = GetRingBasis(segsHorz);
 
     const auto halfHeight       = desc.height*Gs::Real(0.5);
 
@@ -33,8 +33,6 @@ void GeneratePipe(const PipeDescriptor& desc, TriangleMesh& mesh)
     Gs::Vector3 coord, normal, coordAlt;
     Gs::Vector2 texCoord;
 
-    auto angle = Gs::Real(0);
-
     const Gs::Vector2 radii[2] = { desc.outerRadius, desc.innerRadius };
     const Gs::Real faceSide[2] = { 1, -1 };
 
@@ -42,14 +40,13 @@ void GeneratePipe(const PipeDescriptor& desc, TriangleMesh& mesh)
 
     for (std::size_t i = 0; i < 2; ++i)
     {
-        mantleIndexOffset[i] = mesh.vertices.size();
-        angle = Gs::Real(0);
+        mantleIndexOffset[i] = mesh.NumVertices();
 
         for (std::uint32_t u = 0; u <= segsHorz; ++u)
         {
             /* Compute X- and Z coordinates */
-            texCoord.x = std::sin(angle);
-            texCoord.y = std::cos(angle);
+            texCoord.x = ring->sin[u];
+            texCoord.y = ring->cos[u];
 
             coord.x = texCoord.x * radii[i].x;
             coord.z = texCoord.y * radii[i].y;
@@ -69,9 +66,6 @@ void GeneratePipe(const PipeDescriptor& desc, TriangleMesh& mesh)
                 coord.y = Gs::Lerp(halfHeight, -halfHeight, texCoord.y);
                 mesh.AddVertex(coord, normal * faceSide[i], texCoord);
             }
-
-            /* Increase angle for the next iteration */
-            angle += angleSteps;
         }
     }
 
@@ -86,19 +80,18 @@ void GeneratePipe(const PipeDescriptor& desc, TriangleMesh& mesh)
         if (segsCov[i] == 0)
             continue;
 
-        angle = Gs::Real(0);
         const auto invCov = Gs::Real(1) / static_cast<Gs::Real>(segsCov[i]);
         const auto invRadius = Gs::Vector2(1) / (desc.outerRadius * Gs::Real(2.0));
 
         coord.y = halfHeight * coverSide[i];
         coordAlt.y = halfHeight * coverSide[i];
-        coverIndexOffset[i] = mesh.vertices.size();
+        coverIndexOffset[i] = mesh.NumVertices();
 
         for (std::uint32_t u = 0; u <= segsHorz; ++u)
         {
             /* Compute X- and Z coordinates */
-            texCoord.x = std::sin(angle);
-            texCoord.y = std::cos(angle);
+            texCoord.x = ring->sin[u];
+            texCoord.y = ring->cos[u];
 
             coord.x = texCoord.x * desc.outerRadius.x;
             coord.z = texCoord.y * desc.outerRadius.y;
@@ -125,9 +118,6 @@ void GeneratePipe(const PipeDescriptor& desc, TriangleMesh& mesh)
                     Gs::Lerp(texCoordA, texCoordB, interp)
                 );
             }
-
-            /* Increase angle for the next iteration */
-            angle += angleSteps;
         }
     }
 
@@ -185,6 +175,36 @@ void GeneratePipe(const PipeDescriptor& desc, TriangleMesh& mesh)
     }
 }
 
+MeshCounts CountPipe(const PipeDescriptor& desc)
+{
+    const std::size_t segsHorz      = std::max(3u, desc.mantleSegments.x);
+    const std::size_t segsVert      = std::max(1u, desc.mantleSegments.y);
+    const std::size_t segsCov[2]    = { desc.topCoverSegments, desc.bottomCoverSegments };
+
+    /* Inner and outer mantle */
+    MeshCounts counts;
+    counts.numVertices  = 2*(segsHorz + 1)*(segsVert + 1);
+    counts.numTriangles = 4*segsHorz*segsVert;
+
+    /* Top and bottom rings */
+    for (int i = 0; i < 2; ++i)
+    {
+        if (segsCov[i] > 0)
+        {
+            counts.numVertices  += (segsHorz + 1)*(segsCov[i] + 1);
+            counts.numTriangles += 2*segsHorz*segsCov[i];
+        }
+    }
+
+    return counts;
+}
+
+void GeneratePipe(const PipeDescriptor& desc, TriangleMesh& mesh)
+{
+    MeshWriter writer(mesh, CountPipe(desc));
+    GeneratePipePrimary(desc, writer);
+}
+
 TriangleMesh GeneratePipe(const PipeDescriptor& desc)
 {
     TriangleMesh mesh;
@@ -192,6 +212,13 @@ TriangleMesh GeneratePipe(const PipeDescriptor& desc)
     return mesh;
 }
 
+MeshCounts GeneratePipe(const PipeDescriptor& desc, const MeshSpan& span)
+{
+    MeshWriter writer(span, CountPipe(desc));
+    GeneratePipePrimary(desc, writer);
+    return writer.GetSpanCounts();
+}
+
 
 } // /namespace MeshGenerator
 
@@ -15,10 +15,8 @@ namespace MeshGenerator
 {
 
 
-void GenerateSpiral(const SpiralDescriptor& desc, TriangleMesh& mesh)
+static void GenerateSpiralPrimary(const SpiralDescriptor& desc, MeshWriter& mesh)
 {
-    const auto idxBaseOffset    = mesh.vertices.size();
-
     const auto turns            = std::max(Gs::Real(0), desc.turns);
 
     const auto segsU            = std::max(3u, desc.mantleSegments.x);
@@ -27,9 +25,12 @@ void GenerateSpiral(const SpiralDescriptor& desc, TriangleMesh& mesh)
     const auto invSegsU         = Gs::Real(1) / static_cast<Gs::Real>(segsU);
     const auto invSegsV         = Gs::Real(1) / static_cast<Gs::Real>(segsV);
 
+    const auto ringU            = GetRingBasis(segsU);
+    const auto ringV            = GetRingBasis(segsV);
+
     const auto totalSegsU       = static_cast<std::uint32_t>(turns * static_cast<Gs::Real>(segsU));
 
-    auto GetCoverCoordAndNormal = [&](Gs::Real theta, Gs::Real phi, Gs::Vector3& coord, Gs::Vector3& normal, bool center)
+    auto GetCoverCoordAndNormal = [&](Gs::Real s0, Gs::Real c0, Gs::Real phi, Gs::Vector3& coord, Gs::Vector3& normal, bool center)
     {
         auto s1 = std::sin(phi);
         auto c1 = std::cos(phi);
@@ -40,9 +41,6 @@ void GenerateSpiral(const SpiralDescriptor& desc, TriangleMesh& mesh)
 
         if (!center)
         {
-            auto s0 = std::sin(theta);
-            auto c0 = std::cos(theta);
-
             coord.x += s1 * s0 * desc.tubeRadius.x;
             coord.y +=      c0 * desc.tubeRadius.y;
             coord.z += c1 * s0 * desc.tubeRadius.z;
@@ -55,45 +53,55 @@ void GenerateSpiral(const SpiralDescriptor& desc, TriangleMesh& mesh)
         return coord;
     };
 
-    /* Generate mantle vertices */
-    Gs::Vector3 coord, normal;
-    Gs::Vector2 texCoord;
+    /* Generate mantle vertices in parallel blocks of rows */
+    const auto numRowVerts      = totalSegsU + 1;
+    const auto idxBaseOffset    = mesh.AddVertices(numRowVerts*(segsV + 1));
 
-    for (std::uint32_t v = 0; v <= segsV; ++v)
-    {
-        /* Compute theta of spherical coordinate */
-        texCoord.y = static_cast<Gs::Real>(v) * invSegsV;
-        auto theta = texCoord.y * pi_2;
-
-        auto s0 = std::sin(theta);
-        auto c0 = std::cos(theta);
-
-        for (std::uint32_t u = 0; u <= totalSegsU; ++u)
+    ParallelForRows(
+        segsV + 1, numRowVerts,
+        [&](std::uint32_t begin, std::uint32_t end)
         {
-            /* Compute phi of spherical coordinate */
-            texCoord.x = static_cast<Gs::Real>(u) * invSegsU;
-            auto phi = texCoord.x * pi_2;
-
-            auto s1 = std::sin(phi);
-            auto c1 = std::cos(phi);
-
-            /* Compute coordinate and normal */
-            coord.x = s1 * desc.ringRadius.x + s1 * s0 * desc.tubeRadius.x;
-            coord.y = c0 * desc.tubeRadius.y + (texCoord.x - turns * Gs::Real(0.5)) * desc.displacement;
-            coord.z = c1 * desc.ringRadius.y + c1 * s0 * desc.tubeRadius.z;
-
-            normal.x = s1 * s0 / desc.tubeRadius.x;
-            normal.y =      c0 / desc.tubeRadius.y;
-            normal.z = c1 * s0 / desc.tubeRadius.z;
-            normal.Normalize();
-
-            /* Add new vertex */
-            texCoord.x = -texCoord.x;
-            mesh.AddVertex(coord, normal, texCoord);
+            Gs::Vector3 coord, normal;
+            Gs::Vector2 texCoord;
+
+            for (std::uint32_t v = begin; v < end; ++v)
+            {
+                /* Get theta of spherical coordinate from ring basis */
+                texCoord.y = static_cast<Gs::Real>(v) * invSegsV;
+
+                auto s0 = ringV->sin[v];
+                auto c0 = ringV->cos[v];
+
+                for (std::uint32_t u = 0; u <= totalSegsU; ++u)
+                {
+                    /* Get phi of spherical coordinate from ring basis (repeated for each turn) */
+                    texCoord.x = static_cast<Gs::Real>(u) * invSegsU;
+
+                    auto s1 = ringU->sin[u % segsU];
+                    auto c1 = ringU->cos[u % segsU];
+
+                    /* Compute coordinate and normal */
+                    coord.x = s1 * desc.ringRadius.x + s1 * s0 * desc.tubeRadius.x;
+                    coord.y = c0 * desc.tubeRadius.y + (texCoord.x - turns * Gs::Real(0.5)) * desc.displacement;
+                    coord.z = c1 * desc.ringRadius.y + c1 * s0 * desc.tubeRadius.z;
+
+                    normal.x = s1 * s0 / desc.tubeRadius.x;
+                    normal.y =      c0 / desc.tubeRadius.y;
+                    normal.z = c1 * s0 / desc.tubeRadius.z;
+                    normal.Normalize();
+
+                    /* Set vertex */
+                    texCoord.x = -texCoord.x;
+                    mesh.SetVertex(idxBaseOffset + v*numRowVerts + u, coord, normal, texCoord);
+                }
+            }
         }
-    }
+    );
 
     /* Generate bottom and top cover vertices */
+    Gs::Vector3 coord, normal;
+    Gs::Vector2 texCoord;
+
     const std::uint32_t segsCov[2]  = { desc.bottomCoverSegments, desc.topCoverSegments };
     const Gs::Real coverPhi[2]      = { 0, turns * pi_2 };
     const Gs::Real coverSide[2]     = { -1, 1 };
@@ -105,11 +113,10 @@ void GenerateSpiral(const SpiralDescriptor& desc, TriangleMesh& mesh)
         if (segsCov[i] == 0)
             continue;
 
-        auto theta = Gs::Real(0);
         const auto invCov = Gs::Real(1) / static_cast<Gs::Real>(segsCov[i]);
 
         /* Add centered vertex */
-        GetCoverCoordAndNormal(0, coverPhi[i], coord, normal, true);
+        GetCoverCoordAndNormal(0, 1, coverPhi[i], coord, normal, true);
         coverIndexOffset[i] = mesh.AddVertex(
             coord,
             normal * coverSide[i],
@@ -120,9 +127,11 @@ void GenerateSpiral(const SpiralDescriptor& desc, TriangleMesh& mesh)
 
         for (std::uint32_t v = 0; v <= segsV; ++v)
         {
-            /* Compute texture coordinates */
-            texCoord.x = std::sin(theta);
-            texCoord.y = std::cos(theta);
+            /* Compute texture coordinates and the outer coordinate of this ring */
+            texCoord.x = ringV->sin[v];
+            texCoord.y = ringV->cos[v];
+
+            GetCoverCoordAndNormal(texCoord.x, texCoord.y, coverPhi[i], coord, normal, false);
 
             /* Add vertex around the top and bottom */
             for (std::uint32_t j = 1; j <= segsCov[i]; ++j)
@@ -133,35 +142,39 @@ void GenerateSpiral(const SpiralDescriptor& desc, TriangleMesh& mesh)
                 if (i == 1)
                     texCoordFinal.y = Gs::Real(1) - texCoordFinal.y;
 
-                GetCoverCoordAndNormal(theta, coverPhi[i], coord, normal, false);
                 mesh.AddVertex(
                     Gs::Lerp(centerCoord, coord, interp),
                     normal * coverSide[i],
                     texCoordFinal
                 );
             }
-
-            /* Increase angle for the next iteration */
-            theta += invSegsV * pi_2;
         }
     }
 
-    /* Generate indices for the mantle */
-    for (std::uint32_t v = 0; v < segsV; ++v)
-    {
-        for (std::uint32_t u = 0; u < totalSegsU; ++u)
-        {
-            /* Compute indices for current face */
-            auto i0 = v*(totalSegsU + 1) + u;
-            auto i1 = v*(totalSegsU + 1) + (u + 1);
+    /* Generate indices for the mantle in parallel blocks of rows */
+    const auto triBaseOffset    = mesh.AddTriangles(2*totalSegsU*segsV);
 
-            auto i2 = (v + 1)*(totalSegsU + 1) + (u + 1);
-            auto i3 = (v + 1)*(totalSegsU + 1) + u;
-
-            /* Add new indices */
-            AddTriangulatedQuad(mesh, desc.alternateGrid, u, v, i1, i0, i3, i2, idxBaseOffset);
+    ParallelForRows(
+        segsV, totalSegsU,
+        [&](std::uint32_t begin, std::uint32_t end)
+        {
+            for (std::uint32_t v = begin; v < end; ++v)
+            {
+                for (std::uint32_t u = 0; u < totalSegsU; ++u)
+                {
+                    /* Compute indices for current face */
+                    auto i0 = v*(totalSegsU + 1) + u;
+                    auto i1 = v*(totalSegsU + 1) + (u + 1);
+
+                    auto i2 = (v + 1)*(totalSegsU + 1) + (u + 1);
+                    auto i3 = (v + 1)*(totalSegsU + 1) + u;
+
+                    /* Set indices */
+                    SetTriangulatedQuad(mesh, triBaseOffset + 2*(v*totalSegsU + u), desc.alternateGrid, u, v, i1, i0, i3, i2, idxBaseOffset);
+                }
+            }
         }
-    }
+    );
 
     /* Generate indices for the bottom and top */
     for (std::size_t i = 0; i < 2; ++i)
@@ -196,6 +209,39 @@ void GenerateSpiral(const SpiralDescriptor& desc, TriangleMesh& mesh)
     }
 }
 
+MeshCounts CountSpiral(const SpiralDescriptor& desc)
+{
+    const auto          turns       = std::max(Gs::Real(0), desc.turns);
+    const auto          segsU       = std::max(3u, desc.mantleSegments.x);
+    const std::size_t   segsV       = std::max(3u, desc.mantleSegments.y);
+    const std::size_t   segsCov[2]  = { desc.topCoverSegments, desc.bottomCoverSegments };
+
+    /* Must match the number of mantle segments of the generator */
+    const std::size_t   totalSegsU  = static_cast<std::uint32_t>(turns * static_cast<Gs::Real>(segsU));
+
+    MeshCounts counts;
+    counts.numVertices  = (segsV + 1)*(totalSegsU + 1);
+    counts.numTriangles = 2*segsV*totalSegsU;
+
+    /* Top and bottom covers with center vertex */
+    for (int i = 0; i < 2; ++i)
+    {
+        if (segsCov[i] > 0)
+        {
+            counts.numVertices  += 1 + (segsV + 1)*segsCov[i];
+            counts.numTriangles += segsV*(2*segsCov[i] - 1);
+        }
+    }
+
+    return counts;
+}
+
+void GenerateSpiral(const SpiralDescriptor& desc, TriangleMesh& mesh)
+{
+    MeshWriter writer(mesh, CountSpiral(desc));
+    GenerateSpiralPrimary(desc, writer);
+}
+
 TriangleMesh GenerateSpiral(const SpiralDescriptor& desc)
 {
     TriangleMesh mesh;
@@ -203,6 +249,13 @@ TriangleMesh GenerateSpiral(const SpiralDescriptor& desc)
     return mesh;
 }
 
+MeshCounts GenerateSpiral(const SpiralDescriptor& desc, const MeshSpan& span)
+{
+    MeshWriter writer(span, CountSpiral(desc));
+    GenerateSpiralPrimary(desc, writer);
+    return writer.GetSpanCounts();
+}
+
 
 } // /namespace MeshGenerator
 
@@ -15,71 +15,104 @@ namespace MeshGenerator
 {
 
 
-void GenerateTorus(const TorusDescriptor& desc, TriangleMesh& mesh)
+static void GenerateTorusPrimary(const TorusDescriptor& desc, MeshWriter& mesh)
 {
-    const auto idxBaseOffset    = mesh.vertices.size();
-
     const auto segsU            = std::max(3u, desc.segments.x);
     const auto segsV            = std::max(3u, desc.segments.y);
 
     const auto invSegsU         = Gs::Real(1) / static_cast<Gs::Real>(segsU);
     const auto invSegsV         = Gs::Real(1) / static_cast<Gs::Real>(segsV);
 
-    /* Generate vertices */
-    Gs::Vector3 coord, normal;
-    Gs::Vector2 texCoord;
+    const auto ringU            = GetRingBasis(segsU);
+    const auto ringV            = GetRingBasis(segsV);
 
-    for (std::uint32_t v = 0; v <= segsV; ++v)
-    {
-        /* Compute theta of spherical coordinate */
-        texCoord.y = static_cast<Gs::Real>(v) * invSegsV;
-        auto theta = texCoord.y * pi_2;
+    /* Generate vertices in parallel blocks of rows */
+    const auto numRowVerts      = segsU + 1;
+    const auto idxBaseOffset    = mesh.AddVertices(numRowVerts*(segsV + 1));
 
-        auto s0 = std::sin(theta);
-        auto c0 = std::cos(theta);
+    ParallelForRows(
+        segsV + 1, numRowVerts,
+        [&](std::uint32_t begin, std::uint32_t end)
+        {
+            Gs::Vector3 coord, normal;
+            Gs::Vector2 texCoord;
 
-        coord.y = c0 * desc.tubeRadius.y;
+            for (std::uint32_t v = begin; v < end; ++v)
+            {
+                /* Get theta of spherical coordinate from ring basis */
+                texCoord.y = static_cast<Gs::Real>(v) * invSegsV;
 
-        for (std::uint32_t u = 0; u <= segsU; ++u)
-        {
-            /* Compute phi of spherical coordinate */
-            texCoord.x = static_cast<Gs::Real>(u) * invSegsU;
-            auto phi = texCoord.x * pi_2;
+                auto s0 = ringV->sin[v];
+                auto c0 = ringV->cos[v];
+
+                coord.y = c0 * desc.tubeRadius.y;
 
-            auto s1 = std::sin(phi);
-            auto c1 = std::cos(phi);
+                for (std::uint32_t u = 0; u <= segsU; ++u)
+                {
+                    /* Get phi of spherical coordinate from ring basis */
+                    texCoord.x = static_cast<Gs::Real>(u) * invSegsU;
 
-            /* Compute coordinate and normal */
-            coord.x = s1 * desc.ringRadius.x + s1 * s0 * desc.tubeRadius.x;
-            coord.z = c1 * desc.ringRadius.y + c1 * s0 * desc.tubeRadius.z;
+                    auto s1 = ringU->sin[u];
+                    auto c1 = ringU->cos[u];
 
-            normal.x = s1 * s0 / desc.tubeRadius.x;
-            normal.y =      c0 / desc.tubeRadius.y;
-            normal.z = c1 * s0 / desc.tubeRadius.z;
-            normal.Normalize();
+                    /* Compute coordinate and normal */
+                    coord.x = s1 * desc.ringRadius.x + s1 * s0 * desc.tubeRadius.x;
+                    coord.z = c1 * desc.ringRadius.y + c1 * s0 * desc.tubeRadius.z;
 
-            /* Add new vertex */
-            texCoord.x = -texCoord.x;
-            mesh.AddVertex(coord, normal, texCoord);
+                    normal.x = s1 * s0 / desc.tubeRadius.x;
+                    normal.y =      c0 / desc.tubeRadius.y;
+                    normal.z = c1 * s0 / desc.tubeRadius.z;
+                    normal.Normalize();
+
+                    /* Set vertex */
+                    texCoord.x = -texCoord.x;
+                    mesh.SetVertex(idxBaseOffset + v*numRowVerts + u, coord, normal, texCoord);
+                }
+            }
         }
-    }
+    );
+
+    /* Generate indices in parallel blocks of rows */
+    const auto triBaseOffset    = mesh.AddTriangles(2*segsU*segsV);
 
-    /* Generate indices */
-    for (std::uint32_t v = 0; v < segsV; ++v)
-    {
-        for (std::uint32_t u = 0; u < segsU; ++u)
+    ParallelForRows(
+        segsV, segsU,
+        [&](std::uint32_t begin, std::uint32_t end)
         {
-            /* Compute indices for current face */
-            auto i0 = v*(segsU + 1) + u;
-            auto i1 = v*(segsU + 1) + (u + 1);
+            for (std::uint32_t v = begin; v < end; ++v)
+            {
+                for (std::uint32_t u = 0; u < segsU; ++u)
+                {
+                    /* Compute indices for current face */
+                    auto i0 = v*(segsU + 1) + u;
+                    auto i1 = v*(segsU + 1) + (u + 1);
+
+                    auto i2 = (v + 1)*(segsU + 1) + (u + 1);
+                    auto i3 = (v + 1)*(segsU + 1) + u;
+
+                    /* Set indices */
+                    SetTriangulatedQuad(mesh, triBaseOffset + 2*(v*segsU + u), desc.alternateGrid, u, v, i1, i0, i3, i2, idxBaseOffset);
+                }
+            }
+        }
+    );
+}
 
-            auto i2 = (v + 1)*(segsU + 1) + (u + 1);
-            auto i3 = (v + 1)*(segsU + 1) + u;
+MeshCounts CountTorus(const TorusDescriptor& desc)
+{
+    const std::size_t segsU = std::max(3u, desc.segments.x);
+    const std::size_t segsV = std::max(3u, desc.segments.y);
 
-            /* Add new indices */
-            AddTriangulatedQuad(mesh, desc.alternateGrid, u, v, i1, i0, i3, i2, idxBaseOffset);
-        }
-    }
+    MeshCounts counts;
+    counts.numVertices  = (segsU + 1)*(segsV + 1);
+    counts.numTriangles = 2*segsU*segsV;
+    return counts;
+}
+
+void GenerateTorus(const TorusDescriptor& desc, TriangleMesh& mesh)
+{
+    MeshWriter writer(mesh, CountTorus(desc));
+    GenerateTorusPrimary(desc, writer);
 }
 
 TriangleMesh GenerateTorus(const TorusDescriptor& desc)
@@ -89,6 +122,13 @@ TriangleMesh GenerateTorus(const TorusDescriptor& desc)
     return mesh;
 }
 
+MeshCounts GenerateTorus(const TorusDescriptor& desc, const MeshSpan& span)
+{
+    MeshWriter writer(span, CountTorus(desc));
+    GenerateTorusPrimary(desc, writer);
+    return writer.GetSpanCounts();
+}
+
 
 } // /namespace MeshGenerator
 
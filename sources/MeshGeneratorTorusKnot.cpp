@@ -15,7 +15,8 @@ namespace MeshGenerator
 {
 
 
-void GenerateTorusKnot(const TorusKnotDescriptor& desc, TriangleMesh& mesh)
+// Returns the curve descriptor of the torus-knot. The curve function refers to the specified descriptor.
+static CurveDescriptor GetTorusKnotCurveDesc(const TorusKnotDescriptor& desc)
 {
     CurveDescriptor curveDesc;
 
@@ -23,7 +24,7 @@ void GenerateTorusKnot(const TorusKnotDescriptor& desc, TriangleMesh& mesh)
     const auto turns = static_cast<Gs::Real>(desc.turns);
 
     /* Pass torus-knot curve function to curve mesh generator */
-    curveDesc.curveFunction = [&](Gs::Real t)
+    curveDesc.curveFunction = [&desc, loops, turns](Gs::Real t)
     {
         t *= pi_2;
 
@@ -42,8 +43,20 @@ void GenerateTorusKnot(const TorusKnotDescriptor& desc, TriangleMesh& mesh)
     curveDesc.segments          = desc.segments;
     curveDesc.alternateGrid     = desc.alternateGrid;
     curveDesc.vertexModifier    = desc.vertexModifier;
+    curveDesc.tolerance         = desc.tolerance;
+    curveDesc.parallelTransport = desc.parallelTransport;
+
+    return curveDesc;
+}
 
-    GenerateCurve(curveDesc, mesh);
+MeshCounts CountTorusKnot(const TorusKnotDescriptor& desc)
+{
+    return CountCurve(GetTorusKnotCurveDesc(desc));
+}
+
+void GenerateTorusKnot(const TorusKnotDescriptor& desc, TriangleMesh& mesh)
+{
+    GenerateCurve(GetTorusKnotCurveDesc(desc), mesh);
 }
 
 TriangleMesh GenerateTorusKnot(const TorusKnotDescriptor& desc)
@@ -53,6 +66,11 @@ TriangleMesh GenerateTorusKnot(const TorusKnotDescriptor& desc)
     return mesh;
 }
 
+MeshCounts GenerateTorusKnot(const TorusKnotDescriptor& desc, const MeshSpan& span)
+{
+    return GenerateCurve(GetTorusKnotCurveDesc(desc), span);
+}
+
 
 } // /namespace MeshGenerator
 
@@ -6,6 +6,9 @@
  */
 
 #include <Geom/MeshModifier.h>
+#include <Geom/MeshClipper.h>
+#include <Geom/VertexLayout.h>
+#include <Geom/TriangleMeshSoA.h>
 #include <Geom/TriangleCollision.h>
 
 
@@ -82,6 +85,29 @@ class BasicByteBuffer
 using ByteBuffer = BasicByteBuffer<void*>;
 using ConstByteBuffer = BasicByteBuffer<const void*>;
 
+// Returns true if the specified descriptor has the same content as the default vertex descriptor, i.e. it can use the specialized interpolator.
+static bool IsDefaultVertexDesc(const VertexDescriptor& vertexDesc)
+{
+    const auto& defaultDesc = GetDefaultVertexDesc();
+
+    if (&vertexDesc == &defaultDesc)
+        return true;
+
+    if (GetVertexStride(vertexDesc) != DefaultVertexLayout::stride || vertexDesc.attributes.size() != defaultDesc.attributes.size())
+        return false;
+
+    for (std::size_t i = 0; i < vertexDesc.attributes.size(); ++i)
+    {
+        const auto& lhs = vertexDesc.attributes[i];
+        const auto& rhs = defaultDesc.attributes[i];
+
+        if (lhs.offset != rhs.offset || lhs.components != rhs.components || lhs.format != rhs.format)
+            return false;
+    }
+
+    return true;
+}
+
 
 /* ----- Global functions ----- */
 
@@ -107,6 +133,13 @@ void InterpolateBarycentric(
     std::size_t             v2,
     const Gs::Vector3&      barycentricCoords)
 {
+    /* Use specialized interpolator for the default vertex format */
+    if (IsDefaultVertexDesc(vertexDesc))
+    {
+        Gm::InterpolateBarycentric<DefaultVertexLayout>(outputVertexBuffer, inputVertexBuffer, v0, v1, v2, barycentricCoords);
+        return;
+    }
+
     ByteBuffer output(outputVertexBuffer, vertexDesc);
     ConstByteBuffer input(inputVertexBuffer, vertexDesc);
 
@@ -129,83 +162,57 @@ void InterpolateBarycentric(
     }
 }
 
-void ClipMesh(const TriangleMesh& mesh, const Plane& clipPlane, TriangleMesh& front, TriangleMesh& back)
+void InterpolateBarycentricBatch(
+    const VertexDescriptor&         vertexDesc,
+    void*                           outputVertexBuffer,
+    const void*                     inputVertexBuffer,
+    const TriangleMesh::Triangle*   triangles,
+    const std::size_t*              triangleIndices,
+    const Gs::Vector3*              barycentricCoords,
+    std::size_t                     count)
 {
-    /* Clear previous output meshes */
-    front.Clear();
-    back.Clear();
-
-    /* Clip each triangle against the clipping plane */
-    TriangleIndex triIdx = 0;
-
-    const auto& vertices = mesh.vertices;
-
-    for (const auto& indices : mesh.triangles)
+    /* Use specialized interpolator for the default vertex format */
+    if (IsDefaultVertexDesc(vertexDesc))
     {
-        /* Setup triangle coordinates */
-        Triangle3 tri(
-            vertices[indices.a].position,
-            vertices[indices.b].position,
-            vertices[indices.c].position
+        Gm::InterpolateBarycentricBatch<DefaultVertexLayout>(
+            outputVertexBuffer, inputVertexBuffer, triangles, triangleIndices, barycentricCoords, count
         );
+        return;
+    }
+
+    ByteBuffer output(outputVertexBuffer, vertexDesc);
+    ConstByteBuffer input(inputVertexBuffer, vertexDesc);
 
-        /* Clip triangle against plane */
-        ClippedPolygon<Gs::Real> frontPoly, backPoly;
-        auto rel = ClipTriangle<Gs::Real>(tri, clipPlane, frontPoly, backPoly);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto& tri     = triangles[triangleIndices[i]];
+        const auto& coords  = barycentricCoords[i];
 
-        switch (rel)
+        for (const auto& attribDesc : vertexDesc.attributes)
         {
-            case PlaneRelation::InFrontOf:
-            {
-                /* Add current triangle to front sided mesh */
-                auto count = front.vertices.size();
-                front.vertices.push_back(vertices[indices.a]);
-                front.vertices.push_back(vertices[indices.b]);
-                front.vertices.push_back(vertices[indices.c]);
-                front.AddTriangle(count, count + 1, count + 2);
-            }
-            break;
-
-            case PlaneRelation::Behind:
-            {
-                /* Add current triangle to back sided mesh */
-                auto count = back.vertices.size();
-                back.vertices.push_back(vertices[indices.a]);
-                back.vertices.push_back(vertices[indices.b]);
-                back.vertices.push_back(vertices[indices.c]);
-                back.AddTriangle(count, count + 1, count + 2);
-            }
-            break;
-
-            case PlaneRelation::Clipped:
-            {
-                auto count = front.vertices.size();
-                for (unsigned char i = 0; i < frontPoly.count; ++i)
-                {
-                    front.vertices.push_back(mesh.Barycentric(triIdx, frontPoly.vertices[i]));
-                    if (i >= 2)
-                        front.AddTriangle(count, count + i - 1, count + i);
-                }
-
-                count = back.vertices.size();
-                for (unsigned char i = 0; i < backPoly.count; ++i)
-                {
-                    back.vertices.push_back(mesh.Barycentric(triIdx, backPoly.vertices[i]));
-                    if (i >= 2)
-                        back.AddTriangle(count, count + i - 1, count + i);
-                }
-            }
-            break;
-
-            default:
-            break;
-        }
+            auto out = output.Attrib(attribDesc, i);
+
+            auto in0 = input.Attrib(attribDesc, tri.a);
+            auto in1 = input.Attrib(attribDesc, tri.b);
+            auto in2 = input.Attrib(attribDesc, tri.c);
 
-        /* Track triangle index */
-        ++triIdx;
+            for (std::uint32_t j = 0; j < attribDesc.components; ++j)
+                out[j] = in0[j] * coords.x + in1[j] * coords.y + in2[j] * coords.z;
+        }
     }
 }
 
+void ClipMesh(const TriangleMesh& mesh, const Plane& clipPlane, TriangleMesh& front, TriangleMesh& back)
+{
+    MeshClipper clipper;
+    clipper.Clip(mesh, clipPlane, front, back);
+}
+
+void ClipMesh(const TriangleMeshSoA& mesh, const Plane& clipPlane, TriangleMeshSoA& front, TriangleMeshSoA& back)
+{
+    MeshClipper clipper;
+    clipper.Clip(mesh, clipPlane, front, back);
+}
 
 } // /namespace MeshModifier
 
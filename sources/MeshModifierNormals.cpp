@@ -0,0 +1,515 @@
+/*
+ * MeshModifierNormals.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshModifier.h>
+#include <Geom/MeshAdjacency.h>
+#include "ParallelDetails.h"
+#include "SIMDDetails.h"
+#include <algorithm>
+#include <cmath>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+using VertexIndex   = TriangleMesh::VertexIndex;
+using TriangleIndex = TriangleMesh::TriangleIndex;
+
+
+/* ----- Internal functions ----- */
+
+static const std::size_t g_normalsGrainSize = 8192;
+static const std::size_t g_normalsBlockSize = 256;
+
+// Face normals in SoA layout. The weights are the face areas or the interior angles, depending on the weighting.
+struct FaceNormals
+{
+    std::vector<Gs::Real> nx, ny, nz;   // Normalized face normals (zero for degenerated faces).
+    std::vector<Gs::Real> weights;      // Face weights (one per face) or corner weights (three per face).
+    bool                  perCorner = false;
+};
+
+#ifndef GS_REAL_DOUBLE
+
+/*
+Computes the normalized cross products of the edge vectors in the range [begin, end) with SIMD instructions
+and returns the index of the first face that is not yet computed. The lengths of the cross products are stored in 'len'.
+*/
+static std::size_t CrossNormalizeSIMD(
+    const float* ux, const float* uy, const float* uz,
+    const float* vx, const float* vy, const float* vz,
+    float* nx, float* ny, float* nz, float* len, std::size_t begin, std::size_t end)
+{
+    #ifdef GM_SIMD_SSE2
+
+    const auto zero = _mm_setzero_ps();
+    const auto one  = _mm_set1_ps(1.0f);
+
+    for (; begin + 4 <= end; begin += 4)
+    {
+        const auto ax = _mm_loadu_ps(ux + begin);
+        const auto ay = _mm_loadu_ps(uy + begin);
+        const auto az = _mm_loadu_ps(uz + begin);
+        const auto bx = _mm_loadu_ps(vx + begin);
+        const auto by = _mm_loadu_ps(vy + begin);
+        const auto bz = _mm_loadu_ps(vz + begin);
+
+        const auto cx = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by));
+        const auto cy = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz));
+        const auto cz = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+
+        const auto l = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, cx), _mm_mul_ps(cy, cy)), _mm_mul_ps(cz, cz)));
+
+        /* Degenerated faces get a zero normal */
+        const auto valid    = _mm_cmpgt_ps(l, zero);
+        const auto invLen   = _mm_and_ps(valid, _mm_div_ps(one, _mm_or_ps(l, _mm_andnot_ps(valid, one))));
+
+        _mm_storeu_ps(nx + begin, _mm_mul_ps(cx, invLen));
+        _mm_storeu_ps(ny + begin, _mm_mul_ps(cy, invLen));
+        _mm_storeu_ps(nz + begin, _mm_mul_ps(cz, invLen));
+        _mm_storeu_ps(len + begin, l);
+    }
+
+    #endif
+
+    return begin;
+}
+
+#else
+
+static std::size_t CrossNormalizeSIMD(
+    const double* ux, const double* uy, const double* uz,
+    const double* vx, const double* vy, const double* vz,
+    double* nx, double* ny, double* nz, double* len, std::size_t begin, std::size_t end)
+{
+    #ifdef GM_SIMD_SSE2
+
+    const auto zero = _mm_setzero_pd();
+    const auto one  = _mm_set1_pd(1.0);
+
+    for (; begin + 2 <= end; begin += 2)
+    {
+        const auto ax = _mm_loadu_pd(ux + begin);
+        const auto ay = _mm_loadu_pd(uy + begin);
+        const auto az = _mm_loadu_pd(uz + begin);
+        const auto bx = _mm_loadu_pd(vx + begin);
+        const auto by = _mm_loadu_pd(vy + begin);
+        const auto bz = _mm_loadu_pd(vz + begin);
+
+        const auto cx = _mm_sub_pd(_mm_mul_pd(ay, bz), _mm_mul_pd(az, by));
+        const auto cy = _mm_sub_pd(_mm_mul_pd(az, bx), _mm_mul_pd(ax, bz));
+        const auto cz = _mm_sub_pd(_mm_mul_pd(ax, by), _mm_mul_pd(ay, bx));
+
+        const auto l = _mm_sqrt_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(cx, cx), _mm_mul_pd(cy, cy)), _mm_mul_pd(cz, cz)));
+
+        /* Degenerated faces get a zero normal */
+        const auto valid    = _mm_cmpgt_pd(l, zero);
+        const auto invLen   = _mm_and_pd(valid, _mm_div_pd(one, _mm_or_pd(l, _mm_andnot_pd(valid, one))));
+
+        _mm_storeu_pd(nx + begin, _mm_mul_pd(cx, invLen));
+        _mm_storeu_pd(ny + begin, _mm_mul_pd(cy, invLen));
+        _mm_storeu_pd(nz + begin, _mm_mul_pd(cz, invLen));
+        _mm_storeu_pd(len + begin, l);
+    }
+
+    #endif
+
+    return begin;
+}
+
+#endif
+
+// Returns the interior angle between the two specified edge vectors.
+static Gs::Real InteriorAngle(const Gs::Vector3& u, const Gs::Vector3& v)
+{
+    const auto lenSq = u.LengthSq() * v.LengthSq();
+    if (lenSq <= Gs::Real(0))
+        return Gs::Real(0);
+    const auto c = Gs::Dot(u, v) / std::sqrt(lenSq);
+    return std::acos(std::max(Gs::Real(-1), std::min(c, Gs::Real(1))));
+}
+
+/*
+Computes the normals of all faces. The positions are gathered block-wise into SoA edge vectors,
+so the cross products and normalizations run with SIMD instructions.
+*/
+static void ComputeFaceNormals(const TriangleMesh& mesh, NormalWeighting weighting, FaceNormals& faces)
+{
+    const auto& vertices    = mesh.vertices;
+    const auto& triangles   = mesh.triangles;
+    const auto  numFaces    = triangles.size();
+
+    faces.perCorner = (weighting == NormalWeighting::Angle);
+
+    faces.nx.resize(numFaces);
+    faces.ny.resize(numFaces);
+    faces.nz.resize(numFaces);
+    faces.weights.resize(faces.perCorner ? numFaces*3 : numFaces);
+
+    Details::ParallelFor(
+        numFaces, g_normalsGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            Gs::Real edges[6][g_normalsBlockSize];
+            Gs::Real length[g_normalsBlockSize];
+
+            for (auto blockBegin = begin; blockBegin < end; blockBegin += g_normalsBlockSize)
+            {
+                const auto blockSize = std::min(g_normalsBlockSize, end - blockBegin);
+
+                /* Gather edge vectors */
+                for (std::size_t i = 0; i < blockSize; ++i)
+                {
+                    const auto& tri = triangles[blockBegin + i];
+                    const auto& p0  = vertices[tri.a].position;
+                    const auto  u   = vertices[tri.b].position - p0;
+                    const auto  v   = vertices[tri.c].position - p0;
+
+                    edges[0][i] = u.x;
+                    edges[1][i] = u.y;
+                    edges[2][i] = u.z;
+                    edges[3][i] = v.x;
+                    edges[4][i] = v.y;
+                    edges[5][i] = v.z;
+                }
+
+                /* Compute normalized cross products */
+                auto nx = faces.nx.data() + blockBegin;
+                auto ny = faces.ny.data() + blockBegin;
+                auto nz = faces.nz.data() + blockBegin;
+
+                auto i = CrossNormalizeSIMD(
+                    edges[0], edges[1], edges[2], edges[3], edges[4], edges[5],
+                    nx, ny, nz, length, 0, blockSize
+                );
+
+                for (; i < blockSize; ++i)
+                {
+                    const Gs::Vector3 u(edges[0][i], edges[1][i], edges[2][i]);
+                    const Gs::Vector3 v(edges[3][i], edges[4][i], edges[5][i]);
+                    const auto c = Gs::Cross(u, v);
+                    const auto l = c.Length();
+                    const auto s = (l > Gs::Real(0) ? Gs::Real(1) / l : Gs::Real(0));
+
+                    nx[i]       = c.x * s;
+                    ny[i]       = c.y * s;
+                    nz[i]       = c.z * s;
+                    length[i]   = l;
+                }
+
+                /* Store face weights */
+                switch (weighting)
+                {
+                    case NormalWeighting::Uniform:
+                        for (i = 0; i < blockSize; ++i)
+                            faces.weights[blockBegin + i] = (length[i] > Gs::Real(0) ? Gs::Real(1) : Gs::Real(0));
+                        break;
+
+                    case NormalWeighting::Area:
+                        for (i = 0; i < blockSize; ++i)
+                            faces.weights[blockBegin + i] = length[i] * Gs::Real(0.5);
+                        break;
+
+                    case NormalWeighting::Angle:
+                        for (i = 0; i < blockSize; ++i)
+                        {
+                            const auto& tri = triangles[blockBegin + i];
+                            const auto& p0  = vertices[tri.a].position;
+                            const auto& p1  = vertices[tri.b].position;
+                            const auto& p2  = vertices[tri.c].position;
+                            auto        w   = faces.weights.data() + (blockBegin + i)*3;
+
+                            if (length[i] > Gs::Real(0))
+                            {
+                                w[0] = InteriorAngle(p1 - p0, p2 - p0);
+                                w[1] = InteriorAngle(p2 - p1, p0 - p1);
+                                w[2] = Gs::Real(Gs::pi) - w[0] - w[1];
+                            }
+                            else
+                                w[0] = w[1] = w[2] = Gs::Real(0);
+                        }
+                        break;
+                }
+            }
+        }
+    );
+}
+
+/*
+Vertex normal gatherer. Each vertex sums the weighted normals of the faces around it,
+which are identified either by the vertex index or by the representative of its position group.
+*/
+class NormalGatherer
+{
+
+    public:
+
+        using TriangleRange = MeshAdjacency::TriangleRange;
+
+        NormalGatherer(const TriangleMesh& mesh, const MeshAdjacency& adjacency, const FaceNormals& faces, bool smoothSeams) :
+            triangles_  { mesh.triangles },
+            adjacency_  { adjacency      },
+            faces_      { faces          },
+            weldSeams_  { smoothSeams    }
+        {
+        }
+
+        Gs::Vector3 FaceNormal(TriangleIndex t) const
+        {
+            return Gs::Vector3(faces_.nx[t], faces_.ny[t], faces_.nz[t]);
+        }
+
+        TriangleRange Faces(VertexIndex v) const
+        {
+            return (weldSeams_ ? adjacency_.PositionTriangles(v) : adjacency_.VertexTriangles(v));
+        }
+
+        // Returns the weight of the specified face for the specified vertex.
+        Gs::Real FaceWeight(TriangleIndex t, VertexIndex v) const
+        {
+            if (!faces_.perCorner)
+                return faces_.weights[t];
+
+            const auto& tri = triangles_[t];
+            const auto  key = Key(v);
+
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                if (Key(tri[i]) == key)
+                    return faces_.weights[t*3 + i];
+            }
+
+            return Gs::Real(0);
+        }
+
+        /*
+        Sums the weighted normals of all faces around the specified vertex.
+        If 'creaseFace' is a valid face index, only faces within the crease angle of that face are included.
+        */
+        Gs::Vector3 Gather(VertexIndex v, TriangleIndex creaseFace, Gs::Real cosCrease) const
+        {
+            const auto hasCrease = (creaseFace != g_invalidTriangle);
+            const auto creaseNormal = (hasCrease ? FaceNormal(creaseFace) : Gs::Vector3());
+
+            Gs::Vector3 sum;
+
+            for (auto t : Faces(v))
+            {
+                const auto n = FaceNormal(t);
+                if (!hasCrease || Gs::Dot(n, creaseNormal) >= cosCrease)
+                    sum += n * FaceWeight(t, v);
+            }
+
+            return sum;
+        }
+
+        static const TriangleIndex g_invalidTriangle = ~TriangleIndex(0);
+
+    private:
+
+        VertexIndex Key(VertexIndex v) const
+        {
+            return (weldSeams_ ? adjacency_.WeldedVertex(v) : v);
+        }
+
+        const std::vector<TriangleMesh::Triangle>&  triangles_;
+        const MeshAdjacency&                        adjacency_;
+        const FaceNormals&                          faces_;
+        bool                                        weldSeams_;
+
+};
+
+static bool NormalizeInto(const Gs::Vector3& sum, Gs::Vector3& normal)
+{
+    const auto lenSq = sum.LengthSq();
+    if (lenSq > Gs::Real(0))
+    {
+        normal = sum / std::sqrt(lenSq);
+        return true;
+    }
+    return false;
+}
+
+// Recomputes the normals of all vertices without creases.
+static void GatherSmoothNormals(TriangleMesh& mesh, const NormalGatherer& gatherer)
+{
+    auto& vertices = mesh.vertices;
+
+    Details::ParallelFor(
+        vertices.size(), g_normalsGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto v = begin; v < end; ++v)
+            {
+                const auto sum = gatherer.Gather(static_cast<VertexIndex>(v), NormalGatherer::g_invalidTriangle, Gs::Real(0));
+                NormalizeInto(sum, vertices[v].normal);
+            }
+        }
+    );
+}
+
+/*
+Recomputes the normals of all triangle corners with creases and splits each vertex whose corners have different normals.
+The corner normals are computed in parallel, where each vertex only writes the corners that refer to it.
+*/
+static std::size_t GatherCreaseNormals(
+    TriangleMesh&           mesh,
+    const MeshAdjacency&    adjacency,
+    const NormalGatherer&   gatherer,
+    Gs::Real                cosCrease)
+{
+    auto& vertices  = mesh.vertices;
+    auto& triangles = mesh.triangles;
+
+    const auto numVertices = vertices.size();
+
+    std::vector<Gs::Vector3>    cornerNormals(triangles.size() * 3);
+    std::vector<std::uint8_t>   cornerValid(triangles.size() * 3, 0);
+
+    Details::ParallelFor(
+        numVertices, g_normalsGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto v = begin; v < end; ++v)
+            {
+                for (auto t : adjacency.VertexTriangles(static_cast<VertexIndex>(v)))
+                {
+                    const auto sum = gatherer.Gather(static_cast<VertexIndex>(v), t, cosCrease);
+
+                    for (std::size_t i = 0; i < 3; ++i)
+                    {
+                        if (triangles[t][i] == v)
+                            cornerValid[t*3 + i] = (NormalizeInto(sum, cornerNormals[t*3 + i]) ? 1 : 0);
+                    }
+                }
+            }
+        }
+    );
+
+    /* Split vertices with different corner normals (compared with a small tolerance) */
+    const auto equalThreshold = Gs::Real(1) - Gs::Real(1e-4);
+
+    std::vector<VertexIndex> splits;
+
+    for (VertexIndex v = 0; v < numVertices; ++v)
+    {
+        splits.clear();
+
+        for (auto t : adjacency.VertexTriangles(v))
+        {
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                const auto corner = t*3 + i;
+
+                if (triangles[t][i] != v || !cornerValid[corner])
+                    continue;
+
+                const auto& normal = cornerNormals[corner];
+
+                if (splits.empty())
+                {
+                    /* First normal is stored in the original vertex */
+                    vertices[v].normal = normal;
+                    splits.push_back(v);
+                    continue;
+                }
+
+                /* Find vertex with equal normal or append a new one */
+                auto it = std::find_if(
+                    splits.begin(), splits.end(),
+                    [&](VertexIndex w)
+                    {
+                        return (Gs::Dot(vertices[w].normal, normal) >= equalThreshold);
+                    }
+                );
+
+                if (it == splits.end())
+                {
+                    auto vertex = vertices[v];
+                    vertex.normal = normal;
+                    vertices.push_back(vertex);
+                    splits.push_back(static_cast<VertexIndex>(vertices.size() - 1));
+                    triangles[t][i] = splits.back();
+                }
+                else
+                    triangles[t][i] = *it;
+            }
+        }
+    }
+
+    return (vertices.size() - numVertices);
+}
+
+
+/* ----- Global functions ----- */
+
+void ComputeTriangleNormals(const TriangleMesh& mesh, std::vector<Gs::Vector3>& normals)
+{
+    FaceNormals faces;
+    ComputeFaceNormals(mesh, NormalWeighting::Uniform, faces);
+
+    const auto numFaces = mesh.triangles.size();
+    normals.resize(numFaces);
+
+    Details::ParallelFor(
+        numFaces, g_normalsGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+                normals[i] = Gs::Vector3(faces.nx[i], faces.ny[i], faces.nz[i]);
+        }
+    );
+}
+
+std::size_t RecomputeNormals(TriangleMesh& mesh, const NormalsDescriptor& normalsDesc)
+{
+    if (mesh.vertices.empty() || mesh.triangles.empty())
+        return 0;
+
+    /* Get vertex-to-triangle adjacency (with position welding for smooth seams) */
+    const MeshAdjacency* adjacency = mesh.GetAdjacency();
+
+    MeshAdjacency temporaryAdjacency;
+    if (!adjacency || !adjacency->IsBuiltFor(mesh) || (normalsDesc.smoothSeams && !adjacency->HasPositionWelding()))
+    {
+        temporaryAdjacency.Build(mesh, normalsDesc.smoothSeams);
+        adjacency = &temporaryAdjacency;
+    }
+
+    /* Compute face normals and weights */
+    FaceNormals faces;
+    ComputeFaceNormals(mesh, normalsDesc.weighting, faces);
+
+    NormalGatherer gatherer(mesh, *adjacency, faces, normalsDesc.smoothSeams);
+
+    /* Gather vertex normals */
+    if (normalsDesc.creaseAngle >= Gs::Real(Gs::pi))
+    {
+        GatherSmoothNormals(mesh, gatherer);
+        return 0;
+    }
+
+    const auto numSplits = GatherCreaseNormals(mesh, *adjacency, gatherer, std::cos(std::max(Gs::Real(0), normalsDesc.creaseAngle)));
+
+    if (numSplits > 0)
+        mesh.ClearAdjacency();
+
+    return numSplits;
+}
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+
+// ================================================================================
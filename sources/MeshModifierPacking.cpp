@@ -0,0 +1,430 @@
+/*
+ * MeshModifierPacking.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshModifier.h>
+#include "ParallelDetails.h"
+#include "SIMDDetails.h"
+#include "Except.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+/* ----- Internal functions ----- */
+
+static const std::size_t g_packingGrainSize = 16384;
+static const std::size_t g_packingBlockSize = 256;
+
+static std::uint32_t GetSemanticComponents(VertexSemantic semantic)
+{
+    return (semantic == VertexSemantic::TexCoord ? 2 : 3);
+}
+
+static std::size_t GetSemanticOffset(VertexSemantic semantic)
+{
+    switch (semantic)
+    {
+        case VertexSemantic::Position:  return offsetof(TriangleMesh::Vertex, position);
+        case VertexSemantic::Normal:    return offsetof(TriangleMesh::Vertex, normal);
+        case VertexSemantic::TexCoord:  return offsetof(TriangleMesh::Vertex, texCoord);
+    }
+    return 0;
+}
+
+static bool IsOctahedralFormat(VertexFormat format)
+{
+    return (format == VertexFormat::OctahedralSNorm8 || format == VertexFormat::OctahedralSNorm16);
+}
+
+// Returns the format of the encoded components.
+static VertexFormat GetComponentFormat(VertexFormat format)
+{
+    switch (format)
+    {
+        case VertexFormat::OctahedralSNorm8:    return VertexFormat::SNorm8;
+        case VertexFormat::OctahedralSNorm16:   return VertexFormat::SNorm16;
+        default:                                return format;
+    }
+}
+
+static std::size_t GetComponentSize(VertexFormat format)
+{
+    switch (GetComponentFormat(format))
+    {
+        case VertexFormat::Real:    return sizeof(Gs::Real);
+        case VertexFormat::Float:   return 4;
+        case VertexFormat::Half:    return 2;
+        case VertexFormat::SNorm8:  return 1;
+        case VertexFormat::SNorm16: return 2;
+        case VertexFormat::UNorm8:  return 1;
+        case VertexFormat::UNorm16: return 2;
+        default:                    return 0;
+    }
+}
+
+// Converts the specified float into half precision with rounding to nearest even.
+static std::uint16_t FloatToHalf(float value)
+{
+    std::uint32_t f;
+    std::memcpy(&f, &value, sizeof(f));
+
+    const auto sign = static_cast<std::uint16_t>((f >> 16) & 0x8000u);
+    f &= 0x7FFFFFFFu;
+
+    /* Infinity and NaN (keep NaN quiet) */
+    if (f >= 0x7F800000u)
+        return (sign | 0x7C00u | (f > 0x7F800000u ? 0x0200u : 0u));
+
+    /* Overflow to infinity (values >= 65520 round up to infinity) */
+    if (f >= 0x477FF000u)
+        return (sign | 0x7C00u);
+
+    /* Underflow to zero (values < 2^-25) */
+    if (f < 0x33000000u)
+        return sign;
+
+    std::uint32_t h, rem, halfway;
+
+    if (f < 0x38800000u)
+    {
+        /* Subnormal half, i.e. value < 2^-14 */
+        const auto shift    = 126u - (f >> 23);
+        const auto mantissa = (f & 0x007FFFFFu) | 0x00800000u;
+        h       = mantissa >> shift;
+        rem     = mantissa & ((1u << shift) - 1u);
+        halfway = 1u << (shift - 1u);
+    }
+    else
+    {
+        /* Normalized half: rebias exponent from 127 to 15 */
+        h       = (f - 0x38000000u) >> 13;
+        rem     = f & 0x1FFFu;
+        halfway = 0x1000u;
+    }
+
+    if (rem > halfway || (rem == halfway && (h & 1u) != 0))
+        ++h;
+
+    return static_cast<std::uint16_t>(sign | h);
+}
+
+// Returns the scale and the lower clamp bound of the specified normalized format.
+static void GetNormalizedRange(VertexFormat format, float& scale, float& lower)
+{
+    switch (format)
+    {
+        case VertexFormat::SNorm8:  scale = 127.0f;     lower = -1.0f;  break;
+        case VertexFormat::SNorm16: scale = 32767.0f;   lower = -1.0f;  break;
+        case VertexFormat::UNorm8:  scale = 255.0f;     lower = 0.0f;   break;
+        default:                    scale = 65535.0f;   lower = 0.0f;   break;
+    }
+}
+
+/*
+Converts a lane of components into the bit patterns of the specified format (in the low bits of each output value).
+The scalar remainders use the same clamping and rounding as the SIMD instructions.
+*/
+static void ConvertLane(const float* src, std::size_t count, VertexFormat format, std::uint32_t* dst)
+{
+    std::size_t i = 0;
+
+    switch (format)
+    {
+        case VertexFormat::Float:
+        {
+            std::memcpy(dst, src, count * sizeof(float));
+        }
+        break;
+
+        case VertexFormat::Half:
+        {
+            #ifdef GM_SIMD_F16C
+            for (; i + 4 <= count; i += 4)
+            {
+                const auto h = _mm_cvtps_ph(_mm_loadu_ps(src + i), 0);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(h, _mm_setzero_si128()));
+            }
+            #endif
+            for (; i < count; ++i)
+                dst[i] = FloatToHalf(src[i]);
+        }
+        break;
+
+        default:
+        {
+            float scale, lower;
+            GetNormalizedRange(format, scale, lower);
+
+            #ifdef GM_SIMD_SSE2
+            const auto lowerV = _mm_set1_ps(lower);
+            const auto upperV = _mm_set1_ps(1.0f);
+            const auto scaleV = _mm_set1_ps(scale);
+
+            for (; i + 4 <= count; i += 4)
+            {
+                /* Clamp (NaN is mapped to the lower bound) and round to nearest */
+                auto v = _mm_max_ps(_mm_loadu_ps(src + i), lowerV);
+                v = _mm_mul_ps(_mm_min_ps(v, upperV), scaleV);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_cvtps_epi32(v));
+            }
+            #endif
+
+            for (; i < count; ++i)
+            {
+                const auto v = std::min(1.0f, std::max(lower, src[i])) * scale;
+                dst[i] = static_cast<std::uint32_t>(static_cast<std::int32_t>(std::nearbyint(v)));
+            }
+        }
+        break;
+    }
+}
+
+// Writes the low bytes of the converted components into the strided output buffer.
+static void ScatterLane(const std::uint32_t* src, std::size_t count, std::size_t componentSize, char* dst, std::size_t stride)
+{
+    switch (componentSize)
+    {
+        case 1:
+            for (std::size_t i = 0; i < count; ++i, dst += stride)
+                *reinterpret_cast<std::uint8_t*>(dst) = static_cast<std::uint8_t>(src[i]);
+            break;
+
+        case 2:
+            for (std::size_t i = 0; i < count; ++i, dst += stride)
+            {
+                const auto v = static_cast<std::uint16_t>(src[i]);
+                std::memcpy(dst, &v, 2);
+            }
+            break;
+
+        default:
+            for (std::size_t i = 0; i < count; ++i, dst += stride)
+                std::memcpy(dst, src + i, 4);
+            break;
+    }
+}
+
+static void ValidatePackingDesc(const VertexPackingDescriptor& packingDesc)
+{
+    for (const auto& attrib : packingDesc.attributes)
+    {
+        const auto& desc = attrib.attribute;
+
+        if (desc.components == 0 || desc.components > GetSemanticComponents(attrib.semantic))
+            throw std::invalid_argument(GM_EXCEPT_INFO("number of vertex attribute components exceeds the components of its semantic"));
+        if (IsOctahedralFormat(desc.format) && desc.components != 3)
+            throw std::invalid_argument(GM_EXCEPT_INFO("octahedral vertex formats require 3 source components"));
+
+        const auto stride = GetPackedVertexStride(packingDesc, attrib.buffer);
+        if (desc.offset + GetVertexFormatSize(desc.format, desc.components) > stride)
+            throw std::invalid_argument(GM_EXCEPT_INFO("vertex attribute exceeds the stride of its buffer"));
+    }
+}
+
+// Packs a single attribute for the vertex range [begin, end), which must not be larger than the block size.
+static void PackAttributeBlock(
+    const TriangleMesh::Vertex* vertices,
+    std::size_t                 begin,
+    std::size_t                 end,
+    const PackedVertexAttribute& attrib,
+    char*                       buffer,
+    std::size_t                 stride)
+{
+    const auto& desc        = attrib.attribute;
+    const auto  srcOffset   = GetSemanticOffset(attrib.semantic);
+    const auto  count       = end - begin;
+    auto        dst         = buffer + begin * stride + desc.offset;
+
+    if (desc.format == VertexFormat::Real)
+    {
+        /* Copy components without conversion */
+        for (auto i = begin; i < end; ++i, dst += stride)
+            std::memcpy(dst, reinterpret_cast<const char*>(&vertices[i]) + srcOffset, desc.components * sizeof(Gs::Real));
+        return;
+    }
+
+    /* Gather components into SoA lanes */
+    float           lanes[3][g_packingBlockSize];
+    std::uint32_t   bits[g_packingBlockSize];
+    std::uint32_t   numLanes = desc.components;
+
+    if (IsOctahedralFormat(desc.format))
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const auto& v = *reinterpret_cast<const Gs::Vector3*>(reinterpret_cast<const char*>(&vertices[begin + i]) + srcOffset);
+            const auto  p = EncodeOctahedral(v);
+            lanes[0][i] = static_cast<float>(p.x);
+            lanes[1][i] = static_cast<float>(p.y);
+        }
+        numLanes = 2;
+    }
+    else
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const auto src = reinterpret_cast<const Gs::Real*>(reinterpret_cast<const char*>(&vertices[begin + i]) + srcOffset);
+            for (std::uint32_t c = 0; c < numLanes; ++c)
+                lanes[c][i] = static_cast<float>(src[c]);
+        }
+    }
+
+    /* Convert each lane and write it into the output buffer */
+    const auto format           = GetComponentFormat(desc.format);
+    const auto componentSize    = GetComponentSize(format);
+
+    for (std::uint32_t c = 0; c < numLanes; ++c)
+    {
+        ConvertLane(lanes[c], count, format, bits);
+        ScatterLane(bits, count, componentSize, dst + c * componentSize, stride);
+    }
+}
+
+
+/* ----- Global functions ----- */
+
+std::size_t GetVertexFormatSize(VertexFormat format, std::uint32_t components)
+{
+    if (IsOctahedralFormat(format))
+        return 2 * GetComponentSize(format);
+    return components * GetComponentSize(format);
+}
+
+std::size_t GetPackedVertexStride(const VertexPackingDescriptor& packingDesc, std::uint32_t buffer)
+{
+    if (buffer < packingDesc.strides.size() && packingDesc.strides[buffer] != 0)
+        return packingDesc.strides[buffer];
+
+    /* Use the end of the last attribute in this buffer */
+    std::size_t stride = 0;
+
+    for (const auto& attrib : packingDesc.attributes)
+    {
+        if (attrib.buffer == buffer)
+            stride = std::max(stride, attrib.attribute.offset + GetVertexFormatSize(attrib.attribute.format, attrib.attribute.components));
+    }
+
+    return stride;
+}
+
+std::uint32_t GetNumPackedVertexBuffers(const VertexPackingDescriptor& packingDesc)
+{
+    std::uint32_t numBuffers = 0;
+
+    for (const auto& attrib : packingDesc.attributes)
+        numBuffers = std::max(numBuffers, attrib.buffer + 1);
+
+    return numBuffers;
+}
+
+void PackVertices(const TriangleMesh& mesh, const VertexPackingDescriptor& packingDesc, void* const* buffers)
+{
+    ValidatePackingDesc(packingDesc);
+
+    /* Determine strides of all attributes before the vertex loop */
+    std::vector<std::size_t> strides(packingDesc.attributes.size());
+
+    for (std::size_t i = 0; i < strides.size(); ++i)
+        strides[i] = GetPackedVertexStride(packingDesc, packingDesc.attributes[i].buffer);
+
+    const auto vertices = mesh.vertices.data();
+
+    Details::ParallelFor(
+        mesh.vertices.size(),
+        g_packingGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            /* Pack all attributes per block, so the source vertices are still in cache for the next attribute */
+            for (auto blockBegin = begin; blockBegin < end; blockBegin += g_packingBlockSize)
+            {
+                const auto blockEnd = std::min(end, blockBegin + g_packingBlockSize);
+
+                for (std::size_t i = 0; i < strides.size(); ++i)
+                {
+                    const auto& attrib = packingDesc.attributes[i];
+                    PackAttributeBlock(vertices, blockBegin, blockEnd, attrib, reinterpret_cast<char*>(buffers[attrib.buffer]), strides[i]);
+                }
+            }
+        }
+    );
+}
+
+void PackVertices(const TriangleMesh& mesh, const VertexPackingDescriptor& packingDesc, std::vector<std::vector<std::uint8_t>>& buffers)
+{
+    const auto numBuffers = GetNumPackedVertexBuffers(packingDesc);
+
+    buffers.resize(numBuffers);
+
+    std::vector<void*> bufferPtrs(numBuffers);
+
+    for (std::uint32_t i = 0; i < numBuffers; ++i)
+    {
+        buffers[i].resize(mesh.vertices.size() * GetPackedVertexStride(packingDesc, i));
+        bufferPtrs[i] = buffers[i].data();
+    }
+
+    PackVertices(mesh, packingDesc, bufferPtrs.data());
+}
+
+Gs::Vector2 EncodeOctahedral(const Gs::Vector3& normal)
+{
+    const auto l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (l1 <= Gs::Real(0))
+        return Gs::Vector2(0, 0);
+
+    auto x = normal.x / l1;
+    auto y = normal.y / l1;
+
+    if (normal.z < Gs::Real(0))
+    {
+        /* Fold lower hemisphere over the diagonals */
+        const auto fx = (Gs::Real(1) - std::abs(y)) * (x >= Gs::Real(0) ? Gs::Real(1) : Gs::Real(-1));
+        const auto fy = (Gs::Real(1) - std::abs(x)) * (y >= Gs::Real(0) ? Gs::Real(1) : Gs::Real(-1));
+        x = fx;
+        y = fy;
+    }
+
+    return Gs::Vector2(x, y);
+}
+
+Gs::Vector3 DecodeOctahedral(const Gs::Vector2& coords)
+{
+    auto x = coords.x;
+    auto y = coords.y;
+    auto z = Gs::Real(1) - std::abs(x) - std::abs(y);
+
+    if (z < Gs::Real(0))
+    {
+        /* Unfold lower hemisphere */
+        const auto fx = (Gs::Real(1) - std::abs(y)) * (x >= Gs::Real(0) ? Gs::Real(1) : Gs::Real(-1));
+        const auto fy = (Gs::Real(1) - std::abs(x)) * (y >= Gs::Real(0) ? Gs::Real(1) : Gs::Real(-1));
+        x = fx;
+        y = fy;
+    }
+
+    Gs::Vector3 normal(x, y, z);
+    normal.Normalize();
+
+    return normal;
+}
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+
+// ================================================================================
@@ -0,0 +1,592 @@
+/*
+ * MeshModifierSimplify.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshModifier.h>
+#include <Geom/MeshAdjacency.h>
+#include <algorithm>
+#include <queue>
+#include <cmath>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+using VertexIndex   = TriangleMesh::VertexIndex;
+using TriangleIndex = TriangleMesh::TriangleIndex;
+
+
+/* ----- Internal functions ----- */
+
+static const VertexIndex g_invalidVertex = ~VertexIndex(0);
+
+// Symmetric 4x4 quadric matrix of the plane equation 'n*x + d = 0' (stored as upper triangle).
+struct Quadric
+{
+    Quadric() = default;
+
+    Quadric(const Gs::Vector3& n, Gs::Real d) :
+        a00 { n.x*n.x }, a01 { n.x*n.y }, a02 { n.x*n.z },
+        a11 { n.y*n.y }, a12 { n.y*n.z }, a22 { n.z*n.z },
+        b0  { n.x*d   }, b1  { n.y*d   }, b2  { n.z*d   },
+        c   { d*d     }
+    {
+    }
+
+    Quadric& operator += (const Quadric& rhs)
+    {
+        a00 += rhs.a00; a01 += rhs.a01; a02 += rhs.a02;
+        a11 += rhs.a11; a12 += rhs.a12; a22 += rhs.a22;
+        b0  += rhs.b0;  b1  += rhs.b1;  b2  += rhs.b2;
+        c   += rhs.c;
+        return *this;
+    }
+
+    // Returns the sum of squared distances of the specified point to all planes of this quadric.
+    double Evaluate(const Gs::Vector3& p) const
+    {
+        const double x = p.x, y = p.y, z = p.z;
+        return
+        (
+            a00*x*x + 2*a01*x*y + 2*a02*x*z +
+            a11*y*y + 2*a12*y*z + a22*z*z +
+            2*(b0*x + b1*y + b2*z) + c
+        );
+    }
+
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0;
+    double c = 0;
+};
+
+// Half-edge collapse candidate of the position group 'from' into the position group 'to'.
+struct Collapse
+{
+    double          cost;
+    VertexIndex     from;
+    VertexIndex     to;
+    std::size_t     version;
+
+    bool operator < (const Collapse& rhs) const
+    {
+        /* Inverted for a min-heap with std::priority_queue */
+        return (cost > rhs.cost);
+    }
+};
+
+/*
+Quadric error mesh simplifier. All vertices with equal positions form a position group, which is represented by its vertex
+with the smallest index. Collapses are performed per group: each vertex of the source group is collapsed into the vertex
+of the target group it shares an edge with, so attribute seams are only collapsed along the seam.
+*/
+class MeshSimplifier
+{
+
+    public:
+
+        MeshSimplifier(const TriangleMesh& mesh, const SimplifyDescriptor& simplifyDesc);
+
+        // Collapses edges until the number of triangles does not exceed the specified count or the error limit is reached.
+        void SimplifyTo(std::size_t targetTriangleCount);
+
+        // Returns all remaining triangles.
+        std::vector<TriangleMesh::Triangle> Triangles() const;
+
+        // Returns the error of the last collapse.
+        Gs::Real GetError() const
+        {
+            return static_cast<Gs::Real>(std::sqrt(std::max(0.0, error_)));
+        }
+
+    private:
+
+        // Returns true if the triangle contains a vertex of the specified position group.
+        bool ContainsGroup(const TriangleMesh::Triangle& tri, VertexIndex group) const;
+
+        // Returns the vertex of the specified group, which is connected to the vertex 'v', or g_invalidVertex if there is no unique vertex.
+        VertexIndex FindCollapseTarget(VertexIndex v, VertexIndex toGroup) const;
+
+        // Returns true if the edge between the two groups is only shared by a single triangle.
+        bool IsBorderEdge(VertexIndex fromGroup, VertexIndex toGroup) const;
+
+        // Returns true if moving the vertex 'v' to the position of the group 'toGroup' would flip any of its triangles.
+        bool FlipsTriangles(VertexIndex v, VertexIndex toGroup) const;
+
+        // Returns the cost of the collapse or a negative value if the collapse is not allowed.
+        double CollapseCost(VertexIndex fromGroup, VertexIndex toGroup) const;
+
+        // Pushes the best collapse of the specified group into the queue.
+        void UpdateCollapse(VertexIndex group);
+
+        // Collects the groups that are connected to the specified group.
+        void CollectNeighborGroups(VertexIndex group, std::vector<VertexIndex>& neighbors) const;
+
+        void PerformCollapse(VertexIndex fromGroup, VertexIndex toGroup);
+
+        const Gs::Vector3& GroupPosition(VertexIndex group) const
+        {
+            return vertices_[group].position;
+        }
+
+        const std::vector<TriangleMesh::Vertex>&    vertices_;
+        double                                      maxErrorSq_     = 0.0;
+        double                                      error_          = 0.0;
+        bool                                        lockBorders_    = false;
+
+        std::vector<TriangleMesh::Triangle>         triangles_;
+        std::vector<bool>                           aliveTriangles_;
+        std::size_t                                 numAliveTriangles_ = 0;
+
+        std::vector<std::vector<TriangleIndex>>     vertexTriangles_;   // Triangles of each vertex (may contain removed triangles).
+        std::vector<VertexIndex>                    groups_;            // Position group of each vertex.
+        std::vector<std::vector<VertexIndex>>       groupMembers_;      // Vertices of each position group (only for representatives).
+        std::vector<bool>                           borderGroups_;
+        std::vector<bool>                           removedGroups_;
+        std::vector<std::size_t>                    groupVersions_;
+        std::vector<Quadric>                        quadrics_;
+
+        std::priority_queue<Collapse>               queue_;
+        bool                                        errorLimitReached_  = false;
+
+};
+
+MeshSimplifier::MeshSimplifier(const TriangleMesh& mesh, const SimplifyDescriptor& simplifyDesc) :
+    vertices_           { mesh.vertices                 },
+    lockBorders_        { simplifyDesc.lockBorders      },
+    triangles_          { mesh.triangles                },
+    aliveTriangles_     ( mesh.triangles.size(), true   ),
+    numAliveTriangles_  { mesh.triangles.size()         }
+{
+    const auto numVertices = vertices_.size();
+
+    const double maxError = std::max(Gs::Real(0), simplifyDesc.maxError);
+    maxErrorSq_ = maxError*maxError;
+
+    /* Build vertex adjacency and position groups */
+    MeshAdjacency adjacency(mesh, true);
+
+    vertexTriangles_.resize(numVertices);
+    groups_.resize(numVertices);
+    groupMembers_.resize(numVertices);
+
+    for (VertexIndex v = 0; v < numVertices; ++v)
+    {
+        auto range = adjacency.VertexTriangles(v);
+        vertexTriangles_[v].assign(range.begin(), range.end());
+
+        groups_[v] = adjacency.WeldedVertex(v);
+        groupMembers_[groups_[v]].push_back(v);
+    }
+
+    /* Accumulate plane quadrics of all triangles for each position group */
+    quadrics_.resize(numVertices);
+
+    for (const auto& tri : triangles_)
+    {
+        const auto& p0 = vertices_[tri.a].position;
+        const auto& p1 = vertices_[tri.b].position;
+        const auto& p2 = vertices_[tri.c].position;
+
+        auto normal = Gs::Cross(p1 - p0, p2 - p0);
+        if (normal.LengthSq() <= Gs::Real(0))
+            continue;
+
+        normal.Normalize();
+
+        const Quadric q(normal, -Gs::Dot(normal, p0));
+
+        quadrics_[groups_[tri.a]] += q;
+        if (groups_[tri.b] != groups_[tri.a])
+            quadrics_[groups_[tri.b]] += q;
+        if (groups_[tri.c] != groups_[tri.a] && groups_[tri.c] != groups_[tri.b])
+            quadrics_[groups_[tri.c]] += q;
+    }
+
+    /* Find border groups, i.e. groups with an edge that is only shared by a single triangle */
+    borderGroups_.resize(numVertices, false);
+    removedGroups_.resize(numVertices, false);
+    groupVersions_.resize(numVertices, 0);
+
+    std::vector<VertexIndex> neighbors;
+
+    for (VertexIndex g = 0; g < numVertices; ++g)
+    {
+        if (groups_[g] != g)
+            continue;
+
+        CollectNeighborGroups(g, neighbors);
+
+        for (auto n : neighbors)
+        {
+            if (IsBorderEdge(g, n))
+            {
+                borderGroups_[g] = true;
+                break;
+            }
+        }
+    }
+
+    /* Initialize priority queue */
+    for (VertexIndex g = 0; g < numVertices; ++g)
+    {
+        if (groups_[g] == g)
+            UpdateCollapse(g);
+    }
+}
+
+void MeshSimplifier::SimplifyTo(std::size_t targetTriangleCount)
+{
+    while (numAliveTriangles_ > targetTriangleCount && !errorLimitReached_ && !queue_.empty())
+    {
+        const auto collapse = queue_.top();
+
+        /* Skip outdated collapses */
+        if (removedGroups_[collapse.from] || groupVersions_[collapse.from] != collapse.version)
+        {
+            queue_.pop();
+            continue;
+        }
+
+        /* Stop if the error limit is reached (the collapse remains in the queue for the next level) */
+        if (collapse.cost > maxErrorSq_)
+        {
+            errorLimitReached_ = true;
+            break;
+        }
+
+        queue_.pop();
+
+        /* Validate collapse again, since the neighborhood might have changed */
+        if (removedGroups_[collapse.to] || CollapseCost(collapse.from, collapse.to) < 0.0)
+        {
+            UpdateCollapse(collapse.from);
+            continue;
+        }
+
+        error_ = std::max(error_, collapse.cost);
+        PerformCollapse(collapse.from, collapse.to);
+    }
+}
+
+std::vector<TriangleMesh::Triangle> MeshSimplifier::Triangles() const
+{
+    std::vector<TriangleMesh::Triangle> triangles;
+    triangles.reserve(numAliveTriangles_);
+
+    for (std::size_t i = 0; i < triangles_.size(); ++i)
+    {
+        if (aliveTriangles_[i])
+            triangles.push_back(triangles_[i]);
+    }
+
+    return triangles;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+bool MeshSimplifier::ContainsGroup(const TriangleMesh::Triangle& tri, VertexIndex group) const
+{
+    return (groups_[tri.a] == group || groups_[tri.b] == group || groups_[tri.c] == group);
+}
+
+VertexIndex MeshSimplifier::FindCollapseTarget(VertexIndex v, VertexIndex toGroup) const
+{
+    auto target = g_invalidVertex;
+
+    for (auto t : vertexTriangles_[v])
+    {
+        if (!aliveTriangles_[t])
+            continue;
+
+        const auto& tri = triangles_[t];
+
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            if (groups_[tri[i]] == toGroup)
+            {
+                if (target == g_invalidVertex)
+                    target = tri[i];
+                else if (target != tri[i])
+                    return g_invalidVertex;
+            }
+        }
+    }
+
+    return target;
+}
+
+bool MeshSimplifier::IsBorderEdge(VertexIndex fromGroup, VertexIndex toGroup) const
+{
+    std::size_t n = 0;
+
+    for (auto v : groupMembers_[fromGroup])
+    {
+        for (auto t : vertexTriangles_[v])
+        {
+            if (aliveTriangles_[t] && ContainsGroup(triangles_[t], toGroup))
+                ++n;
+        }
+    }
+
+    return (n == 1);
+}
+
+bool MeshSimplifier::FlipsTriangles(VertexIndex v, VertexIndex toGroup) const
+{
+    const auto& target = GroupPosition(toGroup);
+
+    for (auto t : vertexTriangles_[v])
+    {
+        if (!aliveTriangles_[t])
+            continue;
+
+        const auto& tri = triangles_[t];
+
+        /* Triangles that contain both groups are removed by the collapse */
+        if (ContainsGroup(tri, toGroup))
+            continue;
+
+        /* Compare triangle normal before and after the collapse */
+        Gs::Vector3 p[3] =
+        {
+            vertices_[tri.a].position,
+            vertices_[tri.b].position,
+            vertices_[tri.c].position
+        };
+
+        const auto normal = Gs::Cross(p[1] - p[0], p[2] - p[0]);
+
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            if (tri[i] == v)
+                p[i] = target;
+        }
+
+        const auto newNormal = Gs::Cross(p[1] - p[0], p[2] - p[0]);
+
+        if (Gs::Dot(normal, newNormal) <= Gs::Real(0))
+            return true;
+    }
+
+    return false;
+}
+
+double MeshSimplifier::CollapseCost(VertexIndex fromGroup, VertexIndex toGroup) const
+{
+    /* Border vertices are only collapsed along the border */
+    if (borderGroups_[fromGroup])
+    {
+        if (lockBorders_ || !IsBorderEdge(fromGroup, toGroup))
+            return -1.0;
+    }
+
+    /* Each vertex of the source group must be connected to exactly one vertex of the target group */
+    for (auto v : groupMembers_[fromGroup])
+    {
+        if (FindCollapseTarget(v, toGroup) == g_invalidVertex || FlipsTriangles(v, toGroup))
+            return -1.0;
+    }
+
+    auto q = quadrics_[fromGroup];
+    q += quadrics_[toGroup];
+
+    return std::max(0.0, q.Evaluate(GroupPosition(toGroup)));
+}
+
+void MeshSimplifier::UpdateCollapse(VertexIndex group)
+{
+    ++groupVersions_[group];
+
+    std::vector<VertexIndex> neighbors;
+    CollectNeighborGroups(group, neighbors);
+
+    /* Find cheapest collapse into any neighbor group */
+    Collapse best { -1.0, group, g_invalidVertex, groupVersions_[group] };
+
+    for (auto n : neighbors)
+    {
+        const auto cost = CollapseCost(group, n);
+        if (cost >= 0.0 && (best.to == g_invalidVertex || cost < best.cost))
+        {
+            best.cost   = cost;
+            best.to     = n;
+        }
+    }
+
+    if (best.to != g_invalidVertex)
+        queue_.push(best);
+}
+
+void MeshSimplifier::CollectNeighborGroups(VertexIndex group, std::vector<VertexIndex>& neighbors) const
+{
+    neighbors.clear();
+
+    for (auto v : groupMembers_[group])
+    {
+        for (auto t : vertexTriangles_[v])
+        {
+            if (!aliveTriangles_[t])
+                continue;
+
+            const auto& tri = triangles_[t];
+
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                const auto g = groups_[tri[i]];
+                if (g != group)
+                    neighbors.push_back(g);
+            }
+        }
+    }
+
+    std::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+}
+
+void MeshSimplifier::PerformCollapse(VertexIndex fromGroup, VertexIndex toGroup)
+{
+    /* Collapse each vertex of the source group into its connected vertex of the target group */
+    for (auto v : groupMembers_[fromGroup])
+    {
+        const auto target = FindCollapseTarget(v, toGroup);
+
+        for (auto t : vertexTriangles_[v])
+        {
+            if (!aliveTriangles_[t])
+                continue;
+
+            auto& tri = triangles_[t];
+
+            if (ContainsGroup(tri, toGroup))
+            {
+                /* Remove triangle that degenerates */
+                aliveTriangles_[t] = false;
+                --numAliveTriangles_;
+            }
+            else
+            {
+                /* Move triangle to the target vertex */
+                for (std::size_t i = 0; i < 3; ++i)
+                {
+                    if (tri[i] == v)
+                        tri[i] = target;
+                }
+                vertexTriangles_[target].push_back(t);
+            }
+        }
+
+        vertexTriangles_[v].clear();
+    }
+
+    /* Merge quadrics and group state */
+    quadrics_[toGroup] += quadrics_[fromGroup];
+    removedGroups_[fromGroup] = true;
+
+    if (borderGroups_[fromGroup])
+        borderGroups_[toGroup] = true;
+
+    /* Update collapses of the target group and its neighbors */
+    std::vector<VertexIndex> neighbors;
+    CollectNeighborGroups(toGroup, neighbors);
+
+    UpdateCollapse(toGroup);
+    for (auto n : neighbors)
+        UpdateCollapse(n);
+}
+
+static std::size_t GetTargetTriangleCount(std::size_t numTriangles, Gs::Real ratio)
+{
+    ratio = std::max(Gs::Real(0), std::min(ratio, Gs::Real(1)));
+    return static_cast<std::size_t>(static_cast<Gs::Real>(numTriangles) * ratio);
+}
+
+// Removes all vertices that are not referenced by any triangle while keeping the order of the remaining vertices.
+static void RemoveUnusedVertices(TriangleMesh& mesh)
+{
+    std::vector<VertexIndex> remap(mesh.vertices.size(), g_invalidVertex);
+
+    for (const auto& tri : mesh.triangles)
+    {
+        remap[tri.a] = 0;
+        remap[tri.b] = 0;
+        remap[tri.c] = 0;
+    }
+
+    VertexIndex numVertices = 0;
+
+    for (VertexIndex v = 0; v < remap.size(); ++v)
+    {
+        if (remap[v] != g_invalidVertex)
+        {
+            mesh.vertices[numVertices] = mesh.vertices[v];
+            remap[v] = numVertices++;
+        }
+    }
+
+    mesh.vertices.resize(numVertices);
+
+    for (auto& tri : mesh.triangles)
+    {
+        tri.a = remap[tri.a];
+        tri.b = remap[tri.b];
+        tri.c = remap[tri.c];
+    }
+}
+
+
+/* ----- Global functions ----- */
+
+Gs::Real Simplify(TriangleMesh& mesh, const SimplifyDescriptor& simplifyDesc)
+{
+    MeshSimplifier simplifier(mesh, simplifyDesc);
+
+    simplifier.SimplifyTo(GetTargetTriangleCount(mesh.triangles.size(), simplifyDesc.targetRatio));
+
+    mesh.triangles = simplifier.Triangles();
+
+    if (simplifyDesc.removeUnusedVertices)
+        RemoveUnusedVertices(mesh);
+
+    mesh.ClearAdjacency();
+
+    return simplifier.GetError();
+}
+
+std::vector<std::vector<TriangleMesh::Triangle>> SimplifyLODChain(
+    const TriangleMesh&             mesh,
+    const std::vector<Gs::Real>&    ratios,
+    const SimplifyDescriptor&       simplifyDesc)
+{
+    std::vector<std::vector<TriangleMesh::Triangle>> lodChain;
+    lodChain.reserve(ratios.size());
+
+    MeshSimplifier simplifier(mesh, simplifyDesc);
+
+    /* Continue simplification for each level */
+    for (auto ratio : ratios)
+    {
+        simplifier.SimplifyTo(GetTargetTriangleCount(mesh.triangles.size(), ratio));
+        lodChain.push_back(simplifier.Triangles());
+    }
+
+    return lodChain;
+}
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+
+// ================================================================================
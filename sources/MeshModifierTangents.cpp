@@ -0,0 +1,256 @@
+/*
+ * MeshModifierTangents.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshModifier.h>
+#include <Geom/MeshAdjacency.h>
+#include "ParallelDetails.h"
+#include <cmath>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+using VertexIndex   = TriangleMesh::VertexIndex;
+using TriangleIndex = TriangleMesh::TriangleIndex;
+
+
+/* ----- Internal functions ----- */
+
+static const std::size_t g_tangentsGrainSize = 8192;
+
+// Area weighted tangent frames of all faces in SoA layout.
+struct FaceTangents
+{
+    std::vector<Gs::Real>       tx, ty, tz;     // Tangents scaled by the face area.
+    std::vector<Gs::Real>       bx, by, bz;     // Bitangents scaled by the face area.
+    std::vector<std::int8_t>    handedness;     // +1, -1, or 0 for degenerated texture coordinates.
+};
+
+// Sums of the face tangents around a vertex for one handedness.
+struct TangentSum
+{
+    Gs::Vector3 tangent;
+    Gs::Vector3 bitangent;
+    bool        used = false;
+};
+
+static void ComputeFaceTangents(const TriangleMesh& mesh, FaceTangents& faces)
+{
+    const auto& vertices    = mesh.vertices;
+    const auto& triangles   = mesh.triangles;
+    const auto  numFaces    = triangles.size();
+
+    faces.tx.resize(numFaces);
+    faces.ty.resize(numFaces);
+    faces.tz.resize(numFaces);
+    faces.bx.resize(numFaces);
+    faces.by.resize(numFaces);
+    faces.bz.resize(numFaces);
+    faces.handedness.resize(numFaces);
+
+    Details::ParallelFor(
+        numFaces, g_tangentsGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto& tri = triangles[i];
+                const auto& v0  = vertices[tri.a];
+                const auto& v1  = vertices[tri.b];
+                const auto& v2  = vertices[tri.c];
+
+                /* Get triangle vectors (see ComputeTangentSpace) */
+                const auto e1   = v1.position - v0.position;
+                const auto e2   = v2.position - v0.position;
+                const auto st1  = v1.texCoord - v0.texCoord;
+                const auto st2  = v2.texCoord - v0.texCoord;
+
+                const auto det  = st1.x * st2.y - st2.x * st1.y;
+                const auto area = Gs::Cross(e1, e2).Length() * Gs::Real(0.5);
+
+                auto tangent    = (e1 * st2.y) - (e2 * st1.y);
+                auto bitangent  = (e2 * st1.x) - (e1 * st2.x);
+
+                const auto tLenSq = tangent.LengthSq();
+                const auto bLenSq = bitangent.LengthSq();
+
+                /*
+                The determinant is in squared texture units, so compare it relative to the texture edges,
+                otherwise all faces of finely subdivided texture coordinates would be treated as degenerated
+                */
+                const auto minDet = Gs::Epsilon<Gs::Real>() * std::sqrt(st1.LengthSq() * st2.LengthSq());
+
+                if (!(std::abs(det) > minDet) || !std::isfinite(det) || !(tLenSq > Gs::Real(0)) || !(bLenSq > Gs::Real(0)))
+                {
+                    faces.tx[i] = faces.ty[i] = faces.tz[i] = Gs::Real(0);
+                    faces.bx[i] = faces.by[i] = faces.bz[i] = Gs::Real(0);
+                    faces.handedness[i] = 0;
+                    continue;
+                }
+
+                /* Flip tangent frame for mirrored texture coordinates, so it always points along +U and +V */
+                const auto sign = (det > Gs::Real(0) ? Gs::Real(1) : Gs::Real(-1));
+
+                tangent     *= sign * area / std::sqrt(tLenSq);
+                bitangent   *= sign * area / std::sqrt(bLenSq);
+
+                faces.tx[i] = tangent.x;
+                faces.ty[i] = tangent.y;
+                faces.tz[i] = tangent.z;
+                faces.bx[i] = bitangent.x;
+                faces.by[i] = bitangent.y;
+                faces.bz[i] = bitangent.z;
+
+                /* Handedness of the texture mapping relative to the winding order */
+                faces.handedness[i] = (Gs::Dot(Gs::Cross(e1, e2), Gs::Cross(tangent, bitangent)) >= Gs::Real(0) ? 1 : -1);
+            }
+        }
+    );
+}
+
+// Returns a normalized vector that is orthogonal to the specified normal.
+static Gs::Vector3 ArbitraryTangent(const Gs::Vector3& normal)
+{
+    const auto axis = (std::abs(normal.x) < Gs::Real(0.9) ? Gs::Vector3(1, 0, 0) : Gs::Vector3(0, 1, 0));
+    auto tangent = Gs::Cross(axis, normal);
+    return (tangent.LengthSq() > Gs::Real(0) ? tangent.Normalized() : axis);
+}
+
+// Orthogonalizes the specified tangent sum against the normal (Gram-Schmidt) and returns the tangent with bitangent sign.
+static Gs::Vector4 OrthogonalizeTangent(const TangentSum& sum, const Gs::Vector3& normal)
+{
+    auto tangent = sum.tangent - normal * Gs::Dot(normal, sum.tangent);
+
+    /* Compare relative to the tangent sum, which is scaled by the face areas */
+    if (!(tangent.LengthSq() > Gs::Epsilon<Gs::Real>() * Gs::Epsilon<Gs::Real>() * sum.tangent.LengthSq()))
+        tangent = ArbitraryTangent(normal);
+    else
+        tangent.Normalize();
+
+    const auto w = (Gs::Dot(Gs::Cross(normal, tangent), sum.bitangent) < Gs::Real(0) ? Gs::Real(-1) : Gs::Real(1));
+
+    return Gs::Vector4(tangent.x, tangent.y, tangent.z, w);
+}
+
+
+/* ----- Global functions ----- */
+
+std::size_t GenerateTangents(TriangleMesh& mesh, std::vector<Gs::Vector4>& tangents, const TangentsDescriptor& tangentsDesc)
+{
+    auto& vertices  = mesh.vertices;
+    auto& triangles = mesh.triangles;
+
+    const auto numVertices = vertices.size();
+
+    tangents.resize(numVertices);
+
+    if (numVertices == 0)
+        return 0;
+
+    /* Get vertex-to-triangle adjacency */
+    const MeshAdjacency* adjacency = mesh.GetAdjacency();
+
+    MeshAdjacency temporaryAdjacency;
+    if (!adjacency || !adjacency->IsBuiltFor(mesh))
+    {
+        temporaryAdjacency.Build(mesh);
+        adjacency = &temporaryAdjacency;
+    }
+
+    /* Compute face tangents in parallel over triangle chunks */
+    FaceTangents faces;
+    ComputeFaceTangents(mesh, faces);
+
+    /*
+    Gather tangents for each vertex, separated by handedness if mirrored texture coordinates are split.
+    The second sum is only used for vertices with both handednesses.
+    */
+    std::vector<TangentSum> mirroredSums(tangentsDesc.splitMirroredUVs ? numVertices : 0);
+
+    Details::ParallelFor(
+        numVertices, g_tangentsGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto v = begin; v < end; ++v)
+            {
+                TangentSum sums[2];
+
+                for (auto t : adjacency->VertexTriangles(static_cast<VertexIndex>(v)))
+                {
+                    const auto h = faces.handedness[t];
+                    if (h == 0)
+                        continue;
+
+                    auto& sum = sums[(tangentsDesc.splitMirroredUVs && h < 0) ? 1 : 0];
+                    sum.tangent     += Gs::Vector3(faces.tx[t], faces.ty[t], faces.tz[t]);
+                    sum.bitangent   += Gs::Vector3(faces.bx[t], faces.by[t], faces.bz[t]);
+                    sum.used        = true;
+                }
+
+                const auto& normal = vertices[v].normal;
+
+                if (sums[0].used || !sums[1].used)
+                {
+                    tangents[v] = OrthogonalizeTangent(sums[0], normal);
+                    if (tangentsDesc.splitMirroredUVs)
+                        mirroredSums[v] = sums[1];
+                }
+                else
+                    tangents[v] = OrthogonalizeTangent(sums[1], normal);
+            }
+        }
+    );
+
+    if (!tangentsDesc.splitMirroredUVs)
+        return 0;
+
+    /* Split vertices with both handednesses and move the mirrored triangles to the new vertices */
+    for (VertexIndex v = 0; v < numVertices; ++v)
+    {
+        if (!mirroredSums[v].used)
+            continue;
+
+        const auto split  = static_cast<VertexIndex>(vertices.size());
+        const auto vertex = vertices[v];
+
+        vertices.push_back(vertex);
+        tangents.push_back(OrthogonalizeTangent(mirroredSums[v], vertex.normal));
+
+        for (auto t : adjacency->VertexTriangles(v))
+        {
+            if (faces.handedness[t] < 0)
+            {
+                auto& tri = triangles[t];
+                for (std::size_t i = 0; i < 3; ++i)
+                {
+                    if (tri[i] == v)
+                        tri[i] = split;
+                }
+            }
+        }
+    }
+
+    const auto numSplits = vertices.size() - numVertices;
+
+    if (numSplits > 0)
+        mesh.ClearAdjacency();
+
+    return numSplits;
+}
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+
+// ================================================================================
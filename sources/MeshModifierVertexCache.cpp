@@ -0,0 +1,490 @@
+/*
+ * MeshModifierVertexCache.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshModifier.h>
+#include <Geom/MeshAdjacency.h>
+#include <algorithm>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+using VertexIndex   = TriangleMesh::VertexIndex;
+using TriangleIndex = TriangleMesh::TriangleIndex;
+
+
+/* ----- Internal functions ----- */
+
+static const VertexIndex g_invalidVertex = ~VertexIndex(0);
+
+// FIFO vertex cache simulation. Each vertex stores the time stamp it was inserted into the cache.
+class VertexCacheSimulator
+{
+
+    public:
+
+        VertexCacheSimulator(std::size_t numVertices, std::size_t cacheSize) :
+            cacheSize_  { std::max(std::size_t(1), cacheSize)   },
+            timeStamp_  { cacheSize_ + 1                        },
+            entries_    ( numVertices, 0                        )
+        {
+        }
+
+        // Returns true if the specified vertex was a cache miss.
+        bool Access(VertexIndex v)
+        {
+            if (timeStamp_ - entries_[v] > cacheSize_)
+            {
+                entries_[v] = timeStamp_++;
+                return true;
+            }
+            return false;
+        }
+
+        // Invalidates all cache entries.
+        void Reset()
+        {
+            timeStamp_ += cacheSize_ + 1;
+        }
+
+    private:
+
+        std::size_t                 cacheSize_;
+        std::size_t                 timeStamp_;
+        std::vector<std::size_t>    entries_;
+
+};
+
+static const MeshAdjacency& GetMeshAdjacency(const TriangleMesh& mesh, MeshAdjacency& temporary)
+{
+    auto adjacency = mesh.GetAdjacency();
+    if (adjacency && adjacency->IsBuiltFor(mesh))
+        return *adjacency;
+    temporary.Build(mesh);
+    return temporary;
+}
+
+// Computes the number of referenced vertices.
+static std::size_t CountReferencedVertices(const TriangleMesh& mesh)
+{
+    std::vector<bool> referenced(mesh.vertices.size(), false);
+    std::size_t n = 0;
+
+    for (const auto& tri : mesh.triangles)
+    {
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            if (!referenced[tri[i]])
+            {
+                referenced[tri[i]] = true;
+                ++n;
+            }
+        }
+    }
+
+    return n;
+}
+
+/*
+Returns the next fanning vertex for the Tipsify algorithm. Prefers vertices from the candidate list that are still in
+the cache after their remaining triangles have been emitted, then vertices from the dead-end stack, and finally the next
+vertex in input order with remaining triangles.
+*/
+static VertexIndex GetNextFanningVertex(
+    const std::vector<VertexIndex>& candidates,
+    const std::vector<std::size_t>& liveTriangles,
+    const std::vector<std::size_t>& cacheTimeStamps,
+    std::size_t                     timeStamp,
+    std::size_t                     cacheSize,
+    std::vector<VertexIndex>&       deadEndStack,
+    VertexIndex&                    cursor,
+    bool&                           hardBoundary)
+{
+    /* Find best candidate */
+    auto bestVertex     = g_invalidVertex;
+    auto bestPriority   = std::size_t(0);
+
+    for (auto v : candidates)
+    {
+        if (liveTriangles[v] > 0)
+        {
+            /* Priority is the age of the vertex in the cache, if it is still in the cache after fanning */
+            std::size_t priority = 0;
+
+            const auto age = timeStamp - cacheTimeStamps[v];
+            if (age + 2*liveTriangles[v] <= cacheSize)
+                priority = age;
+
+            if (bestVertex == g_invalidVertex || priority > bestPriority)
+            {
+                bestVertex      = v;
+                bestPriority    = priority;
+            }
+        }
+    }
+
+    if (bestVertex != g_invalidVertex)
+    {
+        hardBoundary = false;
+        return bestVertex;
+    }
+
+    hardBoundary = true;
+
+    /* Skip dead-end vertices */
+    while (!deadEndStack.empty())
+    {
+        auto v = deadEndStack.back();
+        deadEndStack.pop_back();
+        if (liveTriangles[v] > 0)
+            return v;
+    }
+
+    /* Find next vertex in input order */
+    for (; cursor < liveTriangles.size(); ++cursor)
+    {
+        if (liveTriangles[cursor] > 0)
+            return cursor;
+    }
+
+    return g_invalidVertex;
+}
+
+/*
+Reorders the triangles with the Tipsify algorithm and returns the new triangle order.
+The output list 'clusters' receives the start of each hard boundary cluster (i.e. where the fanning was interrupted).
+*/
+static std::vector<TriangleIndex> TipsifyTriangles(
+    const TriangleMesh&         mesh,
+    std::size_t                 cacheSize,
+    std::vector<std::size_t>&   clusters)
+{
+    const auto numVertices  = mesh.vertices.size();
+    const auto numTriangles = mesh.triangles.size();
+
+    MeshAdjacency temporaryAdjacency;
+    const auto& adjacency = GetMeshAdjacency(mesh, temporaryAdjacency);
+
+    std::vector<std::size_t> liveTriangles(numVertices), cacheTimeStamps(numVertices, 0);
+
+    for (VertexIndex v = 0; v < numVertices; ++v)
+        liveTriangles[v] = adjacency.VertexTriangles(v).size();
+
+    std::vector<bool>           emitted(numTriangles, false);
+    std::vector<TriangleIndex>  order;
+    std::vector<VertexIndex>    deadEndStack, candidates;
+
+    order.reserve(numTriangles);
+    clusters.clear();
+
+    std::size_t timeStamp       = cacheSize + 1;
+    VertexIndex cursor          = 0;
+    bool        hardBoundary    = true;
+
+    auto fanningVertex = GetNextFanningVertex(candidates, liveTriangles, cacheTimeStamps, timeStamp, cacheSize, deadEndStack, cursor, hardBoundary);
+
+    while (fanningVertex != g_invalidVertex)
+    {
+        if (hardBoundary)
+            clusters.push_back(order.size());
+
+        candidates.clear();
+
+        /* Emit all remaining triangles of the fanning vertex */
+        for (auto t : adjacency.VertexTriangles(fanningVertex))
+        {
+            if (emitted[t])
+                continue;
+
+            emitted[t] = true;
+            order.push_back(t);
+
+            const auto& tri = mesh.triangles[t];
+
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                const auto v = tri[i];
+
+                /* Degenerated triangles are only counted once per vertex */
+                if ((i > 0 && v == tri[0]) || (i > 1 && v == tri[1]))
+                    continue;
+
+                deadEndStack.push_back(v);
+                candidates.push_back(v);
+
+                --liveTriangles[v];
+
+                if (timeStamp - cacheTimeStamps[v] > cacheSize)
+                    cacheTimeStamps[v] = timeStamp++;
+            }
+        }
+
+        fanningVertex = GetNextFanningVertex(candidates, liveTriangles, cacheTimeStamps, timeStamp, cacheSize, deadEndStack, cursor, hardBoundary);
+    }
+
+    return order;
+}
+
+// Splits the hard boundary clusters into smaller clusters, as long as the ACMR of each cluster does not exceed the threshold.
+static void SplitClusters(
+    const TriangleMesh&                 mesh,
+    const std::vector<TriangleIndex>&   order,
+    std::size_t                         cacheSize,
+    Gs::Real                            threshold,
+    std::vector<std::size_t>&           clusters)
+{
+    std::vector<std::size_t> softClusters;
+    VertexCacheSimulator cache(mesh.vertices.size(), cacheSize);
+
+    auto SimulateRange = [&](std::size_t begin, std::size_t end)
+    {
+        std::size_t misses = 0;
+        for (auto i = begin; i < end; ++i)
+        {
+            const auto& tri = mesh.triangles[order[i]];
+            for (std::size_t j = 0; j < 3; ++j)
+            {
+                if (cache.Access(tri[j]))
+                    ++misses;
+            }
+        }
+        return misses;
+    };
+
+    for (std::size_t c = 0; c < clusters.size(); ++c)
+    {
+        const auto begin    = clusters[c];
+        const auto end      = (c + 1 < clusters.size() ? clusters[c + 1] : order.size());
+
+        /* Determine ACMR of the entire cluster */
+        cache.Reset();
+        const auto clusterACMR = static_cast<Gs::Real>(SimulateRange(begin, end)) / static_cast<Gs::Real>(end - begin);
+        const auto maxACMR = clusterACMR * threshold;
+
+        /* Start a new cluster as soon as the ACMR of the current cluster falls below the threshold */
+        softClusters.push_back(begin);
+        cache.Reset();
+
+        std::size_t misses = 0, start = begin;
+
+        for (auto i = begin; i < end; ++i)
+        {
+            misses += SimulateRange(i, i + 1);
+
+            if (i + 1 < end && static_cast<Gs::Real>(misses) <= maxACMR * static_cast<Gs::Real>(i + 1 - start))
+            {
+                softClusters.push_back(i + 1);
+                start   = i + 1;
+                misses  = 0;
+                cache.Reset();
+            }
+        }
+    }
+
+    clusters = std::move(softClusters);
+}
+
+// Sorts the clusters by their orientation towards the outside of the mesh, so that outer clusters are rendered first.
+static void SortClusters(const TriangleMesh& mesh, std::vector<TriangleIndex>& order, const std::vector<std::size_t>& clusters)
+{
+    struct ClusterSortKey
+    {
+        Gs::Real    key;
+        std::size_t cluster;
+    };
+
+    const auto& vertices = mesh.vertices;
+
+    /* Compute area weighted centroid of the mesh */
+    Gs::Vector3 meshCentroid;
+    Gs::Real    meshArea = 0;
+
+    std::vector<Gs::Vector3> triangleCentroids(order.size()), triangleNormals(order.size());
+    std::vector<Gs::Real> triangleAreas(order.size());
+
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+        const auto& tri = mesh.triangles[order[i]];
+        const auto& p0  = vertices[tri.a].position;
+        const auto& p1  = vertices[tri.b].position;
+        const auto& p2  = vertices[tri.c].position;
+
+        triangleNormals[i]      = Gs::Cross(p1 - p0, p2 - p0);
+        triangleAreas[i]        = triangleNormals[i].Length();
+        triangleCentroids[i]    = (p0 + p1 + p2) / Gs::Real(3);
+
+        meshCentroid    += triangleCentroids[i] * triangleAreas[i];
+        meshArea        += triangleAreas[i];
+    }
+
+    if (meshArea > Gs::Real(0))
+        meshCentroid /= meshArea;
+
+    /* Compute sort key for each cluster */
+    std::vector<ClusterSortKey> sortKeys(clusters.size());
+
+    for (std::size_t c = 0; c < clusters.size(); ++c)
+    {
+        const auto begin    = clusters[c];
+        const auto end      = (c + 1 < clusters.size() ? clusters[c + 1] : order.size());
+
+        Gs::Vector3 centroid, normal;
+        Gs::Real    area = 0;
+
+        for (auto i = begin; i < end; ++i)
+        {
+            centroid    += triangleCentroids[i] * triangleAreas[i];
+            normal      += triangleNormals[i];
+            area        += triangleAreas[i];
+        }
+
+        if (area > Gs::Real(0))
+            centroid /= area;
+
+        normal.Normalize();
+
+        sortKeys[c] = { Gs::Dot(centroid - meshCentroid, normal), c };
+    }
+
+    std::stable_sort(
+        sortKeys.begin(), sortKeys.end(),
+        [](const ClusterSortKey& lhs, const ClusterSortKey& rhs)
+        {
+            return (lhs.key > rhs.key);
+        }
+    );
+
+    /* Rearrange triangles by sorted clusters */
+    std::vector<TriangleIndex> sortedOrder;
+    sortedOrder.reserve(order.size());
+
+    for (const auto& sortKey : sortKeys)
+    {
+        const auto begin    = clusters[sortKey.cluster];
+        const auto end      = (sortKey.cluster + 1 < clusters.size() ? clusters[sortKey.cluster + 1] : order.size());
+        sortedOrder.insert(sortedOrder.end(), order.begin() + begin, order.begin() + end);
+    }
+
+    order = std::move(sortedOrder);
+}
+
+
+/* ----- Global functions ----- */
+
+VertexCacheStatistics AnalyzeVertexCache(const TriangleMesh& mesh, std::size_t cacheSize)
+{
+    VertexCacheStatistics stats;
+
+    /* Simulate FIFO cache */
+    VertexCacheSimulator cache(mesh.vertices.size(), cacheSize);
+
+    for (const auto& tri : mesh.triangles)
+    {
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            if (cache.Access(tri[i]))
+                ++stats.numTransforms;
+        }
+    }
+
+    /* Compute ratios */
+    if (!mesh.triangles.empty())
+        stats.acmr = static_cast<Gs::Real>(stats.numTransforms) / static_cast<Gs::Real>(mesh.triangles.size());
+
+    const auto numReferencedVertices = CountReferencedVertices(mesh);
+    if (numReferencedVertices > 0)
+        stats.atvr = static_cast<Gs::Real>(stats.numTransforms) / static_cast<Gs::Real>(numReferencedVertices);
+
+    return stats;
+}
+
+VertexCacheResult OptimizeVertexCache(TriangleMesh& mesh, const VertexCacheDescriptor& cacheDesc)
+{
+    VertexCacheResult result;
+
+    const auto cacheSize = std::max(std::size_t(1), cacheDesc.cacheSize);
+
+    result.before = AnalyzeVertexCache(mesh, cacheSize);
+
+    /* Reorder triangles */
+    std::vector<std::size_t> clusters;
+    auto order = TipsifyTriangles(mesh, cacheSize, clusters);
+
+    if (cacheDesc.optimizeOverdraw && !clusters.empty())
+    {
+        SplitClusters(mesh, order, cacheSize, cacheDesc.overdrawThreshold, clusters);
+        SortClusters(mesh, order, clusters);
+    }
+
+    std::vector<TriangleMesh::Triangle> triangles;
+    triangles.reserve(order.size());
+
+    for (auto t : order)
+        triangles.push_back(mesh.triangles[t]);
+
+    mesh.triangles = std::move(triangles);
+    mesh.ClearAdjacency();
+
+    /* Reorder vertices */
+    if (cacheDesc.optimizeVertexFetch)
+        result.vertexRemap = OptimizeVertexFetch(mesh);
+
+    result.after = AnalyzeVertexCache(mesh, cacheSize);
+
+    return result;
+}
+
+std::vector<VertexIndex> OptimizeVertexFetch(TriangleMesh& mesh)
+{
+    const auto numVertices = mesh.vertices.size();
+
+    std::vector<VertexIndex> remap(numVertices, g_invalidVertex);
+    VertexIndex numRemapped = 0;
+
+    /* Assign new indices by first use */
+    for (auto& tri : mesh.triangles)
+    {
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            auto& v = tri[i];
+            if (remap[v] == g_invalidVertex)
+                remap[v] = numRemapped++;
+            v = remap[v];
+        }
+    }
+
+    /* Append unreferenced vertices */
+    for (auto& v : remap)
+    {
+        if (v == g_invalidVertex)
+            v = numRemapped++;
+    }
+
+    /* Reorder vertices */
+    std::vector<TriangleMesh::Vertex> vertices(numVertices);
+
+    for (VertexIndex v = 0; v < numVertices; ++v)
+        vertices[remap[v]] = mesh.vertices[v];
+
+    mesh.vertices = std::move(vertices);
+    mesh.ClearAdjacency();
+
+    return remap;
+}
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+
+// ================================================================================
@@ -0,0 +1,282 @@
+/*
+ * MeshModifierWeld.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshModifier.h>
+#include "ParallelDetails.h"
+#include "RadixSortDetails.h"
+#include "WeldDetails.h"
+#include <cmath>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+using VertexIndex = TriangleMesh::VertexIndex;
+
+
+/* ----- Internal functions ----- */
+
+static const std::size_t g_weldGrainSize = 4096;
+
+// Size of the spatial hash cells in units of the position epsilon, and the distance to a cell border (in units of the cell size)
+// below which the neighbor cell is searched. The margin is twice the position epsilon to tolerate rounding errors.
+static const Gs::Real g_weldCellSize    = Gs::Real(16);
+static const Gs::Real g_weldCellMargin  = Gs::Real(2) / g_weldCellSize;
+
+struct SpatialCell
+{
+    std::int64_t    coord[3];
+    std::int64_t    neighbor[3]; // Direction (-1 or +1) to the neighbor cell on each axis, or 0 if the vertex is not close to a cell border.
+};
+
+static SpatialCell GetSpatialCell(const Gs::Vector3& position, Gs::Real invCellSize)
+{
+    SpatialCell cell;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const auto x = position[i] * invCellSize;
+        const auto c = std::floor(x);
+        cell.coord[i]       = static_cast<std::int64_t>(c);
+        cell.neighbor[i]    = (x - c < g_weldCellMargin ? -1 : (c + Gs::Real(1) - x < g_weldCellMargin ? 1 : 0));
+    }
+
+    return cell;
+}
+
+static std::uint64_t HashSpatialCell(std::int64_t x, std::int64_t y, std::int64_t z)
+{
+    return
+    (
+        (static_cast<std::uint64_t>(x) * 73856093ull) ^
+        (static_cast<std::uint64_t>(y) * 19349663ull) ^
+        (static_cast<std::uint64_t>(z) * 83492791ull)
+    );
+}
+
+template <typename T>
+static bool EqualsWithin(const T& lhs, const T& rhs, Gs::Real epsilon)
+{
+    for (std::size_t i = 0; i < T::components; ++i)
+    {
+        if (std::abs(lhs[i] - rhs[i]) > epsilon)
+            return false;
+    }
+    return true;
+}
+
+static bool CanWeldVertices(const TriangleMesh::Vertex& lhs, const TriangleMesh::Vertex& rhs, const WeldDescriptor& weldDesc)
+{
+    return
+    (
+        EqualsWithin(lhs.position, rhs.position, weldDesc.positionEpsilon) &&
+        ( !weldDesc.compareNormals   || EqualsWithin(lhs.normal,   rhs.normal,   weldDesc.normalEpsilon  ) ) &&
+        ( !weldDesc.compareTexCoords || EqualsWithin(lhs.texCoord, rhs.texCoord, weldDesc.texCoordEpsilon) )
+    );
+}
+
+/*
+The vertices are stored in a spatial hash, which is a sorted list of keys where each key is
+a hash of the vertex cell in the upper bits and the vertex index in the lower bits.
+Since the cell size is larger than twice the position epsilon, at most the vertex cell and its 7 nearest neighbor cells must be searched,
+and the neighbor cells only on the axes where the vertex is close to a cell border.
+*/
+std::vector<VertexIndex> FindWeldCandidates(const std::vector<TriangleMesh::Vertex>& vertices, const WeldDescriptor& weldDesc)
+{
+    const auto numVertices  = vertices.size();
+    const auto indexBits    = std::max(std::size_t(1), Details::BitWidth(numVertices - 1));
+    const auto hashMask     = (indexBits < 64 ? (~std::uint64_t(0) >> indexBits) : std::uint64_t(0));
+    const auto indexMask    = (indexBits < 64 ? ((std::uint64_t(1) << indexBits) - 1) : ~std::uint64_t(0));
+    const auto epsilon      = std::abs(weldDesc.positionEpsilon);
+    const auto invCellSize  = (epsilon > Gs::Real(0) ? Gs::Real(1) / (g_weldCellSize * epsilon) : Gs::Real(1));
+
+    auto MakeKey = [&](std::uint64_t hash, VertexIndex v)
+    {
+        return (((hash & hashMask) << indexBits) | static_cast<std::uint64_t>(v));
+    };
+
+    /* Build spatial hash */
+    std::vector<std::uint64_t> keys(numVertices), buffer;
+
+    Details::ParallelFor(
+        numVertices, g_weldGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto v = begin; v < end; ++v)
+            {
+                const auto cell = GetSpatialCell(vertices[v].position, invCellSize);
+                keys[v] = MakeKey(HashSpatialCell(cell.coord[0], cell.coord[1], cell.coord[2]), v);
+            }
+        }
+    );
+
+    Details::ParallelRadixSort(keys, buffer, 64);
+
+    /* Store the first key of the own cell for each vertex, so only the neighbor cells require a binary search */
+    std::vector<std::size_t> cellStarts(numVertices);
+
+    for (std::size_t i = 0, start = 0; i < numVertices; ++i)
+    {
+        if ((keys[i] >> indexBits) != (keys[start] >> indexBits))
+            start = i;
+        cellStarts[static_cast<VertexIndex>(keys[i] & indexMask)] = start;
+    }
+
+    /* Search weld candidates in the nearest cells of each vertex */
+    std::vector<VertexIndex> candidates(numVertices);
+
+    Details::ParallelFor(
+        numVertices, g_weldGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto v = begin; v < end; ++v)
+            {
+                const auto& vertex  = vertices[v];
+                const auto  cell    = GetSpatialCell(vertex.position, invCellSize);
+
+                auto candidate = v;
+
+                for (int i = 0; i < 8; ++i)
+                {
+                    /* Skip cells that are equal to a previous one */
+                    if ( ( (i & 1) != 0 && cell.neighbor[0] == 0 ) ||
+                         ( (i & 2) != 0 && cell.neighbor[1] == 0 ) ||
+                         ( (i & 4) != 0 && cell.neighbor[2] == 0 ) )
+                    {
+                        continue;
+                    }
+
+                    const auto x = cell.coord[0] + ((i & 1) != 0 ? cell.neighbor[0] : 0);
+                    const auto y = cell.coord[1] + ((i & 2) != 0 ? cell.neighbor[1] : 0);
+                    const auto z = cell.coord[2] + ((i & 4) != 0 ? cell.neighbor[2] : 0);
+
+                    /* Iterate over all vertices in this cell with a smaller index than the current candidate */
+                    const auto firstKey = MakeKey(HashSpatialCell(x, y, z), 0);
+                    const auto lastKey  = firstKey | static_cast<std::uint64_t>(candidate);
+
+                    auto it = (i == 0 ? keys.begin() + cellStarts[v] : std::lower_bound(keys.begin(), keys.end(), firstKey));
+
+                    for (; it != keys.end() && *it < lastKey; ++it)
+                    {
+                        const auto w = static_cast<VertexIndex>(*it & indexMask);
+                        if (CanWeldVertices(vertex, vertices[w], weldDesc))
+                        {
+                            candidate = w;
+                            break;
+                        }
+                    }
+                }
+
+                candidates[v] = candidate;
+            }
+        }
+    );
+
+    return candidates;
+}
+
+
+/* ----- Global functions ----- */
+
+std::vector<VertexIndex> WeldVertices(TriangleMesh& mesh, const WeldDescriptor& weldDesc)
+{
+    auto& vertices  = mesh.vertices;
+    auto& triangles = mesh.triangles;
+
+    const auto numVertices = vertices.size();
+
+    if (numVertices == 0)
+        return {};
+
+    /* Resolve welding groups (each candidate has a smaller index, so its remap entry is already final) */
+    auto remap = FindWeldCandidates(vertices, weldDesc);
+
+    VertexIndex numWelded = 0;
+
+    for (VertexIndex v = 0; v < numVertices; ++v)
+    {
+        if (remap[v] == v)
+        {
+            /* Keep vertex and move it to its new location */
+            if (numWelded != v)
+                vertices[numWelded] = vertices[v];
+            remap[v] = numWelded++;
+        }
+        else
+            remap[v] = remap[remap[v]];
+    }
+
+    vertices.resize(numWelded);
+
+    /* Remap triangle indices */
+    Details::ParallelFor(
+        triangles.size(), g_weldGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                auto& tri = triangles[i];
+                tri.a = remap[tri.a];
+                tri.b = remap[tri.b];
+                tri.c = remap[tri.c];
+            }
+        }
+    );
+
+    mesh.ClearAdjacency();
+
+    return remap;
+}
+
+void IndexTriangleList(
+    const std::vector<Gm::Triangle<TriangleMesh::Vertex>>&  triangleList,
+    TriangleMesh&                                           mesh,
+    const WeldDescriptor&                                   weldDesc)
+{
+    mesh.Clear();
+
+    /* Copy all triangle vertices */
+    mesh.vertices.resize(triangleList.size() * 3);
+    mesh.triangles.resize(triangleList.size());
+
+    for (std::size_t i = 0; i < triangleList.size(); ++i)
+    {
+        const auto& tri = triangleList[i];
+        const auto  v   = i*3;
+
+        mesh.vertices[v    ] = tri.a;
+        mesh.vertices[v + 1] = tri.b;
+        mesh.vertices[v + 2] = tri.c;
+
+        mesh.triangles[i] = { v, v + 1, v + 2 };
+    }
+
+    /* Weld equal vertices */
+    WeldVertices(mesh, weldDesc);
+}
+
+TriangleMesh IndexTriangleList(
+    const std::vector<Gm::Triangle<TriangleMesh::Vertex>>&  triangleList,
+    const WeldDescriptor&                                   weldDesc)
+{
+    TriangleMesh mesh;
+    IndexTriangleList(triangleList, mesh, weldDesc);
+    return mesh;
+}
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+
+// ================================================================================
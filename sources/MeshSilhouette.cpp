@@ -0,0 +1,308 @@
+/*
+ * MeshSilhouette.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshSilhouette.h>
+#include <Geom/MeshAdjacency.h>
+#include "ParallelDetails.h"
+#include "SIMDDetails.h"
+
+
+namespace Gm
+{
+
+
+/* ----- Internal functions ----- */
+
+static const std::size_t g_silhouetteGrainSize = 16384;
+
+static bool HasDirectedEdge(const TriangleMesh::Triangle& tri, TriangleMesh::VertexIndex a, TriangleMesh::VertexIndex b)
+{
+    return
+        ( tri.a == a && tri.b == b ) ||
+        ( tri.b == a && tri.c == b ) ||
+        ( tri.c == a && tri.a == b );
+}
+
+#ifndef GS_REAL_DOUBLE
+
+/*
+Classifies the faces in the range [begin, end) with SIMD instructions and returns the index of the first face that is not yet classified.
+The plane distance of each face to the light is 'n*L.xyz - d*L.w'.
+*/
+static std::size_t ClassifyFacesSIMD(
+    const float* nx, const float* ny, const float* nz, const float* d,
+    const Gs::Vector4f& light, std::uint8_t* facing, std::size_t begin, std::size_t end)
+{
+    #ifdef GM_SIMD_SSE2
+
+    const auto lx   = _mm_set1_ps(light.x);
+    const auto ly   = _mm_set1_ps(light.y);
+    const auto lz   = _mm_set1_ps(light.z);
+    const auto lw   = _mm_set1_ps(light.w);
+    const auto zero = _mm_setzero_ps();
+
+    for (; begin + 4 <= end; begin += 4)
+    {
+        auto dist = _mm_mul_ps(_mm_loadu_ps(nx + begin), lx);
+        dist = _mm_add_ps(dist, _mm_mul_ps(_mm_loadu_ps(ny + begin), ly));
+        dist = _mm_add_ps(dist, _mm_mul_ps(_mm_loadu_ps(nz + begin), lz));
+        dist = _mm_sub_ps(dist, _mm_mul_ps(_mm_loadu_ps(d + begin), lw));
+
+        const auto mask = _mm_movemask_ps(_mm_cmpgt_ps(dist, zero));
+
+        facing[begin    ] = static_cast<std::uint8_t>( mask       & 1);
+        facing[begin + 1] = static_cast<std::uint8_t>((mask >> 1) & 1);
+        facing[begin + 2] = static_cast<std::uint8_t>((mask >> 2) & 1);
+        facing[begin + 3] = static_cast<std::uint8_t>((mask >> 3) & 1);
+    }
+
+    #endif
+
+    return begin;
+}
+
+#else
+
+static std::size_t ClassifyFacesSIMD(
+    const double* nx, const double* ny, const double* nz, const double* d,
+    const Gs::Vector4d& light, std::uint8_t* facing, std::size_t begin, std::size_t end)
+{
+    #ifdef GM_SIMD_SSE2
+
+    const auto lx   = _mm_set1_pd(light.x);
+    const auto ly   = _mm_set1_pd(light.y);
+    const auto lz   = _mm_set1_pd(light.z);
+    const auto lw   = _mm_set1_pd(light.w);
+    const auto zero = _mm_setzero_pd();
+
+    for (; begin + 2 <= end; begin += 2)
+    {
+        auto dist = _mm_mul_pd(_mm_loadu_pd(nx + begin), lx);
+        dist = _mm_add_pd(dist, _mm_mul_pd(_mm_loadu_pd(ny + begin), ly));
+        dist = _mm_add_pd(dist, _mm_mul_pd(_mm_loadu_pd(nz + begin), lz));
+        dist = _mm_sub_pd(dist, _mm_mul_pd(_mm_loadu_pd(d + begin), lw));
+
+        const auto mask = _mm_movemask_pd(_mm_cmpgt_pd(dist, zero));
+
+        facing[begin    ] = static_cast<std::uint8_t>( mask       & 1);
+        facing[begin + 1] = static_cast<std::uint8_t>((mask >> 1) & 1);
+    }
+
+    #endif
+
+    return begin;
+}
+
+#endif
+
+
+/* ----- MeshSilhouette class ----- */
+
+MeshSilhouette::MeshSilhouette(const TriangleMesh& mesh)
+{
+    Build(mesh);
+}
+
+void MeshSilhouette::Build(const TriangleMesh& mesh)
+{
+    Clear();
+
+    const auto& vertices    = mesh.vertices;
+    const auto& triangles   = mesh.triangles;
+    const auto  numFaces    = triangles.size();
+
+    /* Compute face planes */
+    planeNX_.resize(numFaces);
+    planeNY_.resize(numFaces);
+    planeNZ_.resize(numFaces);
+    planeD_.resize(numFaces);
+    facing_.resize(numFaces);
+
+    Details::ParallelFor(
+        numFaces, g_silhouetteGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto& tri = triangles[i];
+                const auto& p0  = vertices[tri.a].position;
+                const auto  n   = Gs::Cross(vertices[tri.b].position - p0, vertices[tri.c].position - p0);
+
+                planeNX_[i] = n.x;
+                planeNY_[i] = n.y;
+                planeNZ_[i] = n.z;
+                planeD_[i]  = Gs::Dot(n, p0);
+            }
+        }
+    );
+
+    /* Pair faces of each edge with opposite winding orders */
+    const MeshAdjacency* adjacency = mesh.GetAdjacency();
+
+    MeshAdjacency temporaryAdjacency;
+    if (!adjacency || !adjacency->IsBuiltFor(mesh))
+    {
+        temporaryAdjacency.Build(mesh);
+        adjacency = &temporaryAdjacency;
+    }
+
+    std::vector<TriangleIndex> edgeTriangles, forwardFaces, backwardFaces;
+
+    const auto edges = mesh.Edges();
+    edgeFaces_.reserve(edges.size());
+
+    for (const auto& edge : edges)
+    {
+        /* Skip degenerated edges */
+        if (edge.a == edge.b)
+            continue;
+
+        adjacency->EdgeTriangles(mesh, edge, edgeTriangles);
+
+        if (edgeTriangles.size() == 1)
+        {
+            /* Add boundary edge */
+            const auto face = edgeTriangles.front();
+            if (HasDirectedEdge(triangles[face], edge.a, edge.b))
+                edgeFaces_.push_back({ edge.a, edge.b, face, invalidTriangle });
+            else
+                edgeFaces_.push_back({ edge.b, edge.a, face, invalidTriangle });
+        }
+        else
+        {
+            /* Split faces by the direction they refer to this edge */
+            forwardFaces.clear();
+            backwardFaces.clear();
+
+            for (auto face : edgeTriangles)
+            {
+                if (HasDirectedEdge(triangles[face], edge.a, edge.b))
+                    forwardFaces.push_back(face);
+                else
+                    backwardFaces.push_back(face);
+            }
+
+            /* Add manifold edges and split surplus faces into boundary edges */
+            const auto numPairs = std::min(forwardFaces.size(), backwardFaces.size());
+
+            for (std::size_t i = 0; i < numPairs; ++i)
+                edgeFaces_.push_back({ edge.a, edge.b, forwardFaces[i], backwardFaces[i] });
+            for (auto i = numPairs; i < forwardFaces.size(); ++i)
+                edgeFaces_.push_back({ edge.a, edge.b, forwardFaces[i], invalidTriangle });
+            for (auto i = numPairs; i < backwardFaces.size(); ++i)
+                edgeFaces_.push_back({ edge.b, edge.a, backwardFaces[i], invalidTriangle });
+        }
+    }
+}
+
+void MeshSilhouette::Clear()
+{
+    edgeFaces_.clear();
+    planeNX_.clear();
+    planeNY_.clear();
+    planeNZ_.clear();
+    planeD_.clear();
+    facing_.clear();
+}
+
+std::size_t MeshSilhouette::ExtractEdges(const Gs::Vector4& light, Edge* edges, std::size_t maxEdges)
+{
+    ClassifyFaces(light);
+    return ExtractSilhouette(nullptr, light, edges, nullptr, maxEdges);
+}
+
+std::size_t MeshSilhouette::ExtractShadowVolume(
+    const TriangleMesh& mesh,
+    const Gs::Vector4&  light,
+    Edge*               edges,
+    Gs::Vector4*        quadVertices,
+    std::size_t         maxEdges)
+{
+    GS_ASSERT(mesh.triangles.size() == facing_.size());
+    ClassifyFaces(light);
+    return ExtractSilhouette(&mesh, light, edges, quadVertices, maxEdges);
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void MeshSilhouette::ClassifyFaces(const Gs::Vector4& light)
+{
+    const auto numFaces = facing_.size();
+
+    auto i = ClassifyFacesSIMD(
+        planeNX_.data(), planeNY_.data(), planeNZ_.data(), planeD_.data(),
+        light, facing_.data(), 0, numFaces
+    );
+
+    for (; i < numFaces; ++i)
+    {
+        const auto dist = planeNX_[i]*light.x + planeNY_[i]*light.y + planeNZ_[i]*light.z - planeD_[i]*light.w;
+        facing_[i] = (dist > Gs::Real(0) ? 1 : 0);
+    }
+}
+
+std::size_t MeshSilhouette::ExtractSilhouette(
+    const TriangleMesh* mesh,
+    const Gs::Vector4&  light,
+    Edge*               edges,
+    Gs::Vector4*        quadVertices,
+    std::size_t         maxEdges) const
+{
+
+    const Gs::Vector3 lightVec(light.x, light.y, light.z);
+
+    std::size_t n = 0;
+
+    for (const auto& edgeFaces : edgeFaces_)
+    {
+        if (n >= maxEdges)
+            break;
+
+        /* Edge is part of the silhouette if exactly one of its faces is facing the light */
+        const auto facing0 = facing_[edgeFaces.face0];
+        const auto facing1 = (edgeFaces.face1 != invalidTriangle ? facing_[edgeFaces.face1] : std::uint8_t(0));
+
+        if (facing0 == facing1)
+            continue;
+
+        /* Take winding order of the face that is facing the light */
+        const auto a = (facing0 ? edgeFaces.a : edgeFaces.b);
+        const auto b = (facing0 ? edgeFaces.b : edgeFaces.a);
+
+        if (edges)
+            edges[n] = Edge(a, b);
+
+        if (mesh && quadVertices)
+        {
+            /* Extrude edge vertices away from the light to infinity */
+            const auto& pa = mesh->vertices[a].position;
+            const auto& pb = mesh->vertices[b].position;
+
+            auto quad = quadVertices + n*4;
+
+            quad[0] = Gs::Vector4(pb, Gs::Real(1));
+            quad[1] = Gs::Vector4(pa, Gs::Real(1));
+            quad[2] = Gs::Vector4(pa*light.w - lightVec, Gs::Real(0));
+            quad[3] = Gs::Vector4(pb*light.w - lightVec, Gs::Real(0));
+        }
+
+        ++n;
+    }
+
+    return n;
+}
+
+
+
+} // /namespace Gm
+
+
+
+// ================================================================================
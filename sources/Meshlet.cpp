@@ -0,0 +1,542 @@
+/*
+ * Meshlet.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/Meshlet.h>
+#include <Geom/MeshAdjacency.h>
+#include <Geom/PlaneCollision.h>
+#include "ParallelDetails.h"
+#include "RadixSortDetails.h"
+#include "Except.h"
+#include <algorithm>
+#include <cmath>
+
+
+namespace Gm
+{
+
+
+using VertexIndex   = TriangleMesh::VertexIndex;
+using TriangleIndex = TriangleMesh::TriangleIndex;
+
+
+/* ----- Internal functions ----- */
+
+static const std::size_t    g_meshletChunkSize      = 8192;
+static const std::size_t    g_meshletGrainSize      = 16384;
+static const std::uint32_t  g_invalidLocalIndex     = ~std::uint32_t(0);
+
+// Spreads the lower 10 bits of the specified value, so that there are two zero bits between each bit.
+static std::uint32_t SpreadBits10(std::uint32_t v)
+{
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+// Returns the 30-bit Morton code of the specified point, which is normalized to the range [0, 1].
+static std::uint32_t MortonCode(const Gs::Vector3& p)
+{
+    auto Quantize = [](Gs::Real x)
+    {
+        return static_cast<std::uint32_t>(std::max(Gs::Real(0), std::min(x * Gs::Real(1023), Gs::Real(1023))));
+    };
+    return ((SpreadBits10(Quantize(p.x)) << 2) | (SpreadBits10(Quantize(p.y)) << 1) | SpreadBits10(Quantize(p.z)));
+}
+
+// Returns the triangle indices sorted along a Morton curve of their centroids.
+static std::vector<TriangleIndex> SortTrianglesSpatially(const std::vector<Gs::Vector3>& centroids)
+{
+    const auto numTriangles = centroids.size();
+
+    /* Determine bounding box of all centroids */
+    AABB3 box;
+    for (const auto& c : centroids)
+        box.Insert(c);
+
+    const auto size = box.Size();
+    const auto extent = std::max({ size.x, size.y, size.z, Gs::Epsilon<Gs::Real>() });
+
+    /* Sort keys with Morton code in the upper bits and triangle index in the lower bits */
+    const auto indexBits = std::max(std::size_t(1), Details::BitWidth(numTriangles - 1));
+
+    std::vector<std::uint64_t> keys(numTriangles), buffer;
+
+    Details::ParallelFor(
+        numTriangles, g_meshletGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto code = MortonCode((centroids[i] - box.min) / extent);
+                keys[i] = ((static_cast<std::uint64_t>(code) << indexBits) | static_cast<std::uint64_t>(i));
+            }
+        }
+    );
+
+    Details::ParallelRadixSort(keys, buffer, 30 + indexBits);
+
+    const auto indexMask = (std::uint64_t(1) << indexBits) - 1;
+
+    std::vector<TriangleIndex> order(numTriangles);
+    for (std::size_t i = 0; i < numTriangles; ++i)
+        order[i] = static_cast<TriangleIndex>(keys[i] & indexMask);
+
+    return order;
+}
+
+// Computes the bounding volumes of the specified meshlet.
+static void ComputeMeshletBounds(const TriangleMesh& mesh, const MeshletList& meshletList, Meshlet& meshlet)
+{
+    const auto& vertices = mesh.vertices;
+
+    auto Position = [&](std::size_t localIndex) -> const Gs::Vector3&
+    {
+        return vertices[meshletList.vertexIndices[meshlet.vertexOffset + localIndex]].position;
+    };
+
+    /* Compute bounding box and sphere */
+    meshlet.boundingBox.Reset();
+    for (std::uint32_t i = 0; i < meshlet.vertexCount; ++i)
+        meshlet.boundingBox.Insert(Position(i));
+
+    const auto center = meshlet.boundingBox.Center();
+
+    Gs::Real radiusSq = 0;
+    for (std::uint32_t i = 0; i < meshlet.vertexCount; ++i)
+        radiusSq = std::max(radiusSq, Gs::DistanceSq(center, Position(i)));
+
+    meshlet.boundingSphere = Sphere(center, std::sqrt(radiusSq));
+
+    /* Compute normal cone axis */
+    const auto indices = meshletList.localIndices.data() + meshlet.triangleOffset*3;
+
+    std::vector<Gs::Vector3> normals(meshlet.triangleCount);
+    Gs::Vector3 axis;
+
+    for (std::uint32_t i = 0; i < meshlet.triangleCount; ++i)
+    {
+        const auto& p0 = Position(indices[i*3    ]);
+        const auto& p1 = Position(indices[i*3 + 1]);
+        const auto& p2 = Position(indices[i*3 + 2]);
+
+        normals[i] = Gs::Cross(p1 - p0, p2 - p0);
+        normals[i].Normalize();
+        axis += normals[i];
+    }
+
+    meshlet.cone = MeshletCone();
+    meshlet.cone.apex = center;
+
+    if (axis.LengthSq() <= Gs::Epsilon<Gs::Real>())
+        return;
+
+    axis.Normalize();
+    meshlet.cone.axis = axis;
+
+    /* Compute cone angle, the cone is unusable if it spans (almost) a hemisphere */
+    Gs::Real minDot = 1;
+    for (const auto& n : normals)
+        minDot = std::min(minDot, Gs::Dot(axis, n));
+
+    if (minDot <= Gs::Real(0.1))
+        return;
+
+    /* Move apex behind all triangle planes along the axis */
+    Gs::Real maxT = 0;
+
+    for (std::uint32_t i = 0; i < meshlet.triangleCount; ++i)
+    {
+        const auto dn = Gs::Dot(axis, normals[i]);
+        const auto dc = Gs::Dot(center - Position(indices[i*3]), normals[i]);
+        maxT = std::max(maxT, dc / dn);
+    }
+
+    meshlet.cone.apex   = center - axis * maxT;
+    meshlet.cone.cutoff = std::sqrt(Gs::Real(1) - minDot*minDot);
+}
+
+// Greedy meshlet builder for a single chunk of spatially sorted triangles.
+class MeshletChunkBuilder
+{
+
+    public:
+
+        MeshletChunkBuilder(
+            const TriangleMesh&                 mesh,
+            const MeshAdjacency&                adjacency,
+            const MeshletDescriptor&            meshletDesc,
+            const std::vector<Gs::Vector3>&     centroids,
+            const std::vector<std::uint32_t>&   triangleChunks,
+            std::vector<std::uint8_t>&          usedTriangles) :
+                mesh_           { mesh                                                  },
+                adjacency_      { adjacency                                             },
+                meshletDesc_    { meshletDesc                                           },
+                centroids_      { centroids                                             },
+                triangleChunks_ { triangleChunks                                        },
+                usedTriangles_  { usedTriangles                                         },
+                localIndices_   ( mesh.vertices.size(), g_invalidLocalIndex             )
+        {
+        }
+
+        // Builds all meshlets for the triangles in the specified range of the sorted triangle order.
+        void Build(
+            const TriangleIndex*    orderBegin,
+            const TriangleIndex*    orderEnd,
+            std::uint32_t           chunk,
+            MeshletList&            output)
+        {
+            chunk_  = chunk;
+            output_ = &output;
+
+            for (auto seed = orderBegin; seed != orderEnd;)
+            {
+                if (usedTriangles_[*seed])
+                {
+                    ++seed;
+                    continue;
+                }
+
+                /* Grow meshlet by adjacent triangles, or continue with the next seed in spatial order */
+                auto next = FindNextTriangle();
+
+                if (next == g_invalidTriangle)
+                {
+                    if (!Fits(*seed))
+                    {
+                        FlushMeshlet();
+                        continue;
+                    }
+                    next = *seed;
+                }
+
+                AddTriangle(next);
+
+                if (triangleCount_ == meshletDesc_.maxTriangles)
+                    FlushMeshlet();
+            }
+
+            FlushMeshlet();
+        }
+
+    private:
+
+        static const TriangleIndex g_invalidTriangle = ~TriangleIndex(0);
+
+        std::size_t CountNewVertices(TriangleIndex t) const
+        {
+            const auto& tri = mesh_.triangles[t];
+            std::size_t n = 0;
+
+            if (localIndices_[tri.a] == g_invalidLocalIndex)
+                ++n;
+            if (tri.b != tri.a && localIndices_[tri.b] == g_invalidLocalIndex)
+                ++n;
+            if (tri.c != tri.a && tri.c != tri.b && localIndices_[tri.c] == g_invalidLocalIndex)
+                ++n;
+
+            return n;
+        }
+
+        bool Fits(TriangleIndex t) const
+        {
+            return (meshletVertices_.size() + CountNewVertices(t) <= meshletDesc_.maxVertices);
+        }
+
+        // Returns the best candidate triangle that shares vertices with the current meshlet.
+        TriangleIndex FindNextTriangle()
+        {
+            auto        best            = g_invalidTriangle;
+            std::size_t bestNewVertices = 0;
+            Gs::Real    bestDistance    = 0;
+
+            const auto center = (triangleCount_ > 0 ? centroidSum_ / static_cast<Gs::Real>(triangleCount_) : Gs::Vector3());
+
+            std::size_t numCandidates = 0;
+
+            for (auto t : candidates_)
+            {
+                if (usedTriangles_[t])
+                    continue;
+
+                /* Keep candidate for later iterations */
+                candidates_[numCandidates++] = t;
+
+                const auto newVertices = CountNewVertices(t);
+                if (meshletVertices_.size() + newVertices > meshletDesc_.maxVertices)
+                    continue;
+
+                const auto distance = Gs::DistanceSq(centroids_[t], center);
+
+                if (best == g_invalidTriangle || newVertices < bestNewVertices || (newVertices == bestNewVertices && distance < bestDistance))
+                {
+                    best            = t;
+                    bestNewVertices = newVertices;
+                    bestDistance    = distance;
+                }
+            }
+
+            candidates_.resize(numCandidates);
+
+            return best;
+        }
+
+        void AddTriangle(TriangleIndex t)
+        {
+            usedTriangles_[t] = 1;
+
+            const auto& tri = mesh_.triangles[t];
+
+            for (std::size_t i = 0; i < 3; ++i)
+            {
+                const auto v = tri[i];
+
+                if (localIndices_[v] == g_invalidLocalIndex)
+                {
+                    localIndices_[v] = static_cast<std::uint32_t>(meshletVertices_.size());
+                    meshletVertices_.push_back(v);
+
+                    /* Add unused triangles of the same chunk as candidates */
+                    for (auto neighbor : adjacency_.VertexTriangles(v))
+                    {
+                        if (triangleChunks_[neighbor] == chunk_ && !usedTriangles_[neighbor])
+                            candidates_.push_back(neighbor);
+                    }
+                }
+
+                output_->localIndices.push_back(static_cast<std::uint8_t>(localIndices_[v]));
+            }
+
+            centroidSum_ += centroids_[t];
+            ++triangleCount_;
+        }
+
+        void FlushMeshlet()
+        {
+            if (triangleCount_ == 0)
+                return;
+
+            auto& output = *output_;
+
+            /* Append meshlet */
+            Meshlet meshlet;
+            {
+                meshlet.vertexOffset    = static_cast<std::uint32_t>(output.vertexIndices.size());
+                meshlet.vertexCount     = static_cast<std::uint32_t>(meshletVertices_.size());
+                meshlet.triangleOffset  = static_cast<std::uint32_t>(output.localIndices.size()/3 - triangleCount_);
+                meshlet.triangleCount   = static_cast<std::uint32_t>(triangleCount_);
+            }
+            output.vertexIndices.insert(output.vertexIndices.end(), meshletVertices_.begin(), meshletVertices_.end());
+            output.meshlets.push_back(meshlet);
+
+            /* Reset meshlet state */
+            for (auto v : meshletVertices_)
+                localIndices_[v] = g_invalidLocalIndex;
+
+            meshletVertices_.clear();
+            candidates_.clear();
+            centroidSum_    = Gs::Vector3();
+            triangleCount_  = 0;
+        }
+
+        const TriangleMesh&                 mesh_;
+        const MeshAdjacency&                adjacency_;
+        const MeshletDescriptor&            meshletDesc_;
+        const std::vector<Gs::Vector3>&     centroids_;
+        const std::vector<std::uint32_t>&   triangleChunks_;
+        std::vector<std::uint8_t>&          usedTriangles_;     // Each chunk only reads and writes the flags of its own triangles.
+
+        std::vector<std::uint32_t>          localIndices_;
+        std::vector<VertexIndex>            meshletVertices_;
+        std::vector<TriangleIndex>          candidates_;
+        Gs::Vector3                         centroidSum_;
+        std::size_t                         triangleCount_      = 0;
+
+        std::uint32_t                       chunk_              = 0;
+        MeshletList*                        output_             = nullptr;
+
+};
+
+template <typename Predicate>
+std::size_t CullMeshletsWithPredicate(const MeshletList& meshletList, std::vector<std::uint32_t>& visibleMeshlets, Predicate isVisible)
+{
+    visibleMeshlets.clear();
+
+    const auto numMeshlets = static_cast<std::uint32_t>(meshletList.meshlets.size());
+    for (std::uint32_t i = 0; i < numMeshlets; ++i)
+    {
+        if (isVisible(meshletList.meshlets[i]))
+            visibleMeshlets.push_back(i);
+    }
+
+    return visibleMeshlets.size();
+}
+
+static bool IsMeshletInsideFrustum(const Meshlet& meshlet, const Frustum& frustum)
+{
+    for (std::size_t i = 0; i < 6; ++i)
+    {
+        const auto& plane = frustum.GetPlane(static_cast<FrustumPlane>(i));
+        if (SgnDistanceToPlane(plane, meshlet.boundingSphere.origin) > meshlet.boundingSphere.radius)
+            return false;
+    }
+    return true;
+}
+
+
+/* ----- Global functions ----- */
+
+void BuildMeshlets(const TriangleMesh& mesh, MeshletList& meshletList, const MeshletDescriptor& meshletDesc)
+{
+    if (meshletDesc.maxVertices < 3 || meshletDesc.maxVertices > 256)
+        throw std::invalid_argument(GM_EXCEPT_INFO("maximal number of vertices per meshlet must be in the range [3, 256]"));
+    if (meshletDesc.maxTriangles == 0)
+        throw std::invalid_argument(GM_EXCEPT_INFO("maximal number of triangles per meshlet must be greater than zero"));
+
+    meshletList.meshlets.clear();
+    meshletList.vertexIndices.clear();
+    meshletList.localIndices.clear();
+
+    const auto& triangles   = mesh.triangles;
+    const auto  numTriangles = triangles.size();
+
+    if (numTriangles == 0)
+        return;
+
+    /* Sort triangles spatially by their centroids */
+    std::vector<Gs::Vector3> centroids(numTriangles);
+
+    Details::ParallelFor(
+        numTriangles, g_meshletGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto& tri = triangles[i];
+                centroids[i] = (
+                    mesh.vertices[tri.a].position +
+                    mesh.vertices[tri.b].position +
+                    mesh.vertices[tri.c].position
+                ) / Gs::Real(3);
+            }
+        }
+    );
+
+    const auto order = SortTrianglesSpatially(centroids);
+
+    /* Split sorted triangles into chunks */
+    const auto numChunks = (numTriangles + g_meshletChunkSize - 1) / g_meshletChunkSize;
+
+    std::vector<std::uint32_t> triangleChunks(numTriangles);
+    for (std::size_t i = 0; i < numTriangles; ++i)
+        triangleChunks[order[i]] = static_cast<std::uint32_t>(i / g_meshletChunkSize);
+
+    /* Build meshlets for all chunks in parallel */
+    const MeshAdjacency* adjacency = mesh.GetAdjacency();
+
+    MeshAdjacency temporaryAdjacency;
+    if (!adjacency || !adjacency->IsBuiltFor(mesh))
+    {
+        temporaryAdjacency.Build(mesh);
+        adjacency = &temporaryAdjacency;
+    }
+
+    std::vector<std::uint8_t> usedTriangles(numTriangles, 0);
+    std::vector<MeshletList> chunkMeshlets(numChunks);
+
+    Details::ParallelFor(
+        numChunks, 1,
+        [&](std::size_t begin, std::size_t end)
+        {
+            MeshletChunkBuilder builder(mesh, *adjacency, meshletDesc, centroids, triangleChunks, usedTriangles);
+
+            for (auto chunk = begin; chunk < end; ++chunk)
+            {
+                const auto first    = chunk * g_meshletChunkSize;
+                const auto last     = std::min(first + g_meshletChunkSize, numTriangles);
+                builder.Build(order.data() + first, order.data() + last, static_cast<std::uint32_t>(chunk), chunkMeshlets[chunk]);
+            }
+        }
+    );
+
+    /* Concatenate meshlets of all chunks */
+    for (auto& chunk : chunkMeshlets)
+    {
+        const auto vertexOffset     = static_cast<std::uint32_t>(meshletList.vertexIndices.size());
+        const auto triangleOffset   = static_cast<std::uint32_t>(meshletList.localIndices.size()/3);
+
+        for (auto meshlet : chunk.meshlets)
+        {
+            meshlet.vertexOffset    += vertexOffset;
+            meshlet.triangleOffset  += triangleOffset;
+            meshletList.meshlets.push_back(meshlet);
+        }
+
+        meshletList.vertexIndices.insert(meshletList.vertexIndices.end(), chunk.vertexIndices.begin(), chunk.vertexIndices.end());
+        meshletList.localIndices.insert(meshletList.localIndices.end(), chunk.localIndices.begin(), chunk.localIndices.end());
+    }
+
+    /* Compute bounding volumes */
+    Details::ParallelFor(
+        meshletList.meshlets.size(), 64,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+                ComputeMeshletBounds(mesh, meshletList, meshletList.meshlets[i]);
+        }
+    );
+}
+
+bool IsMeshletBackFacing(const Meshlet& meshlet, const Gs::Vector3& viewPosition)
+{
+    const auto& cone = meshlet.cone;
+
+    if (cone.cutoff > Gs::Real(1))
+        return false;
+
+    auto dir = cone.apex - viewPosition;
+    dir.Normalize();
+
+    return (Gs::Dot(dir, cone.axis) >= cone.cutoff);
+}
+
+std::size_t CullMeshlets(
+    const MeshletList&          meshletList,
+    const Frustum&              frustum,
+    std::vector<std::uint32_t>& visibleMeshlets)
+{
+    return CullMeshletsWithPredicate(
+        meshletList, visibleMeshlets,
+        [&frustum](const Meshlet& meshlet)
+        {
+            return IsMeshletInsideFrustum(meshlet, frustum);
+        }
+    );
+}
+
+std::size_t CullMeshlets(
+    const MeshletList&          meshletList,
+    const Frustum&              frustum,
+    const Gs::Vector3&          viewPosition,
+    std::vector<std::uint32_t>& visibleMeshlets)
+{
+    return CullMeshletsWithPredicate(
+        meshletList, visibleMeshlets,
+        [&frustum, &viewPosition](const Meshlet& meshlet)
+        {
+            return (!IsMeshletBackFacing(meshlet, viewPosition) && IsMeshletInsideFrustum(meshlet, frustum));
+        }
+    );
+}
+
+
+} // /namespace Gm
+
+
+
+// ================================================================================
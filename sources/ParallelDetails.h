@@ -0,0 +1,117 @@
+/*
+ * ParallelDetails.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_PARALLEL_DETAILS_H
+#define GM_PARALLEL_DETAILS_H
+
+
+#include <Geom/Config.h>
+#include <algorithm>
+#include <cstddef>
+
+#ifdef GM_ENABLE_MULTI_THREADING
+#   include <Geom/ThreadPool.h>
+#endif
+
+
+namespace Gm
+{
+
+namespace Details
+{
+
+
+/**
+\brief Returns the number of chunks a range of 'count' elements is split into for parallel processing.
+\param[in] count Specifies the number of elements.
+\param[in] grainSize Specifies the minimal number of elements per chunk.
+\see ThreadPool::GetChunkCount
+*/
+inline std::size_t GetParallelChunkCount(std::size_t count, std::size_t grainSize)
+{
+    #ifdef GM_ENABLE_MULTI_THREADING
+    /* Avoid access to the global thread pool for small ranges */
+    if (count / std::max(std::size_t(1), grainSize) >= 2)
+        return GetGlobalThreadPool()->GetChunkCount(count, grainSize);
+    #else
+    (void)count;
+    (void)grainSize;
+    #endif
+    return 1;
+}
+
+/**
+\brief Calls the specified function for each chunk of the range [0, count) on the global thread pool.
+\param[in] count Specifies the number of elements.
+\param[in] grainSize Specifies the minimal number of elements per chunk. Ranges smaller than this are processed on the calling thread.
+\param[in] func Specifies the chunk function with the signature 'void(std::size_t chunk, std::size_t begin, std::size_t end)'.
+\return Number of chunks the range has been split into. This is equal to 'GetParallelChunkCount(count, grainSize)'.
+\see GetGlobalThreadPool
+*/
+template <typename Func>
+std::size_t ParallelForChunks(std::size_t count, std::size_t grainSize, const Func& func)
+{
+    #ifdef GM_ENABLE_MULTI_THREADING
+
+    if (count / std::max(std::size_t(1), grainSize) >= 2)
+    {
+        auto pool = GetGlobalThreadPool();
+
+        const auto numChunks = pool->GetChunkCount(count, grainSize);
+
+        if (numChunks > 1)
+        {
+            const auto chunkSize = count / numChunks;
+
+            /* Run each chunk as separate task (the last chunk includes the remainder) */
+            pool->ParallelFor(
+                numChunks, 1,
+                [&](std::size_t begin, std::size_t end)
+                {
+                    for (auto i = begin; i < end; ++i)
+                        func(i, i*chunkSize, (i + 1 == numChunks ? count : (i + 1)*chunkSize));
+                }
+            );
+
+            return numChunks;
+        }
+    }
+
+    #else
+
+    (void)grainSize;
+
+    #endif
+
+    func(std::size_t(0), std::size_t(0), count);
+    return 1;
+}
+
+//! Calls the specified function for each chunk of the range [0, count) with the signature 'void(std::size_t begin, std::size_t end)'.
+template <typename Func>
+void ParallelFor(std::size_t count, std::size_t grainSize, const Func& func)
+{
+    ParallelForChunks(
+        count, grainSize,
+        [&func](std::size_t /*chunk*/, std::size_t begin, std::size_t end)
+        {
+            func(begin, end);
+        }
+    );
+}
+
+
+} // /namespace Details
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
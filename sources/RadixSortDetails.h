@@ -0,0 +1,134 @@
+/*
+ * RadixSortDetails.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_RADIX_SORT_DETAILS_H
+#define GM_RADIX_SORT_DETAILS_H
+
+
+#include "ParallelDetails.h"
+#include <cstdint>
+#include <vector>
+
+
+namespace Gm
+{
+
+namespace Details
+{
+
+
+static const std::size_t    g_radixBits         = 8;
+static const std::size_t    g_radixBuckets      = (1u << g_radixBits);
+static const std::size_t    g_radixGrainSize    = 16384;
+
+//! Returns the number of bits that are required to store the specified value.
+inline std::size_t BitWidth(std::uint64_t value)
+{
+    std::size_t n = 0;
+    while (value != 0)
+    {
+        value >>= 1;
+        ++n;
+    }
+    return n;
+}
+
+/**
+\brief Sorts the specified 64-bit keys with a parallel and stable LSD radix sort.
+\param[in,out] keys Specifies the keys to sort.
+\param[in,out] buffer Specifies the temporary buffer. This will be resized to the number of keys.
+\param[in] numKeyBits Specifies the number of least significant bits which are used by the keys. Higher bits are ignored.
+\remarks Passes, in which all keys share the same digit, are skipped.
+*/
+inline void ParallelRadixSort(std::vector<std::uint64_t>& keys, std::vector<std::uint64_t>& buffer, std::size_t numKeyBits)
+{
+    const auto count        = keys.size();
+    const auto numChunks    = GetParallelChunkCount(count, g_radixGrainSize);
+
+    buffer.resize(count);
+
+    std::vector<std::size_t> histograms(numChunks * g_radixBuckets);
+
+    auto src = &keys;
+    auto dst = &buffer;
+
+    for (std::size_t shift = 0; shift < numKeyBits; shift += g_radixBits)
+    {
+        /* Build digit histogram for each chunk */
+        std::fill(histograms.begin(), histograms.end(), 0);
+
+        ParallelForChunks(
+            count, g_radixGrainSize,
+            [&](std::size_t chunk, std::size_t begin, std::size_t end)
+            {
+                auto hist = &histograms[chunk * g_radixBuckets];
+                for (auto i = begin; i < end; ++i)
+                    ++hist[((*src)[i] >> shift) & (g_radixBuckets - 1)];
+            }
+        );
+
+        /* Skip this pass if all keys share the same digit */
+        bool trivialPass = false;
+
+        for (std::size_t d = 0; d < g_radixBuckets && !trivialPass; ++d)
+        {
+            std::size_t n = 0;
+            for (std::size_t chunk = 0; chunk < numChunks; ++chunk)
+                n += histograms[chunk * g_radixBuckets + d];
+            trivialPass = (n == count);
+        }
+
+        if (trivialPass)
+            continue;
+
+        /* Convert histograms into write offsets (ordered by digit first, then by chunk to keep the sort stable) */
+        std::size_t offset = 0;
+
+        for (std::size_t d = 0; d < g_radixBuckets; ++d)
+        {
+            for (std::size_t chunk = 0; chunk < numChunks; ++chunk)
+            {
+                auto& n = histograms[chunk * g_radixBuckets + d];
+                const auto next = offset + n;
+                n = offset;
+                offset = next;
+            }
+        }
+
+        /* Scatter keys into destination buffer */
+        ParallelForChunks(
+            count, g_radixGrainSize,
+            [&](std::size_t chunk, std::size_t begin, std::size_t end)
+            {
+                auto hist = &histograms[chunk * g_radixBuckets];
+                for (auto i = begin; i < end; ++i)
+                {
+                    const auto key = (*src)[i];
+                    (*dst)[hist[(key >> shift) & (g_radixBuckets - 1)]++] = key;
+                }
+            }
+        );
+
+        std::swap(src, dst);
+    }
+
+    /* Move result back into the input container if the number of passes was odd */
+    if (src != &keys)
+        keys.swap(buffer);
+}
+
+
+} // /namespace Details
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
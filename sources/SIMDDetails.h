@@ -0,0 +1,34 @@
+/*
+ * SIMDDetails.h
+ *
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_SIMD_DETAILS_H
+#define GM_SIMD_DETAILS_H
+
+
+/* Detect SIMD instruction sets that are enabled for the current compilation */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define GM_SIMD_SSE2
+#   include <emmintrin.h>
+#endif
+
+#if defined(__AVX__)
+#   define GM_SIMD_AVX
+#   include <immintrin.h>
+#endif
+
+/* F16C is a separate ISA option for GCC and Clang; MSVC needs no option for the intrinsics, so AVX2 implies it there */
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#   define GM_SIMD_F16C
+#   include <immintrin.h>
+#endif
+
+
+#endif
+
+
+
+// ================================================================================
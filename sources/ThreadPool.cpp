@@ -0,0 +1,286 @@
+/*
+ * ThreadPool.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/ThreadPool.h>
+#include <algorithm>
+
+
+namespace Gm
+{
+
+
+/* ----- Internal functions ----- */
+
+// Number of chunks per thread for parallel loops, so that threads which finish early can steal work.
+static const std::size_t g_chunksPerThread = 4;
+
+// Thread pool and queue index of the current worker thread.
+static thread_local ThreadPool*     g_currentPool       = nullptr;
+static thread_local std::size_t     g_currentQueue      = 0;
+
+static std::mutex                   g_globalPoolMutex;
+static std::shared_ptr<ThreadPool>  g_globalPool;
+
+static std::size_t GetDefaultWorkerCount()
+{
+    const auto numThreads = static_cast<std::size_t>(std::thread::hardware_concurrency());
+    return (numThreads > 1 ? numThreads - 1 : 0);
+}
+
+
+/* ----- ThreadPool class ----- */
+
+ThreadPool::ThreadPool() :
+    numPendingTasks_ { 0 },
+    nextQueue_       { 0 }
+{
+    StartWorkers(GetDefaultWorkerCount());
+}
+
+ThreadPool::ThreadPool(std::size_t numWorkers) :
+    numPendingTasks_ { 0 },
+    nextQueue_       { 0 }
+{
+    StartWorkers(numWorkers);
+}
+
+ThreadPool::~ThreadPool()
+{
+    /* Signal workers to stop after all pending tasks are done */
+    {
+        std::lock_guard<std::mutex> guard(sleepMutex_);
+        stop_ = true;
+    }
+    wakeCondition_.notify_all();
+
+    for (auto& worker : workers_)
+        worker.join();
+}
+
+std::size_t ThreadPool::GetChunkCount(std::size_t count, std::size_t grainSize) const
+{
+    if (workers_.empty())
+        return 1;
+    const auto maxChunks = Concurrency() * g_chunksPerThread;
+    return std::max(std::size_t(1), std::min(maxChunks, count / std::max(std::size_t(1), grainSize)));
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void ThreadPool::StartWorkers(std::size_t numWorkers)
+{
+    /* Allocate one queue per worker (at least one for pools without workers) */
+    queues_.resize(std::max(std::size_t(1), numWorkers));
+    for (auto& queue : queues_)
+        queue = std::unique_ptr<WorkQueue>(new WorkQueue());
+
+    workers_.reserve(numWorkers);
+    for (std::size_t i = 0; i < numWorkers; ++i)
+        workers_.emplace_back(&ThreadPool::WorkerThread, this, i);
+}
+
+void ThreadPool::WorkerThread(std::size_t workerIndex)
+{
+    g_currentPool   = this;
+    g_currentQueue  = workerIndex;
+
+    while (true)
+    {
+        if (RunPendingTask())
+            continue;
+
+        /* Sleep until new tasks are submitted or the pool is destroyed */
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+
+        wakeCondition_.wait(
+            lock,
+            [this]()
+            {
+                return (stop_ || numPendingTasks_.load() > 0);
+            }
+        );
+
+        if (stop_ && numPendingTasks_.load() == 0)
+            break;
+    }
+
+    g_currentPool = nullptr;
+}
+
+void ThreadPool::Submit(Task task)
+{
+    /* Workers push into their own queue, other threads distribute their tasks over all queues */
+    const auto queueIndex = (g_currentPool == this ? g_currentQueue : nextQueue_.fetch_add(1) % queues_.size());
+
+    {
+        auto& queue = *queues_[queueIndex];
+        std::lock_guard<std::mutex> guard(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    /* Increment counter under the sleep mutex, so that no worker misses the notification */
+    {
+        std::lock_guard<std::mutex> guard(sleepMutex_);
+        ++numPendingTasks_;
+    }
+    wakeCondition_.notify_one();
+}
+
+bool ThreadPool::RunPendingTask()
+{
+    if (numPendingTasks_.load() == 0)
+        return false;
+
+    const auto numQueues    = queues_.size();
+    const auto ownQueue     = (g_currentPool == this ? g_currentQueue : numQueues);
+
+    Task task;
+
+    /* Take newest task from own queue */
+    if (ownQueue < numQueues)
+    {
+        auto& queue = *queues_[ownQueue];
+        std::lock_guard<std::mutex> guard(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+    }
+
+    /* Steal oldest task from other queues */
+    if (!task)
+    {
+        const auto first = (ownQueue < numQueues ? ownQueue + 1 : nextQueue_.load());
+
+        for (std::size_t i = 0; i < numQueues && !task; ++i)
+        {
+            auto& queue = *queues_[(first + i) % numQueues];
+            std::lock_guard<std::mutex> guard(queue.mutex);
+            if (!queue.tasks.empty())
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+        }
+    }
+
+    if (!task)
+        return false;
+
+    --numPendingTasks_;
+    task();
+
+    return true;
+}
+
+
+/* ----- TaskGroup class ----- */
+
+TaskGroup::TaskGroup(ThreadPool& pool) :
+    pool_     { pool },
+    numTasks_ { 0    }
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+    WaitForTasks();
+}
+
+void TaskGroup::Run(std::function<void()> task)
+{
+    ++numTasks_;
+
+    pool_.Submit(
+        [this, task]()
+        {
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> guard(mutex_);
+                if (!exception_)
+                    exception_ = std::current_exception();
+            }
+
+            /* Notify waiting thread when the last task has finished */
+            std::lock_guard<std::mutex> guard(mutex_);
+            if (--numTasks_ == 0)
+                doneCondition_.notify_all();
+        }
+    );
+}
+
+void TaskGroup::Wait()
+{
+    WaitForTasks();
+
+    /* Rethrow first exception of all tasks */
+    std::exception_ptr exception;
+    std::swap(exception, exception_);
+
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void TaskGroup::WaitForTasks()
+{
+    /* Help executing pending tasks while this group is not done */
+    while (numTasks_.load() > 0)
+    {
+        if (!pool_.RunPendingTask())
+        {
+            /* All remaining tasks are running on other threads */
+            std::unique_lock<std::mutex> lock(mutex_);
+            doneCondition_.wait(
+                lock,
+                [this]()
+                {
+                    return (numTasks_.load() == 0);
+                }
+            );
+        }
+    }
+
+    /* Synchronize with the last task, which still holds the mutex while it notifies this group */
+    std::lock_guard<std::mutex> guard(mutex_);
+}
+
+
+/* ----- Global functions ----- */
+
+void SetGlobalThreadPool(const std::shared_ptr<ThreadPool>& pool)
+{
+    std::lock_guard<std::mutex> guard(g_globalPoolMutex);
+    g_globalPool = pool;
+}
+
+std::shared_ptr<ThreadPool> GetGlobalThreadPool()
+{
+    std::lock_guard<std::mutex> guard(g_globalPoolMutex);
+    if (!g_globalPool)
+        g_globalPool = std::make_shared<ThreadPool>();
+    return g_globalPool;
+}
+
+
+} // /namespace Gm
+
+
+
+// ================================================================================
@@ -6,15 +6,20 @@
  */
 
 #include <Geom/TriangleMesh.h>
+#include <Geom/TriangleMeshT.h>
 #include <Geom/TriangleCollision.h>
 #include <Geom/MeshModifier.h>
+#include <Geom/VertexLayout.h>
+#include <Geom/MeshAdjacency.h>
+#include <Geom/BoundingBoxKernels.h>
 #include <Gauss/TransformVector.h>
 #include <Gauss/Equals.h>
+#include "RadixSortDetails.h"
+#include "Except.h"
 #include <algorithm>
 
 #ifdef GM_ENABLE_MULTI_THREADING
-#   include <thread>
-#   include <memory>
+#   include <Geom/ThreadPool.h>
 #endif
 
 
@@ -22,6 +27,205 @@ namespace Gm
 {
 
 
+/* ----- Internal functions ----- */
+
+static const std::size_t g_edgeGrainSize = 16384;
+
+// Minimal number of vertices per thread for batched barycentric interpolation.
+static const std::size_t g_barycentricGrainSize = 8192;
+
+// Extracts all unique edges by sorting them as pairs of indices (fallback for index ranges that can not be packed into 64 bits).
+template <typename IndexT>
+static void ExtractEdgesViaComparisonSort(
+    const std::vector<Triangle<IndexT>>&    triangles,
+    std::vector<Line<IndexT>>&              edges,
+    std::vector<std::uint32_t>*             edgeTriangleCounts)
+{
+    using Edge = Line<IndexT>;
+
+    auto AddEdge = [&edges](IndexT a, IndexT b)
+    {
+        if (a < b)
+            edges.push_back({ a, b });
+        else
+            edges.push_back({ b, a });
+    };
+
+    /* Enumerate edges from triangles */
+    edges.reserve(triangles.size() * 3);
+
+    for (const auto& tri : triangles)
+    {
+        AddEdge(tri.a, tri.b);
+        AddEdge(tri.b, tri.c);
+        AddEdge(tri.c, tri.a);
+    }
+
+    /* Remove equivalent edges */
+    std::sort(
+        edges.begin(), edges.end(),
+        [](const Edge& lhs, const Edge& rhs)
+        {
+            if (lhs.a < rhs.a)
+                return true;
+            if (lhs.a > rhs.a)
+                return false;
+            return lhs.b < rhs.b;
+        }
+    );
+
+    std::size_t n = 0;
+
+    for (std::size_t i = 0; i < edges.size(); ++n)
+    {
+        /* Count equivalent edges */
+        auto j = i + 1;
+        while (j < edges.size() && edges[j].a == edges[i].a && edges[j].b == edges[i].b)
+            ++j;
+
+        if (edgeTriangleCounts)
+            edgeTriangleCounts->push_back(static_cast<std::uint32_t>(j - i));
+
+        edges[n] = edges[i];
+        i = j;
+    }
+
+    edges.resize(n);
+}
+
+/*
+Extracts all unique edges by packing each edge into a 64-bit key, sorting the keys with a parallel radix sort,
+and compacting equivalent keys in parallel. The result is sorted in the same order as with the comparison sort.
+*/
+template <typename IndexT>
+std::vector<Line<IndexT>> ExtractEdges(
+    const std::vector<Triangle<IndexT>>&    triangles,
+    std::size_t                             numVertices,
+    std::vector<std::uint32_t>*             edgeTriangleCounts)
+{
+    std::vector<Line<IndexT>> edges;
+
+    if (edgeTriangleCounts)
+        edgeTriangleCounts->clear();
+
+    const auto indexBits = std::max(std::size_t(1), Details::BitWidth(numVertices > 0 ? static_cast<std::uint64_t>(numVertices - 1) : 0));
+
+    if (indexBits > 32)
+    {
+        ExtractEdgesViaComparisonSort(triangles, edges, edgeTriangleCounts);
+        return edges;
+    }
+
+    /* Pack edges into keys: the smaller index in the upper bits, the larger index in the lower bits */
+    const auto numKeys = triangles.size() * 3;
+    const auto lowMask = (std::uint64_t(1) << indexBits) - 1;
+
+    std::vector<std::uint64_t> keys(numKeys), buffer;
+
+    auto MakeKey = [indexBits](std::uint64_t a, std::uint64_t b)
+    {
+        return (a < b ? ((a << indexBits) | b) : ((b << indexBits) | a));
+    };
+
+    Details::ParallelFor(
+        triangles.size(), g_edgeGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto& tri = triangles[i];
+                keys[i*3    ] = MakeKey(tri.a, tri.b);
+                keys[i*3 + 1] = MakeKey(tri.b, tri.c);
+                keys[i*3 + 2] = MakeKey(tri.c, tri.a);
+            }
+        }
+    );
+
+    Details::ParallelRadixSort(keys, buffer, indexBits * 2);
+
+    /* Count unique keys (i.e. the first key of each run) per chunk */
+    auto IsRunStart = [&keys](std::size_t i)
+    {
+        return (i == 0 || keys[i] != keys[i - 1]);
+    };
+
+    std::vector<std::size_t> chunkOffsets(Details::GetParallelChunkCount(numKeys, g_edgeGrainSize) + 1, 0);
+
+    Details::ParallelForChunks(
+        numKeys, g_edgeGrainSize,
+        [&](std::size_t chunk, std::size_t begin, std::size_t end)
+        {
+            std::size_t n = 0;
+            for (auto i = begin; i < end; ++i)
+            {
+                if (IsRunStart(i))
+                    ++n;
+            }
+            chunkOffsets[chunk + 1] = n;
+        }
+    );
+
+    for (std::size_t chunk = 1; chunk < chunkOffsets.size(); ++chunk)
+        chunkOffsets[chunk] += chunkOffsets[chunk - 1];
+
+    /* Write unique edges (and the length of their runs) into the output */
+    edges.resize(chunkOffsets.back());
+    if (edgeTriangleCounts)
+        edgeTriangleCounts->resize(chunkOffsets.back());
+
+    Details::ParallelForChunks(
+        numKeys, g_edgeGrainSize,
+        [&](std::size_t chunk, std::size_t begin, std::size_t end)
+        {
+            auto n = chunkOffsets[chunk];
+            for (auto i = begin; i < end; ++i)
+            {
+                if (IsRunStart(i))
+                {
+                    const auto key = keys[i];
+                    edges[n] = Line<IndexT>(
+                        static_cast<IndexT>(key >> indexBits),
+                        static_cast<IndexT>(key & lowMask)
+                    );
+
+                    if (edgeTriangleCounts)
+                    {
+                        /* Runs may continue into the next chunk */
+                        auto j = i + 1;
+                        while (j < numKeys && keys[j] == key)
+                            ++j;
+                        (*edgeTriangleCounts)[n] = static_cast<std::uint32_t>(j - i);
+                    }
+
+                    ++n;
+                }
+            }
+        }
+    );
+
+    return edges;
+}
+
+template std::vector<Line<unsigned char     >> ExtractEdges(const std::vector<Triangle<unsigned char     >>&, std::size_t, std::vector<std::uint32_t>*);
+template std::vector<Line<unsigned short    >> ExtractEdges(const std::vector<Triangle<unsigned short    >>&, std::size_t, std::vector<std::uint32_t>*);
+template std::vector<Line<unsigned int      >> ExtractEdges(const std::vector<Triangle<unsigned int      >>&, std::size_t, std::vector<std::uint32_t>*);
+template std::vector<Line<unsigned long     >> ExtractEdges(const std::vector<Triangle<unsigned long     >>&, std::size_t, std::vector<std::uint32_t>*);
+template std::vector<Line<unsigned long long>> ExtractEdges(const std::vector<Triangle<unsigned long long>>&, std::size_t, std::vector<std::uint32_t>*);
+
+namespace Details
+{
+
+void CheckVertexIndexRange(std::size_t numVertices, std::uint64_t maxIndex)
+{
+    if (numVertices > 0 && static_cast<std::uint64_t>(numVertices - 1) > maxIndex)
+        throw std::out_of_range(GM_EXCEPT_INFO("vertex index exceeds the range of the index type"));
+}
+
+} // /namespace Details
+
+
+/* ----- TriangleMesh class ----- */
+
 TriangleMesh::Vertex::Vertex(const Gs::Vector3& position, const Gs::Vector3& normal, const Gs::Vector2& texCoord) :
     position { position },
     normal   { normal   },
@@ -46,8 +250,9 @@ TriangleMesh::Vertex& TriangleMesh::Vertex::operator *= (Gs::Real rhs)
 }
 
 TriangleMesh::TriangleMesh(TriangleMesh&& rhs) noexcept :
-    vertices  { std::move(rhs.vertices)  },
-    triangles { std::move(rhs.triangles) }
+    vertices   { std::move(rhs.vertices)   },
+    triangles  { std::move(rhs.triangles)  },
+    adjacency_ { std::move(rhs.adjacency_) }
 {
 }
 
@@ -55,6 +260,7 @@ TriangleMesh& TriangleMesh::operator = (TriangleMesh&& rhs) noexcept
 {
     vertices = std::move(rhs.vertices);
     triangles = std::move(rhs.triangles);
+    adjacency_ = std::move(rhs.adjacency_);
     return *this;
 }
 
@@ -62,10 +268,12 @@ void TriangleMesh::Clear()
 {
     vertices.clear();
     triangles.clear();
+    ClearAdjacency();
 }
 
 TriangleMesh::VertexIndex TriangleMesh::AddVertex(const Gs::Vector3& position, const Gs::Vector3& normal, const Gs::Vector2& texCoord)
 {
+    ClearAdjacency();
     auto idx = vertices.size();
     vertices.push_back({ position, normal, texCoord });
     return idx;
@@ -74,6 +282,7 @@ TriangleMesh::VertexIndex TriangleMesh::AddVertex(const Gs::Vector3& position, c
 TriangleMesh::TriangleIndex TriangleMesh::AddTriangle(VertexIndex v0, VertexIndex v1, VertexIndex v2)
 {
     GS_ASSERT(v0 < vertices.size() && v1 < vertices.size() && v2 < vertices.size());
+    ClearAdjacency();
     auto idx = triangles.size();
     triangles.push_back({ v0, v1, v2 });
     return idx;
@@ -85,80 +294,39 @@ TriangleMesh::Vertex TriangleMesh::Barycentric(TriangleIndex triangleIndex, cons
 
     const auto& tri = triangles[triangleIndex];
 
-    #if 0
-
-    const auto& a = vertices[tri.a];
-    const auto& b = vertices[tri.b];
-    const auto& c = vertices[tri.c];
-
     Vertex v;
-
-    v.position  = a.position * barycentricCoords.x + b.position * barycentricCoords.y + c.position * barycentricCoords.z;
-    v.normal    = a.normal   * barycentricCoords.x + b.normal   * barycentricCoords.y + c.normal   * barycentricCoords.z;
-    v.texCoord  = a.texCoord * barycentricCoords.x + b.texCoord * barycentricCoords.y + c.texCoord * barycentricCoords.z;
-
-    #else
-
-    Vertex v;
-
-    MeshModifier::InterpolateBarycentric(
-        MeshModifier::GetDefaultVertexDesc(),
-        &v, vertices.data(),
-        tri.a,
-        tri.b,
-        tri.c,
-        barycentricCoords
-    );
-
-    #endif
+    InterpolateBarycentric<DefaultVertexLayout>(&v, vertices.data(), tri.a, tri.b, tri.c, barycentricCoords);
 
     return v;
 }
 
-std::vector<TriangleMesh::Edge> TriangleMesh::Edges() const
+void TriangleMesh::Barycentric(const TriangleIndex* triangleIndices, const Gs::Vector3* barycentricCoords, std::size_t count, Vertex* outputVertices) const
 {
-    std::vector<Edge> edges;
-
-    auto AddEdge = [&edges](VertexIndex a, VertexIndex b)
-    {
-        if (a < b)
-            edges.push_back({ a, b });
-        else
-            edges.push_back({ b, a });
-    };
-
-    /* Enumerate edges from triangles */
-    for (const auto& tri : triangles)
-    {
-        AddEdge(tri.a, tri.b);
-        AddEdge(tri.b, tri.c);
-        AddEdge(tri.c, tri.a);
-    }
-
-    /* Remove equivalent edges */
-    std::sort(
-        edges.begin(), edges.end(),
-        [](const Edge& lhs, const Edge& rhs)
-        {
-            if (lhs.a < rhs.a)
-                return true;
-            if (lhs.a > rhs.a)
-                return false;
-            return lhs.b < rhs.b;
-        }
-    );
-
-    auto last = std::unique(
-        edges.begin(), edges.end(),
-        [](const Edge& lhs, const Edge& rhs)
+    Details::ParallelFor(
+        count,
+        g_barycentricGrainSize,
+        [&](std::size_t begin, std::size_t end)
         {
-            return lhs.a == rhs.a && lhs.b == rhs.b;
+            InterpolateBarycentricBatch<DefaultVertexLayout>(
+                outputVertices + begin,
+                vertices.data(),
+                triangles.data(),
+                triangleIndices + begin,
+                barycentricCoords + begin,
+                end - begin
+            );
         }
     );
+}
 
-    edges.erase(last, edges.end());
+std::vector<TriangleMesh::Edge> TriangleMesh::Edges() const
+{
+    return ExtractEdges(triangles, vertices.size());
+}
 
-    return edges;
+std::vector<TriangleMesh::Edge> TriangleMesh::Edges(std::vector<std::uint32_t>& edgeTriangleCounts) const
+{
+    return ExtractEdges(triangles, vertices.size(), &edgeTriangleCounts);
 }
 
 std::vector<TriangleMesh::Edge> TriangleMesh::SilhouetteEdges(Gs::Real toleranceAngle) const
@@ -169,10 +337,15 @@ std::vector<TriangleMesh::Edge> TriangleMesh::SilhouetteEdges(Gs::Real tolerance
     toleranceAngle = std::sin(std::abs(toleranceAngle));
 
     /* Search all edges that are not part of the silhouette */
+    MeshAdjacency temporaryAdjacency;
+    const auto& adjacency = CachedOrTemporaryAdjacency(temporaryAdjacency, false);
+
+    std::vector<TriangleIndex> tris;
+
     auto PartOfSilh = [&](const Edge& edge)
     {
         /* Find all triangles that are connected to this edge and compare their normal of equality */
-        auto tris = FindTriangles(edge);
+        adjacency.EdgeTriangles(*this, edge, tris);
 
         if (tris.size() >= 2)
         {
@@ -207,63 +380,68 @@ std::set<TriangleMesh::TriangleIndex> TriangleMesh::TriangleNeighbors(
         GS_ASSERT(i < triangles.size());
     #endif
 
-    auto MatchVertex = [&](VertexIndex a, VertexIndex b)
+    MeshAdjacency temporaryAdjacency;
+    const auto& adjacency = CachedOrTemporaryAdjacency(temporaryAdjacency, searchViaPosition);
+
+    auto VertexKey = [&](VertexIndex v)
     {
-        return Gs::Equals(vertices[a].position, vertices[b].position);
+        return (searchViaPosition ? adjacency.WeldedVertex(v) : v);
     };
 
     auto HasVertex = [&](const Triangle& tri, VertexIndex v)
     {
-        if (searchViaPosition)
-            return (MatchVertex(v, tri.a) || MatchVertex(v, tri.b) || MatchVertex(v, tri.c));
-        return (v == tri.a || v == tri.b || v == tri.c);
+        v = VertexKey(v);
+        return (v == VertexKey(tri.a) || v == VertexKey(tri.b) || v == VertexKey(tri.c));
     };
 
-    /* Repeat the search for the specified number. */
-    std::set<TriangleIndex> neighbors;
+    /* Only the triangles found in the previous iteration (the frontier) can have new neighbors */
+    std::vector<bool> visited(triangles.size(), false);
+    std::vector<TriangleIndex> frontier(triangleIndices.begin(), triangleIndices.end()), neighbors;
 
-    for (; searchDepth > 0; --searchDepth)
+    for (auto i : frontier)
+        visited[i] = true;
+
+    /* Repeat the search for the specified number. */
+    for (; searchDepth > 0 && !frontier.empty(); --searchDepth)
     {
-        /* Iterate over all triangle which are currently not contained in the neighbor set */
-        for (TriangleIndex i = 0; i < triangles.size(); ++i)
+        for (auto j : frontier)
         {
-            if (triangleIndices.find(i) == triangleIndices.end())
+            const auto& tri = triangles[j];
+
+            /* Check all triangles which share a vertex with the current triangle in the search set (j) */
+            for (std::size_t k = 0; k < 3; ++k)
             {
-                const auto& indices = triangles[i];
+                auto candidates = (searchViaPosition ? adjacency.PositionTriangles(tri[k]) : adjacency.VertexTriangles(tri[k]));
 
-                /* Check if the current triangle (i) is a neighbor of the current triangle in the search set (j) */
-                for (auto j : triangleIndices)
+                for (auto i : candidates)
                 {
-                    const auto& tri = triangles[j];
+                    if (visited[i])
+                        continue;
 
-                    if (!edgeBondOnly)
-                    {
-                        /* Check for corner bond */
-                        if ( HasVertex(tri, indices.a) ||
-                             HasVertex(tri, indices.b) ||
-                             HasVertex(tri, indices.c) )
-                        {
-                            neighbors.insert(i);
-                        }
-                    }
-                    else
+                    if (edgeBondOnly)
                     {
                         /* Check for edge bond */
+                        const auto& indices = triangles[i];
+
                         int n = 0;
 
                         if (HasVertex(tri, indices.a)) ++n;
                         if (HasVertex(tri, indices.b)) ++n;
                         if (HasVertex(tri, indices.c)) ++n;
 
-                        if (n >= 2)
-                            neighbors.insert(i);
+                        if (n < 2)
+                            continue;
                     }
+
+                    visited[i] = true;
+                    neighbors.push_back(i);
                 }
             }
         }
 
         /* Take over new neighbors */
         triangleIndices.insert(neighbors.begin(), neighbors.end());
+        frontier.swap(neighbors);
         neighbors.clear();
     }
 
@@ -272,6 +450,12 @@ std::set<TriangleMesh::TriangleIndex> TriangleMesh::TriangleNeighbors(
 
 std::vector<TriangleMesh::TriangleIndex> TriangleMesh::FindTriangles(VertexIndex vertexIndex) const
 {
+    if (auto adjacency = ValidAdjacency())
+    {
+        auto range = adjacency->VertexTriangles(vertexIndex);
+        return std::vector<TriangleIndex>(range.begin(), range.end());
+    }
+
     std::vector<TriangleIndex> result;
 
     for (TriangleIndex i = 0; i < triangles.size(); ++i)
@@ -288,6 +472,12 @@ std::vector<TriangleMesh::TriangleIndex> TriangleMesh::FindTriangles(const Edge&
 {
     std::vector<TriangleIndex> result;
 
+    if (auto adjacency = ValidAdjacency())
+    {
+        adjacency->EdgeTriangles(*this, edge, result);
+        return result;
+    }
+
     auto HasEdge = [](const Triangle& tri, VertexIndex v0, VertexIndex v1)
     {
         return
@@ -306,6 +496,18 @@ std::vector<TriangleMesh::TriangleIndex> TriangleMesh::FindTriangles(const Edge&
     return result;
 }
 
+const MeshAdjacency& TriangleMesh::BuildAdjacency(bool weldByPosition)
+{
+    auto adjacency = std::make_shared<MeshAdjacency>(*this, weldByPosition);
+    adjacency_ = adjacency;
+    return *adjacency;
+}
+
+void TriangleMesh::ClearAdjacency()
+{
+    adjacency_.reset();
+}
+
 std::vector<Gm::Triangle<TriangleMesh::Vertex>> TriangleMesh::TriangleList() const
 {
     std::vector<Gm::Triangle<Vertex>> triangleList;
@@ -339,83 +541,65 @@ Gs::Vector3 TriangleMesh::TriangleNormal(TriangleIndex triangleIndex) const
 
 AABB3 TriangleMesh::BoundingBox() const
 {
-    AABB3 box;
-
-    for (const auto& vert : vertices)
-        box.Insert(vert.position);
-
-    return box;
+    if (vertices.empty())
+        return AABB3();
+    return ComputeBoundingBox(&(vertices.front().position.x), vertices.size(), sizeof(Vertex));
 }
 
 AABB3 TriangleMesh::BoundingBox(const Gs::AffineMatrix4& matrix) const
 {
+    #ifndef GS_ROW_VECTORS
+
+    if (vertices.empty())
+        return AABB3();
+    return ComputeBoundingBox(&(vertices.front().position.x), vertices.size(), sizeof(Vertex), matrix);
+
+    #else
+
     AABB3 box;
 
     for (const auto& vert : vertices)
         box.Insert(Gs::TransformVector(matrix, vert.position));
 
     return box;
+
+    #endif
 }
 
 #ifdef GM_ENABLE_MULTI_THREADING
 
-static void BoundingBoxThreadProc(AABB3& box, const TriangleMesh::Vertex* vertices, std::size_t vertexCount)
-{
-    for (std::size_t i = 0; i < vertexCount; ++i)
-        box.Insert(vertices[i].position);
-}
-
 AABB3 TriangleMesh::BoundingBoxMultiThreaded(std::size_t threadCount) const
 {
     /* Clamp thread count */
-    auto numVerts = vertices.size();
+    const auto numVerts = vertices.size();
 
     if (threadCount < 2 || numVerts / threadCount < 64)
         return BoundingBox();
 
-    if (threadCount < 1)
-        threadCount = 1;
-    if (threadCount > numVerts)
-        threadCount = numVerts;
-
-    auto verticesPerThread = numVerts / threadCount;
-
-    /* Allocate threads */
-    std::vector< std::unique_ptr<std::thread> > threads(threadCount);
-    std::vector<AABB3> subBoxes(threadCount);
-
-    for (std::size_t i = 0; i < threadCount; ++i)
-    {
-        threads[i] = std::unique_ptr<std::thread>(
-            new std::thread(
-                BoundingBoxThreadProc,
-                std::ref(subBoxes[i]),
-                &(vertices[verticesPerThread*i]),
-                verticesPerThread
-            )
-        );
-    }
-
-    /* Insert remaining vertices */
-    AABB3 box;
-
-    for (std::size_t i = verticesPerThread * threadCount; i < numVerts; ++i)
-        box.Insert(vertices[i].position);
-
-    /* Join all threads */
-    for (std::size_t i = 0; i < threadCount; ++i)
-    {
-        threads[i]->join();
-        box.Insert(subBoxes[i]);
-    }
-
-    return box;
+    /* Reduce sub-boxes on the global thread pool (rounding up the grain size limits the split to 'threadCount' chunks) */
+    return GetGlobalThreadPool()->ParallelReduce(
+        numVerts,
+        (numVerts + threadCount - 1) / threadCount,
+        AABB3(),
+        [this](std::size_t begin, std::size_t end)
+        {
+            return ComputeBoundingBox(&(vertices[begin].position.x), end - begin, sizeof(Vertex));
+        },
+        [](const AABB3& lhs, const AABB3& rhs)
+        {
+            auto box = lhs;
+            box.Insert(rhs);
+            return box;
+        }
+    );
 }
 
 #endif
 
 void TriangleMesh::Append(const TriangleMesh& other)
 {
+    ClearAdjacency();
+
     /* Append all vertices */
     auto vertexOffset = vertices.size();
     vertices.resize(vertexOffset + other.vertices.size());
@@ -436,6 +620,26 @@ void TriangleMesh::Append(const TriangleMesh& other)
 }
 
 
+/*
+ * ======= Private: =======
+ */
+
+const MeshAdjacency& TriangleMesh::CachedOrTemporaryAdjacency(MeshAdjacency& temporary, bool weldByPosition) const
+{
+    auto adjacency = ValidAdjacency();
+    if (adjacency && (!weldByPosition || adjacency->HasPositionWelding()))
+        return *adjacency;
+
+    temporary.Build(*this, weldByPosition);
+    return temporary;
+}
+
+const MeshAdjacency* TriangleMesh::ValidAdjacency() const
+{
+    return (adjacency_ && adjacency_->IsBuiltFor(*this) ? adjacency_.get() : nullptr);
+}
+
+
 } // /namespace Gm
 
 
@@ -0,0 +1,213 @@
+/*
+ * TriangleMeshSoA.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/TriangleMeshSoA.h>
+#include "ParallelDetails.h"
+#include <algorithm>
+
+
+namespace Gm
+{
+
+
+/* ----- Internal functions ----- */
+
+// Minimal number of vertices per thread for the layout conversion.
+static const std::size_t g_conversionGrainSize = 16384;
+
+
+/* ----- TriangleMeshSoA class ----- */
+
+TriangleMeshSoA::TriangleMeshSoA(const TriangleMesh& mesh)
+{
+    Assign(mesh);
+}
+
+void TriangleMeshSoA::Clear()
+{
+    positionsX.clear();
+    positionsY.clear();
+    positionsZ.clear();
+    normals.clear();
+    texCoords.clear();
+    triangles.clear();
+}
+
+void TriangleMeshSoA::Reserve(std::size_t numVertices, std::size_t numTriangles)
+{
+    positionsX.reserve(numVertices);
+    positionsY.reserve(numVertices);
+    positionsZ.reserve(numVertices);
+    normals.reserve(numVertices);
+    texCoords.reserve(numVertices);
+    triangles.reserve(numTriangles);
+}
+
+void TriangleMeshSoA::ResizeVertices(std::size_t numVertices)
+{
+    positionsX.resize(numVertices);
+    positionsY.resize(numVertices);
+    positionsZ.resize(numVertices);
+    normals.resize(numVertices);
+    texCoords.resize(numVertices);
+}
+
+void TriangleMeshSoA::Assign(const TriangleMesh& mesh)
+{
+    const auto& vertices = mesh.vertices;
+
+    ResizeVertices(vertices.size());
+    triangles = mesh.triangles;
+
+    /* Split interleaved vertices into separate streams */
+    Details::ParallelFor(
+        vertices.size(),
+        g_conversionGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto& vert = vertices[i];
+                positionsX[i]   = vert.position.x;
+                positionsY[i]   = vert.position.y;
+                positionsZ[i]   = vert.position.z;
+                normals[i]      = vert.normal;
+                texCoords[i]    = vert.texCoord;
+            }
+        }
+    );
+}
+
+void TriangleMeshSoA::ToTriangleMesh(TriangleMesh& mesh) const
+{
+    auto& vertices = mesh.vertices;
+
+    vertices.resize(NumVertices());
+    mesh.triangles = triangles;
+    mesh.ClearAdjacency();
+
+    /* Merge separate streams into interleaved vertices */
+    Details::ParallelFor(
+        vertices.size(),
+        g_conversionGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+                vertices[i] = GetVertex(i);
+        }
+    );
+}
+
+TriangleMesh TriangleMeshSoA::ToTriangleMesh() const
+{
+    TriangleMesh mesh;
+    ToTriangleMesh(mesh);
+    return mesh;
+}
+
+TriangleMeshSoA::VertexIndex TriangleMeshSoA::AddVertex(const Gs::Vector3& position, const Gs::Vector3& normal, const Gs::Vector2& texCoord)
+{
+    auto idx = NumVertices();
+    positionsX.push_back(position.x);
+    positionsY.push_back(position.y);
+    positionsZ.push_back(position.z);
+    normals.push_back(normal);
+    texCoords.push_back(texCoord);
+    return idx;
+}
+
+TriangleMeshSoA::VertexIndex TriangleMeshSoA::AddVertex(const Vertex& vertex)
+{
+    return AddVertex(vertex.position, vertex.normal, vertex.texCoord);
+}
+
+TriangleMeshSoA::TriangleIndex TriangleMeshSoA::AddTriangle(VertexIndex v0, VertexIndex v1, VertexIndex v2)
+{
+    GS_ASSERT(v0 < NumVertices() && v1 < NumVertices() && v2 < NumVertices());
+    auto idx = triangles.size();
+    triangles.push_back({ v0, v1, v2 });
+    return idx;
+}
+
+Gs::Vector3 TriangleMeshSoA::Position(VertexIndex vertexIndex) const
+{
+    return Gs::Vector3(positionsX[vertexIndex], positionsY[vertexIndex], positionsZ[vertexIndex]);
+}
+
+void TriangleMeshSoA::SetPosition(VertexIndex vertexIndex, const Gs::Vector3& position)
+{
+    positionsX[vertexIndex] = position.x;
+    positionsY[vertexIndex] = position.y;
+    positionsZ[vertexIndex] = position.z;
+}
+
+TriangleMeshSoA::Vertex TriangleMeshSoA::GetVertex(VertexIndex vertexIndex) const
+{
+    return Vertex(Position(vertexIndex), normals[vertexIndex], texCoords[vertexIndex]);
+}
+
+TriangleMeshSoA::Vertex TriangleMeshSoA::Barycentric(TriangleIndex triangleIndex, const Gs::Vector3& barycentricCoords) const
+{
+    GS_ASSERT(triangleIndex < triangles.size());
+
+    const auto& tri = triangles[triangleIndex];
+
+    auto Interpolate = [&](const Gs::Real* stream) -> Gs::Real
+    {
+        return stream[tri.a] * barycentricCoords.x + stream[tri.b] * barycentricCoords.y + stream[tri.c] * barycentricCoords.z;
+    };
+
+    return Vertex(
+        Gs::Vector3(Interpolate(positionsX.data()), Interpolate(positionsY.data()), Interpolate(positionsZ.data())),
+        normals  [tri.a] * barycentricCoords.x + normals  [tri.b] * barycentricCoords.y + normals  [tri.c] * barycentricCoords.z,
+        texCoords[tri.a] * barycentricCoords.x + texCoords[tri.b] * barycentricCoords.y + texCoords[tri.c] * barycentricCoords.z
+    );
+}
+
+AABB3 TriangleMeshSoA::BoundingBox() const
+{
+    return Positions().BoundingBox();
+}
+
+AABB3 TriangleMeshSoA::BoundingBox(const Gs::AffineMatrix4& matrix) const
+{
+    return Positions().BoundingBox(matrix);
+}
+
+void TriangleMeshSoA::Append(const TriangleMeshSoA& other)
+{
+    /* Take the sizes before resizing, because 'other' may refer to this mesh */
+    const auto vertexOffset     = NumVertices();
+    const auto numVertices      = other.NumVertices();
+    const auto triangleOffset   = triangles.size();
+    const auto numTriangles     = other.triangles.size();
+
+    /* Append vertex streams (copy after resizing, so the source is not invalidated by a reallocation) */
+    ResizeVertices(vertexOffset + numVertices);
+
+    std::copy_n(other.positionsX.begin(), numVertices, positionsX.begin() + vertexOffset);
+    std::copy_n(other.positionsY.begin(), numVertices, positionsY.begin() + vertexOffset);
+    std::copy_n(other.positionsZ.begin(), numVertices, positionsZ.begin() + vertexOffset);
+    std::copy_n(other.normals.begin(), numVertices, normals.begin() + vertexOffset);
+    std::copy_n(other.texCoords.begin(), numVertices, texCoords.begin() + vertexOffset);
+
+    /* Append triangles with index offset */
+    triangles.resize(triangleOffset + numTriangles);
+
+    for (std::size_t i = 0; i < numTriangles; ++i)
+    {
+        const auto& tri = other.triangles[i];
+        triangles[triangleOffset + i] = { tri.a + vertexOffset, tri.b + vertexOffset, tri.c + vertexOffset };
+    }
+}
+
+
+} // /namespace Gm
+
+
+
+// ================================================================================
@@ -0,0 +1,44 @@
+/*
+ * WeldDetails.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_WELD_DETAILS_H
+#define GM_WELD_DETAILS_H
+
+
+#include <Geom/TriangleMesh.h>
+#include <Geom/MeshModifier.h>
+#include <vector>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+/**
+\brief Finds for each vertex the vertex with the smallest index that can be welded with it, using a spatial hash in O(n log n).
+\return List of weld candidates. Each candidate is either the vertex itself or a vertex with a smaller index.
+\see WeldVertices
+*/
+std::vector<TriangleMesh::VertexIndex> FindWeldCandidates(
+    const std::vector<TriangleMesh::Vertex>&    vertices,
+    const WeldDescriptor&                       weldDesc
+);
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
@@ -228,6 +228,19 @@ static void testConeCollision()
         std::cout << "cone is NOT on front side of the plane" << std::endl;
 }
 
+static void indexBufferTest1()
+{
+    // Append 32-bit indices which fit into 16 bits to a default (16-bit) buffer
+    IndexBuffer src(IndexFormat::UInt32);
+    src.Append({ { 0, 1, 2 }, { 2, 1, 3 } });
+
+    IndexBuffer dst;
+    dst.Append(src, 4);
+
+    std::cout << "index buffer: format = " << (dst.GetFormat() == IndexFormat::UInt16 ? "UInt16" : "UInt32");
+    std::cout << ", triangles = " << dst.NumTriangles() << ", max index = " << dst.GetMaxIndex() << std::endl;
+}
+
 int main()
 {
     std::cout << "GeometronLib Test 1" << std::endl;
@@ -243,6 +256,7 @@ int main()
     //uniformSplineTest1();
     //testAABBCollision();
     testConeCollision();
+    indexBufferTest1();
 
     #ifdef _WIN32
     system("pause");
@@ -0,0 +1,706 @@
+/*
+ * Test9_Kernels.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Gauss/Gauss.h>
+#include <Geom/MeshGenerator.h>
+#include <Geom/MeshModifier.h>
+#include <Geom/MeshClipper.h>
+#include <Geom/TriangleMeshSoA.h>
+#include <Geom/BoundingBoxKernels.h>
+#include <Geom/BernsteinPolynomial.h>
+#include <Geom/Spline.h>
+#include <Geom/UniformSpline.h>
+#include <Gauss/RotateVector.h>
+#include <Gauss/TransformVector.h>
+#include <iostream>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+
+using namespace Gm;
+
+static const auto g_pi2 = Gs::Real(Gs::pi) * Gs::Real(2);
+
+static int g_numFailures = 0;
+
+static void check(const std::string& name, bool passed)
+{
+    std::cout << (passed ? "passed: " : "FAILED: ") << name << std::endl;
+    if (!passed)
+        ++g_numFailures;
+}
+
+static double elapsedMilliseconds(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void meshGeneratorAppendTest()
+{
+    // Append many small primitives to one mesh; the containers must keep their geometric growth
+    const std::size_t numCuboids = 16000;
+
+    MeshGenerator::CuboidDescriptor desc;
+    TriangleMesh mesh;
+
+    std::size_t numReallocs = 0;
+    auto data = mesh.vertices.data();
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < numCuboids; ++i)
+    {
+        desc.size = Gs::Vector3(Gs::Real(1) + Gs::Real(i % 7));
+        MeshGenerator::GenerateCuboid(desc, mesh);
+        if (mesh.vertices.data() != data)
+        {
+            data = mesh.vertices.data();
+            ++numReallocs;
+        }
+    }
+
+    std::cout << "appended " << numCuboids << " cuboids: " << numReallocs << " reallocations, " << elapsedMilliseconds(start) << " ms" << std::endl;
+
+    const auto counts = MeshGenerator::CountCuboid(desc);
+    check("mesh generator append: vertex count", mesh.vertices.size() == numCuboids * counts.numVertices);
+    check("mesh generator append: geometric growth", numReallocs <= 64);
+}
+
+static void curveRingRotationTest()
+{
+    // Torus knot like curve with the default options, i.e. Y-aligned ring frames and uniform rings
+    MeshGenerator::CurveDescriptor desc;
+    desc.curveFunction = [](Gs::Real t)
+    {
+        const auto a = t * g_pi2;
+        return Gs::Vector3(
+            std::cos(Gs::Real(2)*a) * (Gs::Real(2) + std::cos(Gs::Real(3)*a)),
+            std::sin(Gs::Real(3)*a),
+            std::sin(Gs::Real(2)*a) * (Gs::Real(2) + std::cos(Gs::Real(3)*a))
+        );
+    };
+    desc.segments = Gs::Vector2ui(400, 32);
+
+    const auto mesh     = MeshGenerator::GenerateCurve(desc);
+    const auto segsU    = desc.segments.x;
+    const auto segsV    = desc.segments.y;
+
+    // Compare against the per-vertex rotation around the tangent
+    auto maxError = Gs::Real(0);
+
+    for (std::uint32_t u = 0; u < segsU; ++u)
+    {
+        const auto p0 = desc.curveFunction(static_cast<Gs::Real>(u) / (segsU - 1));
+        const auto p1 = desc.curveFunction(static_cast<Gs::Real>((u + 1) % (segsU - 1)) / (segsU - 1));
+
+        auto tangent = p1 - p0;
+        tangent.Normalize();
+
+        auto ringNormal = Gs::Cross(tangent, Gs::Cross(Gs::Vector3(0, 1, 0), tangent));
+        ringNormal.Normalize();
+
+        for (std::uint32_t v = 0; v < segsV; ++v)
+        {
+            const auto angle    = static_cast<Gs::Real>(v) / (segsV - 1) * g_pi2;
+            const auto normal   = Gs::RotateVectorAroundAxis(ringNormal, tangent, angle);
+            const auto& vertex  = mesh.vertices[u*segsV + v];
+
+            maxError = std::max(maxError, Gs::Distance(vertex.normal, normal));
+            maxError = std::max(maxError, Gs::Distance(vertex.position, p0 + normal * desc.radius));
+        }
+    }
+
+    std::cout << "curve ring rotation: max. error " << maxError << std::endl;
+    check("curve ring rotation within rounding", maxError < Gs::Real(1.0e-5));
+}
+
+/* ----- Bounding box kernels ----- */
+
+template <typename T>
+static bool equalBoxes(const AABB3T<T>& lhs, const AABB3T<T>& rhs)
+{
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        if (lhs.min[i] != rhs.min[i] || lhs.max[i] != rhs.max[i])
+            return false;
+    }
+    return true;
+}
+
+template <typename T>
+static bool boundingBoxKernelTest()
+{
+    // Strided points with a padding scalar, so the AoS kernel has to skip memory between the points
+    const std::size_t maxCount = 1001;
+    const std::size_t stride = 4*sizeof(T);
+
+    std::vector<T> points(maxCount * 4), x(maxCount), y(maxCount), z(maxCount);
+
+    for (std::size_t i = 0; i < maxCount; ++i)
+    {
+        x[i] = static_cast<T>(std::sin(static_cast<double>(i) * 0.37) * 100.0);
+        y[i] = static_cast<T>(std::cos(static_cast<double>(i) * 1.13) * 50.0 - 3.0);
+        z[i] = static_cast<T>(static_cast<double>(i % 17) - 8.5);
+
+        // NaN coordinates must be ignored like in 'AABB::Insert'
+        if (i % 97 == 5)
+            y[i] = std::numeric_limits<T>::quiet_NaN();
+
+        points[i*4    ] = x[i];
+        points[i*4 + 1] = y[i];
+        points[i*4 + 2] = z[i];
+        points[i*4 + 3] = std::numeric_limits<T>::quiet_NaN();
+    }
+
+    Gs::AffineMatrix4T<T> matrix;
+    matrix(0, 0) = T(0.8);  matrix(0, 1) = T(-0.6); matrix(0, 2) = T(0.1);  matrix(0, 3) = T(5);
+    matrix(1, 0) = T(0.6);  matrix(1, 1) = T(0.8);  matrix(1, 2) = T(-0.2); matrix(1, 3) = T(-2);
+    matrix(2, 0) = T(0.05); matrix(2, 1) = T(0.3);  matrix(2, 2) = T(1.5);  matrix(2, 3) = T(0.25);
+
+    // Compare all remainder sizes of the SIMD loops and a large count against the scalar insertion
+    std::vector<std::size_t> counts;
+    for (std::size_t count = 0; count <= 40; ++count)
+        counts.push_back(count);
+    counts.push_back(maxCount);
+
+    for (const auto count : counts)
+    {
+        AABB3T<T> box, transformedBox;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const Gs::Vector3T<T> p(x[i], y[i], z[i]);
+            box.Insert(p);
+            transformedBox.Insert(Gs::TransformVector(matrix, p));
+        }
+
+        if (!equalBoxes(ComputeBoundingBox(points.data(), count, stride), box) ||
+            !equalBoxes(ComputeBoundingBoxSoA(x.data(), y.data(), z.data(), count), box) ||
+            !equalBoxes(ComputeBoundingBox(points.data(), count, stride, matrix), transformedBox) ||
+            !equalBoxes(ComputeBoundingBoxSoA(x.data(), y.data(), z.data(), count, matrix), transformedBox))
+        {
+            std::cout << "bounding box mismatch for " << count << " points" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void boundingBoxTest()
+{
+    check("SIMD bounding box equals scalar (float)", boundingBoxKernelTest<float>());
+    check("SIMD bounding box equals scalar (double)", boundingBoxKernelTest<double>());
+}
+
+
+/* ----- Half precision packing ----- */
+
+// Reference conversion from half to single precision.
+static float halfToFloat(std::uint16_t h)
+{
+    const auto sign     = ((h & 0x8000u) != 0 ? -1.0f : 1.0f);
+    const auto exponent = static_cast<int>((h >> 10) & 0x1Fu);
+    const auto mantissa = static_cast<int>(h & 0x03FFu);
+
+    if (exponent == 0)
+        return sign * std::ldexp(static_cast<float>(mantissa), -24);
+    if (exponent == 31)
+        return (mantissa == 0 ? sign * std::numeric_limits<float>::infinity() : std::numeric_limits<float>::quiet_NaN());
+
+    return sign * std::ldexp(static_cast<float>(mantissa | 0x0400), exponent - 25);
+}
+
+// Packs the specified values as half precision positions and returns the packed components.
+static std::vector<std::uint16_t> packHalfs(const std::vector<float>& values)
+{
+    TriangleMesh mesh;
+
+    for (std::size_t i = 0; i < values.size(); i += 3)
+    {
+        Gs::Vector3 position;
+        for (std::size_t j = 0; j < 3; ++j)
+            position[j] = static_cast<Gs::Real>(i + j < values.size() ? values[i + j] : 0.0f);
+        mesh.AddVertex(position, Gs::Vector3(0, 0, 1), Gs::Vector2(0, 0));
+    }
+
+    MeshModifier::VertexPackingDescriptor packingDesc;
+    packingDesc.attributes.push_back(
+        MeshModifier::PackedVertexAttribute(
+            MeshModifier::VertexSemantic::Position,
+            MeshModifier::VertexAttributeDescriptor(0, 3, MeshModifier::VertexFormat::Half)
+        )
+    );
+
+    std::vector<std::vector<std::uint8_t>> buffers;
+    MeshModifier::PackVertices(mesh, packingDesc, buffers);
+
+    std::vector<std::uint16_t> halfs(values.size());
+    std::memcpy(halfs.data(), buffers[0].data(), halfs.size() * sizeof(std::uint16_t));
+
+    return halfs;
+}
+
+static void halfPackingTest()
+{
+    // All finite halfs (including subnormals and signed zeros) and both infinities must survive the round-trip
+    std::vector<float> values;
+    std::vector<std::uint16_t> expected;
+
+    for (std::uint32_t h = 0; h <= 0xFFFFu; ++h)
+    {
+        if ((h & 0x7C00u) == 0x7C00u && (h & 0x03FFu) != 0)
+            continue;
+        values.push_back(halfToFloat(static_cast<std::uint16_t>(h)));
+        expected.push_back(static_cast<std::uint16_t>(h));
+    }
+
+    check("half precision round-trip", packHalfs(values) == expected);
+
+    // Rounding to nearest even, overflow to infinity, and underflow of subnormals
+    const std::pair<float, std::uint16_t> cases[] =
+    {
+        { 1.0f + std::ldexp(1.0f, -11),         0x3C00u },  // Tie rounds down to even
+        { 1.0f + 3.0f*std::ldexp(1.0f, -11),    0x3C02u },  // Tie rounds up to even
+        { 65504.0f,                             0x7BFFu },  // Largest half
+        { 65519.0f,                             0x7BFFu },  // Rounds down to the largest half
+        { 65520.0f,                             0x7C00u },  // Rounds up to infinity
+        { 1.0e10f,                              0x7C00u },
+        { -1.0e10f,                             0xFC00u },
+        { std::ldexp(1.0f, -14),                0x0400u },  // Smallest normal half
+        { std::ldexp(1.0f, -24),                0x0001u },  // Smallest subnormal half
+        { std::ldexp(1.0f, -25),                0x0000u },  // Tie rounds down to zero
+        { 1.5f*std::ldexp(1.0f, -25),           0x0001u },
+        { 2.5f*std::ldexp(1.0f, -24),           0x0002u },  // Subnormal tie rounds to even
+        { 3.5f*std::ldexp(1.0f, -24),           0x0004u },
+        { -std::ldexp(1.0f, -26),               0x8000u },  // Underflow keeps the sign
+    };
+
+    // Repeat the cases, so they are converted by the SIMD blocks and by the scalar remainders
+    values.clear();
+    expected.clear();
+
+    for (int repeat = 0; repeat < 5; ++repeat)
+    {
+        for (const auto& c : cases)
+        {
+            values.push_back(c.first);
+            expected.push_back(c.second);
+        }
+    }
+
+    check("half precision rounding, overflow, and underflow", packHalfs(values) == expected);
+}
+
+
+/* ----- Mesh clipping ----- */
+
+static std::size_t countRefs(const std::vector<MeshClipper::VertexRef>& refs, MeshClipper::VertexRef::Type type)
+{
+    return static_cast<std::size_t>(
+        std::count_if(
+            refs.begin(), refs.end(),
+            [type](const MeshClipper::VertexRef& ref) { return ref.type == type; }
+        )
+    );
+}
+
+static bool hasUniquePositions(const TriangleMesh& mesh)
+{
+    std::vector<std::array<Gs::Real, 3>> positions;
+    positions.reserve(mesh.vertices.size());
+
+    for (const auto& v : mesh.vertices)
+        positions.push_back({ { v.position.x, v.position.y, v.position.z } });
+
+    std::sort(positions.begin(), positions.end());
+    return (std::adjacent_find(positions.begin(), positions.end()) == positions.end());
+}
+
+static void clipperDeduplicationTest()
+{
+    // Closed torus without duplicate positions
+    MeshGenerator::TorusDescriptor torusDesc;
+    torusDesc.segments = Gs::Vector2ui(64, 48);
+
+    auto mesh = MeshGenerator::GenerateTorus(torusDesc);
+    MeshModifier::WeldVertices(mesh);
+
+    const Plane clipPlane(Gs::Vector3(Gs::Real(0.3), Gs::Real(1), Gs::Real(0.2)).Normalized(), Gs::Real(0.1));
+
+    MeshClipper clipper;
+    TriangleMesh front, back;
+    clipper.Clip(mesh, clipPlane, front, back);
+
+    const auto& frontRefs   = clipper.GetVertexRefs();
+    const auto& backRefs    = clipper.GetBackVertexRefs();
+
+    const auto numFrontEdges    = countRefs(frontRefs, MeshClipper::VertexRef::Type::Edge);
+    const auto numBackEdges     = countRefs(backRefs, MeshClipper::VertexRef::Type::Edge);
+    const auto numFrontKept     = countRefs(frontRefs, MeshClipper::VertexRef::Type::Original);
+    const auto numBackKept      = countRefs(backRefs, MeshClipper::VertexRef::Type::Original);
+
+    std::cout << "clipped " << mesh.vertices.size() << " vertices into " << front.vertices.size() << " + " << back.vertices.size()
+        << " vertices (" << numFrontEdges << " edge vertices)" << std::endl;
+
+    // Each split edge creates exactly one vertex per side, and each kept vertex is referenced once
+    check("clipper: split edges on both sides", numFrontEdges > 0 && numFrontEdges == numBackEdges);
+    check("clipper: kept vertices are shared", numFrontKept + numBackKept == mesh.vertices.size());
+    check("clipper: no duplicate vertices", hasUniquePositions(front) && hasUniquePositions(back));
+
+    // The other mesh layouts must produce the same topology
+    CompactTriangleMesh compactMesh(mesh), compactFront, compactBack;
+    MeshModifier::ClipMesh(compactMesh, PlaneT<float>(clipPlane.normal.Cast<float>(), static_cast<float>(clipPlane.distance)), compactFront, compactBack);
+
+    TriangleMeshSoA soaMesh(mesh), soaFront, soaBack;
+    MeshModifier::ClipMesh(soaMesh, clipPlane, soaFront, soaBack);
+
+    check(
+        "clipper: templated and SoA meshes",
+        compactFront.vertices.size() == front.vertices.size() && compactBack.triangles.size() == back.triangles.size() &&
+        soaFront.NumVertices() == front.vertices.size() && soaBack.triangles.size() == back.triangles.size()
+    );
+
+    // Vertices inside of clipped triangles are interpolated in one batch, which must equal the single interpolation
+    const Plane planes[] =
+    {
+        Plane(Gs::Vector3(1, 0, 0), Gs::Real(0.2)),
+        Plane(Gs::Vector3(0, 1, 0), Gs::Real(0.3)),
+        Plane(Gs::Vector3(0, Gs::Real(0.6), Gs::Real(0.8)), Gs::Real(0.1)),
+    };
+
+    TriangleMesh inside;
+    clipper.ClipConvex(mesh, planes, 3, inside);
+
+    std::size_t numInterior = 0, numWrong = 0;
+    const auto& insideRefs = clipper.GetVertexRefs();
+
+    for (std::size_t i = 0; i < insideRefs.size(); ++i)
+    {
+        const auto& ref = insideRefs[i];
+        if (ref.type == MeshClipper::VertexRef::Type::Interior)
+        {
+            const auto v = mesh.Barycentric(ref.index, ref.barycentric);
+            if (std::memcmp(&v.position, &inside.vertices[i].position, sizeof(v.position)) != 0 ||
+                std::memcmp(&v.normal, &inside.vertices[i].normal, sizeof(v.normal)) != 0 ||
+                std::memcmp(&v.texCoord, &inside.vertices[i].texCoord, sizeof(v.texCoord)) != 0)
+            {
+                ++numWrong;
+            }
+            ++numInterior;
+        }
+    }
+
+    check("clipper: batched interior vertices", numInterior > 0 && numWrong == 0);
+}
+
+
+/* ----- Splines ----- */
+
+// Reference binomial coefficient with factorials, which is exact for n <= 20.
+static double referenceBinomial(std::uint32_t i, std::uint32_t n)
+{
+    return static_cast<double>(Details::Factorial(n) / (Details::Factorial(i) * Details::Factorial(n - i)));
+}
+
+static double referenceBernstein(double t, std::uint32_t i, std::uint32_t n)
+{
+    return referenceBinomial(i, n) * std::pow(t, static_cast<int>(i)) * std::pow(1.0 - t, static_cast<int>(n - i));
+}
+
+static void bernsteinTest()
+{
+    const std::size_t numSamples = 33;
+    const auto maxError = 1.0e-12;
+
+    std::vector<double> t(numSamples), batch;
+    for (std::size_t k = 0; k < numSamples; ++k)
+        t[k] = static_cast<double>(k) / (numSamples - 1);
+
+    double basis[21], error = 0.0;
+
+    for (std::uint32_t n = 1; n <= 20; ++n)
+    {
+        batch.resize((n + 1) * numSamples);
+        BernsteinBasis(t.data(), numSamples, n, batch.data());
+
+        for (std::size_t k = 0; k < numSamples; ++k)
+        {
+            BernsteinBasis(t[k], n, basis);
+
+            for (std::uint32_t i = 0; i <= n; ++i)
+            {
+                const auto expected = referenceBernstein(t[k], i, n);
+                error = std::max(error, std::abs(BernsteinPolynomial(t[k], i, n) - expected));
+                error = std::max(error, std::abs(basis[i] - expected));
+                error = std::max(error, std::abs(batch[i*numSamples + k] - expected));
+            }
+        }
+    }
+
+    for (std::size_t k = 0; k < numSamples; ++k)
+    {
+        BernsteinBasis<3>(t[k], basis);
+        for (std::uint32_t i = 0; i <= 3; ++i)
+            error = std::max(error, std::abs(basis[i] - referenceBernstein(t[k], i, 3)));
+
+        BernsteinBasis<4>(t[k], basis);
+        for (std::uint32_t i = 0; i <= 4; ++i)
+            error = std::max(error, std::abs(basis[i] - referenceBernstein(t[k], i, 4)));
+    }
+
+    check("Bernstein polynomials equal the binomial formula", error < maxError);
+
+    // The multiplicative binomial coefficients must match Pascal's triangle beyond the range of the factorials
+    bool binomialsValid = true;
+    std::vector<std::uint64_t> row(1, 1);
+
+    for (std::uint64_t n = 1; n <= 62; ++n)
+    {
+        std::vector<std::uint64_t> next(n + 1, 1);
+        for (std::uint64_t i = 1; i < n; ++i)
+            next[i] = row[i - 1] + row[i];
+        row.swap(next);
+
+        for (std::uint64_t i = 0; i <= n; ++i)
+            binomialsValid = binomialsValid && (Details::BinomialCoefficient(i, n) == row[i]);
+    }
+
+    check("binomial coefficients up to n = 62", binomialsValid);
+}
+
+static double referenceInterval(const Spline3d& spline, int i)
+{
+    const auto& points = spline.GetPoints();
+    i = std::max(0, std::min(i, static_cast<int>(points.size()) - 1));
+    return points[static_cast<std::size_t>(i)].interval;
+}
+
+// Reference B-spline basis with the recursion of Cox and de Boor.
+static double referenceBasis(const Spline3d& spline, int q, int i, double t)
+{
+    const auto xi   = referenceInterval(spline, i);
+    const auto xi1  = referenceInterval(spline, i + 1);
+
+    if (q == 0)
+        return (xi <= t && t < xi1 ? 1.0 : 0.0);
+
+    const auto xiq  = referenceInterval(spline, i + q);
+    const auto xiq1 = referenceInterval(spline, i + q + 1);
+
+    const auto dx1  = xiq - xi;
+    const auto dx2  = xiq1 - xi1;
+
+    double r1 = 0.0, r2 = 0.0;
+
+    if (dx1 > 0.0)
+        r1 = (t - xi)/dx1 * referenceBasis(spline, q - 1, i, t);
+    if (dx2 > 0.0)
+        r2 = (xiq1 - t)/dx2 * referenceBasis(spline, q - 1, i + 1, t);
+
+    return r1 + r2;
+}
+
+static Gs::Vector3d referenceSpline(const Spline3d& spline, double t)
+{
+    Gs::Vector3d result(0, 0, 0);
+
+    const auto& points = spline.GetPoints();
+    int j = -spline.GetOrder();
+
+    for (std::size_t i = 0; i < points.size(); ++i, ++j)
+        result += points[i].point * referenceBasis(spline, spline.GetOrder(), j, t);
+
+    return result;
+}
+
+static void splineDeBoorTest()
+{
+    // Non-uniform intervals with a repeated knot
+    const double intervals[] = { 0.0, 0.5, 1.0, 1.0, 2.5, 3.0, 4.5, 5.0, 6.0, 8.0 };
+
+    auto maxError = 0.0;
+
+    for (int order = 1; order <= 5; ++order)
+    {
+        Spline3d spline;
+
+        for (std::size_t i = 0; i < sizeof(intervals)/sizeof(intervals[0]); ++i)
+        {
+            const auto x = static_cast<double>(i);
+            spline.AddPoint(Gs::Vector3d(x, std::sin(x), std::cos(x*0.7) * 2.0), intervals[i]);
+        }
+
+        spline.SetOrder(order);
+
+        // Sample beyond both ends and exactly at the knots
+        std::vector<double> t;
+        for (int k = -40; k <= 360; ++k)
+            t.push_back(static_cast<double>(k) / 40.0);
+
+        std::vector<Gs::Vector3d> points(t.size());
+        spline.Evaluate(t.data(), points.data(), t.size());
+
+        for (std::size_t k = 0; k < t.size(); ++k)
+        {
+            const auto expected = referenceSpline(spline, t[k]);
+            maxError = std::max(maxError, Gs::Distance(spline.Evaluate(t[k]), expected));
+            maxError = std::max(maxError, Gs::Distance(points[k], expected));
+        }
+    }
+
+    std::cout << "de Boor spline evaluation: max. error " << maxError << std::endl;
+    check("de Boor spline evaluation equals Cox-de Boor recursion", maxError < 1.0e-9);
+}
+
+static bool equalPolynomials(const UniformSpline3d& lhs, const UniformSpline3d& rhs)
+{
+    const auto& a = lhs.GetPolynomials();
+    const auto& b = rhs.GetPolynomials();
+
+    if (a.size() != b.size())
+        return false;
+
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        for (std::size_t j = 0; j < 4; ++j)
+        {
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                if (a[i][j][k] != b[i][j][k])
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static void uniformSplineIncrementalTest()
+{
+    std::vector<Gs::Vector3d> points;
+    for (std::size_t i = 0; i < 300; ++i)
+    {
+        const auto x = static_cast<double>(i);
+        points.push_back(Gs::Vector3d(x, std::sin(x*0.3) * 4.0, std::cos(x*0.11)));
+    }
+
+    for (const auto expansion : { 1.0, 0.5 })
+    {
+        UniformSpline3d spline, rebuilt;
+        spline.Build(points, expansion);
+
+        // Each modification must give the same polynomials as a complete rebuild
+        bool equal = true;
+
+        auto CompareWithRebuild = [&]()
+        {
+            rebuilt.Build(spline.GetPoints(), expansion);
+            equal = equal && equalPolynomials(spline, rebuilt);
+        };
+
+        spline.SetPoint(150, Gs::Vector3d(150, 10, -3));
+        CompareWithRebuild();
+
+        spline.SetPoint(0, Gs::Vector3d(-1, 2, 0));
+        CompareWithRebuild();
+
+        spline.SetPoint(spline.GetPoints().size() - 1, Gs::Vector3d(310, 0, 5));
+        CompareWithRebuild();
+
+        spline.InsertPoint(80, Gs::Vector3d(79.5, -6, 1));
+        CompareWithRebuild();
+
+        spline.InsertPoint(0, Gs::Vector3d(-2, 0, 0));
+        CompareWithRebuild();
+
+        spline.InsertPoint(spline.GetPoints().size(), Gs::Vector3d(320, 1, 1));
+        CompareWithRebuild();
+
+        spline.RemovePoint(200);
+        CompareWithRebuild();
+
+        spline.RemovePoint(0);
+        CompareWithRebuild();
+
+        spline.RemovePoint(spline.GetPoints().size() - 1);
+        CompareWithRebuild();
+
+        check(std::string("incremental uniform spline equals rebuild") + (expansion < 1.0 ? " (expansion 0.5)" : ""), equal);
+    }
+}
+
+static void tangentsFineUVTest()
+{
+    // Grid with 1024x1024 quads and texture coordinates in [0, 1], i.e. each UV determinant is about 1e-6
+    const std::size_t n = 1024;
+    const auto invN = Gs::Real(1) / static_cast<Gs::Real>(n);
+
+    TriangleMesh mesh;
+
+    for (std::size_t j = 0; j <= n; ++j)
+    {
+        for (std::size_t i = 0; i <= n; ++i)
+        {
+            const auto u = static_cast<Gs::Real>(i) * invN;
+            const auto v = static_cast<Gs::Real>(j) * invN;
+            mesh.AddVertex(Gs::Vector3(u, v, 0), Gs::Vector3(0, 0, 1), Gs::Vector2(u, v));
+        }
+    }
+
+    for (std::size_t j = 0; j < n; ++j)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const auto v0 = j*(n + 1) + i;
+            mesh.AddTriangle(v0, v0 + 1, v0 + n + 2);
+            mesh.AddTriangle(v0, v0 + n + 2, v0 + n + 1);
+        }
+    }
+
+    std::vector<Gs::Vector4> tangents;
+    MeshModifier::GenerateTangents(mesh, tangents);
+
+    // All tangents must point along +U, which is the X axis
+    std::size_t numWrong = 0;
+    for (const auto& t : tangents)
+    {
+        if (!(t.x > Gs::Real(0.999) && t.w > Gs::Real(0)))
+            ++numWrong;
+    }
+
+    check("tangents of fine texture coordinates", numWrong == 0);
+}
+
+int main()
+{
+    std::cout << "GeometronLib Test 9" << std::endl;
+    std::cout << "===================" << std::endl;
+
+    boundingBoxTest();
+    halfPackingTest();
+    clipperDeduplicationTest();
+    bernsteinTest();
+    splineDeBoorTest();
+    uniformSplineIncrementalTest();
+    meshGeneratorAppendTest();
+    curveRingRotationTest();
+    tangentsFineUVTest();
+
+    if (g_numFailures > 0)
+        std::cout << g_numFailures << " test(s) failed" << std::endl;
+    else
+        std::cout << "all tests passed" << std::endl;
+
+    return (g_numFailures > 0 ? 1 : 0);
+}